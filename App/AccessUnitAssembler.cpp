@@ -0,0 +1,144 @@
+#include <string.h>
+#include <algorithm>
+#include <climits>
+
+#include "AccessUnitAssembler.h"
+
+AccessUnitAssembler::AccessUnitAssembler(std::unique_ptr<BitstreamInput> source)
+    : m_source(std::move(source)) {
+    m_sourcePersistent = m_source->isPayloadPersistent();
+}
+
+bool AccessUnitAssembler::xFetch() {
+    if(m_eof) {
+        return false;
+    }
+    if(m_source->read(m_next) <= 0) {
+        m_eof = true;
+        return false;
+    }
+    return true;
+}
+
+bool AccessUnitAssembler::xStartsNewAu(const AccessUnit& nalUnit) const {
+    if(m_nals.empty() || nalUnit.numNals == 0 || nalUnit.nals[0].size < 2) {
+        return false;
+    }
+
+    const uint8_t*    header  = nalUnit.payload + nalUnit.nals[0].offset;
+    const NalUnitType nut     = (NalUnitType)((header[1] >> 3) & 0x1f);
+    const int         layerId = header[0] & 0x3f;
+
+    switch(nut) {
+    case NAL_UNIT_ACCESS_UNIT_DELIMITER:
+        return true;
+
+    case NAL_UNIT_OPI:
+    case NAL_UNIT_DCI:
+    case NAL_UNIT_VPS:
+    case NAL_UNIT_SPS:
+    case NAL_UNIT_PPS:
+    case NAL_UNIT_PREFIX_APS:
+    case NAL_UNIT_PH:
+    case NAL_UNIT_PREFIX_SEI:
+    case NAL_UNIT_RESERVED_NVCL_26:
+    case NAL_UNIT_UNSPECIFIED_28:
+    case NAL_UNIT_UNSPECIFIED_29:
+        return m_hasVcl && layerId <= m_lastVclLayerId;
+
+    default:
+        break;
+    }
+
+    if(nut <= NAL_UNIT_RESERVED_IRAP_VCL_11 && nalUnit.nals[0].size > 2) {
+        // sh_picture_header_in_slice_header_flag is the first bit after the NAL unit header, the
+        // header's second byte is non-zero so it can not be an emulation prevention byte
+        const bool picHeaderInSliceHeader = (header[2] & 0x80) != 0;
+        return picHeaderInSliceHeader && m_hasVcl && layerId <= m_lastVclLayerId;
+    }
+    return false;
+}
+
+void AccessUnitAssembler::xStartCopying() {
+    if(m_copying) {
+        return;
+    }
+    m_buffer.resize(m_size);
+    if(m_size) {
+        ::memcpy(m_buffer.data(), m_span, m_size);
+    }
+    m_copying = true;
+}
+
+void AccessUnitAssembler::xAppend(const AccessUnit& nalUnit) {
+    const size_t size = (size_t)nalUnit.payloadUsedSize;
+
+    if(!m_copying) {
+        if(m_nals.empty() && m_size == 0 && m_sourcePersistent) {
+            m_span = nalUnit.payload;
+        } else if(!m_sourcePersistent || m_span + m_size != nalUnit.payload) {
+            xStartCopying();
+        }
+    }
+    if(m_copying) {
+        m_buffer.resize(m_size + size);
+        ::memcpy(m_buffer.data() + m_size, nalUnit.payload, size);
+    } else {
+        // the source's readable bytes behind the NAL unit stay readable behind the access unit
+        m_available = m_size + std::max(size, (size_t)nalUnit.payloadSize);
+    }
+
+    for(int i = 0; i < nalUnit.numNals; i++) {
+        NalBoundary nal = nalUnit.nals[i];
+        nal.offset += m_size;
+        m_nals.push_back(nal);
+
+        if(nal.size >= 2) {
+            const uint8_t*    header = nalUnit.payload + nalUnit.nals[i].offset;
+            const NalUnitType nut    = (NalUnitType)((header[1] >> 3) & 0x1f);
+            if(nut <= NAL_UNIT_RESERVED_IRAP_VCL_11) {
+                m_hasVcl         = true;
+                m_lastVclLayerId = header[0] & 0x3f;
+                m_rap           |= nut >= NAL_UNIT_CODED_SLICE_IDR_W_RADL && nut <= NAL_UNIT_CODED_SLICE_GDR;
+            }
+        }
+    }
+    m_size += size;
+}
+
+int AccessUnitAssembler::read(AccessUnit& accessUnit) {
+    accessUnit.payloadUsedSize = 0;
+
+    m_span           = nullptr;
+    m_size           = 0;
+    m_available      = 0;
+    m_copying        = false;
+    m_nals.clear();
+    m_hasVcl         = false;
+    m_lastVclLayerId = -1;
+    m_rap            = false;
+
+    if(!m_hasNext && !xFetch()) {
+        return -1;
+    }
+    xAppend(m_next);
+    m_hasNext = false;
+
+    while(xFetch()) {
+        if(xStartsNewAu(m_next)) {
+            m_hasNext = true;
+            break;
+        }
+        xAppend(m_next);
+    }
+
+    const uint8_t* payload = m_copying ? m_buffer.data() : m_span;
+    CHECK(m_size > INT_MAX, "access unit too large");
+    accessUnit.payload         = const_cast<unsigned char*>(payload);
+    accessUnit.payloadSize     = m_copying ? (int)m_size : (int)std::min<size_t>(INT_MAX, m_available);
+    accessUnit.payloadUsedSize = (int)m_size;
+    accessUnit.nals            = m_nals.data();
+    accessUnit.numNals         = (int)m_nals.size();
+    accessUnit.rap             = m_rap;
+    return accessUnit.payloadUsedSize;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "BitstreamInput.h"
+
+// Groups the NAL units of another input into complete access units, so that DecImpl::decode sees a
+// whole picture (all layers of one time instance) per call. A new access unit starts with
+//  - an access unit delimiter,
+//  - a DCI, OPI, VPS, SPS, PPS, prefix APS, PH, prefix SEI or reserved/unspecified prefix NAL unit
+//    that follows a VCL NAL unit of the same or a higher layer,
+//  - a slice with sh_picture_header_in_slice_header_flag equal to 1 (the first slice of a picture
+//    without a separate PH NAL unit) that follows a VCL NAL unit of the same or a higher layer.
+// The picture order count is not checked since slice headers are not parsed at this stage; within a
+// layer every new picture carries a PH, either as a NAL unit or in its first slice.
+//
+// If the source keeps its payloads valid (a fully mapped file) and the NAL units are contiguous, the
+// access unit points into the source; otherwise the NAL units are copied into a reused buffer.
+class AccessUnitAssembler : public BitstreamInput {
+public:
+    explicit AccessUnitAssembler( std::unique_ptr<BitstreamInput> source );
+    ~AccessUnitAssembler() override = default;
+    CLASS_COPY_MOVE_DELETE( AccessUnitAssembler )
+
+    int  read( AccessUnit& accessUnit ) override;
+
+private:
+    bool xFetch       ();
+    bool xStartsNewAu ( const AccessUnit& nalUnit ) const;
+    void xAppend      ( const AccessUnit& nalUnit );
+    void xStartCopying();
+
+    std::unique_ptr<BitstreamInput> m_source;
+    bool                            m_sourcePersistent;
+
+    AccessUnit                      m_next           = {};      // NAL unit last read from the source
+    bool                            m_hasNext        = false;   // m_next belongs to the next access unit
+    bool                            m_eof            = false;
+
+    // access unit being assembled
+    const uint8_t*                  m_span           = nullptr; // zero-copy: start of the payload in the source
+    size_t                          m_size           = 0;
+    size_t                          m_available      = 0;       // zero-copy: bytes readable from m_span
+    bool                            m_copying        = false;
+    std::vector<uint8_t>            m_buffer;
+    NalBoundaryVec                  m_nals;
+    bool                            m_hasVcl         = false;
+    int                             m_lastVclLayerId = -1;
+    bool                            m_rap            = false;
+};
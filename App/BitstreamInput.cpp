@@ -0,0 +1,27 @@
+#include <climits>
+#include <algorithm>
+
+#include "BitstreamInput.h"
+
+int BitstreamInput::xSetAccessUnit(AccessUnit& accessUnit, const uint8_t* payload, size_t size, size_t available, size_t startCodePos) {
+    CHECK(size > INT_MAX, "NAL unit too large");
+
+    accessUnit.payload         = const_cast<unsigned char*>(payload);
+    accessUnit.payloadSize     = (int)std::min<size_t>(INT_MAX, available);
+    accessUnit.payloadUsedSize = (int)size;
+
+    // hand the NAL unit boundary to the decoder so it does not have to scan the payload again
+    accessUnit.nals    = nullptr;
+    accessUnit.numNals = 0;
+    if(startCodePos + 3 <= size) {
+        m_nal.offset       = startCodePos + 3;
+        m_nal.startCodeLen = (startCodePos > 0 && payload[startCodePos - 1] == 0) ? 4 : 3;
+        m_nal.size         = size - m_nal.offset;
+        while(m_nal.size > 0 && payload[m_nal.offset + m_nal.size - 1] == 0) {
+            m_nal.size--;
+        }
+        accessUnit.nals    = &m_nal;
+        accessUnit.numNals = 1;
+    }
+    return accessUnit.payloadUsedSize;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "Common/Def.h"
+#include "Common/NalScanner.h"
+#include "Decoder/Decode.h"
+
+// Source of Annex-B NAL units for the decoder app.
+class BitstreamInput {
+public:
+    BitstreamInput() = default;
+    virtual ~BitstreamInput() = default;
+    CLASS_COPY_MOVE_DELETE( BitstreamInput )
+
+    // Fills accessUnit with the next NAL unit including its start code, together with its boundary.
+    // The payload stays valid until the next call to read() or close(). Returns the payload size or -1 at the end of the input.
+    virtual int read( AccessUnit& accessUnit ) = 0;
+
+    // True if payloads handed out by read() stay valid until the input is closed.
+    virtual bool isPayloadPersistent() const { return false; }
+
+protected:
+    // Points accessUnit at size payload bytes of which available can be read. startCodePos is the
+    // payload offset of the NAL unit's 00 00 01, or size if the payload does not contain one.
+    int xSetAccessUnit( AccessUnit& accessUnit, const uint8_t* payload, size_t size, size_t available, size_t startCodePos );
+
+    NalBoundary m_nal = {};   // boundary of the NAL unit returned by the last read()
+};
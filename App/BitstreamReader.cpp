@@ -0,0 +1,142 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <iostream>
+
+#include "BitstreamReader.h"
+
+BitstreamReader::~BitstreamReader() {
+    close();
+}
+
+int BitstreamReader::open(const std::string& fileName, size_t maxMapSize) {
+    close();
+
+    m_fd = ::open(fileName.c_str(), O_RDONLY);
+    if(m_fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if(fstat(m_fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close();
+        return -1;
+    }
+
+    // the window must cover at least one page, otherwise remapping could not make progress
+    const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    m_maxMapSize = std::max(pageSize, (maxMapSize + pageSize - 1) & ~(pageSize - 1));
+    m_fileSize   = (uint64_t)st.st_size;
+    m_readPos    = 0;
+
+    if(m_fileSize > 0 && !xMapWindow(0)) {
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+void BitstreamReader::close() {
+    xUnmapWindow();
+    if(m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_fileSize = 0;
+    m_readPos  = 0;
+}
+
+bool BitstreamReader::xMapWindow(uint64_t offset) {
+    xUnmapWindow();
+
+    const uint64_t pageSize  = (uint64_t)sysconf(_SC_PAGESIZE);
+    const uint64_t mapPos    = offset & ~(pageSize - 1);
+    const size_t   mapSize   = (size_t)std::min<uint64_t>(m_maxMapSize, m_fileSize - mapPos);
+
+    void* ptr = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, m_fd, (off_t)mapPos);
+    if(ptr == MAP_FAILED) {
+        return false;
+    }
+    madvise(ptr, mapSize, MADV_SEQUENTIAL);
+
+    m_window     = (const uint8_t*)ptr;
+    m_windowPos  = mapPos;
+    m_windowSize = mapSize;
+    return true;
+}
+
+void BitstreamReader::xUnmapWindow() {
+    if(m_window) {
+        munmap((void*)m_window, m_windowSize);
+        m_window = nullptr;
+    }
+    m_windowPos  = 0;
+    m_windowSize = 0;
+}
+
+// Searches the mapped window for the next 00 00 01 at or after file offset from.
+bool BitstreamReader::xFindNextStartCode(uint64_t from, uint64_t& startCodePos) {
+    const uint8_t* end = m_window + m_windowSize;
+    const uint8_t* sc  = findStartCode(m_window + (from - m_windowPos), end);
+    if(sc == end) {
+        return false;
+    }
+    startCodePos = m_windowPos + (sc - m_window);
+    return true;
+}
+
+int BitstreamReader::read(AccessUnit& accessUnit) {
+    accessUnit.payloadUsedSize = 0;
+
+    if(m_fd < 0 || m_readPos >= m_fileSize) {
+        return -1;
+    }
+
+    // the whole NAL unit has to be inside the window, move it to the NAL unit start if needed
+    if(m_readPos < m_windowPos || m_readPos >= m_windowPos + m_windowSize) {
+        if(!xMapWindow(m_readPos)) {
+            std::cerr << "W266 [error]: failed to map the bitstream file" << std::endl;
+            return -1;
+        }
+    }
+
+    uint64_t nalEnd       = m_fileSize;
+    uint64_t ownStartCode = 0;
+    bool     hasStartCode = false;
+    while(true) {
+        const uint64_t windowEnd = m_windowPos + m_windowSize;
+
+        uint64_t nextStartCode = 0;
+        hasStartCode = xFindNextStartCode(m_readPos, ownStartCode);
+        if(hasStartCode && xFindNextStartCode(ownStartCode + 3, nextStartCode)) {
+            // a leading zero_byte belongs to the next start code
+            nalEnd = nextStartCode;
+            if(nalEnd > m_readPos && m_window[nalEnd - 1 - m_windowPos] == 0) {
+                nalEnd--;
+            }
+            break;
+        }
+        if(windowEnd >= m_fileSize) {
+            nalEnd = m_fileSize;
+            break;
+        }
+        if(m_windowPos == (m_readPos & ~((uint64_t)sysconf(_SC_PAGESIZE) - 1))) {
+            // the window already starts at this NAL unit, remapping cannot make it fit
+            std::cerr << "W266 [error]: NAL unit exceeds the bitstream mapping size" << std::endl;
+            return -1;
+        }
+        if(!xMapWindow(m_readPos)) {
+            std::cerr << "W266 [error]: failed to map the bitstream file" << std::endl;
+            return -1;
+        }
+    }
+
+    const uint8_t* payload   = m_window + (m_readPos - m_windowPos);
+    const size_t   available = (size_t)(m_windowPos + m_windowSize - m_readPos);
+    const size_t   size      = (size_t)(nalEnd - m_readPos);
+    const int      ret       = xSetAccessUnit(accessUnit, payload, size, available, hasStartCode ? (size_t)(ownStartCode - m_readPos) : size);
+
+    m_readPos = nalEnd;
+    return ret;
+}
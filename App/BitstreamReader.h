@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+#include "BitstreamInput.h"
+
+// Annex-B byte stream reader. The file is memory-mapped and every access unit handed out by read()
+// points directly into the mapping, so no payload bytes are copied. Files larger than the mapping
+// budget are streamed through a sliding window that is remapped whenever a NAL unit crosses its end.
+class BitstreamReader : public BitstreamInput {
+public:
+    static const size_t DEFAULT_MAX_MAP_SIZE = size_t( 1 ) << 30;   // 1 GiB of address space
+
+    BitstreamReader() = default;
+    ~BitstreamReader() override;
+    CLASS_COPY_MOVE_DELETE( BitstreamReader )
+
+    int  open ( const std::string& fileName, size_t maxMapSize = DEFAULT_MAX_MAP_SIZE );
+    void close();
+
+    int  read ( AccessUnit& accessUnit ) override;
+    bool isPayloadPersistent() const override { return !isStreaming(); }
+
+    // Continues reading at the start code at file offset pos, e.g. a random access point.
+    void     seek(uint64_t pos)    { m_readPos = pos; }
+    uint64_t tell()          const { return m_readPos; }
+
+    // the whole file, if it is mapped at once
+    const uint8_t* getData()  const { return isStreaming() ? nullptr : m_window; }
+
+    bool     isOpen()      const { return m_fd >= 0; }
+    bool     isStreaming() const { return m_fileSize > m_maxMapSize; }
+    uint64_t getFileSize() const { return m_fileSize; }
+
+private:
+    bool xMapWindow        ( uint64_t offset );
+    void xUnmapWindow      ();
+    bool xFindNextStartCode( uint64_t from, uint64_t& startCodePos );
+
+    int             m_fd         = -1;
+    uint64_t        m_fileSize   = 0;
+    size_t          m_maxMapSize = DEFAULT_MAX_MAP_SIZE;
+
+    const uint8_t*  m_window     = nullptr;   // mapped part of the file
+    uint64_t        m_windowPos  = 0;         // file offset of m_window[0]
+    size_t          m_windowSize = 0;
+
+    uint64_t        m_readPos    = 0;         // file offset of the next NAL unit start code
+};
@@ -1,159 +1,148 @@
-#include <iostream>
-#include <fstream>
+#include <sys/stat.h>
+#include <stdlib.h>
 #include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
 
 #include "Decoder/Decode.h"
+#include "Common/Trace.h"
+#include "BitstreamReader.h"
+#include "StreamReader.h"
+#include "PrefetchReader.h"
+#include "AccessUnitAssembler.h"
+#include "RapIndex.h"
+#include "NalTable.h"
+
+static bool handle_frame() {
+    return true;
+}
 
-static inline int retrieveNalStartCode(unsigned char *pB, int iZerosInStartcode) {
-    int info = 1;
-    int i=0;
-    for (i = 0; i < iZerosInStartcode; i++) {
-        if( pB[i] != 0 ) {
-            info = 0;
+static bool isRegularFile(const std::string& path) {
+    struct stat st;
+    return path != "-" && stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// Regular files are memory-mapped, stdin ("-"), pipes and devices are read through a ring buffer.
+// With scanThreads >= 0 a file is indexed up front on that many threads (0: all). Only regular
+// files can start at startOffset > 0.
+static std::unique_ptr<BitstreamInput> openBitstream(const std::string& path, uint64_t startOffset, int scanThreads) {
+    if(isRegularFile(path) && scanThreads >= 0) {
+        std::unique_ptr<NalTableReader> reader(new NalTableReader());
+        if(reader->open(path, scanThreads) != 0) {
+            return nullptr;
         }
+        reader->seek(startOffset);
+        return reader;
     }
-
-    if (pB[i] != 1 ){
-        info = 0;
+    if(isRegularFile(path)) {
+        std::unique_ptr<BitstreamReader> reader(new BitstreamReader());
+        if(reader->open(path) != 0) {
+            return nullptr;
+        }
+        reader->seek(startOffset);
+        return reader;
     }
 
-    return info;
+    if(startOffset > 0) {
+        return nullptr;
+    }
+    std::unique_ptr<StreamReader> reader(new StreamReader());
+    if(reader->open(path) != 0) {
+        return nullptr;
+    }
+    return reader;
 }
 
-static int readBitstreamFromFile(std::ifstream *f, AccessUnit* pcAccessUnit, bool bLoop) {
-    int info2=0;
-    int info3=0;
-    int pos = 0;
-
-    int iStartCodeFound =0;
-    int iRewind=0;
-    uint32_t len;
-    unsigned char* pBuf = pcAccessUnit->payload;
-    pcAccessUnit->payloadUsedSize = 0;
-
-    auto curfilpos = f->tellg();
-    if(curfilpos < 0) {
-        if(bLoop) {
-            f->clear();
-            f->seekg(0, f->beg);
-            if(f->bad() || f->fail()) {
-                return -1;
-            }
+int main(int argc, char* argv[]) {
+    std::string bsFilePath;
+    int         iPrefetch = 0;                                    // > 0: read that many units ahead on a background thread
+    bool        bStats    = false;
+    int         iRap      = -1;                                   // random access point to start at
+    std::string indexFilePath;
+    int         iScanThreads = -1;                                // >= 0: index the whole file up front
+    std::string traceFilePath;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-b" && i + 1 < argc) {
+            bsFilePath = argv[++i];
+        } else if(arg == "--prefetch" && i + 1 < argc) {
+            iPrefetch = std::max(0, atoi(argv[++i]));
+        } else if(arg == "--stats") {
+            bStats = true;
+        } else if(arg == "--rap" && i + 1 < argc) {
+            iRap = atoi(argv[++i]);
+        } else if(arg == "--index" && i + 1 < argc) {
+            indexFilePath = argv[++i];
+        } else if(arg == "--scan-threads" && i + 1 < argc) {
+            iScanThreads = std::max(0, atoi(argv[++i]));
+        } else if(arg == "--trace" && i + 1 < argc) {
+            traceFilePath = argv[++i];
         } else {
-            return -1;
+            bsFilePath = arg;
         }
     }
 
-    //jump over possible start code
-    f->read((char*)pBuf, 5);
-    size_t extracted = f->gcount();
-    if(extracted < 4) {
-        if( bLoop ) {
-            f->clear();
-            f->seekg( 0, f->beg );
-            if(f->bad() || f->fail()) {
-                return -1;
-            }
-
-            f->read((char*)pBuf, 5);
-            size_t extracted = f->gcount();
-            if(extracted < 4) {
-                return -1;
-            }
+    if(!traceFilePath.empty()) {
+        if(!TRACING_ENABLED) {
+            std::cerr << "W266 [error]: tracing is not compiled in, configure with -DENABLE_TRACING=ON" << std::endl;
+            return -1;
         }
-        else {
+        if(SyntaxTrace::get().open(traceFilePath) != 0) {
+            std::cerr << "W266 [error]: failed to open trace file " << traceFilePath << std::endl;
             return -1;
         }
     }
 
-    pos +=5;
-    info2 = 0;
-    info3 = 0;
-    iStartCodeFound = 0;
-
-    while(!iStartCodeFound) {
-        if(f->eof()) {
-            if(pos > 5) {
-                len = pos - 1;
-                pcAccessUnit->payloadUsedSize=len;
-                return len;
-            } else if(bLoop) {
-                f->clear();
-                f->seekg( 0, f->beg );
-            } else {
-                return -1;
-            }
+    // seeking uses the random access index next to the bitstream, which is built on first use
+    uint64_t             uiStartOffset = 0;
+    std::vector<uint8_t> paramSets;
+    if(iRap >= 0) {
+        RapIndex index;
+        if(indexFilePath.empty()) {
+            indexFilePath = RapIndex::getDefaultIndexFile(bsFilePath);
         }
-
-        if( pos >= pcAccessUnit->payloadSize ) {
-            int iNewSize = pcAccessUnit->payloadSize*2;
-            unsigned char* newbuf = (unsigned char*) malloc(sizeof( unsigned char ) * iNewSize);
-            if(newbuf == NULL) {
-                fprintf( stderr, "ERR: readBitstreamFromFile: memory re-allocation failed!\n" );
+        if(!isRegularFile(bsFilePath)) {
+            std::cerr << "W266 [error]: random access requires a bitstream file" << std::endl;
+            return -1;
+        }
+        if(index.load(indexFilePath, bsFilePath) != 0) {
+            if(index.build(bsFilePath, std::max(0, iScanThreads)) != 0) {
+                std::cerr << "W266 [error]: failed to index bitstream file" << std::endl;
                 return -1;
             }
-            std::copy_n( pcAccessUnit->payload, std::min(pcAccessUnit->payloadSize , iNewSize), newbuf);
-            pcAccessUnit->payloadSize = iNewSize;
-            free( pcAccessUnit->payload );
-
-            pcAccessUnit->payload = newbuf;
-            pBuf = pcAccessUnit->payload;
+            if(index.save(indexFilePath) != 0) {
+                std::cerr << "W266 [warning]: failed to write random access index " << indexFilePath << std::endl;
+            }
         }
-        unsigned char* p= pBuf + pos;
-        f->read((char*)p, 1);
-        pos++;
-
-        info3 = retrieveNalStartCode(&pBuf[pos-4], 3);
-        if(info3 != 1)
-        {
-        info2 = retrieveNalStartCode(&pBuf[pos-3], 2);
+        if(iRap >= (int)index.getEntries().size() || index.readParamSets(bsFilePath, iRap, paramSets) != 0) {
+            std::cerr << "W266 [error]: random access point " << iRap << " not available" << std::endl;
+            return -1;
         }
-        iStartCodeFound = (info2 == 1 || info3 == 1);
+        uiStartOffset = index.getEntries()[iRap].offset;
     }
 
-
-    // Here, we have found another start code (and read length of startcode bytes more than we should
-    // have.  Hence, go back in the file
-    iRewind = 0;
-    if(info3 == 1)
-        iRewind = -4;
-    else if (info2 == 1)
-        iRewind = -3;
-    else
-        fprintf( stderr, "ERR: readBitstreamFromFile: Error in next start code search \n");
-
-    f->seekg (iRewind, f->cur);
-    if(f->bad() || f->fail()) {
-        fprintf( stderr, "ERR: readBitstreamFromFile: Cannot seek %d in the bit stream file", iRewind );
+    std::unique_ptr<BitstreamInput> pcReader = bsFilePath.empty() ? nullptr : openBitstream(bsFilePath, uiStartOffset, iScanThreads);
+    if(!pcReader) {
+        std::cerr << "W266 [error]: failed to open bitstream file " << std::endl;
         return -1;
     }
 
-    // Here the Start code, the complete NALU, and the next start code is in the pBuf.
-    // The size of pBuf is pos, pos+rewind are the number of bytes excluding the next
-    // start code, and (pos+rewind)-startcodeprefix_len is the size of the NALU
-
-    len = (pos+iRewind);
-    pcAccessUnit->payloadUsedSize=len;
-    return len;
-}
+    // decode whole access units, assembled on the prefetch thread if there is one
+    pcReader.reset(new AccessUnitAssembler(std::move(pcReader)));
 
-static bool handle_frame() {
-    return true;
-}
-
-int main(int argc, char* argv[]) {
-    std::string bsFilePath = std::string(argv[2]);
-    std::ifstream cInFile(bsFilePath.c_str(), std::fstream::binary );
-    if(!cInFile) {
-        std::cerr << "W266 [error]: failed to open bitstream file " << std::endl;
-        return -1;
+    // prefetching copies every unit, so it is opt-in: it pays off for pipes and slow storage, while mapped
+    // files are read without a copy on the decoder thread
+    PrefetchReader* pcPrefetch = nullptr;
+    if(iPrefetch > 0) {
+        pcPrefetch = new PrefetchReader(std::move(pcReader), iPrefetch);
+        pcReader.reset(pcPrefetch);
     }
 
+    // the payload buffer is provided by the reader
     AccessUnit* accessUnit = accessUnitAlloc();
-    accessUnitAllocPayload(accessUnit, MAX_CODED_PICTURE_SIZE);
 
     Frame* pcFrame = NULL;
-    Frame* pcPrevField = NULL;
 
     Decoder* dec = decoderOpen();
 
@@ -161,20 +150,33 @@ int main(int argc, char* argv[]) {
     accessUnit->dts = 0; accessUnit->dtsValid = true;
 
     int iRet = -1;
-    int iRead = 0;
-    do {
-        iRead = readBitstreamFromFile(&cInFile, accessUnit, false);
-        NalType eNalType = getNalUnitType(accessUnit);
+    if(!paramSets.empty()) {
+        // parameter sets that precede the random access point
+        AccessUnit paramSetUnit = *accessUnit;
+        paramSetUnit.payload         = paramSets.data();
+        paramSetUnit.payloadSize     = (int)paramSets.size();
+        paramSetUnit.payloadUsedSize = (int)paramSets.size();
+        iRet = decode(dec, &paramSetUnit, &pcFrame);
+    }
 
+    while(pcReader->read(*accessUnit) > 0) {
         iRet = decode(dec, accessUnit, &pcFrame);
 
         handle_frame();
+    }
 
-    } while (iRead > 0);
+    if(bStats && pcPrefetch) {
+        const PrefetchStats& stats = pcPrefetch->getStats();
+        std::cout << "W266 [info]: prefetch queue size " << stats.queueSize
+                  << ", mean depth " << (stats.numUnits ? (double)stats.sumDepth / stats.numUnits : 0.0)
+                  << ", max depth " << stats.maxDepth
+                  << ", decoder stall " << stats.decoderStallSec << " s"
+                  << ", reader stall " << stats.readerStallSec << " s" << std::endl;
+    }
 
     decoderClose();
 
     accessUnitFree();
 
-    return 0;
-}
\ No newline at end of file
+    return iRet < 0 ? -1 : 0;
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include "NalTable.h"
+
+static void findStartCodes(const uint8_t* data, size_t begin, size_t end, size_t size, std::vector<uint64_t>& positions) {
+    // start codes beginning in [begin, end) may reach two bytes into the next chunk
+    const uint8_t* scanEnd = data + std::min(end + 2, size);
+    const uint8_t* sc      = findStartCode(data + begin, scanEnd);
+    while(sc != scanEnd) {
+        positions.push_back(sc - data);
+        sc = findStartCode(sc + 3, scanEnd);
+    }
+}
+
+void NalTable::build(const uint8_t* data, size_t size, unsigned numThreads) {
+    if(numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t numChunks = std::max<size_t>(1, std::min<size_t>(numThreads, size / MIN_CHUNK_SIZE));
+    const size_t chunkSize = (size + numChunks - 1) / numChunks;
+
+    std::vector<std::vector<uint64_t>> chunkPositions(numChunks);
+    std::vector<std::thread>           threads;
+    for(size_t i = 1; i < numChunks; i++) {
+        threads.emplace_back(findStartCodes, data, i * chunkSize, std::min(size, (i + 1) * chunkSize), size, std::ref(chunkPositions[i]));
+    }
+    findStartCodes(data, 0, std::min(size, chunkSize), size, chunkPositions[0]);
+    for(std::thread& thread: threads) {
+        thread.join();
+    }
+
+    // a 00 00 01 can not overlap another one, so the chunks' start codes are disjoint and ordered
+    std::vector<uint64_t> positions;
+    for(const std::vector<uint64_t>& chunk: chunkPositions) {
+        positions.insert(positions.end(), chunk.begin(), chunk.end());
+    }
+
+    const size_t numNals = positions.size();
+    m_offset      .resize(numNals);
+    m_size        .resize(numNals);
+    m_startCodeLen.resize(numNals);
+    m_nalUnitType .resize(numNals);
+    m_layerId     .resize(numNals);
+    m_temporalId  .resize(numNals);
+
+    for(size_t i = 0; i < numNals; i++) {
+        const uint64_t sc     = positions[i];
+        const uint64_t offset = sc + 3;
+        uint64_t       end    = i + 1 < numNals ? positions[i + 1] : size;
+
+        // the zero_byte of a 4 byte start code and trailing zero bytes do not belong to the NAL unit
+        while(end > offset && data[end - 1] == 0) {
+            end--;
+        }
+        CHECK(end - offset > std::numeric_limits<uint32_t>::max(), "NAL unit too large");
+
+        m_offset[i]       = offset;
+        m_size[i]         = (uint32_t)(end - offset);
+        m_startCodeLen[i] = (sc > 0 && data[sc - 1] == 0) ? 4 : 3;
+        if(m_size[i] >= 2) {
+            m_nalUnitType[i] = (uint8_t)getNalUnitHeaderType(data + offset);
+            m_layerId[i]     = (uint8_t)getNalUnitHeaderLayerId(data + offset);
+            m_temporalId[i]  = (int8_t) getNalUnitHeaderTemporalId(data + offset);
+        } else {
+            m_nalUnitType[i] = NAL_UNIT_INVALID;
+            m_layerId[i]     = 0;
+            m_temporalId[i]  = -1;
+        }
+    }
+}
+
+size_t NalTable::findNalUnit(uint64_t pos) const {
+    size_t lo = 0;
+    size_t hi = size();
+    while(lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if(getStartCodeOffset(mid) < pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int NalTableReader::open(const std::string& fileName, unsigned numThreads) {
+    // the table refers to the whole file, so it has to be mapped at once
+    if(m_reader.open(fileName, std::numeric_limits<size_t>::max() / 2) != 0 || m_reader.isStreaming()) {
+        return -1;
+    }
+    m_table.build(m_reader.getData(), (size_t)m_reader.getFileSize(), numThreads);
+    m_next = 0;
+    return 0;
+}
+
+int NalTableReader::read(AccessUnit& accessUnit) {
+    accessUnit.payloadUsedSize = 0;
+    if(m_next >= m_table.size()) {
+        return -1;
+    }
+
+    // the payload reaches up to the next start code, so consecutive NAL units are contiguous
+    const size_t   idx   = m_next++;
+    const uint64_t begin = m_table.getStartCodeOffset(idx);
+    const uint64_t end   = m_next < m_table.size() ? m_table.getStartCodeOffset(m_next) : getFileSize();
+    const uint8_t* data  = getData();
+
+    // the table already knows the NAL unit boundary, so the payload is passed without a start code position
+    const size_t size = (size_t)(end - begin);
+    xSetAccessUnit(accessUnit, data + begin, size, (size_t)(getFileSize() - begin), size);
+
+    m_nal.offset       = m_table.m_startCodeLen[idx];
+    m_nal.size         = m_table.m_size[idx];
+    m_nal.startCodeLen = m_table.m_startCodeLen[idx];
+    accessUnit.nals    = &m_nal;
+    accessUnit.numNals = 1;
+    return accessUnit.payloadUsedSize;
+}
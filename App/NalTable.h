@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "BitstreamInput.h"
+#include "BitstreamReader.h"
+
+// Structure-of-arrays table of all NAL units of an Annex-B buffer. The start-code search is split
+// into chunks that are scanned on separate threads and merged afterwards; start codes straddling
+// chunk edges are found by letting each chunk's search run two bytes into the next chunk.
+class NalTable {
+public:
+    static const size_t MIN_CHUNK_SIZE = size_t( 1 ) << 20;
+
+    NalTable() = default;
+    ~NalTable() = default;
+    CLASS_COPY_MOVE_DEFAULT( NalTable )
+
+    // numThreads 0 uses all hardware threads.
+    void build( const uint8_t* data, size_t size, unsigned numThreads = 0 );
+
+    size_t size() const { return m_offset.size(); }
+    // offset of the first start code byte of NAL unit idx, including its zero_byte
+    uint64_t getStartCodeOffset( size_t idx ) const { return m_offset[idx] - m_startCodeLen[idx]; }
+    // first NAL unit whose start code begins at or after pos
+    size_t   findNalUnit( uint64_t pos ) const;
+
+    std::vector<uint64_t> m_offset;         // NAL unit header
+    std::vector<uint32_t> m_size;           // without start code and trailing zero bytes
+    std::vector<uint8_t>  m_startCodeLen;
+    std::vector<uint8_t>  m_nalUnitType;
+    std::vector<uint8_t>  m_layerId;
+    std::vector<int8_t>   m_temporalId;
+};
+
+// Hands out the NAL units of a fully mapped file from a prebuilt NalTable, without any scanning.
+class NalTableReader : public BitstreamInput {
+public:
+    NalTableReader() = default;
+    ~NalTableReader() override = default;
+    CLASS_COPY_MOVE_DELETE( NalTableReader )
+
+    int  open( const std::string& fileName, unsigned numThreads = 0 );
+
+    int  read( AccessUnit& accessUnit ) override;
+    bool isPayloadPersistent() const override { return true; }
+
+    void seek( uint64_t pos ) { m_next = m_table.findNalUnit( pos ); }
+
+    const NalTable& getTable()    const { return m_table; }
+    const uint8_t*  getData()     const { return m_reader.getData(); }
+    uint64_t        getFileSize() const { return m_reader.getFileSize(); }
+
+private:
+    BitstreamReader m_reader;   // owns the mapping
+    NalTable        m_table;
+    size_t          m_next = 0;
+};
@@ -0,0 +1,135 @@
+#include <string.h>
+#include <chrono>
+#include <iostream>
+
+#include "PrefetchReader.h"
+
+typedef std::chrono::steady_clock Clock;
+
+PrefetchReader::PrefetchReader(std::unique_ptr<BitstreamInput> source, uint32_t queueSize)
+    : m_source(std::move(source)) {
+    uint32_t size = 2;
+    while(size < queueSize) {
+        size <<= 1;
+    }
+    m_slots.resize(size);
+    m_mask = size - 1;
+    m_stats.queueSize = size;
+
+    m_thread = std::thread(&PrefetchReader::xReaderThread, this);
+}
+
+PrefetchReader::~PrefetchReader() {
+    xStop();
+}
+
+void PrefetchReader::xStop() {
+    m_abort.store(true);
+    xWake(m_readerWaiting, m_notFull);
+    if(m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+// Called after publishing the state the other side waits for. The sequentially consistent store of that
+// state and the load of the waiting flag pair with the waiter's flag store and re-check under the mutex,
+// so either the waiter sees the new state or it is already asleep when notified.
+void PrefetchReader::xWake(std::atomic<bool>& waiting, std::condition_variable& cond) {
+    if(waiting.load()) {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        cond.notify_one();
+    }
+}
+
+void PrefetchReader::xReaderThread() {
+    AccessUnit accessUnit = {};
+    double     stallSec   = 0;
+
+    try {
+        while(!m_abort.load(std::memory_order_relaxed)) {
+            const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+
+            // backpressure: wait until the decoder has released a slot
+            if(tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+                const Clock::time_point start = Clock::now();
+                {
+                    std::unique_lock<std::mutex> lock(m_waitMutex);
+                    m_readerWaiting.store(true);
+                    m_notFull.wait(lock, [&] { return tail - m_head.load() != m_slots.size() || m_abort.load(); });
+                    m_readerWaiting.store(false, std::memory_order_relaxed);
+                }
+                stallSec += std::chrono::duration<double>(Clock::now() - start).count();
+                m_readerStallSec.store(stallSec, std::memory_order_relaxed);
+                continue;
+            }
+
+            const int size = m_source->read(accessUnit);
+            if(size <= 0) {
+                break;
+            }
+
+            Slot& slot = m_slots[tail & m_mask];
+            if(slot.buffer.size() < (size_t)size) {
+                slot.buffer.resize(size);
+            }
+            ::memcpy(slot.buffer.data(), accessUnit.payload, size);
+            slot.size = size;
+            slot.rap  = accessUnit.rap;
+            slot.nals.assign(accessUnit.nals, accessUnit.nals + accessUnit.numNals);
+
+            m_tail.store(tail + 1);
+            xWake(m_decoderWaiting, m_notEmpty);
+        }
+    } catch(std::exception& e) {
+        std::cerr << "W266 [error]: " << e.what() << std::endl;
+    }
+    m_finished.store(true);
+    xWake(m_decoderWaiting, m_notEmpty);
+}
+
+int PrefetchReader::read(AccessUnit& accessUnit) {
+    accessUnit.payloadUsedSize = 0;
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    if(m_holdsSlot) {
+        // the previous unit is no longer used by the decoder, return its slot to the reader thread
+        m_head.store(++head);
+        m_holdsSlot = false;
+        xWake(m_readerWaiting, m_notFull);
+    }
+
+    uint64_t tail = m_tail.load(std::memory_order_acquire);
+    if(tail == head) {
+        const Clock::time_point start = Clock::now();
+        {
+            // the reader publishes its last unit before it finishes, so the tail is final once m_finished is set
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_decoderWaiting.store(true);
+            m_notEmpty.wait(lock, [&] { return m_tail.load() != head || m_finished.load(); });
+            m_decoderWaiting.store(false, std::memory_order_relaxed);
+            tail = m_tail.load();
+        }
+        m_stats.decoderStallSec += std::chrono::duration<double>(Clock::now() - start).count();
+        if(tail == head) {
+            m_stats.readerStallSec = m_readerStallSec.load(std::memory_order_relaxed);
+            return -1;
+        }
+    }
+
+    const uint32_t depth = (uint32_t)(tail - head);
+    m_stats.numUnits++;
+    m_stats.sumDepth      += depth;
+    m_stats.maxDepth       = std::max(m_stats.maxDepth, depth);
+    m_stats.readerStallSec = m_readerStallSec.load(std::memory_order_relaxed);
+
+    Slot& slot  = m_slots[head & m_mask];
+    m_holdsSlot = true;
+
+    accessUnit.payload         = slot.buffer.data();
+    accessUnit.payloadSize     = (int)slot.buffer.size();
+    accessUnit.payloadUsedSize = (int)slot.size;
+    accessUnit.nals            = slot.nals.data();
+    accessUnit.numNals         = (int)slot.nals.size();
+    accessUnit.rap             = slot.rap;
+    return accessUnit.payloadUsedSize;
+}
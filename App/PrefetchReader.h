@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BitstreamInput.h"
+
+struct PrefetchStats {
+    uint64_t numUnits         = 0;   // units handed to the decoder
+    uint64_t sumDepth         = 0;   // queue depth summed over all read() calls, sumDepth / numUnits is the mean
+    uint32_t maxDepth         = 0;
+    uint32_t queueSize        = 0;
+    double   decoderStallSec  = 0;   // time the decoder waited for an empty queue
+    double   readerStallSec   = 0;   // time the reader thread waited for a full queue (backpressure)
+};
+
+// Reads NAL or access units from another input on a background thread, so that I/O overlaps decoding. The
+// units are copied into a fixed pool of buffers that is passed from the reader thread to the
+// decoder through a single-producer/single-consumer lock-free queue. A full queue stalls the reader.
+// A side that finds the queue full or empty sleeps on a condition variable; the mutex is only taken
+// when the other side is known to be sleeping, so a queue that never runs dry costs no locking.
+class PrefetchReader : public BitstreamInput {
+public:
+    static const uint32_t DEFAULT_QUEUE_SIZE = 16;
+
+    PrefetchReader( std::unique_ptr<BitstreamInput> source, uint32_t queueSize = DEFAULT_QUEUE_SIZE );
+    ~PrefetchReader() override;
+    CLASS_COPY_MOVE_DELETE( PrefetchReader )
+
+    int  read( AccessUnit& accessUnit ) override;
+
+    // Only consistent after the last read() or from the decoder thread.
+    const PrefetchStats& getStats() const { return m_stats; }
+
+private:
+    struct Slot {
+        std::vector<uint8_t>     buffer;    // reused, grows to the largest unit seen
+        size_t                   size = 0;
+        NalBoundaryVec           nals;
+        bool                     rap  = false;
+    };
+
+    void xReaderThread();
+    void xStop();
+    void xWake( std::atomic<bool>& waiting, std::condition_variable& cond );
+
+    std::unique_ptr<BitstreamInput> m_source;
+    std::vector<Slot>               m_slots;
+    uint32_t                        m_mask;
+
+    // m_head is only written by the decoder, m_tail only by the reader thread. They are advanced once per
+    // unit, so sharing a cache line costs nothing measurable and needs no over-aligned allocation.
+    std::atomic<uint64_t>           m_head{ 0 };   // next slot to be decoded
+    std::atomic<uint64_t>           m_tail{ 0 };   // next slot to be filled
+    std::atomic<bool>               m_finished{ false };
+    std::atomic<bool>               m_abort{ false };
+    std::atomic<double>             m_readerStallSec{ 0 };
+
+    // sleeping on a full (reader) or empty (decoder) queue
+    std::mutex                      m_waitMutex;
+    std::condition_variable         m_notFull;
+    std::condition_variable         m_notEmpty;
+    std::atomic<bool>               m_readerWaiting{ false };
+    std::atomic<bool>               m_decoderWaiting{ false };
+
+    bool                            m_holdsSlot = false;   // the slot at m_head is lent to the decoder
+    PrefetchStats                   m_stats;
+    std::thread                     m_thread;
+};
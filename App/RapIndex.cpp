@@ -0,0 +1,252 @@
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+
+#include "RapIndex.h"
+#include "NalTable.h"
+
+static const char     RAP_INDEX_MAGIC[8]  = { 'W', '2', '6', '6', 'R', 'A', 'P', 'I' };
+static const uint32_t RAP_INDEX_VERSION   = 2;
+
+// slots in m_active: VPS 0..15, SPS 16..31, PPS 32..95, APS 96..351
+static int getActiveSlot(NalUnitType nut, int id) {
+    switch(nut) {
+    case NAL_UNIT_VPS:        return id;
+    case NAL_UNIT_SPS:        return 16 + id;
+    case NAL_UNIT_PPS:        return 32 + id;
+    case NAL_UNIT_PREFIX_APS:
+    case NAL_UNIT_SUFFIX_APS: return 96 + id;
+    default:                  return -1;
+    }
+}
+
+// The id is the first syntax element of the RBSP and lies in the byte after the NAL unit header,
+// which can not be an emulation prevention byte as the header's second byte is non-zero.
+static int getParamSetId(NalUnitType nut, const uint8_t* nalUnit) {
+    switch(nut) {
+    case NAL_UNIT_VPS:
+    case NAL_UNIT_SPS:        return nalUnit[2] >> 4;   // vps_video_parameter_set_id, sps_seq_parameter_set_id: u(4)
+    case NAL_UNIT_PPS:        return nalUnit[2] >> 2;   // pps_pic_parameter_set_id: u(6)
+    case NAL_UNIT_PREFIX_APS:
+    case NAL_UNIT_SUFFIX_APS: return nalUnit[2];        // aps_params_type: u(3), aps_adaptation_parameter_set_id: u(5)
+    default:                  return -1;
+    }
+}
+
+// Size and modification time in nanoseconds of a file.
+static int getFileStamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) {
+        return -1;
+    }
+    size  = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return 0;
+}
+
+void RapIndex::reset(uint64_t bitstreamSize, int64_t bitstreamMtime) {
+    m_bitstreamSize  = bitstreamSize;
+    m_bitstreamMtime = bitstreamMtime;
+    m_paramSets.clear();
+    m_entries.clear();
+    m_active.assign(96 + 256, -1);
+    m_auStarted = false;
+    m_phSeen    = false;
+    m_auStart   = 0;
+}
+
+void RapIndex::addNalUnit(uint64_t startCodeOffset, uint64_t offset, const uint8_t* nalUnit, size_t size) {
+    if(size < 3) {
+        return;
+    }
+
+    const NalUnitType nut   = getNalUnitHeaderType(nalUnit);
+    const int         layer = getNalUnitHeaderLayerId(nalUnit);
+
+    if(nut > NAL_UNIT_RESERVED_IRAP_VCL_11) {
+        // suffix NAL units belong to the preceding picture
+        const bool isSuffix = nut == NAL_UNIT_SUFFIX_SEI || nut == NAL_UNIT_SUFFIX_APS || nut == NAL_UNIT_FD
+                              || nut == NAL_UNIT_EOS || nut == NAL_UNIT_EOB;
+        if(!isSuffix && !m_auStarted) {
+            m_auStart   = startCodeOffset;
+            m_auStarted = true;
+        }
+        m_phSeen |= nut == NAL_UNIT_PH;
+
+        const int id   = getParamSetId(nut, nalUnit);
+        const int slot = getActiveSlot(nut, id);
+        if(slot >= 0) {
+            RapParamSet ps;
+            ps.offset      = offset;
+            ps.size        = (uint32_t)size;
+            ps.nalUnitType = (uint8_t)nut;
+            ps.id          = (uint8_t)id;
+            ps.layerId     = (uint8_t)layer;
+            m_active[slot] = (int32_t)m_paramSets.size();
+            m_paramSets.push_back(ps);
+        }
+        return;
+    }
+
+    // a picture starts with a PH NAL unit or a slice with sh_picture_header_in_slice_header_flag
+    const bool firstSliceOfPic = m_phSeen || (nalUnit[2] & 0x80) != 0;
+    if(firstSliceOfPic && !m_auStarted) {
+        m_auStart = startCodeOffset;
+    }
+
+    if(firstSliceOfPic && nut >= NAL_UNIT_CODED_SLICE_IDR_W_RADL && nut <= NAL_UNIT_CODED_SLICE_GDR) {
+        RapEntry entry;
+        entry.offset      = m_auStart;
+        entry.nalUnitType = (uint8_t)nut;
+        entry.layerId     = (uint8_t)layer;
+        for(int32_t idx: m_active) {
+            // parameter sets of the access unit itself are decoded after seeking anyway
+            if(idx >= 0 && m_paramSets[idx].offset < m_auStart) {
+                entry.paramSets.push_back((uint32_t)idx);
+            }
+        }
+        m_entries.push_back(std::move(entry));
+    }
+    m_auStarted = false;
+    m_phSeen    = false;
+}
+
+void RapIndex::build(const NalTable& table, const uint8_t* data, uint64_t bitstreamSize, int64_t bitstreamMtime) {
+    reset(bitstreamSize, bitstreamMtime);
+    for(size_t i = 0; i < table.size(); i++) {
+        addNalUnit(table.getStartCodeOffset(i), table.m_offset[i], data + table.m_offset[i], table.m_size[i]);
+    }
+}
+
+int RapIndex::build(const std::string& bitstreamFile, unsigned numThreads) {
+    // the stamp is taken before scanning, a file modified meanwhile gets a newer one and is indexed again
+    uint64_t       size  = 0;
+    int64_t        mtime = 0;
+    NalTableReader reader;
+    if(getFileStamp(bitstreamFile, size, mtime) != 0 || reader.open(bitstreamFile, numThreads) != 0) {
+        return -1;
+    }
+    build(reader.getTable(), reader.getData(), reader.getFileSize(), mtime);
+    return 0;
+}
+
+template<typename T>
+static void writeValue(std::ofstream& file, T value) {
+    file.write((const char*)&value, sizeof(T));
+}
+
+template<typename T>
+static bool readValue(std::ifstream& file, T& value) {
+    return !!file.read((char*)&value, sizeof(T));
+}
+
+int RapIndex::save(const std::string& indexFile) const {
+    std::ofstream file(indexFile, std::ios::binary | std::ios::trunc);
+    if(!file) {
+        return -1;
+    }
+
+    file.write(RAP_INDEX_MAGIC, sizeof(RAP_INDEX_MAGIC));
+    writeValue<uint32_t>(file, RAP_INDEX_VERSION);
+    writeValue<uint64_t>(file, m_bitstreamSize);
+    writeValue<int64_t> (file, m_bitstreamMtime);
+
+    writeValue<uint32_t>(file, (uint32_t)m_paramSets.size());
+    for(const RapParamSet& ps: m_paramSets) {
+        writeValue<uint64_t>(file, ps.offset);
+        writeValue<uint32_t>(file, ps.size);
+        writeValue<uint8_t> (file, ps.nalUnitType);
+        writeValue<uint8_t> (file, ps.id);
+        writeValue<uint8_t> (file, ps.layerId);
+    }
+
+    writeValue<uint32_t>(file, (uint32_t)m_entries.size());
+    for(const RapEntry& entry: m_entries) {
+        writeValue<uint64_t>(file, entry.offset);
+        writeValue<uint8_t> (file, entry.nalUnitType);
+        writeValue<uint8_t> (file, entry.layerId);
+        writeValue<uint16_t>(file, (uint16_t)entry.paramSets.size());
+        for(uint32_t idx: entry.paramSets) {
+            writeValue<uint32_t>(file, idx);
+        }
+    }
+    return file ? 0 : -1;
+}
+
+int RapIndex::load(const std::string& indexFile, const std::string& bitstreamFile) {
+    uint64_t bitstreamSize  = 0;
+    int64_t  bitstreamMtime = 0;
+    if(getFileStamp(bitstreamFile, bitstreamSize, bitstreamMtime) != 0) {
+        return -1;
+    }
+    std::ifstream file(indexFile, std::ios::binary);
+    if(!file) {
+        return -1;
+    }
+
+    char     magic[sizeof(RAP_INDEX_MAGIC)];
+    uint32_t version = 0;
+    uint64_t size    = 0;
+    int64_t  mtime   = 0;
+    if(!file.read(magic, sizeof(magic)) || memcmp(magic, RAP_INDEX_MAGIC, sizeof(magic)) != 0
+       || !readValue(file, version) || version != RAP_INDEX_VERSION
+       || !readValue(file, size) || size != bitstreamSize || !readValue(file, mtime) || mtime != bitstreamMtime) {
+        return -1;
+    }
+    reset(bitstreamSize, bitstreamMtime);
+
+    uint32_t numParamSets = 0;
+    if(!readValue(file, numParamSets)) {
+        return -1;
+    }
+    m_paramSets.resize(numParamSets);
+    for(RapParamSet& ps: m_paramSets) {
+        if(!readValue(file, ps.offset) || !readValue(file, ps.size) || !readValue(file, ps.nalUnitType)
+           || !readValue(file, ps.id) || !readValue(file, ps.layerId) || ps.offset + ps.size > bitstreamSize) {
+            return -1;
+        }
+    }
+
+    uint32_t numEntries = 0;
+    if(!readValue(file, numEntries)) {
+        return -1;
+    }
+    m_entries.resize(numEntries);
+    for(RapEntry& entry: m_entries) {
+        uint16_t numIdx = 0;
+        if(!readValue(file, entry.offset) || !readValue(file, entry.nalUnitType) || !readValue(file, entry.layerId)
+           || !readValue(file, numIdx) || entry.offset >= bitstreamSize) {
+            return -1;
+        }
+        entry.paramSets.resize(numIdx);
+        for(uint32_t& idx: entry.paramSets) {
+            if(!readValue(file, idx) || idx >= numParamSets) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int RapIndex::readParamSets(const std::string& bitstreamFile, size_t entryIdx, std::vector<uint8_t>& annexB) const {
+    annexB.clear();
+    if(entryIdx >= m_entries.size()) {
+        return -1;
+    }
+
+    std::ifstream file(bitstreamFile, std::ios::binary);
+    if(!file) {
+        return -1;
+    }
+    static const uint8_t startCode[4] = { 0, 0, 0, 1 };
+    for(uint32_t idx: m_entries[entryIdx].paramSets) {
+        const RapParamSet& ps  = m_paramSets[idx];
+        const size_t       pos = annexB.size();
+        annexB.resize(pos + sizeof(startCode) + ps.size);
+        ::memcpy(&annexB[pos], startCode, sizeof(startCode));
+        if(!file.seekg(ps.offset) || !file.read((char*)&annexB[pos + sizeof(startCode)], ps.size)) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Common/Def.h"
+
+class NalTable;
+
+// Parameter set NAL unit referenced by random access points.
+struct RapParamSet {
+    uint64_t offset;        // file offset of the NAL unit header
+    uint32_t size;          // NAL unit size without start code
+    uint8_t  nalUnitType;   // VPS, SPS, PPS or prefix/suffix APS
+    uint8_t  id;            // parameter set id, for APS aps_params_type << 5 | aps_adaptation_parameter_set_id
+    uint8_t  layerId;
+};
+
+// IDR, CRA or GDR picture at which decoding can start.
+struct RapEntry {
+    uint64_t              offset;        // file offset of the first start code of the access unit
+    uint8_t               nalUnitType;
+    uint8_t               layerId;
+    std::vector<uint32_t> paramSets;     // indices of the parameter sets active before offset
+};
+
+// Random access index of an Annex-B file. It is built by scanning the file once and can be stored
+// in a compact sidecar file, so later runs can seek without rescanning.
+class RapIndex {
+public:
+    RapIndex() = default;
+    ~RapIndex() = default;
+    CLASS_COPY_MOVE_DEFAULT( RapIndex )
+
+    // Scans the file with numThreads threads, 0 uses all hardware threads.
+    int  build( const std::string& bitstreamFile, unsigned numThreads = 0 );
+    void build( const NalTable& table, const uint8_t* data, uint64_t bitstreamSize, int64_t bitstreamMtime = 0 );
+    int  save ( const std::string& indexFile ) const;
+    // Fails if the index does not exist or was made for a file of a different size or modification time,
+    // so an index is not reused after the bitstream was rewritten in place.
+    int  load ( const std::string& indexFile, const std::string& bitstreamFile );
+
+    static std::string getDefaultIndexFile( const std::string& bitstreamFile ) { return bitstreamFile + ".rapidx"; }
+
+    // Annex-B byte stream of the parameter sets needed to start decoding at entry entryIdx.
+    int  readParamSets( const std::string& bitstreamFile, size_t entryIdx, std::vector<uint8_t>& annexB ) const;
+
+    uint64_t                        getBitstreamSize()  const { return m_bitstreamSize; }
+    int64_t                         getBitstreamMtime() const { return m_bitstreamMtime; }   // nanoseconds since the epoch
+    const std::vector<RapEntry>&    getEntries()        const { return m_entries; }
+    const std::vector<RapParamSet>& getParamSets()      const { return m_paramSets; }
+
+private:
+    void reset           ( uint64_t bitstreamSize, int64_t bitstreamMtime );
+    void addNalUnit      ( uint64_t startCodeOffset, uint64_t offset, const uint8_t* nalUnit, size_t size );
+
+    uint64_t                 m_bitstreamSize  = 0;
+    int64_t                  m_bitstreamMtime = 0;
+    std::vector<RapParamSet> m_paramSets;
+    std::vector<RapEntry>    m_entries;
+
+    // build state
+    std::vector<int32_t>     m_active;                // latest parameter set per type and id, -1 if none
+    bool                     m_auStarted = false;     // a prefix NAL unit followed the last VCL NAL unit
+    bool                     m_phSeen    = false;     // a PH NAL unit followed the last VCL NAL unit
+    uint64_t                 m_auStart   = 0;         // first start code of the current access unit
+};
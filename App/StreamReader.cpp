@@ -0,0 +1,159 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+
+#include "StreamReader.h"
+
+StreamReader::~StreamReader() {
+    close();
+}
+
+int StreamReader::open(const std::string& fileName, size_t ringSize) {
+    close();
+
+    if(fileName == "-") {
+        m_fd    = STDIN_FILENO;
+        m_ownFd = false;
+    } else {
+        m_fd    = ::open(fileName.c_str(), O_RDONLY);
+        m_ownFd = true;
+        if(m_fd < 0) {
+            return -1;
+        }
+    }
+
+    size_t size = 4096;
+    while(size < ringSize) {
+        size <<= 1;
+    }
+    m_ring.resize(size);
+    m_mask = size - 1;
+
+    m_eof          = false;
+    m_begin        = 0;
+    m_end          = 0;
+    m_scanPos      = 0;
+    m_hasStartCode = false;
+    return 0;
+}
+
+void StreamReader::close() {
+    if(m_fd >= 0 && m_ownFd) {
+        ::close(m_fd);
+    }
+    m_fd    = -1;
+    m_ownFd = false;
+    m_ring.clear();
+    m_ring.shrink_to_fit();
+    m_staging.clear();
+    m_staging.shrink_to_fit();
+}
+
+// Reads whatever is available into the free contiguous part of the ring. Returns the number of
+// bytes read, 0 at the end of the input and -1 on error or if the ring is full.
+int StreamReader::xFill() {
+    const uint64_t ringSize = m_mask + 1;
+    if(m_end - m_begin == ringSize) {
+        return -1;
+    }
+
+    const size_t writePos = (size_t)(m_end & m_mask);
+    const size_t len      = (size_t)std::min<uint64_t>(ringSize - writePos, m_begin + ringSize - m_end);
+    while(true) {
+        ssize_t ret = ::read(m_fd, &m_ring[writePos], len);
+        if(ret >= 0) {
+            m_end += ret;
+            m_eof  = ret == 0;
+            return (int)ret;
+        }
+        if(errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+// Searches [from, m_end) for 00 00 01. The ring is scanned in its contiguous parts, start codes that
+// straddle the wrap-around are checked byte by byte.
+bool StreamReader::xFindStartCode(uint64_t from, uint64_t& startCodePos) const {
+    while(from + 3 <= m_end) {
+        const uint64_t segEnd = std::min(m_end, (from | m_mask) + 1);
+        const uint8_t* seg    = &m_ring[from & m_mask];
+        const uint8_t* sc     = findStartCode(seg, seg + (segEnd - from));
+        if(sc != seg + (segEnd - from)) {
+            startCodePos = from + (sc - seg);
+            return true;
+        }
+        for(uint64_t pos = std::max(from, segEnd - std::min<uint64_t>(segEnd, 2)); pos < segEnd && pos + 3 <= m_end; pos++) {
+            if(xAt(pos) == 0 && xAt(pos + 1) == 0 && xAt(pos + 2) == 1) {
+                startCodePos = pos;
+                return true;
+            }
+        }
+        from = segEnd;
+    }
+    return false;
+}
+
+int StreamReader::read(AccessUnit& accessUnit) {
+    accessUnit.payloadUsedSize = 0;
+
+    if(m_fd < 0) {
+        return -1;
+    }
+
+    uint64_t nalEnd = 0;
+    while(true) {
+        uint64_t startCode = 0;
+        if(!m_hasStartCode) {
+            if(xFindStartCode(m_scanPos, startCode)) {
+                m_startCode    = startCode;
+                m_hasStartCode = true;
+                m_scanPos      = startCode + 3;
+            }
+        }
+        if(m_hasStartCode && xFindStartCode(m_scanPos, startCode)) {
+            // a leading zero_byte belongs to the next start code
+            nalEnd = startCode;
+            if(nalEnd > m_startCode + 3 && xAt(nalEnd - 1) == 0) {
+                nalEnd--;
+            }
+            break;
+        }
+        // the last two bytes may be the beginning of a start code completed by the next chunk
+        m_scanPos = std::max(m_scanPos, m_end - std::min<uint64_t>(m_end - m_begin, 2));
+
+        if(m_eof) {
+            nalEnd = m_end;
+            break;
+        }
+        int ret = xFill();
+        if(ret < 0) {
+            std::cerr << "W266 [error]: " << (m_end - m_begin == m_mask + 1 ? "NAL unit exceeds the stream buffer size" : "failed to read the bitstream") << std::endl;
+            return -1;
+        }
+    }
+
+    if(nalEnd == m_begin) {
+        return -1;
+    }
+
+    const size_t   size     = (size_t)(nalEnd - m_begin);
+    const size_t   ringPos  = (size_t)(m_begin & m_mask);
+    const uint8_t* payload  = &m_ring[ringPos];
+    if(ringPos + size > m_ring.size()) {
+        const size_t firstPart = m_ring.size() - ringPos;
+        m_staging.resize(size);
+        ::memcpy(m_staging.data(), &m_ring[ringPos], firstPart);
+        ::memcpy(m_staging.data() + firstPart, m_ring.data(), size - firstPart);
+        payload = m_staging.data();
+    }
+    const size_t startCodePos = m_hasStartCode ? (size_t)(m_startCode - m_begin) : size;
+    const int    ret          = xSetAccessUnit(accessUnit, payload, size, size, startCodePos);
+
+    m_begin        = nalEnd;
+    m_scanPos      = nalEnd;
+    m_hasStartCode = false;
+    return ret;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "BitstreamInput.h"
+
+// Annex-B reader for non-seekable inputs such as pipes and stdin. Bytes are read in chunks into a
+// fixed size ring buffer, so memory stays bounded by the largest NAL unit. A NAL unit is handed out
+// as soon as the following start code has arrived; only NAL units that wrap around the end of the
+// ring are copied into a staging buffer.
+class StreamReader : public BitstreamInput {
+public:
+    static const size_t DEFAULT_RING_SIZE = size_t( 16 ) << 20;
+
+    StreamReader() = default;
+    ~StreamReader() override;
+    CLASS_COPY_MOVE_DELETE( StreamReader )
+
+    // "-" opens stdin. ringSize is rounded up to a power of two and limits the NAL unit size.
+    int  open ( const std::string& fileName, size_t ringSize = DEFAULT_RING_SIZE );
+    void close();
+
+    int  read ( AccessUnit& accessUnit ) override;
+
+    bool isOpen() const { return m_fd >= 0; }
+
+private:
+    int  xFill            ();
+    bool xFindStartCode   ( uint64_t from, uint64_t& startCodePos ) const;
+    uint8_t xAt           ( uint64_t pos ) const { return m_ring[pos & m_mask]; }
+
+    int                  m_fd        = -1;
+    bool                 m_ownFd     = false;
+    bool                 m_eof       = false;
+
+    std::vector<uint8_t> m_ring;
+    uint64_t             m_mask      = 0;
+
+    // absolute stream offsets, m_begin <= m_scanPos <= m_end <= m_begin + ring size
+    uint64_t             m_begin     = 0;   // first byte of the next NAL unit
+    uint64_t             m_end       = 0;   // end of the bytes read so far
+    uint64_t             m_scanPos   = 0;   // the search for the next start code resumes here
+    uint64_t             m_startCode = 0;   // 00 00 01 of the next NAL unit, valid if m_hasStartCode
+    bool                 m_hasStartCode = false;
+
+    std::vector<uint8_t> m_staging;         // NAL units that wrap around the end of m_ring
+};
@@ -1,5 +1,81 @@
+#include <algorithm>
+
 #include "BitStream.h"
 
+InputBitstream& InputBitstream::operator=( const InputBitstream& other ) {
+    if( this == &other ) {
+        return *this;
+    }
+    m_fifo          = other.m_fifo;
+    m_borrowed      = other.m_borrowed;
+    m_data          = m_borrowed ? other.m_data : m_fifo.data();   // an owned copy must not point into the other FIFO
+    m_size          = other.m_size;
+    m_readable      = other.m_readable;
+    m_fifo_idx      = other.m_fifo_idx;
+    m_num_held_bits = other.m_num_held_bits;
+    m_held_bits     = other.m_held_bits;
+    m_zeroByteAdded = other.m_zeroByteAdded;
+    m_emulationPreventionByteLocation = other.m_emulationPreventionByteLocation;
+    return *this;
+}
+
+void InputBitstream::attachFifo() {
+    CHECK( m_fifo.size() > UINT32_MAX - FIFO_PADDING, "NAL unit too large" );
+    m_size     = (uint32_t)m_fifo.size();
+    m_readable = m_size + FIFO_PADDING;
+    m_fifo.resize( m_readable );
+    m_data     = m_fifo.data();
+    m_borrowed = false;
+    resetToStart();
+}
+
+void InputBitstream::attachView( const uint8_t* data, size_t size, size_t readable ) {
+    CHECK( size > UINT32_MAX, "NAL unit too large" );
+    m_data     = data;
+    m_size     = (uint32_t)size;
+    m_readable = (uint32_t)std::min<size_t>( UINT32_MAX, std::max( size, readable ) );
+    m_borrowed = true;
+    resetToStart();
+}
+
+uint32_t InputBitstream::getRbspByteOffset( uint32_t nalByteOffset ) const {
+    // every emulation prevention byte before the position was removed
+    const auto& loc = m_emulationPreventionByteLocation;
+    return nalByteOffset - (uint32_t)( std::lower_bound( loc.begin(), loc.end(), nalByteOffset ) - loc.begin() );
+}
+
+uint32_t InputBitstream::getNalByteOffset( uint32_t rbspByteOffset ) const {
+    uint32_t nalByteOffset = rbspByteOffset;
+    for( uint32_t pos : m_emulationPreventionByteLocation ) {
+        if( pos > nalByteOffset ) {
+            break;
+        }
+        nalByteOffset++;
+    }
+    return nalByteOffset;
+}
+
+void InputBitstream::extractSubstreams( const std::vector<uint32_t>& entryPointOffsets, std::vector<InputBitstream>& substreams ) const {
+    CHECK( getNumBitsUntilByteAligned() != 0, "Slice data does not start byte aligned" );
+
+    const uint32_t sliceDataRbsp = m_fifo_idx - m_num_held_bits / 8;
+    uint32_t       entryNal      = getNalByteOffset( sliceDataRbsp );
+    uint32_t       entryRbsp     = sliceDataRbsp;
+
+    substreams.resize( entryPointOffsets.size() + 1 );
+    for( size_t i = 0; i <= entryPointOffsets.size(); i++ ) {
+        uint32_t nextRbsp = m_size;
+        if( i < entryPointOffsets.size() ) {
+            CHECK( entryPointOffsets[i] == 0 || entryPointOffsets[i] > UINT32_MAX - entryNal, "Invalid entry point offset" );
+            entryNal += entryPointOffsets[i];
+            nextRbsp  = getRbspByteOffset( entryNal );
+            CHECK( nextRbsp > m_size, "Entry point offset exceeds the slice data" );
+        }
+        substreams[i].attachView( m_data + entryRbsp, nextRbsp - entryRbsp, m_readable - entryRbsp );
+        entryRbsp = nextRbsp;
+    }
+}
+
 uint32_t InputBitstream::peekBits( uint32_t uiNumberOfBits ) {
     auto saved_fifo_idx      = m_fifo_idx;
     auto saved_num_held_bits = m_num_held_bits;
@@ -33,7 +109,7 @@ uint32_t InputBitstream::read (uint32_t uiNumberOfBits) {
         return retval;
     }
 
-    CHECK( uiNumberOfBits > 32, "Too many bits read" );
+    CHECKD( uiNumberOfBits > 32, "Too many bits read" );
 
     if( m_num_held_bits )
     {
@@ -64,4 +140,34 @@ uint32_t InputBitstream::read (uint32_t uiNumberOfBits) {
     retval |= static_cast<uint32_t>( m_held_bits >> m_num_held_bits );
 
     return retval;
-}
\ No newline at end of file
+}
+uint32_t InputBitstream::xReadUvlcSlow() {
+    uint32_t prefixLen = 0;
+    while( read( 1 ) == 0 ) {
+        prefixLen++;
+    }
+    // the largest ue(v) value, 2^32 - 2, has a 31 bit prefix
+    CHECK( prefixLen > 31, "Exp-Golomb code too long" );
+
+    const uint64_t info = prefixLen ? read( prefixLen ) : 0;
+    return static_cast<uint32_t>( ( uint64_t( 1 ) << prefixLen ) - 1 + info );
+}
+
+void InputBitstream::xLoadTailBits( int requiredBits ) {
+    const uint32_t num_bytes_to_load = m_size - m_fifo_idx;   // less than 8
+    CHECK( (uint32_t)requiredBits > 8 * num_bytes_to_load, "Exceeded FIFO size" );
+
+    if( m_fifo_idx + 8 <= m_readable ) {
+        // the padding or the data following a borrowed view can be loaded, the surplus bytes are shifted out
+        uint64_t word;
+        ::memcpy( &word, m_data + m_fifo_idx, sizeof( word ) );
+        m_held_bits = __builtin_bswap64( word ) >> ( 64 - 8 * num_bytes_to_load );
+    } else {
+        m_held_bits = 0;
+        for( uint32_t i = 0; i < num_bytes_to_load; i++ ) {
+            m_held_bits = ( m_held_bits << 8 ) | m_data[m_fifo_idx + i];
+        }
+    }
+    m_fifo_idx     += num_bytes_to_load;
+    m_num_held_bits = num_bytes_to_load * 8;
+}
@@ -1,62 +1,119 @@
 #pragma once
 
 #include <stdint.h>
+#include <string.h>
 #include <vector>
 #include "Def.h"
 
+// Reads bits either from the owned m_fifo or from a borrowed view of the caller's buffer. The view
+// is used for NAL units without emulation prevention bytes and has to outlive the reading.
 class InputBitstream {
 private:
     AlignedByteVec        m_fifo;
-    uint32_t m_fifo_idx = 0;   /// Read index into m_fifo
+    const uint8_t* m_data     = nullptr;   /// Bytes being read, m_fifo.data() or a borrowed view
+    uint32_t       m_size     = 0;
+    uint32_t       m_readable = 0;         /// Bytes that may be loaded from m_data, m_size plus any readable tail
+    bool           m_borrowed = false;
+    uint32_t m_fifo_idx = 0;   /// Read index into m_data
 
     uint32_t m_num_held_bits = 0;
     uint64_t m_held_bits     = 0;
 
     bool m_zeroByteAdded = false;
 
+    std::vector<uint32_t> m_emulationPreventionByteLocation;   /// NAL unit byte positions of the removed 0x03 bytes, ascending
+
 public:
+    static constexpr uint32_t FIFO_PADDING = 8;   ///< readable bytes appended to the FIFO content
+
+    InputBitstream() = default;
+    InputBitstream( const InputBitstream& other )            { *this = other; }
+    InputBitstream( InputBitstream&& other )                 = default;   // moving the FIFO keeps its data pointer
+    InputBitstream& operator=( const InputBitstream& other );
+    InputBitstream& operator=( InputBitstream&& other )      = default;
 
     const AlignedByteVec& getFifo() const { return m_fifo; }
           AlignedByteVec& getFifo()       { return m_fifo; }
 
+    // Reads from the FIFO content from now on, must be called after the FIFO has been filled.
+    // Appends FIFO_PADDING bytes, so the last refill can also be done with one load.
+    void attachFifo();
+    // Reads from a borrowed buffer that is not copied and has to stay valid while reading. readable
+    // is the number of bytes at data that may be accessed, it can exceed size if more data follows.
+    void attachView( const uint8_t* data, size_t size, size_t readable = 0 );
+    void resetToStart() { m_fifo_idx = 0; m_num_held_bits = 0; m_held_bits = 0; }
+
+    bool            isBorrowed() const { return m_borrowed; }
+    bool            empty()      const { return m_size == 0; }
+    uint32_t        getByteSize() const { return m_size; }
+    const uint8_t*  getData()    const { return m_data; }
+
+    // Emulation prevention bytes removed while converting the NAL unit to the RBSP in m_fifo.
+    void            clearEmulationPreventionByteLocation()                 { m_emulationPreventionByteLocation.clear(); }
+    void            pushEmulationPreventionByteLocation( uint32_t pos )    { m_emulationPreventionByteLocation.push_back( pos ); }
+    uint32_t        numEmulationPreventionBytesRead() const                { return (uint32_t)m_emulationPreventionByteLocation.size(); }
+    const std::vector<uint32_t>& getEmulationPreventionByteLocations() const { return m_emulationPreventionByteLocation; }
+
+    // Byte positions in the NAL unit (with emulation prevention bytes) and in the RBSP (without).
+    uint32_t        getRbspByteOffset( uint32_t nalByteOffset ) const;
+    uint32_t        getNalByteOffset ( uint32_t rbspByteOffset ) const;
+
+    // Splits the slice data that starts at the current, byte aligned read position into one reader per
+    // entry point. entryPointOffsets are the offset_len_minus1 + 1 values of the slice header, which
+    // count NAL unit bytes including emulation prevention bytes. The readers are views into the data of
+    // this reader, so it has to stay attached while they are used. Fails if an offset exceeds the data.
+    void            extractSubstreams( const std::vector<uint32_t>& entryPointOffsets, std::vector<InputBitstream>& substreams ) const;
+
     inline uint8_t  getNumBitsUntilByteAligned() const { return m_num_held_bits & ( 0x7 ); }
-    inline uint32_t getNumBitsLeft()             const { return ( m_fifo_idx < m_fifo.size() ? 8 * ( (uint32_t) m_fifo.size() - m_fifo_idx ) : 0 ) + m_num_held_bits; }
+    inline uint32_t getNumBitsRead()             const { return 8 * m_fifo_idx - m_num_held_bits; }
+    inline uint32_t getNumBitsLeft()             const { return ( m_fifo_idx < m_size ? 8 * ( m_size - m_fifo_idx ) : 0 ) + m_num_held_bits; }
 
     uint32_t       peekBits( uint32_t uiNumberOfBits );
     uint32_t       read    ( uint32_t uiNumberOfBits );
 
-private:
-    inline void load_next_bits( int requiredBits ) {
-        uint32_t num_bytes_to_load = 8;
-        if UNLIKELY( m_fifo_idx + num_bytes_to_load > m_fifo.size()   // end of bitstream
-                    || ( m_fifo_idx & 0x7 ) != 0 )                   // unaligned read position (m_fifo should be aligned)
-        {
-            const int required_bytes = ( requiredBits + 7 ) >> 3;
-            CHECK( m_fifo_idx + required_bytes > m_fifo.size(), "Exceeded FIFO size" );
-
-            num_bytes_to_load = (uint32_t)m_fifo.size() - m_fifo_idx;
-
-            m_held_bits = 0;
-            switch( num_bytes_to_load )
-            {
-            default: num_bytes_to_load = 8;   // in the unaligned case num_bytes_to_load could be >8
-            case 8:  m_held_bits =  static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 7 * 8 );
-            case 7:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 6 * 8 );
-            case 6:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 5 * 8 );
-            case 5:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 4 * 8 );
-            case 4:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 3 * 8 );
-            case 3:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 2 * 8 );
-            case 2:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] ) << ( 1 * 8 );
-            case 1:  m_held_bits |= static_cast<uint64_t>( m_fifo[m_fifo_idx++] );
+    // ue(v) and se(v). The prefix is counted with one clz over the held bits; only code words that
+    // cross the end of the held bits take the bit by bit path.
+    inline uint32_t readUvlc() {
+        if( m_num_held_bits ) {
+            const uint64_t window = m_held_bits << ( 64 - m_num_held_bits );   // held bits at the MSB
+            if( window ) {
+                const uint32_t prefixLen = __builtin_clzll( window );
+                const uint32_t codeLen   = 2 * prefixLen + 1;
+                if( codeLen <= m_num_held_bits ) {
+                    m_num_held_bits -= codeLen;
+                    // 1 followed by prefixLen info bits is codeNum + 1
+                    const uint64_t codeNumPlus1 = ( m_held_bits >> m_num_held_bits ) & ( ( uint64_t( 2 ) << prefixLen ) - 1 );
+                    return static_cast<uint32_t>( codeNumPlus1 - 1 );
+                }
             }
         }
-        else
-        {
-            CHECKD( reinterpret_cast<intptr_t>( &m_fifo[m_fifo_idx] ) & 0x7, "bistream read pos unaligned" );
-            m_held_bits = __builtin_bswap64( *reinterpret_cast<uint64_t*>( &m_fifo[m_fifo_idx] ) );
-            m_fifo_idx += num_bytes_to_load;
-        }
+        return xReadUvlcSlow();
+    }
+    inline int32_t readSvlc() {
+        const uint32_t codeNum = readUvlc();
+        // 0, 1, -1, 2, -2, ...
+        return ( codeNum & 1 ) ? static_cast<int32_t>( ( codeNum >> 1 ) + 1 ) : -static_cast<int32_t>( codeNum >> 1 );
+    }
+
+private:
+    uint32_t xReadUvlcSlow();
+
+    void xLoadTailBits( int requiredBits );
 
-        m_num_held_bits = num_bytes_to_load * 8;
+    // Refills the held bits with one unaligned big-endian load. Only the last few bytes of the data
+    // take the out of line path, which also checks that enough bits are left. The fast path compares
+    // against m_size rather than m_readable: the held bits then never contain padding, so
+    // getNumBitsLeft() stays exact and reading past a corrupt NAL unit fails in release builds too.
+    // The padding only saves the byte loop of that once per NAL unit refill.
+    inline void load_next_bits( int requiredBits ) {
+        if LIKELY( m_fifo_idx + 8 <= m_size ) {
+            uint64_t word;
+            ::memcpy( &word, m_data + m_fifo_idx, sizeof( word ) );
+            m_held_bits     = __builtin_bswap64( word );
+            m_fifo_idx     += 8;
+            m_num_held_bits = 64;
+            return;
+        }
+        xLoadTailBits( requiredBits );
     }
 };
\ No newline at end of file
@@ -0,0 +1,673 @@
+#include <string.h>
+
+#include "Contexts.h"
+
+static constexpr uint8_t CNU = 35;   // initValue of contexts that are not used with an initType
+static constexpr uint8_t DWS = 8;    // shiftIdx of contexts without specified adaptation rates
+
+std::vector<uint8_t> ContextSetCfg::sm_initValues[3];
+std::vector<uint8_t> ContextSetCfg::sm_shiftIdx;
+
+// The rows are the initValue of initType 0, 1 and 2 and the shiftIdx of every context of the set, as
+// in the tables of clause 9.3.2.2 of the specification.
+CtxSet ContextSetCfg::xAddCtxSet( std::initializer_list<std::initializer_list<uint8_t>> rows ) {
+    CHECK( rows.size() != 4, "A context set needs three initValue rows and one shiftIdx row" );
+    const std::initializer_list<uint8_t>* row = rows.begin();
+
+    CtxSet ctxSet;
+    ctxSet.offset = (uint16_t)sm_shiftIdx.size();
+    ctxSet.size   = (uint16_t)row[0].size();
+    for( unsigned initType = 0; initType < 3; initType++ ) {
+        CHECK( row[initType].size() != ctxSet.size, "Context set rows differ in size" );
+        sm_initValues[initType].insert( sm_initValues[initType].end(), row[initType].begin(), row[initType].end() );
+    }
+    CHECK( row[3].size() != ctxSet.size, "Context set rows differ in size" );
+    sm_shiftIdx.insert( sm_shiftIdx.end(), row[3].begin(), row[3].end() );
+    return ctxSet;
+}
+
+// The definition order is the memory order. The sets are grouped by the syntax structure that uses
+// them, so that the contexts of one coefficient group or coding unit are close together.
+
+// residual coding
+const CtxSet ContextSetCfg::SigFlag[6] = {
+    xAddCtxSet( {
+        {  25,  19,  28,  14,  25,  20,  29,  30,  19,  37,  30,  38 },
+        {  17,  41,  42,  29,  25,  49,  43,  37,  33,  58,  51,  30 },
+        {  17,  41,  49,  36,   1,  49,  50,  37,  48,  51,  58,  45 },
+        {  12,   9,   9,  10,   9,   9,   9,  10,   8,   8,   8,  10 },
+    } ),
+    xAddCtxSet( {
+        {  11,  38,  46,  54,  27,  39,  39,  39,  44,  39,  39,  39 },
+        {  19,  38,  38,  46,  34,  54,  54,  39,   6,  39,  39,  39 },
+        {  26,  45,  53,  46,  49,  54,  61,  39,  35,  39,  39,  39 },
+        {   9,  13,   8,   8,   8,   8,   8,   5,   8,   0,   0,   0 },
+    } ),
+    xAddCtxSet( {
+        {  18,  39,  39,  39,  27,  39,  39,  39,   0,  39,  39,  39 },
+        {  19,  39,  54,  39,  19,  39,  39,  39,  56,  39,  39,  39 },
+        {  19,  54,  39,  39,  50,  39,  39,  39,   0,  39,  39,  39 },
+        {   8,   8,   8,   8,   8,   0,   4,   4,   0,   0,   0,   0 },
+    } ),
+    xAddCtxSet( {
+        {  25,  27,  28,  37,  34,  53,  53,  46 },
+        {  17,  34,  35,  21,  41,  59,  60,  38 },
+        {   9,  49,  50,  36,  48,  59,  59,  38 },
+        {  12,  12,   9,  13,   4,   5,   8,   9 },
+    } ),
+    xAddCtxSet( {
+        {  19,  46,  38,  39,  52,  39,  39,  39 },
+        {  35,  45,  53,  54,  44,  39,  39,  39 },
+        {  34,  45,  38,  31,  58,  39,  39,  39 },
+        {   8,  12,  12,   8,   4,   0,   0,   0 },
+    } ),
+    xAddCtxSet( {
+        {  11,  39,  39,  39,  19,  39,  39,  39 },
+        {  34,  38,  62,  39,  26,  39,  39,  39 },
+        {  34,  38,  54,  39,  41,  39,  39,  39 },
+        {   8,   8,   8,   8,   4,   0,   0,   0 },
+    } )
+};
+
+const CtxSet ContextSetCfg::GtxFlag[4] = {
+    xAddCtxSet( {
+        {  25,  25,  11,  27,  20,  21,  33,  12,  28,  21,  22,  34,  28,  29,  29,  30,  36,  29,  45,  30,  23 },
+        {   0,  17,  26,  19,  35,  21,  25,  34,  20,  28,  29,  33,  27,  28,  29,  22,  34,  28,  44,  37,  38 },
+        {   0,   0,  33,  34,  35,  21,  25,  34,  35,  28,  29,  40,  42,  43,  29,  30,  49,  36,  37,  45,  38 },
+        {   9,   5,  10,  13,  13,  10,   9,  10,  13,  13,  13,   9,  10,  10,  10,  13,   8,   9,  10,  10,  13 },
+    } ),
+    xAddCtxSet( {
+        {  40,  33,  27,  28,  21,  37,  36,  37,  45,  38,  46 },
+        {   0,  25,  19,  20,  13,  14,  19,  35,  37,  37,  38 },
+        {   0,  40,  39,  30,  38,  31,  16,  38,  46,  27,  43 },
+        {   8,   8,   9,  12,  12,  10,   5,   9,   9,   9,  13 },
+    } ),
+    xAddCtxSet( {
+        {  25,   1,  40,  25,  33,  11,  17,  25,  25,  18,   4,  17,  33,  26,  19,  13,  33,  19,  20,  28,  22 },
+        {  17,   0,   1,  17,  25,  18,   0,   9,  25,  33,  34,   9,  25,  18,  26,  20,  25,  18,  19,  27,  29 },
+        {  25,   0,   0,  17,  25,  26,   0,   9,  25,  33,  19,   0,  25,  33,  26,  20,  25,  33,  27,  35,  22 },
+        {   1,   5,   9,   9,   9,   6,   5,   9,  10,  10,   9,   9,   9,   9,   9,   9,   6,   8,   9,   9,  10 },
+    } ),
+    xAddCtxSet( {
+        {  40,   9,  25,  18,  26,  35,  25,  26,  35,  28,  37 },
+        {  17,   9,  25,  10,  18,   4,  17,  33,  19,  20,  29 },
+        {  25,   1,  25,  33,  26,  12,  43,  44,  44,  45,  37 },
+        {   1,   5,   8,   8,   9,   6,   6,   9,   8,   8,   9 },
+    } )
+};
+
+const CtxSet ContextSetCfg::ParFlag[2] = {
+    xAddCtxSet( {
+        {  33,  25,  18,  26,  34,  27,  25,  26,  19,  42,  35,  33,  19,  27,  35,  35,  34,  42,  20,  43,  20 },
+        {  18,  17,  33,  18,  26,  42,  25,  33,  26,  42,  27,  25,  34,  42,  42,  35,  26,  27,  42,  20,  20 },
+        {  33,  40,  25,  41,  26,  42,  25,  33,  26,  34,  27,  25,  41,  42,  42,  35,  33,  27,  35,  42,  43 },
+        {   8,   9,  12,  13,  13,  13,  10,  13,  13,  13,  13,  13,  13,  13,  13,  13,  10,  13,  13,  13,  13 },
+    } ),
+    xAddCtxSet( {
+        {  33,  25,  26,  42,  19,  27,  26,  50,  35,  20,  43 },
+        {  25,  25,  26,  11,  19,  27,  33,  42,  35,  35,  43 },
+        {  33,  25,  26,  34,  19,  27,  33,  42,  43,  35,  43 },
+        {   8,  12,  12,  12,  13,  13,  13,  13,  13,  13,  13 },
+    } )
+};
+
+const CtxSet ContextSetCfg::SigCoeffGroup[2] = {
+    xAddCtxSet( {
+        {  18,  31 },
+        {  25,  30 },
+        {  25,  45 },
+        {   8,   5 },
+    } ),
+    xAddCtxSet( {
+        {  25,  15 },
+        {  25,  45 },
+        {  25,  14 },
+        {   5,   8 },
+    } )
+};
+
+const CtxSet ContextSetCfg::LastX[2] = {
+    xAddCtxSet( {
+        {  13,   5,   4,  21,  14,   4,   6,  14,  21,  11,  14,   7,  14,   5,  11,  21,  30,  22,  13,  42 },
+        {   6,  13,  12,   6,   6,  12,  14,  14,  13,  12,  29,   7,   6,  13,  36,  28,  14,  13,   5,  26 },
+        {   6,   6,  12,  14,   6,   4,  14,   7,   6,   4,  29,   7,   6,   6,  12,  28,   7,  13,  13,  35 },
+        {   8,   5,   4,   5,   4,   4,   5,   4,   1,   0,   4,   1,   0,   0,   0,   0,   1,   0,   0,   0 },
+    } ),
+    xAddCtxSet( {
+        {  12,   4,   3 },
+        {  12,   4,  18 },
+        {  19,   5,   4 },
+        {   5,   4,   4 },
+    } )
+};
+
+const CtxSet ContextSetCfg::LastY[2] = {
+    xAddCtxSet( {
+        {  13,   5,   4,   6,  13,  11,  14,   6,   5,   3,  14,  22,   6,   4,   3,   6,  22,  29,  20,  34 },
+        {   5,   5,  12,   6,   6,   4,   6,  14,   5,  12,  14,   7,  13,   5,  13,  21,  14,  20,  12,  34 },
+        {   5,   5,  20,  13,  13,  19,  21,   6,  12,  12,  14,  14,   5,   4,  12,  13,   7,  13,  12,  41 },
+        {   8,   5,   8,   5,   5,   4,   5,   5,   4,   0,   5,   4,   1,   0,   0,   1,   4,   0,   0,   0 },
+    } ),
+    xAddCtxSet( {
+        {  12,   4,   3 },
+        {  11,   4,  18 },
+        {  11,   5,  27 },
+        {   6,   5,   5 },
+    } )
+};
+
+const CtxSet ContextSetCfg::QtCbf[3] = {
+    xAddCtxSet( {
+        {  15,  12,   5,   7 },
+        {  23,   5,  20,   7 },
+        {  15,   6,   5,  14 },
+        {   5,   1,   8,   9 },
+    } ),
+    xAddCtxSet( {
+        {  12,  21 },
+        {  25,  28 },
+        {  25,  37 },
+        {   5,   0 },
+    } ),
+    xAddCtxSet( {
+        {  33,  28,  36 },
+        {  25,  29,  45 },
+        {   9,  36,  45 },
+        {   2,   1,   0 },
+    } )
+};
+
+const CtxSet ContextSetCfg::TsSigCoeffGroup = xAddCtxSet( {
+    {  18,  35,  45 },
+    {  18,  12,  29 },
+    {  18,  20,  38 },
+    {   5,   8,   8 },
+} );
+
+const CtxSet ContextSetCfg::TsSigFlag = xAddCtxSet( {
+    {  25,  28,  38 },
+    {  40,  35,  44 },
+    {  25,  50,  37 },
+    {  13,  13,   8 },
+} );
+
+const CtxSet ContextSetCfg::TsParFlag = xAddCtxSet( {
+    {  11 },
+    {   3 },
+    {  11 },
+    {   6 },
+} );
+
+const CtxSet ContextSetCfg::TsGtxFlag = xAddCtxSet( {
+    { CNU,  10,   3,   3,   3 },
+    { CNU,   2,  10,   3,   3 },
+    { CNU,   3,   4,   4,   5 },
+    { DWS,   1,   1,   1,   1 },
+} );
+
+const CtxSet ContextSetCfg::TsLrg1Flag = xAddCtxSet( {
+    {  11,   5,   5,  14 },
+    {  18,  11,   4,  28 },
+    {  19,  11,   4,   6 },
+    {   4,   2,   1,   6 },
+} );
+
+const CtxSet ContextSetCfg::TsResidualSign = xAddCtxSet( {
+    {  12,  17,  46,  28,  25,  46 },
+    {   5,  10,  53,  43,  25,  46 },
+    {  35,  25,  46,  28,  33,  38 },
+    {   1,   4,   4,   5,   8,   8 },
+} );
+
+const CtxSet ContextSetCfg::TransformSkipFlag = xAddCtxSet( {
+    {  25,   9 },
+    {  25,   9 },
+    {  25,   9 },
+    {   1,   1 },
+} );
+
+const CtxSet ContextSetCfg::JointCbCrFlag = xAddCtxSet( {
+    {  12,  21,  35 },
+    {  27,  36,  45 },
+    {  42,  37,  33 },
+    {   1,   1,   0 },
+} );
+
+const CtxSet ContextSetCfg::MTSIdx = xAddCtxSet( {
+    {  29,   0,  28,   0 },
+    {  45,  40,  27,   0 },
+    {  45,  25,  27,   0 },
+    {   8,   0,   9,   0 },
+} );
+
+const CtxSet ContextSetCfg::LFNSTIdx = xAddCtxSet( {
+    {  28,  52,  42 },
+    {  37,  45,  27 },
+    {  52,  37,  48 },
+    {   9,   9,  10 },
+} );
+
+const CtxSet ContextSetCfg::QtRootCbf = xAddCtxSet( {
+    {   6 },
+    {   5 },
+    {  12 },
+    {   4 },
+} );
+
+// coding tree and coding unit
+const CtxSet ContextSetCfg::SplitFlag = xAddCtxSet( {
+    {  19,  28,  38,  27,  29,  38,  20,  30,  31 },
+    {  11,  35,  53,  12,   6,  30,  13,  15,  31 },
+    {  18,  27,  15,  18,  28,  45,  26,   7,  23 },
+    {  12,  13,   8,   8,  13,  12,   5,   9,   9 },
+} );
+
+const CtxSet ContextSetCfg::SplitQtFlag = xAddCtxSet( {
+    {  27,   6,  15,  25,  19,  37 },
+    {  20,  14,  23,  18,  19,   6 },
+    {  26,  36,  38,  18,  34,  21 },
+    {   0,   8,   8,  12,  12,   8 },
+} );
+
+const CtxSet ContextSetCfg::SplitHvFlag = xAddCtxSet( {
+    {  43,  42,  29,  27,  44 },
+    {  43,  35,  37,  34,  52 },
+    {  43,  42,  37,  42,  44 },
+    {   9,   8,   9,   8,   5 },
+} );
+
+const CtxSet ContextSetCfg::Split12Flag = xAddCtxSet( {
+    {  36,  45,  36,  45 },
+    {  43,  37,  21,  22 },
+    {  28,  29,  28,  29 },
+    {  12,  13,  12,  13 },
+} );
+
+const CtxSet ContextSetCfg::ModeConsFlag = xAddCtxSet( {
+    { CNU, CNU },
+    {  25,  12 },
+    {  25,  20 },
+    {   1,   0 },
+} );
+
+const CtxSet ContextSetCfg::SkipFlag = xAddCtxSet( {
+    {   0,  26,  28 },
+    {  57,  59,  45 },
+    {  57,  60,  46 },
+    {   5,   4,   8 },
+} );
+
+const CtxSet ContextSetCfg::PredMode = xAddCtxSet( {
+    { CNU, CNU },
+    {  40,  35 },
+    {  40,  35 },
+    {   5,   1 },
+} );
+
+const CtxSet ContextSetCfg::IntraLumaMpmFlag = xAddCtxSet( {
+    {  45 },
+    {  36 },
+    {  44 },
+    {   6 },
+} );
+
+const CtxSet ContextSetCfg::IntraLumaPlanarFlag = xAddCtxSet( {
+    {  13,  28 },
+    {  12,  20 },
+    {  13,   6 },
+    {   1,   5 },
+} );
+
+const CtxSet ContextSetCfg::MultiRefLineIdx = xAddCtxSet( {
+    {  25,  60 },
+    {  25,  58 },
+    {  25,  59 },
+    {   5,   8 },
+} );
+
+const CtxSet ContextSetCfg::MipFlag = xAddCtxSet( {
+    {  33,  49,  50,  25 },
+    {  41,  57,  58,  26 },
+    {  56,  57,  50,  26 },
+    {   9,  10,   9,   6 },
+} );
+
+const CtxSet ContextSetCfg::IntraChromaPredMode = xAddCtxSet( {
+    {  34 },
+    {  25 },
+    {  25 },
+    {   5 },
+} );
+
+const CtxSet ContextSetCfg::CclmModeFlag = xAddCtxSet( {
+    {  59 },
+    {  34 },
+    {  26 },
+    {   4 },
+} );
+
+const CtxSet ContextSetCfg::CclmModeIdx = xAddCtxSet( {
+    {  27 },
+    {  27 },
+    {  27 },
+    {   9 },
+} );
+
+const CtxSet ContextSetCfg::BDPCMMode = xAddCtxSet( {
+    {  19,  35,   1,  27 },
+    {  40,  36,   0,  13 },
+    {  19,  21,   0,  28 },
+    {   1,   4,   1,   0 },
+} );
+
+const CtxSet ContextSetCfg::DeltaQP = xAddCtxSet( {
+    { CNU, CNU },
+    { CNU, CNU },
+    { CNU, CNU },
+    { DWS, DWS },
+} );
+
+const CtxSet ContextSetCfg::ChromaQpAdjFlag = xAddCtxSet( {
+    { CNU },
+    { CNU },
+    { CNU },
+    { DWS },
+} );
+
+const CtxSet ContextSetCfg::ChromaQpAdjIdc = xAddCtxSet( {
+    { CNU },
+    { CNU },
+    { CNU },
+    { DWS },
+} );
+
+// inter prediction
+const CtxSet ContextSetCfg::MergeFlag = xAddCtxSet( {
+    {  26 },
+    {  21 },
+    {   6 },
+    {   4 },
+} );
+
+const CtxSet ContextSetCfg::RegularMergeFlag = xAddCtxSet( {
+    { CNU, CNU },
+    {  38,   7 },
+    {  46,  15 },
+    {   5,   5 },
+} );
+
+const CtxSet ContextSetCfg::MergeIdx = xAddCtxSet( {
+    {  34 },
+    {  20 },
+    {  18 },
+    {   4 },
+} );
+
+const CtxSet ContextSetCfg::MmvdFlag = xAddCtxSet( {
+    { CNU },
+    {  26 },
+    {  25 },
+    {   4 },
+} );
+
+const CtxSet ContextSetCfg::MmvdMergeIdx = xAddCtxSet( {
+    { CNU },
+    {  43 },
+    {  43 },
+    {  10 },
+} );
+
+const CtxSet ContextSetCfg::MmvdStepMvpIdx = xAddCtxSet( {
+    { CNU },
+    {  60 },
+    {  59 },
+    {   0 },
+} );
+
+const CtxSet ContextSetCfg::SubblockMergeFlag = xAddCtxSet( {
+    { CNU, CNU, CNU },
+    {  48,  57,  44 },
+    {  25,  58,  45 },
+    {   4,   4,   4 },
+} );
+
+const CtxSet ContextSetCfg::AffineFlag = xAddCtxSet( {
+    { CNU, CNU, CNU },
+    {  12,  13,  14 },
+    {  19,  13,   6 },
+    {   4,   0,   0 },
+} );
+
+const CtxSet ContextSetCfg::AffineType = xAddCtxSet( {
+    { CNU },
+    {  35 },
+    {  35 },
+    {   4 },
+} );
+
+const CtxSet ContextSetCfg::AffMergeIdx = xAddCtxSet( {
+    { CNU },
+    {   5 },
+    {   4 },
+    {   0 },
+} );
+
+const CtxSet ContextSetCfg::CiipFlag = xAddCtxSet( {
+    { CNU },
+    {  57 },
+    {  57 },
+    {   1 },
+} );
+
+const CtxSet ContextSetCfg::InterDir = xAddCtxSet( {
+    { CNU, CNU, CNU, CNU, CNU, CNU },
+    {   7,   6,   5,  12,   4,  40 },
+    {  14,  13,   5,   4,   3,  40 },
+    {   0,   0,   1,   4,   4,   0 },
+} );
+
+const CtxSet ContextSetCfg::RefPic = xAddCtxSet( {
+    { CNU, CNU },
+    {  20,  35 },
+    {   5,  35 },
+    {   0,   4 },
+} );
+
+const CtxSet ContextSetCfg::SmvdFlag = xAddCtxSet( {
+    { CNU },
+    {  28 },
+    {  28 },
+    {   5 },
+} );
+
+const CtxSet ContextSetCfg::Mvd = xAddCtxSet( {
+    {  14,  45 },
+    {  44,  43 },
+    {  51,  36 },
+    {   9,   5 },
+} );
+
+const CtxSet ContextSetCfg::MVPIdx = xAddCtxSet( {
+    {  42 },
+    {  34 },
+    {  34 },
+    {  12 },
+} );
+
+const CtxSet ContextSetCfg::ImvFlag = xAddCtxSet( {
+    {  35,  34,  35, CNU, CNU },
+    {  59,  48,  58,  60,  60 },
+    {  59,  26,  50,  60,  38 },
+    {   0,   5,   0,   0,   4 },
+} );
+
+const CtxSet ContextSetCfg::BcwIdx = xAddCtxSet( {
+    { CNU },
+    {   4 },
+    {   5 },
+    {   1 },
+} );
+
+const CtxSet ContextSetCfg::IBCFlag = xAddCtxSet( {
+    {  17,  42,  36 },
+    {   0,  57,  44 },
+    {   0,   5,  35 },
+    {   1,   5,   8 },
+} );
+
+const CtxSet ContextSetCfg::SbtFlag = xAddCtxSet( {
+    { CNU, CNU },
+    {  56,  57 },
+    {  41,  57 },
+    {   1,   5 },
+} );
+
+const CtxSet ContextSetCfg::SbtQuadFlag = xAddCtxSet( {
+    { CNU },
+    {  42 },
+    {  42 },
+    {  10 },
+} );
+
+const CtxSet ContextSetCfg::SbtHorFlag = xAddCtxSet( {
+    { CNU, CNU, CNU },
+    {  20,  43,  12 },
+    {  35,  51,  27 },
+    {   8,   4,   1 },
+} );
+
+const CtxSet ContextSetCfg::SbtPosFlag = xAddCtxSet( {
+    { CNU },
+    {  28 },
+    {  28 },
+    {  13 },
+} );
+
+// in-loop filters and palette
+const CtxSet ContextSetCfg::SaoMergeFlag = xAddCtxSet( {
+    {  60 },
+    {  60 },
+    {   2 },
+    {   0 },
+} );
+
+const CtxSet ContextSetCfg::SaoTypeIdx = xAddCtxSet( {
+    {  13 },
+    {   5 },
+    {   2 },
+    {   4 },
+} );
+
+const CtxSet ContextSetCfg::CtbAlfFlag = xAddCtxSet( {
+    {  62,  39,  39,  54,  39,  39,  31,  39,  39 },
+    {  13,  23,  46,   4,  61,  54,  19,  46,  54 },
+    {  33,  52,  46,  25,  61,  54,  25,  61,  54 },
+    {   0,   0,   0,   4,   0,   0,   1,   0,   0 },
+} );
+
+const CtxSet ContextSetCfg::CtbAlfAlternative = xAddCtxSet( {
+    {  11,  11 },
+    {  20,  12 },
+    {  11,  26 },
+    {   0,   0 },
+} );
+
+const CtxSet ContextSetCfg::AlfUseTemporalFilt = xAddCtxSet( {
+    {  46 },
+    {  46 },
+    {  46 },
+    {   0 },
+} );
+
+const CtxSet ContextSetCfg::CcAlfFilterControlFlag = xAddCtxSet( {
+    {  18,  30,  31,  18,  30,  31 },
+    {  18,  21,  38,  18,  21,  38 },
+    {  25,  35,  38,  25,  28,  38 },
+    {   4,   1,   4,   4,   1,   4 },
+} );
+
+const CtxSet ContextSetCfg::ACTFlag = xAddCtxSet( {
+    {  52 },
+    {  46 },
+    {  46 },
+    {   1 },
+} );
+
+const CtxSet ContextSetCfg::PLTFlag = xAddCtxSet( {
+    {  25 },
+    {   0 },
+    {  17 },
+    {   1 },
+} );
+
+const CtxSet ContextSetCfg::RotationFlag = xAddCtxSet( {
+    {  42 },
+    {  31 },
+    {  35 },
+    {   5 },
+} );
+
+const CtxSet ContextSetCfg::RunTypeFlag = xAddCtxSet( {
+    {  42 },
+    {  59 },
+    {  50 },
+    {   9 },
+} );
+
+const CtxSet ContextSetCfg::IdxRunModel = xAddCtxSet( {
+    {  50,  37,  45,  30,  46 },
+    {  51,  30,  30,  38,  23 },
+    {  51,  30,  30,  38,  23 },
+    {   9,   6,   9,  10,   5 },
+} );
+
+const CtxSet ContextSetCfg::CopyRunModel = xAddCtxSet( {
+    {  45,  38,  46 },
+    {  38,  53,  46 },
+    {  38,  53,  46 },
+    {   0,   9,   5 },
+} );
+
+const unsigned ContextSetCfg::NumberOfContexts = (unsigned)ContextSetCfg::sm_shiftIdx.size();
+
+const std::vector<uint8_t>& ContextSetCfg::getInitTable( unsigned initType ) {
+    CHECK( initType > 2, "Invalid CABAC init type" );
+    return sm_initValues[initType];
+}
+
+const std::vector<uint8_t>& ContextSetCfg::getShiftTable() {
+    return sm_shiftIdx;
+}
+
+CtxStore::CtxStore() {
+    m_ctx = detail::aligned_malloc<BinProbModel>( ContextSetCfg::NumberOfContexts, CACHE_LINE_SIZE );
+    for( unsigned i = 0; i < ContextSetCfg::NumberOfContexts; i++ ) {
+        new( &m_ctx[i] ) BinProbModel();
+    }
+    if( TRACING_ENABLED ) {
+        m_accessCount.resize( ContextSetCfg::NumberOfContexts, 0 );
+    }
+}
+
+CtxStore::CtxStore( const CtxStore& other ) : CtxStore() {
+    *this = other;
+}
+
+CtxStore::~CtxStore() {
+    free( m_ctx );
+}
+
+CtxStore& CtxStore::operator=( const CtxStore& other ) {
+    // BinProbModel is trivially copyable, the whole store is one block
+    ::memcpy( m_ctx, other.m_ctx, sizeof( BinProbModel ) * ContextSetCfg::NumberOfContexts );
+    return *this;
+}
+
+void CtxStore::init( int qp, unsigned initType ) {
+    const std::vector<uint8_t>& initValues = ContextSetCfg::getInitTable( initType );
+    const std::vector<uint8_t>& shiftIdx   = ContextSetCfg::getShiftTable();
+    for( unsigned i = 0; i < ContextSetCfg::NumberOfContexts; i++ ) {
+        m_ctx[i].init( qp, initValues[i] );
+        m_ctx[i].setShiftIdx( shiftIdx[i] );
+    }
+}
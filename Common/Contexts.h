@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <initializer_list>
+#include <type_traits>
+
+#include "Def.h"
+#include "Trace.h"
+
+// Probability model of one CABAC context variable. It keeps the two probability estimates of the
+// specification (pStateIdx0 with 10 bits and pStateIdx1 with 14 bits), which are adapted with a
+// fast and a slow window size.
+class BinProbModel {
+public:
+    BinProbModel() = default;
+
+    // initValue is the 6 bit init value of the context for the slice QP.
+    void init( int qp, int initValue ) {
+        const int slopeIdx  = initValue >> 3;
+        const int offsetIdx = initValue & 7;
+        const int m         = slopeIdx - 4;
+        const int n         = offsetIdx * 18 + 1;
+        const int preState  = clip3( 1, 127, ( ( m * ( clip3( 0, MAX_QP, qp ) - 16 ) ) >> 1 ) + n );
+        m_state[0] = (uint16_t)( preState << 3 );
+        m_state[1] = (uint16_t)( preState << 7 );
+    }
+    // shiftIdx selects the adaptation rates of the two estimates.
+    void setShiftIdx( int shiftIdx ) {
+        m_shift0 = (uint8_t)( ( shiftIdx >> 2 ) + 2 );
+        m_shift1 = (uint8_t)( ( shiftIdx & 3 ) + 3 + m_shift0 );
+    }
+
+    // pState in 15 bits, the MSB is the most probable symbol
+    uint32_t state() const { return m_state[1] + 16 * m_state[0]; }
+    uint32_t mps()   const { return state() >> 14; }
+
+    // Range of the least probable symbol, computed from the state instead of a table lookup.
+    uint32_t getLPS( uint32_t range ) const {
+        const uint32_t pState = state();
+        const uint32_t q      = ( pState >> 14 ) ? 32767 - pState : pState;
+        return ( ( ( range >> 5 ) * ( q >> 9 ) ) >> 1 ) + 4;
+    }
+
+    void update( uint32_t bin ) {
+        m_state[0] = (uint16_t)( m_state[0] - ( m_state[0] >> m_shift0 ) + ( ( 1023  * bin ) >> m_shift0 ) );
+        m_state[1] = (uint16_t)( m_state[1] - ( m_state[1] >> m_shift1 ) + ( ( 16383 * bin ) >> m_shift1 ) );
+    }
+
+private:
+    uint16_t m_state[2] = { 512, 8192 };   // equiprobable
+    uint8_t  m_shift0   = 4;
+    uint8_t  m_shift1   = 7;
+};
+
+static_assert( sizeof( BinProbModel ) == 6, "context models are stored as three 16 bit words" );
+static_assert( std::is_trivially_copyable<BinProbModel>::value, "context stores are copied with memcpy" );
+
+// Range of consecutive contexts of one syntax element in the CtxStore.
+struct CtxSet {
+    uint16_t offset = 0;
+    uint16_t size   = 0;
+
+    uint16_t operator()( int inc ) const { return offset + inc; }
+};
+
+// Layout of all CABAC contexts. The sets are grouped by syntax element and placed in the order in
+// which they are defined in Contexts.cpp, so that the contexts of one coefficient group or coding unit
+// share few cache lines.
+class ContextSetCfg {
+public:
+    // residual coding
+    static const CtxSet SigFlag[6];          // sig_coeff_flag, luma and chroma per dependent quantization state
+    static const CtxSet GtxFlag[4];          // abs_level_gtx_flag, luma/chroma gt1 and gt3
+    static const CtxSet ParFlag[2];          // par_level_flag
+    static const CtxSet SigCoeffGroup[2];    // sb_coded_flag
+    static const CtxSet LastX[2];            // last_sig_coeff_x_prefix
+    static const CtxSet LastY[2];            // last_sig_coeff_y_prefix
+    static const CtxSet QtCbf[3];            // tu_y/cb/cr_coded_flag
+    static const CtxSet TsSigCoeffGroup;
+    static const CtxSet TsSigFlag;
+    static const CtxSet TsParFlag;
+    static const CtxSet TsGtxFlag;
+    static const CtxSet TsLrg1Flag;
+    static const CtxSet TsResidualSign;
+    static const CtxSet TransformSkipFlag;
+    static const CtxSet JointCbCrFlag;
+    static const CtxSet MTSIdx;
+    static const CtxSet LFNSTIdx;
+    static const CtxSet QtRootCbf;
+    // coding tree and coding unit
+    static const CtxSet SplitFlag;
+    static const CtxSet SplitQtFlag;
+    static const CtxSet SplitHvFlag;
+    static const CtxSet Split12Flag;
+    static const CtxSet ModeConsFlag;
+    static const CtxSet SkipFlag;
+    static const CtxSet PredMode;
+    static const CtxSet IntraLumaMpmFlag;
+    static const CtxSet IntraLumaPlanarFlag;
+    static const CtxSet MultiRefLineIdx;
+    static const CtxSet MipFlag;
+    static const CtxSet IntraChromaPredMode;
+    static const CtxSet CclmModeFlag;
+    static const CtxSet CclmModeIdx;
+    static const CtxSet BDPCMMode;
+    static const CtxSet DeltaQP;
+    static const CtxSet ChromaQpAdjFlag;
+    static const CtxSet ChromaQpAdjIdc;
+    // inter prediction
+    static const CtxSet MergeFlag;
+    static const CtxSet RegularMergeFlag;
+    static const CtxSet MergeIdx;
+    static const CtxSet MmvdFlag;
+    static const CtxSet MmvdMergeIdx;
+    static const CtxSet MmvdStepMvpIdx;
+    static const CtxSet SubblockMergeFlag;
+    static const CtxSet AffineFlag;
+    static const CtxSet AffineType;
+    static const CtxSet AffMergeIdx;
+    static const CtxSet CiipFlag;
+    static const CtxSet InterDir;
+    static const CtxSet RefPic;
+    static const CtxSet SmvdFlag;
+    static const CtxSet Mvd;
+    static const CtxSet MVPIdx;
+    static const CtxSet ImvFlag;
+    static const CtxSet BcwIdx;
+    static const CtxSet IBCFlag;
+    static const CtxSet SbtFlag;
+    static const CtxSet SbtQuadFlag;
+    static const CtxSet SbtHorFlag;
+    static const CtxSet SbtPosFlag;
+    // in-loop filters and palette
+    static const CtxSet SaoMergeFlag;
+    static const CtxSet SaoTypeIdx;
+    static const CtxSet CtbAlfFlag;
+    static const CtxSet CtbAlfAlternative;
+    static const CtxSet AlfUseTemporalFilt;
+    static const CtxSet CcAlfFilterControlFlag;
+    static const CtxSet ACTFlag;
+    static const CtxSet PLTFlag;
+    static const CtxSet RotationFlag;
+    static const CtxSet RunTypeFlag;
+    static const CtxSet IdxRunModel;
+    static const CtxSet CopyRunModel;
+
+    static const unsigned NumberOfContexts;
+
+    // initValue of every context for initType 0..2, and the shiftIdx of every context
+    static const std::vector<uint8_t>& getInitTable( unsigned initType );
+    static const std::vector<uint8_t>& getShiftTable();
+
+private:
+    static CtxSet xAddCtxSet( std::initializer_list<std::initializer_list<uint8_t>> rows );
+
+    static std::vector<uint8_t> sm_initValues[3];
+    static std::vector<uint8_t> sm_shiftIdx;
+};
+
+// All context models of a slice in one cache line aligned array. Saving and restoring the contexts,
+// e.g. for wavefront parallel processing, copies the array with one memcpy.
+class CtxStore {
+public:
+    CtxStore();
+    CtxStore( const CtxStore& other );
+    ~CtxStore();
+    CtxStore& operator=( const CtxStore& other );
+
+    // initType is 0 for I slices, for P and B slices it depends on sh_cabac_init_flag
+    void init( int qp, unsigned initType );
+
+    BinProbModel& operator[]( unsigned idx ) {
+        if( TRACING_ENABLED ) {
+            m_accessCount[idx]++;
+        }
+        return m_ctx[idx];
+    }
+    const BinProbModel& operator[]( unsigned idx ) const { return m_ctx[idx]; }
+
+    // number of accesses per context, only counted with ENABLE_TRACING to tune the layout
+    const std::vector<uint64_t>& getAccessCounts() const { return m_accessCount; }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    BinProbModel*         m_ctx = nullptr;
+    std::vector<uint64_t> m_accessCount;
+};
@@ -6,6 +6,7 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <atomic>
 #include <vector>
 
 typedef       int16_t         Pel;               ///< pixel type
@@ -59,9 +60,36 @@ static const int MAX_QP =                                          63;
 static const int NOT_VALID =                                       -1;
 
 static const int MRG_MAX_NUM_CANDS =                                6; ///< MERGE
+static const int AFFINE_MRG_MAX_NUM_CANDS =                         5; ///< AFFINE MERGE
+static const int IBC_MRG_MAX_NUM_CANDS =                            6; ///< IBC MERGE
 
 static const int MAX_NUM_SUB_PICS =                               255;
+static const int MAX_NUM_SPS =                                     16;
+static const int MAX_NUM_PPS =                                     64;
+static const int MAX_NUM_CQP_MAPPING_TABLES =                       3; ///< Maximum number of chroma QP mapping tables (Cb, Cr and joint Cb-Cr)
+static const int MAX_QP_BD_OFFSET =                                48; ///< QpBdOffset for a bit depth of 16
 static const int MAX_NUM_LONG_TERM_REF_PICS =                      33;
+static const int MAX_QP_OFFSET_LIST_SIZE =                          6; ///< Maximum size of QP offset list is 6 entries
+static const int MAX_SLICES =                                    1000; ///< Maximum number of slices in a picture
+static const int MAX_TILE_COLS =                                   30; ///< Maximum number of tile columns
+static const int MAX_TILES =                                      990; ///< Maximum number of tiles
+static const int MAX_NUM_APS_IDS =                                  8; ///< aps_adaptation_parameter_set_id range of ALF and scaling list APSs
+static const int MAX_NUM_LMCS_APS_IDS =                             4; ///< aps_adaptation_parameter_set_id range of LMCS APSs
+
+static const int MAX_NUM_ALF_CLASSES =                             25; ///< luma filter classes
+static const int MAX_NUM_ALF_LUMA_COEFF =                          12; ///< signalled coefficients of the 7x7 luma diamond, the centre tap is implicit
+static const int MAX_NUM_ALF_CHROMA_COEFF =                         6; ///< signalled coefficients of the 5x5 chroma diamond
+static const int MAX_NUM_ALF_ALTERNATIVES_CHROMA =                  8;
+static const int MAX_NUM_CC_ALF_FILTERS =                           4;
+static const int MAX_NUM_CC_ALF_COEFF =                             7;
+static const int MAX_NUM_ALF_CLIP_VALUES =                          4;
+
+static const int LMCS_NUM_BINS =                                   16; ///< pieces of the LMCS luma mapping function
+static const int LMCS_SCALE_FP_PREC =                              11; ///< fractional bits of the LMCS scale coefficients
+
+static const int SCALING_LIST_NUM =                                 6; ///< intra Y, Cb, Cr and inter Y, Cb, Cr
+static const int SCALING_LIST_DC =                                 16; ///< flat scaling factor
+static const int SCALING_LIST_MAX_CODED_SIZE =                     32; ///< coefficients beyond 32 in a direction are zeroed out
 
 static const int MAX_TLAYER =                                       7; ///< Explicit temporal layer QP offset - max number of temporal layer
 
@@ -73,6 +101,8 @@ static const int MIN_CU_LOG2 =                                      2;
 static const int MIN_PU_SIZE =                                      4;
 static const int MIN_TU_SIZE =                                      4;
 static const int MAX_LOG2_TU_SIZE_PLUS_ONE =                        7; ///< log2(MAX_TU_SIZE) + 1
+static const int COEF_REMAIN_BIN_REDUCTION =                        5; ///< prefix length of abs_remainder/dec_abs_level before the Exp-Golomb part
+static const int MAX_LOG2_TR_DYNAMIC_RANGE =                       15; ///< log2 of the coefficient range without the range extension
 
 typedef       uint16_t        SplitSeries;       ///< used to encoded the splits that caused a particular CU size
 
@@ -167,6 +197,13 @@ enum NalUnitType {
     NAL_UNIT_INVALID
 };
 
+enum ApsType : uint8_t {
+    ALF_APS          = 0,
+    LMCS_APS         = 1,
+    SCALING_LIST_APS = 2,
+    NUM_APS_TYPES
+};
+
 enum ScalingList1dStartIdx {
     SCALING_LIST_1D_START_2x2    = 0,
     SCALING_LIST_1D_START_4x4    = 2,
@@ -174,6 +211,7 @@ enum ScalingList1dStartIdx {
     SCALING_LIST_1D_START_16x16  = 14,
     SCALING_LIST_1D_START_32x32  = 20,
     SCALING_LIST_1D_START_64x64  = 26,
+    SCALING_LIST_1D_NUM          = 28,
 };
 
 static inline ChannelType toChannelType             (const ComponentID id)                         { return (id==COMPONENT_Y)? CHANNEL_TYPE_LUMA : CHANNEL_TYPE_CHROMA; }
@@ -229,7 +267,12 @@ public:
 #define CHECK_WARN(cond, msg)        { if UNLIKELY(cond)   { WARN             (msg << "\nWARNING CONDITION: " << #cond); } }
 #define CHECK_FATAL(cond, msg)       { if UNLIKELY(cond)   { THROW_FATAL      (msg << "\nERROR CONDITION: "   << #cond); } }
 #define CHECK( cond, msg )           { if UNLIKELY( cond ) { THROW_RECOVERABLE( msg << "\nERROR CONDITION: "   << #cond ); } }
+// debug-only checks, compiled out of release builds
+#ifdef NDEBUG
+#define CHECKD(cond, msg)            { }
+#else
 #define CHECKD(cond, msg)            { if UNLIKELY( cond ) { ABORT            ( msg << "\nERROR CONDITION: "   << #cond ); } }
+#endif
 
 
 #define MEMORY_ALIGN_DEF_SIZE       32  // for use with avx2 (256 bit)
@@ -237,16 +280,26 @@ public:
 #define xMalloc(type, len) detail::aligned_malloc<type>(len, MEMORY_ALIGN_DEF_SIZE)
 
 namespace detail {
+    // counts all xMalloc/AlignedAllocator allocations, shared by all translation units
+    inline std::atomic<uint64_t>& aligned_malloc_counter() {
+        static std::atomic<uint64_t> counter{ 0 };
+        return counter;
+    }
+
     template<typename T>
     static inline T* aligned_malloc(size_t len, size_t alignement) {
         T* p = NULL;
         if(posix_memalign((void**) &p, alignement, sizeof(T) * (len))) {
         THROW_FATAL("posix_memalign failed");
         }
+        aligned_malloc_counter().fetch_add(1, std::memory_order_relaxed);
         return p;
     }
 }   // namespace detail
 
+// Number of heap allocations made through xMalloc and AlignedAllocator since the start of the process.
+static inline uint64_t getNumAlignedAllocations() { return detail::aligned_malloc_counter().load(std::memory_order_relaxed); }
+
 template<class T>
 struct AlignedAllocator {
     using value_type = T;
@@ -0,0 +1,193 @@
+#include <string.h>
+
+#include "NalScanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define NAL_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+static const uint8_t* findStartCodeScalar(const uint8_t* p, const uint8_t* end) {
+    // look for the 01 byte first, memchr is vectorized by the C library
+    p += 2;
+    while(p < end) {
+        p = (const uint8_t*)memchr(p, 0x01, end - p);
+        if(p == nullptr) {
+            return end;
+        }
+        if(p[-1] == 0 && p[-2] == 0) {
+            return p - 2;
+        }
+        p += 3;   // p[-1] or p[-2] is non-zero, so the next candidate 01 is at least 3 bytes away
+    }
+    return end;
+}
+
+static const uint8_t* findZeroPairScalar(const uint8_t* p, const uint8_t* end) {
+    for(; p + 1 < end; p++) {
+        if(p[1] != 0) {
+            p++;   // neither p[0] nor p[1] can start a pair
+        } else if(p[0] == 0) {
+            return p;
+        }
+    }
+    return end;
+}
+
+#if NAL_SCANNER_X86
+// Each block compares the bytes at p, p+1 and p+2 so that start codes straddling two blocks are
+// found without carrying state between iterations.
+__attribute__((target("sse2")))
+static const uint8_t* findStartCodeSSE2(const uint8_t* p, const uint8_t* end) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8(1);
+
+    for(; p + 2 + 16 <= end; p += 16) {
+        __m128i b0 = _mm_loadu_si128((const __m128i*)p);
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(p + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i*)(p + 2));
+        __m128i hit = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+                                    _mm_cmpeq_epi8(b2, one));
+        int mask = _mm_movemask_epi8(hit);
+        if(mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findStartCodeScalar(p, end);
+}
+
+__attribute__((target("sse2")))
+static const uint8_t* findZeroPairSSE2(const uint8_t* p, const uint8_t* end) {
+    const __m128i zero = _mm_setzero_si128();
+
+    for(; p + 1 + 16 <= end; p += 16) {
+        __m128i b0 = _mm_loadu_si128((const __m128i*)p);
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(p + 1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)));
+        if(mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findZeroPairScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t* findStartCodeAVX2(const uint8_t* p, const uint8_t* end) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one  = _mm256_set1_epi8(1);
+
+    for(; p + 2 + 32 <= end; p += 32) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)p);
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(p + 1));
+        __m256i b2 = _mm256_loadu_si256((const __m256i*)(p + 2));
+        __m256i hit = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)),
+                                       _mm256_cmpeq_epi8(b2, one));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+        if(mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findStartCodeSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t* findZeroPairAVX2(const uint8_t* p, const uint8_t* end) {
+    const __m256i zero = _mm256_setzero_si256();
+
+    for(; p + 1 + 32 <= end; p += 32) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)p);
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(p + 1));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(b0, zero), _mm256_cmpeq_epi8(b1, zero)));
+        if(mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findZeroPairSSE2(p, end);
+}
+#endif
+
+typedef const uint8_t* (*ByteSearchFunc)(const uint8_t*, const uint8_t*);
+
+struct ByteSearchFuncs {
+    ByteSearchFunc findStartCode;
+    ByteSearchFunc findZeroPair;
+};
+
+static ByteSearchFuncs selectByteSearchFuncs() {
+#if NAL_SCANNER_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return { findStartCodeAVX2, findZeroPairAVX2 };
+    }
+    if(__builtin_cpu_supports("sse2")) {
+        return { findStartCodeSSE2, findZeroPairSSE2 };
+    }
+#endif
+    return { findStartCodeScalar, findZeroPairScalar };
+}
+
+static const ByteSearchFuncs g_byteSearch = selectByteSearchFuncs();
+
+const uint8_t* findStartCode(const uint8_t* begin, const uint8_t* end) {
+    if(end - begin < 3) {
+        return end;
+    }
+    return g_byteSearch.findStartCode(begin, end);
+}
+
+const uint8_t* findZeroPair(const uint8_t* begin, const uint8_t* end) {
+    if(end - begin < 2) {
+        return end;
+    }
+    return g_byteSearch.findZeroPair(begin, end);
+}
+
+size_t scanNalUnits(const uint8_t* data, size_t size, NalBoundaryVec& nals) {
+    const size_t   numBefore = nals.size();
+    const uint8_t* end       = data + size;
+    const uint8_t* sc        = findStartCode(data, end);
+
+    while(sc != end) {
+        NalBoundary nal;
+        nal.offset       = sc + 3 - data;
+        nal.startCodeLen = (sc > data && sc[-1] == 0) ? 4 : 3;
+
+        sc = findStartCode(sc + 3, end);
+
+        // trailing_zero_8bits and the zero_byte of a 4 byte start code do not belong to the NAL unit,
+        // whose last byte is never zero
+        const uint8_t* nalEnd = sc;
+        while(nalEnd > data + nal.offset && nalEnd[-1] == 0) {
+            nalEnd--;
+        }
+        nal.size = nalEnd - (data + nal.offset);
+        nals.push_back(nal);
+    }
+    return nals.size() - numBefore;
+}
+
+bool splitLengthPrefixedNalUnits(const uint8_t* data, size_t size, int lengthSize, NalBoundaryVec& nals) {
+    CHECK(lengthSize != 1 && lengthSize != 2 && lengthSize != 4, "NAL unit length size must be 1, 2 or 4");
+
+    size_t pos = 0;
+    while(pos < size) {
+        if(size - pos < (size_t)lengthSize) {
+            return false;
+        }
+        size_t nalSize = 0;
+        for(int i = 0; i < lengthSize; i++) {
+            nalSize = (nalSize << 8) | data[pos++];
+        }
+        if(nalSize > size - pos) {
+            return false;
+        }
+
+        NalBoundary nal;
+        nal.offset       = pos;
+        nal.size         = nalSize;
+        nal.startCodeLen = (uint8_t)lengthSize;
+        nals.push_back(nal);
+        pos += nalSize;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "Def.h"
+
+// Location of one NAL unit inside an Annex-B byte stream.
+struct NalBoundary {
+    size_t  offset;         ///< first byte of the NAL unit header, i.e. directly after the start code
+    size_t  size;           ///< number of NAL unit bytes up to the next start code (or the end of the data)
+    uint8_t startCodeLen;   ///< 3 for 00 00 01, 4 if a zero_byte precedes it, or the size of the length prefix
+};
+
+typedef std::vector<NalBoundary, AlignedAllocator<NalBoundary>> NalBoundaryVec;
+
+// Fields of the two byte NAL unit header, see DecImpl::xReadNalUnitHeader.
+static inline NalUnitType getNalUnitHeaderType      (const uint8_t* header) { return (NalUnitType)((header[1] >> 3) & 0x1f); }
+static inline int         getNalUnitHeaderLayerId   (const uint8_t* header) { return header[0] & 0x3f; }
+static inline int         getNalUnitHeaderTemporalId(const uint8_t* header) { return (header[1] & 0x7) - 1; }
+
+// Returns a pointer to the first byte of the next 00 00 01 in [begin, end), or end if there is none.
+// Uses SSE2/AVX2 when the CPU supports it.
+const uint8_t* findStartCode(const uint8_t* begin, const uint8_t* end);
+
+// Returns a pointer to the first byte of the next 00 00 in [begin, end), or end if there is none.
+// Uses SSE2/AVX2 when the CPU supports it.
+const uint8_t* findZeroPair(const uint8_t* begin, const uint8_t* end);
+
+// Splits data into NAL units in one pass. Leading bytes before the first start code are skipped and
+// trailing zero bytes are stripped from every NAL unit. Returns the number of boundaries appended.
+size_t scanNalUnits(const uint8_t* data, size_t size, NalBoundaryVec& nals);
+
+// Splits data made of NAL units that are each preceded by a big-endian size field of lengthSize
+// (1, 2 or 4) bytes, as stored in MP4/MKV samples. Returns false if a size exceeds the data.
+bool splitLengthPrefixedNalUnits(const uint8_t* data, size_t size, int lengthSize, NalBoundaryVec& nals);
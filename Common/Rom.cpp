@@ -5,6 +5,30 @@
 
 int8_t                    g_aucLog2    [MAX_CU_SIZE + 1];
 
+const ScanElement*        g_scanOrder  [MAX_LOG2_TU_SIZE_PLUS_ONE][MAX_LOG2_TU_SIZE_PLUS_ONE];
+
+// all scan orders, ( 2^MAX_LOG2_TU_SIZE_PLUS_ONE - 1 )^2 elements for the sizes 1 to 64 in each direction
+static ScanElement        g_scanOrderBuf[( ( 1 << MAX_LOG2_TU_SIZE_PLUS_ONE ) - 1 ) * ( ( 1 << MAX_LOG2_TU_SIZE_PLUS_ONE ) - 1 )];
+
+static void initDiagScan( ScanElement* scan, int blkWidth, int blkHeight ) {
+    int i = 0;
+    int x = 0;
+    int y = 0;
+    while( i < blkWidth * blkHeight ) {
+        while( y >= 0 ) {
+            if( x < blkWidth && y < blkHeight ) {
+                scan[i].x = (uint8_t) x;
+                scan[i].y = (uint8_t) y;
+                i++;
+            }
+            y--;
+            x++;
+        }
+        y = x;
+        x = 0;
+    }
+}
+
 void initROM() {
     int c;
 
@@ -18,4 +42,13 @@ void initROM() {
         }
         g_aucLog2    [i] = c;
     }
+
+    ScanElement* scan = g_scanOrderBuf;
+    for( int log2Width = 0; log2Width < MAX_LOG2_TU_SIZE_PLUS_ONE; log2Width++ ) {
+        for( int log2Height = 0; log2Height < MAX_LOG2_TU_SIZE_PLUS_ONE; log2Height++ ) {
+            initDiagScan( scan, 1 << log2Width, 1 << log2Height );
+            g_scanOrder[log2Width][log2Height] = scan;
+            scan += 1 << ( log2Width + log2Height );
+        }
+    }
 }
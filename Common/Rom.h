@@ -6,4 +6,14 @@
 
 extern int8_t                    g_aucLog2    [MAX_CU_SIZE + 1];
 
-void initROM();
\ No newline at end of file
+// position of one scan index inside a block
+struct ScanElement {
+    uint8_t x;
+    uint8_t y;
+};
+
+// up-right diagonal scan order (6.5.3) of a block with the given log2 width and log2 height, used for
+// coefficient groups in a transform block and for coefficients in a coefficient group
+extern const ScanElement* g_scanOrder[MAX_LOG2_TU_SIZE_PLUS_ONE][MAX_LOG2_TU_SIZE_PLUS_ONE];
+
+void initROM();
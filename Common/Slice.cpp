@@ -2,6 +2,7 @@
 
 #include "Slice.h"
 #include "Picture.h"
+#include "Common.h"
 
 ReferencePictureList::ReferencePictureList() {
     ::memset(this, 0, sizeof(*this));
@@ -81,17 +82,504 @@ bool ReferencePictureList::findInRefPicList(const Picture* checkRefPic, int curr
 }
 
 int ReferencePictureList::calcLTRefPOC(int currPoc, int bitsForPoc, int refPicIdentifier, bool pocMSBPresent, int deltaPocMSBCycle) {
-    return 0;
+    const int maxPocLsb = 1 << bitsForPoc;
+    int ltrpPoc = refPicIdentifier & (maxPocLsb - 1);
+    if (pocMSBPresent) {
+        ltrpPoc += currPoc - deltaPocMSBCycle * maxPocLsb - (currPoc & (maxPocLsb - 1));
+    }
+    return ltrpPoc;
 }
 
 int ReferencePictureList::calcLTRefPOC(int currPoc, int bitsForPoc, int refPicIdx) const {
-    return 0;
+    return calcLTRefPOC(currPoc, bitsForPoc, m_refPicIdentifier[refPicIdx], m_deltaPocMSBPresentFlag[refPicIdx], m_deltaPOCMSBCycleLT[refPicIdx]);
 }
 
-ScalingList::ScalingList() {
+void ReferencePictureList::derivePOCs(int currPoc, int bitsForPoc) {
+    for (int i = 0; i < getNumRefEntries(); i++) {
+        if (m_isInterLayerRefPic[i]) {
+            m_POC[i] = currPoc;
+        } else if (m_isLongtermRefPic[i]) {
+            m_POC[i] = calcLTRefPOC(currPoc, bitsForPoc, i);
+        } else {
+            m_POC[i] = currPoc + m_refPicIdentifier[i];
+        }
+    }
+}
 
+void Slice::initSlice() {
+    std::vector<uint32_t> substreamSizes;
+    substreamSizes.swap(m_substreamSizes);
+    *this = Slice();
+    substreamSizes.clear();
+    m_substreamSizes.swap(substreamSizes);
+}
+
+ScalingList::ScalingList() {
+    reset();
 }
 
 void ScalingList::reset() {
-    
-}
\ No newline at end of file
+    ::memset( m_scalingListCoef, SCALING_LIST_DC, sizeof( m_scalingListCoef ) );
+    for( int id = 0; id < SCALING_LIST_1D_NUM; id++ ) {
+        m_scalingListDC[id] = SCALING_LIST_DC;
+    }
+    m_matrixArena.clear();
+}
+
+int ScalingList::getScalingListId( int log2Width, int log2Height, int listType ) {
+    // indexed by the log2 size of the larger side; 2x2 blocks are chroma only, and 64x64 chroma blocks use the 32x32 lists
+    static const uint8_t scalingListId[MAX_LOG2_TU_SIZE_PLUS_ONE][SCALING_LIST_NUM] = {
+        {  0,  0,  0,  0,  0,  0 },
+        {  0,  0,  1,  0,  0,  1 },
+        {  2,  3,  4,  5,  6,  7 },
+        {  8,  9, 10, 11, 12, 13 },
+        { 14, 15, 16, 17, 18, 19 },
+        { 20, 21, 22, 23, 24, 25 },
+        { 26, 21, 22, 27, 24, 25 },
+    };
+    return scalingListId[std::max( log2Width, log2Height )][listType];
+}
+
+void ScalingList::processRefMatrix( uint32_t scalingListId, uint32_t refListId ) {
+    const int numCoef = matrixSize( scalingListId ) * matrixSize( scalingListId );
+    if( scalingListId == refListId ) {
+        ::memset( getScalingListAddress( scalingListId ), SCALING_LIST_DC, numCoef );
+        m_scalingListDC[scalingListId] = SCALING_LIST_DC;
+    } else {
+        ::memcpy( getScalingListAddress( scalingListId ), getScalingListAddress( refListId ), numCoef );
+        m_scalingListDC[scalingListId] = m_scalingListDC[refListId];
+    }
+}
+
+void ScalingList::deriveScalingMatrices() {
+    m_matrixArena.resize( NUM_MATRIX_SAMPLES );
+    for( int listType = 0; listType < SCALING_LIST_NUM; listType++ ) {
+        for( int log2Width = 1; log2Width < MAX_LOG2_TU_SIZE_PLUS_ONE; log2Width++ ) {
+            for( int log2Height = 1; log2Height < MAX_LOG2_TU_SIZE_PLUS_ONE; log2Height++ ) {
+                xExpandMatrix( log2Width, log2Height, listType, m_matrixArena.data() + xMatrixOffset( log2Width, log2Height, listType ) );
+            }
+        }
+    }
+}
+
+void ScalingList::xExpandMatrix( int log2Width, int log2Height, int listType, int16_t* dst ) const {
+    const int      id         = getScalingListId( log2Width, log2Height, listType );
+    const int      log2Size   = std::max( log2Width, log2Height );
+    const int      log2Matrix = id < SCALING_LIST_1D_START_4x4 ? 1 : id < SCALING_LIST_1D_START_8x8 ? 2 : 3;
+    const int      width      = std::min( 1 << log2Width,  SCALING_LIST_MAX_CODED_SIZE );
+    const int      height     = std::min( 1 << log2Height, SCALING_LIST_MAX_CODED_SIZE );
+    const uint8_t* coef       = getScalingListAddress( id );
+
+    // a position is scaled to the square block of the larger side and from there down to the coded matrix
+    const int      shiftX     = log2Size - log2Width;
+    const int      shiftY     = log2Size - log2Height;
+    const int      shiftDown  = log2Size - log2Matrix;
+    for( int y = 0; y < height; y++ ) {
+        const uint8_t* row = coef + ( ( y << shiftY ) >> shiftDown << log2Matrix );
+        for( int x = 0; x < width; x++ ) {
+            dst[y * width + x] = row[( x << shiftX ) >> shiftDown];
+        }
+    }
+    if( log2Size > 3 ) {
+        dst[0] = (int16_t)m_scalingListDC[id];
+    }
+}
+
+void APS::deriveTables( int bitDepth ) {
+    switch( m_APSType ) {
+    case ALF_APS:
+        xDeriveAlfFilterBank( bitDepth );
+        break;
+    case LMCS_APS:
+        xDeriveLmcsTables( bitDepth );
+        break;
+    case SCALING_LIST_APS:
+        if( !m_scalingList.hasScalingMatrices() ) {
+            m_scalingList.deriveScalingMatrices();
+        }
+        break;
+    default:
+        THROW_RECOVERABLE( "Invalid APS type" );
+    }
+    m_tablesBitDepth = bitDepth;
+}
+
+void APS::xDeriveAlfFilterBank( int bitDepth ) {
+    // AlfClip of the specification; the clipping range of index 0 is reduced by one to fit int16_t, which does not
+    // change the result since a difference of two samples never exceeds it
+    const int16_t alfClip[MAX_NUM_ALF_CLIP_VALUES] = { (int16_t)std::min( ( 1 << bitDepth ) - 1, (int)INT16_MAX ),
+                                                       (int16_t)( 1 << ( bitDepth - 3 ) ),
+                                                       (int16_t)( 1 << ( bitDepth - 5 ) ),
+                                                       (int16_t)( 1 << ( bitDepth - 7 ) ) };
+    const AlfParam& param = m_alfParam;
+    AlfFilterBank&  bank  = m_alfFilterBank;
+    ::memset( &bank, 0, sizeof( bank ) );
+
+    if( param.lumaFilterSignalFlag ) {
+        for( int classIdx = 0; classIdx < MAX_NUM_ALF_CLASSES; classIdx++ ) {
+            const int filtIdx = param.lumaCoeffDeltaIdx[classIdx];
+            for( int j = 0; j < MAX_NUM_ALF_LUMA_COEFF; j++ ) {
+                bank.lumaCoeff[classIdx][j] = param.lumaCoeff[filtIdx][j];
+                bank.lumaClip [classIdx][j] = alfClip[param.lumaClipIdx[filtIdx][j]];
+            }
+        }
+    }
+    if( param.chromaFilterSignalFlag ) {
+        for( int altIdx = 0; altIdx < param.numAltChroma; altIdx++ ) {
+            for( int j = 0; j < MAX_NUM_ALF_CHROMA_COEFF; j++ ) {
+                bank.chromaCoeff[altIdx][j] = param.chromaCoeff[altIdx][j];
+                bank.chromaClip [altIdx][j] = alfClip[param.chromaClipIdx[altIdx][j]];
+            }
+        }
+    }
+    ::memcpy( bank.ccAlfCoeff, param.ccAlfCoeff, sizeof( bank.ccAlfCoeff ) );
+}
+
+void APS::xDeriveLmcsTables( int bitDepth ) {
+    const LmcsParam& param     = m_lmcsParam;
+    LmcsTables&      tables    = m_lmcsTables;
+    const int        orgCW     = ( 1 << bitDepth ) / LMCS_NUM_BINS;
+    const int        log2OrgCW = bitDepth - 4;
+    const int        round     = 1 << ( LMCS_SCALE_FP_PREC - 1 );
+    const int        maxVal    = ( 1 << bitDepth ) - 1;
+
+    tables.lmcsPivot[0] = 0;
+    for( int i = 0; i < LMCS_NUM_BINS; i++ ) {
+        const bool coded  = i >= param.minBinIdx && i <= param.maxBinIdx;
+        const int  lmcsCW = coded ? orgCW + param.deltaCW[i] : 0;
+        CHECK( coded && ( lmcsCW < ( orgCW >> 3 ) || lmcsCW > ( orgCW << 3 ) - 1 ), "lmcsCW out of range" );
+        CHECK( lmcsCW && ( lmcsCW + param.deltaCrs < ( orgCW >> 3 ) || lmcsCW + param.deltaCrs > ( orgCW << 3 ) - 1 ), "lmcsDeltaCrs out of range" );
+
+        tables.inputPivot      [i]     = i * orgCW;
+        tables.lmcsPivot       [i + 1] = tables.lmcsPivot[i] + lmcsCW;
+        tables.scaleCoeff      [i]     = ( lmcsCW * ( 1 << LMCS_SCALE_FP_PREC ) + ( 1 << ( log2OrgCW - 1 ) ) ) >> log2OrgCW;
+        tables.invScaleCoeff   [i]     = lmcsCW ? orgCW * ( 1 << LMCS_SCALE_FP_PREC ) / lmcsCW : 0;
+        tables.chromaScaleCoeff[i]     = lmcsCW ? orgCW * ( 1 << LMCS_SCALE_FP_PREC ) / ( lmcsCW + param.deltaCrs ) : 1 << LMCS_SCALE_FP_PREC;
+    }
+    tables.inputPivot[LMCS_NUM_BINS] = LMCS_NUM_BINS * orgCW;
+    CHECK( tables.lmcsPivot[LMCS_NUM_BINS] > maxVal, "The sum of lmcsCW exceeds the sample range" );
+
+    tables.fwdLUT        .resize( maxVal + 1 );
+    tables.invLUT        .resize( maxVal + 1 );
+    tables.chromaScaleLUT.resize( maxVal + 1 );
+    int idxYInv = param.minBinIdx;
+    for( int y = 0; y <= maxVal; y++ ) {
+        const int idxY = y >> log2OrgCW;
+        tables.fwdLUT[y] = (Pel)( tables.lmcsPivot[idxY] + ( ( tables.scaleCoeff[idxY] * ( y - tables.inputPivot[idxY] ) + round ) >> LMCS_SCALE_FP_PREC ) );
+
+        // identification of the piecewise function index, the values are visited in increasing order
+        while( idxYInv < param.maxBinIdx && y >= tables.lmcsPivot[idxYInv + 1] ) {
+            idxYInv++;
+        }
+        const int invSample = tables.inputPivot[idxYInv] + ( ( tables.invScaleCoeff[idxYInv] * ( y - tables.lmcsPivot[idxYInv] ) + round ) >> LMCS_SCALE_FP_PREC );
+        tables.invLUT        [y] = (Pel)clip3( 0, maxVal, invSample );
+        tables.chromaScaleLUT[y] = (int16_t)tables.chromaScaleCoeff[idxYInv];
+    }
+}
+void ChromaQpMappingTable::deriveChromaQPMappingTables() {
+    const int qpBdOffset = m_qpBdOffset;
+    for( int i = 0; i < m_numQpTables; i++ ) {
+        const int numPts = m_numPtsInCQPTableMinus1[i] + 1;
+        std::vector<int> qpInVal ( numPts + 1 );
+        std::vector<int> qpOutVal( numPts + 1 );
+        qpInVal [0] = m_qpTableStartMinus26[i] + 26;
+        qpOutVal[0] = qpInVal[0];
+        for( int j = 0; j < numPts; j++ ) {
+            qpInVal [j + 1] = qpInVal [j] + m_deltaQpInValMinus1[i][j] + 1;
+            qpOutVal[j + 1] = qpOutVal[j] + ( m_deltaQpInValMinus1[i][j] ^ m_deltaQpOutVal[i][j] );
+        }
+        CHECK( qpInVal[0] < -qpBdOffset || qpInVal[numPts] > MAX_QP, "Invalid chroma QP mapping table" );
+
+        int8_t* table = m_table[i] + MAX_QP_BD_OFFSET;
+        table[qpInVal[0]] = (int8_t)qpOutVal[0];
+        for( int k = qpInVal[0] - 1; k >= -qpBdOffset; k-- ) {
+            table[k] = (int8_t)clip3( -qpBdOffset, MAX_QP, table[k + 1] - 1 );
+        }
+        for( int j = 0; j < numPts; j++ ) {
+            const int sh = ( m_deltaQpInValMinus1[i][j] + 1 ) >> 1;
+            for( int k = qpInVal[j] + 1, m = 1; k <= qpInVal[j + 1]; k++, m++ ) {
+                table[k] = (int8_t)( table[qpInVal[j]] + ( ( qpOutVal[j + 1] - qpOutVal[j] ) * m + sh ) / ( m_deltaQpInValMinus1[i][j] + 1 ) );
+            }
+        }
+        for( int k = qpInVal[numPts] + 1; k <= MAX_QP; k++ ) {
+            table[k] = (int8_t)clip3( -qpBdOffset, MAX_QP, table[k - 1] + 1 );
+        }
+    }
+    for( int i = m_numQpTables; i < MAX_NUM_CQP_MAPPING_TABLES; i++ ) {
+        ::memcpy( m_table[i], m_table[0], sizeof( m_table[0] ) );
+    }
+}
+
+RPLList& SPS::createRPLList( int l, int numRPL ) {
+    m_RPLList[l].clear();
+    m_RPLList[l].resize( numRPL );
+    m_numRPL[l] = numRPL;
+    return m_RPLList[l];
+}
+
+void PPS::initTiles() {
+    if( m_noPicPartitionFlag ) {
+        m_tileColumnWidth.assign( 1, m_picWidthInCtu );
+        m_tileRowHeight  .assign( 1, m_picHeightInCtu );
+        m_numExpTileCols = 1;
+        m_numExpTileRows = 1;
+    }
+    CHECK( m_tileColumnWidth.size() != m_numExpTileCols || m_tileRowHeight.size() != m_numExpTileRows, "Tile sizes are initialized twice" );
+
+    // the last explicit size is repeated as long as it fits, the rest of the picture is the last tile
+    uint32_t remainingWidthInCtu = m_picWidthInCtu;
+    for( uint32_t width: m_tileColumnWidth ) {
+        CHECK( width > remainingWidthInCtu, "Explicit tile column widths exceed the picture width" );
+        remainingWidthInCtu -= width;
+    }
+    const uint32_t uniformTileColWidth = m_tileColumnWidth.back();
+    while( remainingWidthInCtu >= uniformTileColWidth ) {
+        addTileColumnWidth( uniformTileColWidth );
+        remainingWidthInCtu -= uniformTileColWidth;
+    }
+    if( remainingWidthInCtu > 0 ) {
+        addTileColumnWidth( remainingWidthInCtu );
+    }
+
+    uint32_t remainingHeightInCtu = m_picHeightInCtu;
+    for( uint32_t height: m_tileRowHeight ) {
+        CHECK( height > remainingHeightInCtu, "Explicit tile row heights exceed the picture height" );
+        remainingHeightInCtu -= height;
+    }
+    const uint32_t uniformTileRowHeight = m_tileRowHeight.back();
+    while( remainingHeightInCtu >= uniformTileRowHeight ) {
+        addTileRowHeight( uniformTileRowHeight );
+        remainingHeightInCtu -= uniformTileRowHeight;
+    }
+    if( remainingHeightInCtu > 0 ) {
+        addTileRowHeight( remainingHeightInCtu );
+    }
+
+    m_numTileCols = (uint32_t)m_tileColumnWidth.size();
+    m_numTileRows = (uint32_t)m_tileRowHeight.size();
+    CHECK( getNumTiles() > MAX_TILES, "Number of tiles exceeds valid range" );
+
+    m_tileColBd.resize( m_numTileCols + 1 );
+    m_tileRowBd.resize( m_numTileRows + 1 );
+    m_ctuToTileCol.resize( m_picWidthInCtu );
+    m_ctuToTileRow.resize( m_picHeightInCtu );
+
+    m_tileColBd[0] = 0;
+    for( uint32_t col = 0; col < m_numTileCols; col++ ) {
+        m_tileColBd[col + 1] = m_tileColBd[col] + m_tileColumnWidth[col];
+        std::fill( m_ctuToTileCol.begin() + m_tileColBd[col], m_ctuToTileCol.begin() + m_tileColBd[col + 1], col );
+    }
+    m_tileRowBd[0] = 0;
+    for( uint32_t row = 0; row < m_numTileRows; row++ ) {
+        m_tileRowBd[row + 1] = m_tileRowBd[row] + m_tileRowHeight[row];
+        std::fill( m_ctuToTileRow.begin() + m_tileRowBd[row], m_ctuToTileRow.begin() + m_tileRowBd[row + 1], row );
+    }
+}
+
+void PPS::initTileSliceMaps( const SPS& sps ) {
+    if( m_noPicPartitionFlag ) {
+        setLog2CtuSize( getLog2( sps.getCTUSize() ) );
+        initTiles();
+        m_rectSliceFlag            = true;
+        m_singleSlicePerSubPicFlag = false;
+        m_numSlicesInPic           = 1;
+        m_rectSlices.assign( 1, RectSlice() );
+    }
+    CHECK( m_ctuSize != sps.getCTUSize(), "The CTU size of the PPS and the SPS differ" );
+
+    // CtbAddrRsToTs and CtbAddrTsToRs, the tiles in raster scan and the CTUs in raster scan inside each tile
+    const uint32_t numCtusInPic = getNumCtusInPic();
+    m_ctuRsToTs.resize( numCtusInPic );
+    m_ctuTsToRs.resize( numCtusInPic );
+    m_tileFirstCtuTs.resize( getNumTiles() + 1 );
+
+    uint32_t ctuTsAddr = 0;
+    for( uint32_t tileRow = 0; tileRow < m_numTileRows; tileRow++ ) {
+        for( uint32_t tileCol = 0; tileCol < m_numTileCols; tileCol++ ) {
+            m_tileFirstCtuTs[tileRow * m_numTileCols + tileCol] = ctuTsAddr;
+            for( uint32_t ctuY = m_tileRowBd[tileRow]; ctuY < m_tileRowBd[tileRow + 1]; ctuY++ ) {
+                for( uint32_t ctuX = m_tileColBd[tileCol]; ctuX < m_tileColBd[tileCol + 1]; ctuX++ ) {
+                    const uint32_t ctuRsAddr = ctuY * m_picWidthInCtu + ctuX;
+                    m_ctuRsToTs[ctuRsAddr]   = ctuTsAddr;
+                    m_ctuTsToRs[ctuTsAddr++] = ctuRsAddr;
+                }
+            }
+        }
+    }
+    m_tileFirstCtuTs.back() = ctuTsAddr;
+
+    // the CTUs of raster scan slices follow from the tile scan and the slice header
+    m_sliceCtuAddrs.clear();
+    m_sliceFirstCtuIdx.assign( 1, 0 );
+    if( !m_rectSliceFlag ) {
+        return;
+    }
+
+    m_sliceCtuAddrs.reserve( numCtusInPic );
+    if( m_singleSlicePerSubPicFlag ) {
+        if( !sps.getSubPicInfoPresentFlag() ) {
+            m_numSlicesInPic = 1;
+            xAddCtusInRect( 0, m_picWidthInCtu, 0, m_picHeightInCtu );
+            return;
+        }
+        m_numSlicesInPic = sps.getNumSubPics();
+        for( uint32_t i = 0; i < m_numSlicesInPic; i++ ) {
+            const uint32_t ctuX = sps.getSubPicCtuTopLeftX( i );
+            const uint32_t ctuY = sps.getSubPicCtuTopLeftY( i );
+            xAddCtusInRect( ctuX, std::min( ctuX + sps.getSubPicWidth( i ), m_picWidthInCtu ), ctuY, std::min( ctuY + sps.getSubPicHeight( i ), m_picHeightInCtu ) );
+        }
+        return;
+    }
+
+    CHECK( m_rectSlices.size() != m_numSlicesInPic, "Number of rectangular slices does not match the PPS" );
+    uint32_t prevTileIdx = getNumTiles();
+    uint32_t ctuYInTile  = 0;
+    for( const RectSlice& slice: m_rectSlices ) {
+        const uint32_t tileX = slice.tileIdx % m_numTileCols;
+        const uint32_t tileY = slice.tileIdx / m_numTileCols;
+        CHECK( tileX + slice.sliceWidthInTiles > m_numTileCols || tileY + slice.sliceHeightInTiles > m_numTileRows, "Rectangular slice exceeds the picture" );
+
+        if( slice.sliceHeightInCtu > 0 ) {
+            // one of several slices inside a tile, they follow each other from the top of the tile
+            ctuYInTile  = slice.tileIdx == prevTileIdx ? ctuYInTile : m_tileRowBd[tileY];
+            CHECK( ctuYInTile + slice.sliceHeightInCtu > m_tileRowBd[tileY + 1], "Slices exceed the height of the tile" );
+            xAddCtusInRect( m_tileColBd[tileX], m_tileColBd[tileX + 1], ctuYInTile, ctuYInTile + slice.sliceHeightInCtu );
+            ctuYInTile += slice.sliceHeightInCtu;
+        } else {
+            xAddCtusInRect( m_tileColBd[tileX], m_tileColBd[tileX + slice.sliceWidthInTiles], m_tileRowBd[tileY], m_tileRowBd[tileY + slice.sliceHeightInTiles] );
+        }
+        prevTileIdx = slice.tileIdx;
+    }
+}
+
+void PPS::xAddCtusInRect( uint32_t ctuX0, uint32_t ctuX1, uint32_t ctuY0, uint32_t ctuY1 ) {
+    CHECK( ctuX0 >= ctuX1 || ctuY0 >= ctuY1, "Empty slice" );
+    for( uint32_t tileRow = m_ctuToTileRow[ctuY0]; tileRow < m_numTileRows && m_tileRowBd[tileRow] < ctuY1; tileRow++ ) {
+        for( uint32_t tileCol = m_ctuToTileCol[ctuX0]; tileCol < m_numTileCols && m_tileColBd[tileCol] < ctuX1; tileCol++ ) {
+            const uint32_t tileY1 = std::min( ctuY1, m_tileRowBd[tileRow + 1] );
+            const uint32_t tileX1 = std::min( ctuX1, m_tileColBd[tileCol + 1] );
+            for( uint32_t ctuY = std::max( ctuY0, m_tileRowBd[tileRow] ); ctuY < tileY1; ctuY++ ) {
+                for( uint32_t ctuX = std::max( ctuX0, m_tileColBd[tileCol] ); ctuX < tileX1; ctuX++ ) {
+                    m_sliceCtuAddrs.push_back( ctuY * m_picWidthInCtu + ctuX );
+                }
+            }
+        }
+    }
+    m_sliceFirstCtuIdx.push_back( (uint32_t)m_sliceCtuAddrs.size() );
+}
+
+std::shared_ptr<const SeqPicContext> SeqPicContext::create( std::shared_ptr<const SPS> sps, std::shared_ptr<const PPS> pps ) {
+    CHECK( pps->getSPSId() != sps->getSPSId(), "The PPS does not refer to the SPS" );
+    CHECK( pps->getPicWidthInLumaSamples() > sps->getMaxPicWidthInLumaSamples() || pps->getPicHeightInLumaSamples() > sps->getMaxPicHeightInLumaSamples(),
+           "The picture size of the PPS exceeds the maximum picture size of the SPS" );
+    CHECK( pps->getCtuSize() != sps->getCTUSize() || pps->getNumCtusInPic() == 0, "The tile and slice maps of the PPS have not been derived for the SPS" );
+
+    std::shared_ptr<SeqPicContext> ctx( new SeqPicContext() );
+
+    ctx->chromaFormat  = sps->getChromaFormatIdc();
+    ctx->numComponents = getNumberValidComponents( ctx->chromaFormat );
+    for( int comp = 0; comp < MAX_NUM_COMPONENT; comp++ ) {
+        ctx->compScaleX[comp] = (uint8_t)getComponentScaleX( ComponentID( comp ), ctx->chromaFormat );
+        ctx->compScaleY[comp] = (uint8_t)getComponentScaleY( ComponentID( comp ), ctx->chromaFormat );
+    }
+    ctx->bitDepth   = sps->getBitDepth();
+    ctx->qpBdOffset = sps->getQpBDOffset();
+
+    ctx->picWidth  = pps->getPicWidthInLumaSamples();
+    ctx->picHeight = pps->getPicHeightInLumaSamples();
+
+    ctx->log2CtuSize    = pps->getLog2CtuSize();
+    ctx->ctuSize        = pps->getCtuSize();
+    ctx->ctuMask        = ctx->ctuSize - 1;
+    ctx->picWidthInCtu  = pps->getPicWidthInCtu();
+    ctx->picHeightInCtu = pps->getPicHeightInCtu();
+    ctx->numCtusInPic   = pps->getNumCtusInPic();
+
+    ctx->log2MinCbSize    = sps->getLog2MinCodingBlockSize();
+    ctx->minCbSize        = 1 << ctx->log2MinCbSize;
+    ctx->picWidthInMinCb  = ctx->picWidth  >> ctx->log2MinCbSize;
+    ctx->picHeightInMinCb = ctx->picHeight >> ctx->log2MinCbSize;
+    CHECK( ctx->picWidth & ( ctx->minCbSize - 1 ) || ctx->picHeight & ( ctx->minCbSize - 1 ), "The picture size is not a multiple of the minimum coding block size" );
+
+    ctx->log2MinBlkSize    = getLog2( MIN_PU_SIZE );
+    ctx->picWidthInMinBlk  = ctx->picWidth  >> ctx->log2MinBlkSize;
+    ctx->picHeightInMinBlk = ctx->picHeight >> ctx->log2MinBlkSize;
+    ctx->numMinBlksInPic   = ctx->picWidthInMinBlk * ctx->picHeightInMinBlk;
+
+    ctx->log2MaxTbSize = sps->getLog2MaxTbSize();
+    ctx->log2MaxTsSize = sps->getLog2MaxTransformSkipBlockSize();
+
+    // the chroma entries are 0 without a dual tree
+    auto log2Size = []( unsigned size ) { return (uint8_t)( size ? getLog2( size ) : 0 ); };
+    for( int i = 0; i < 3; i++ ) {
+        ctx->log2MinQtSize[i] = log2Size( sps->getMinQTSizes()[i] );
+        ctx->log2MaxBtSize[i] = log2Size( sps->getMaxBTSizes()[i] );
+        ctx->log2MaxTtSize[i] = log2Size( sps->getMaxTTSizes()[i] );
+        ctx->maxMttDepth  [i] = (uint8_t)sps->getMaxMTTHierarchyDepths()[i];
+    }
+
+    if( pps->getUseWrapAround() ) {
+        ctx->wrapAroundOffset = ctx->minCbSize * ( ctx->picWidthInMinCb - pps->getPicWidthMinusWrapAroundOffset() );
+    }
+
+    ctx->ctuRsToTs    = pps->getCtuRsToTsTable();
+    ctx->ctuTsToRs    = pps->getCtuTsToRsTable();
+    ctx->ctuToTileCol = pps->getCtuToTileColTable();
+    ctx->ctuToTileRow = pps->getCtuToTileRowTable();
+
+    if( sps->getSubPicInfoPresentFlag() ) {
+        ctx->subPics.resize( sps->getNumSubPics() );
+        for( uint32_t i = 0; i < sps->getNumSubPics(); i++ ) {
+            SubPicRect& subPic = ctx->subPics[i];
+            subPic.ctuX0  = sps->getSubPicCtuTopLeftX( i );
+            subPic.ctuY0  = sps->getSubPicCtuTopLeftY( i );
+            subPic.ctuX1  = std::min( subPic.ctuX0 + sps->getSubPicWidth( i ),  ctx->picWidthInCtu );
+            subPic.ctuY1  = std::min( subPic.ctuY0 + sps->getSubPicHeight( i ), ctx->picHeightInCtu );
+            subPic.lumaX0 = subPic.ctuX0 << ctx->log2CtuSize;
+            subPic.lumaY0 = subPic.ctuY0 << ctx->log2CtuSize;
+            subPic.lumaX1 = std::min( subPic.ctuX1 << ctx->log2CtuSize, ctx->picWidth );
+            subPic.lumaY1 = std::min( subPic.ctuY1 << ctx->log2CtuSize, ctx->picHeight );
+        }
+    } else {
+        ctx->subPics.push_back( SubPicRect{ 0, 0, ctx->picWidthInCtu, ctx->picHeightInCtu, 0, 0, ctx->picWidth, ctx->picHeight } );
+    }
+
+    for( uint32_t i = 0; i < ctx->subPics.size(); i++ ) {
+        if( sps->getSubPicIdMappingExplicitlySignalledFlag() ) {
+            ctx->subPics[i].subPicId = pps->getSubPicIdMappingPresentFlag() ? pps->getSubPicId( i ) : sps->getSubPicId( i );
+        } else {
+            ctx->subPics[i].subPicId = i;
+        }
+    }
+
+    // a rectangular slice belongs to the sub-picture containing its first CTU, the slices of a sub-picture keep
+    // their picture order
+    if( pps->getRectSliceFlag() ) {
+        std::vector<uint32_t> sliceSubPic( pps->getNumSlicesInPic() );
+        for( uint32_t i = 0; i < pps->getNumSlicesInPic(); i++ ) {
+            const uint32_t ctuAddr = pps->getSliceMap( i )[0];
+            const uint32_t ctuX    = ctuAddr % ctx->picWidthInCtu;
+            const uint32_t ctuY    = ctuAddr / ctx->picWidthInCtu;
+            uint32_t       subPic  = 0;
+            while( subPic + 1 < ctx->subPics.size()
+                   && !( ctuX >= ctx->subPics[subPic].ctuX0 && ctuX < ctx->subPics[subPic].ctuX1 && ctuY >= ctx->subPics[subPic].ctuY0 && ctuY < ctx->subPics[subPic].ctuY1 ) ) {
+                subPic++;
+            }
+            sliceSubPic[i] = subPic;
+            ctx->subPics[subPic].numSlices++;
+        }
+        ctx->subPicSliceIdx.reserve( pps->getNumSlicesInPic() );
+        for( uint32_t subPic = 0; subPic < ctx->subPics.size(); subPic++ ) {
+            ctx->subPics[subPic].firstSliceIdx = (uint32_t)ctx->subPicSliceIdx.size();
+            for( uint32_t i = 0; i < pps->getNumSlicesInPic(); i++ ) {
+                if( sliceSubPic[i] == subPic ) {
+                    ctx->subPicSliceIdx.push_back( i );
+                }
+            }
+        }
+    }
+
+    ctx->sps = std::move( sps );
+    ctx->pps = std::move( pps );
+    return ctx;
+}
@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include <array>
+#include <cstring>
 
 #include "Def.h"
 #include "Rom.h"
@@ -32,6 +33,81 @@ struct BasePS: public std::enable_shared_from_this<T> {
     template<class Tf, int MAX_ID> friend class ParameterSetMap;
 };
 
+// Parameter sets of one type indexed by their id. Every stored set keeps a copy of the RBSP it was parsed
+// from, so a retransmitted set that is bit-identical to the stored one is recognized by a hash and one
+// memcmp before parsing. It is then neither parsed nor allocated, and the stored set stays the active
+// one, so everything holding its shared_ptr or state derived from it remains valid.
+template<class T, int MAX_ID>
+class ParameterSetMap {
+public:
+    ParameterSetMap()  = default;
+    ~ParameterSetMap() = default;
+    CLASS_COPY_MOVE_DELETE( ParameterSetMap )
+
+    static uint64_t hashRbsp( const uint8_t* rbsp, size_t size ) {
+        uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+        for( ; size >= 8; rbsp += 8, size -= 8 ) {
+            uint64_t word;
+            ::memcpy( &word, rbsp, 8 );
+            hash = xMix( hash ^ word );
+        }
+        uint64_t tail = 0;
+        ::memcpy( &tail, rbsp, size );
+        return xMix( hash ^ tail );
+    }
+
+    // The stored set with the id, if it was parsed from the same RBSP, and nullptr otherwise.
+    std::shared_ptr<T> getIdenticalPS( int psId, const uint8_t* rbsp, size_t size, uint64_t hash ) const {
+        CHECK( psId < 0 || psId >= MAX_ID, "Invalid parameter set id" );
+        const MapData& entry = m_map[psId];
+        if( !entry.ps || entry.hash != hash || entry.rbsp.size() != size || ::memcmp( entry.rbsp.data(), rbsp, size ) != 0 ) {
+            return nullptr;
+        }
+        return entry.ps;
+    }
+
+    // Stores a newly parsed set together with its RBSP. It is marked as changed if it replaces a set with the same id.
+    void storePS( int psId, std::shared_ptr<T> ps, const uint8_t* rbsp, size_t size, uint64_t hash ) {
+        CHECK( psId < 0 || psId >= MAX_ID, "Invalid parameter set id" );
+        MapData& entry = m_map[psId];
+        ps->m_changedFlag = entry.ps != nullptr;
+        entry.ps          = std::move( ps );
+        entry.hash        = hash;
+        entry.rbsp.assign( rbsp, rbsp + size );
+    }
+
+    // Replaces the stored set by one with the same content, e.g. with rebuilt derived tables, keeping the RBSP it
+    // was parsed from. Everything holding the previous set keeps using it.
+    void replacePS( int psId, std::shared_ptr<T> ps ) {
+        CHECK( psId < 0 || psId >= MAX_ID, "Invalid parameter set id" );
+        CHECK( !m_map[psId].ps, "No parameter set to replace" );
+        m_map[psId].ps = std::move( ps );
+    }
+
+    std::shared_ptr<T>       getPS( int psId )       { CHECK( psId < 0 || psId >= MAX_ID, "Invalid parameter set id" ); return m_map[psId].ps; }
+    std::shared_ptr<const T> getPS( int psId ) const { CHECK( psId < 0 || psId >= MAX_ID, "Invalid parameter set id" ); return m_map[psId].ps; }
+
+    void clear() {
+        for( auto& entry : m_map ) {
+            entry = MapData();
+        }
+    }
+
+private:
+    static uint64_t xMix( uint64_t x ) {
+        x *= 0xff51afd7ed558ccdull;
+        return x ^ ( x >> 32 );
+    }
+
+    struct MapData {
+        std::shared_ptr<T>   ps;
+        uint64_t             hash = 0;
+        std::vector<uint8_t> rbsp;
+    };
+
+    MapData m_map[MAX_ID];
+};
+
 class Window {
 private:
     bool m_enabledFlag     = false;
@@ -117,31 +193,136 @@ public:
 
     static int calcLTRefPOC( int currPoc, int bitsForPoc, int refPicIdentifier, bool pocMSBPresent, int deltaPocMSBCycle );
     int        calcLTRefPOC( int currPoc, int bitsForPoc, int refPicIdx ) const;
+
+    // Sets the POC of every entry for the current picture. A long-term entry without delta_poc_msb_cycle_lt
+    // gets its POC LSBs, it is matched against the LSBs of the reference pictures.
+    void derivePOCs( int currPoc, int bitsForPoc );
 };
 
 typedef std::vector<ReferencePictureList> RPLList;
 
+// Scaling lists of a scaling list APS. The coded lists are kept in one array, and deriveScalingMatrices() expands
+// them into the scaling factors of every transform block size, chroma included, and of every matrixId. All the
+// expanded matrices share one int16_t arena, so dequantization reads the factor of a coefficient directly and a
+// copy of the lists costs a single allocation.
 class ScalingList {
 public:
     ScalingList();
     ~ScalingList() = default;
     CLASS_COPY_MOVE_DEFAULT( ScalingList )
 
+    // sets all lists to the flat default and drops the expanded matrices
     void       reset();
 
     static inline int  matrixSize( uint32_t scalingListId )   { return scalingListId < SCALING_LIST_1D_START_4x4 ? 2 : scalingListId < SCALING_LIST_1D_START_8x8 ? 4 : 8; }
     static inline bool isLumaScalingList( int scalingListId ) { return scalingListId % MAX_NUM_COMPONENT == SCALING_LIST_1D_START_4x4 || scalingListId == SCALING_LIST_1D_START_64x64 + 1;}
 
+    // matrixId of the specification: intra (and IBC) Y, Cb, Cr followed by inter Y, Cb, Cr
+    static inline int  getListType( bool isIntra, ComponentID compID ) { return ( isIntra ? 0 : MAX_NUM_COMPONENT ) + compID; }
+    // id of the coded list used by a transform block, it is the list of the square block of its larger side
+    static int         getScalingListId( int log2Width, int log2Height, int listType );
+
     void              setScalingListDC(uint32_t scalingListId, uint32_t u)             { m_scalingListDC[scalingListId] = u;                       } //!< set DC value
     int               getScalingListDC(uint32_t scalingListId) const                   { return m_scalingListDC[scalingListId];                    } //!< get DC value
 
-    int*              getScalingListAddress(uint32_t scalingListId)                    { return m_scalingListCoef[scalingListId].data();           } //!< get matrix coefficient
-    const int*        getScalingListAddress(uint32_t scalingListId) const              { return m_scalingListCoef[scalingListId].data();           } //!< get matrix coefficient
-    std::vector<int>& getScalingListVec( uint32_t scalingListId )                      { return m_scalingListCoef[scalingListId]; }
+    uint8_t*          getScalingListAddress(uint32_t scalingListId)                    { return m_scalingListCoef + xCoefOffset( scalingListId );  } //!< get matrix coefficient
+    const uint8_t*    getScalingListAddress(uint32_t scalingListId) const              { return m_scalingListCoef + xCoefOffset( scalingListId );  } //!< get matrix coefficient
+
+    // copies the list and DC value of refListId, or sets the flat default when refListId is the list itself
+    void              processRefMatrix( uint32_t scalingListId, uint32_t refListId );
+
+    // expands the coded lists, to be called once all of them are set
+    void              deriveScalingMatrices();
+    bool              hasScalingMatrices() const                                       { return !m_matrixArena.empty(); }
+
+    // The scaling factors m[ x ][ y ] of a transform block, row by row. A matrix only covers the part of the block
+    // that can hold coefficients, at most SCALING_LIST_MAX_CODED_SIZE in each direction, and that width is the stride.
+    const int16_t*    getScalingMatrix( int log2Width, int log2Height, int listType ) const {
+        CHECKD( !hasScalingMatrices(), "The scaling matrices have not been derived" );
+        return m_matrixArena.data() + xMatrixOffset( log2Width, log2Height, listType );
+    }
 
 private:
-    int              m_scalingListDC  [28] = { 0 }; //!< the DC value of the matrix coefficient for 16x16
-    std::vector<int> m_scalingListCoef[28];         //!< quantization matrix
+    // the 2x2, 4x4 and 8x8 coded lists one after another
+    static constexpr int    NUM_COEF = 2 * 2 * 2 + 6 * 4 * 4 + 20 * 8 * 8;
+
+    static int              xCoefOffset( uint32_t scalingListId ) {
+        return scalingListId < SCALING_LIST_1D_START_4x4 ? scalingListId * 4
+             : scalingListId < SCALING_LIST_1D_START_8x8 ? 8 + ( scalingListId - SCALING_LIST_1D_START_4x4 ) * 16
+             :                                              104 + ( scalingListId - SCALING_LIST_1D_START_8x8 ) * 64;
+    }
+
+    // The matrices of a list type are ordered by log2 width, then by log2 height, from 2 to 64 samples. With the
+    // clipped side sizes s( l ) = Min( 1 << l, 32 ) and their prefix sums, this is a closed form.
+    static constexpr int    MATRIX_SIDE_SUM = 2 + 4 + 8 + 16 + 32 + 32;
+    static constexpr size_t NUM_MATRIX_SAMPLES = size_t( SCALING_LIST_NUM ) * MATRIX_SIDE_SUM * MATRIX_SIDE_SUM;
+
+    static size_t           xMatrixOffset( int log2Width, int log2Height, int listType ) {
+        static const int sidePrefix[MAX_LOG2_TU_SIZE_PLUS_ONE] = { 0, 0, 2, 6, 14, 30, 62 };
+        CHECKD( log2Width < 1 || log2Height < 1 || log2Width >= MAX_LOG2_TU_SIZE_PLUS_ONE || log2Height >= MAX_LOG2_TU_SIZE_PLUS_ONE, "Invalid transform block size" );
+        return size_t( listType ) * MATRIX_SIDE_SUM * MATRIX_SIDE_SUM + sidePrefix[log2Width] * MATRIX_SIDE_SUM
+             + std::min( 1 << log2Width, SCALING_LIST_MAX_CODED_SIZE ) * sidePrefix[log2Height];
+    }
+
+    void                    xExpandMatrix( int log2Width, int log2Height, int listType, int16_t* dst ) const;
+
+    int                  m_scalingListDC  [SCALING_LIST_1D_NUM] = { 0 }; //!< the DC value of the matrix coefficient for 16x16
+    uint8_t              m_scalingListCoef[NUM_COEF]            = { 0 }; //!< quantization matrix
+    std::vector<int16_t> m_matrixArena;                                  //!< expanded scaling factors, see xMatrixOffset()
+};
+
+// Chroma QP offsets of Cb, Cr and joint Cb-Cr, indexed by ComponentID.
+struct ChromaQpOffset {
+    int  get( ComponentID compID ) const    { CHECKD( compID == COMPONENT_Y || compID > JOINT_CbCr, "Invalid chroma component" ); return m_offset[compID - 1]; }
+    void set( ComponentID compID, int val ) { CHECKD( compID == COMPONENT_Y || compID > JOINT_CbCr, "Invalid chroma component" ); m_offset[compID - 1] = val; }
+
+private:
+    int m_offset[3] = { 0, 0, 0 };
+};
+
+// Rectangular slice as signalled in the PPS, in units of tiles, or of CTU rows for a slice inside a tile.
+struct RectSlice {
+    uint32_t tileIdx           = 0;   //!< index of the tile containing the top left CTU
+    uint32_t sliceWidthInTiles = 1;
+    uint32_t sliceHeightInTiles= 1;
+    uint32_t numSlicesInTile   = 1;   //!< number of slices in the tile if the slice is one of several inside a tile
+    uint32_t sliceHeightInCtu  = 0;   //!< height of a slice inside a tile
+};
+
+// CTU raster scan addresses of one slice in decoding order. It is a view into the CTU list of the PPS.
+struct SliceMap {
+    const uint32_t* ctuAddrs = nullptr;
+    uint32_t        numCtus  = 0;
+
+    const uint32_t* begin() const { return ctuAddrs; }
+    const uint32_t* end()   const { return ctuAddrs + numCtus; }
+    uint32_t        operator[]( uint32_t idx ) const { CHECKD( idx >= numCtus, "CTU index exceeds the slice" ); return ctuAddrs[idx]; }
+};
+
+struct ChromaQpMappingTableParams {
+    int              m_qpBdOffset                                         = 0;
+    bool             m_sameCQPTableForAllChromaFlag                       = true;
+    int              m_numQpTables                                        = 1;
+    int              m_qpTableStartMinus26   [MAX_NUM_CQP_MAPPING_TABLES] = { 0 };
+    int              m_numPtsInCQPTableMinus1[MAX_NUM_CQP_MAPPING_TABLES] = { 0 };
+    std::vector<int> m_deltaQpInValMinus1    [MAX_NUM_CQP_MAPPING_TABLES];
+    std::vector<int> m_deltaQpOutVal         [MAX_NUM_CQP_MAPPING_TABLES];
+};
+
+// ChromaQpTable[ i ][ qPChroma ] of the specification for qPChroma from -QpBdOffset to 63, indexed by
+// the component (Cb, Cr or joint Cb-Cr) instead of a search in the signalled pivot points.
+class ChromaQpMappingTable : public ChromaQpMappingTableParams {
+public:
+    ChromaQpMappingTable() = default;
+    explicit ChromaQpMappingTable( const ChromaQpMappingTableParams& params ) : ChromaQpMappingTableParams( params ) {}
+
+    void deriveChromaQPMappingTables();
+    int  getMappedChromaQpValue( ComponentID compID, int qpVal ) const {
+        return m_table[m_sameCQPTableForAllChromaFlag ? 0 : (int)compID - 1][qpVal + MAX_QP_BD_OFFSET];
+    }
+
+private:
+    int8_t m_table[MAX_NUM_CQP_MAPPING_TABLES][MAX_QP_BD_OFFSET + MAX_QP + 1] = { { 0 } };
 };
 
 
@@ -305,7 +486,7 @@ private:
     int               m_LadfQpOffset          [MAX_LADF_INTERVALS] = { 0 };
     int               m_LadfIntervalLowerBound[MAX_LADF_INTERVALS] = { 0 };
     bool              m_MIP                                = false;
-    // ChromaQpMappingTable m_chromaQpMappingTable;
+    ChromaQpMappingTable m_chromaQpMappingTable;
     bool              m_GDREnabledFlag                     = false;
     bool              m_SubLayerCbpParametersPresentFlag   = false;
     bool              m_rprEnabledFlag                     = false;
@@ -664,11 +845,10 @@ public:
     bool      getUseWPBiPred        ()                                      const     { return m_useWeightedBiPred; }
     void      setUseWP              ( bool b )                                        { m_useWeightPred = b; }
     void      setUseWPBiPred        ( bool b )                                        { m_useWeightedBiPred = b; }
-    // void      setChromaQpMappingTableFromParams( const ChromaQpMappingTableParams& params )  { m_chromaQpMappingTable = ChromaQpMappingTable( params ); }
-    // void      setChromaQpMappingTableFromParams( const ChromaQpMappingTableParams&& params ) { m_chromaQpMappingTable = ChromaQpMappingTable( std::move( params ) ); }
-    // void      deriveChromaQPMappingTables()                                           { m_chromaQpMappingTable.deriveChromaQPMappingTables(); }
-    // const ChromaQpMappingTable& getChromaQpMappingTable()                   const     { return m_chromaQpMappingTable;}
-    // int       getMappedChromaQpValue(ComponentID compID, int qpVal)         const     { return m_chromaQpMappingTable.getMappedChromaQpValue(compID, qpVal); }
+    void      setChromaQpMappingTableFromParams( const ChromaQpMappingTableParams& params )  { m_chromaQpMappingTable = ChromaQpMappingTable( params ); }
+    void      deriveChromaQPMappingTables()                                           { m_chromaQpMappingTable.deriveChromaQPMappingTables(); }
+    const ChromaQpMappingTable& getChromaQpMappingTable()                   const     { return m_chromaQpMappingTable;}
+    int       getMappedChromaQpValue(ComponentID compID, int qpVal)         const     { return m_chromaQpMappingTable.getMappedChromaQpValue(compID, qpVal); }
     void      setGDREnabledFlag     ( bool b )                                        { m_GDREnabledFlag = b;    }
     bool      getGDREnabledFlag()                                           const     { return m_GDREnabledFlag; }
     void      setSubLayerParametersPresentFlag(bool flag)                             { m_SubLayerCbpParametersPresentFlag = flag; }
@@ -703,12 +883,12 @@ private:
 
     // access channel
 
-    // ChromaQpOffset   m_chromaQpOffset;
-    // bool             m_chromaJointCbCrQpOffsetPresentFlag= false;
+    ChromaQpOffset   m_chromaQpOffset;
+    bool             m_chromaJointCbCrQpOffsetPresentFlag= false;
 
     // Chroma QP Adjustments
-    // int              m_chromaQpOffsetListLen             = 0; // size (excludes the null entry used in the following array).
-    // ChromaQpOffset   m_ChromaQpAdjTableIncludingNullEntry[1+MAX_QP_OFFSET_LIST_SIZE]; //!< Array includes entry [0] for the null offset used when cu_chroma_qp_offset_flag=0, and entries [cu_chroma_qp_offset_idx+1...] otherwise
+    int              m_chromaQpOffsetListLen             = 0; // size (excludes the null entry used in the following array).
+    ChromaQpOffset   m_ChromaQpAdjTableIncludingNullEntry[1+MAX_QP_OFFSET_LIST_SIZE]; //!< Array includes entry [0] for the null offset used when cu_chroma_qp_offset_flag=0, and entries [cu_chroma_qp_offset_idx+1...] otherwise
 
     uint32_t         m_numRefIdxL0DefaultActive          = 1;
     uint32_t         m_numRefIdxL1DefaultActive          = 1;
@@ -718,33 +898,38 @@ private:
     bool             m_bUseWeightPred                    = false;   //!< Use of Weighting Prediction (P_SLICE)
     bool             m_useWeightedBiPred                 = false;   //!< Use of Weighting Bi-Prediction (B_SLICE)
     bool             m_OutputFlagPresentFlag             = false;   //!< Indicates the presence of output_flag in slice header
-    // uint8_t          m_numSubPics                        = 1;       //!< number of sub-pictures used - must match SPS
-    // bool             m_subPicIdMappingPresentFlag        = false;
-    // uint32_t         m_subPicIdLen                       = 0;       //!< sub-picture ID length in bits
-    // uint16_t         m_subPicId[MAX_NUM_SUB_PICS]        = { 0 };   //!< sub-picture ID for each sub-picture in the sequence
-    // bool             m_noPicPartitionFlag                = false;   //!< no picture partitioning flag - single slice, single tile
+    uint32_t         m_numSubPics                        = 1;       //!< number of sub-pictures used - must match SPS
+    bool             m_subPicIdMappingPresentFlag        = false;
+    uint32_t         m_subPicIdLen                       = 0;       //!< sub-picture ID length in bits
+    uint16_t         m_subPicId[MAX_NUM_SUB_PICS]        = { 0 };   //!< sub-picture ID for each sub-picture in the sequence
+    bool             m_noPicPartitionFlag                = false;   //!< no picture partitioning flag - single slice, single tile
     uint8_t          m_log2CtuSize                       = 0;       //!< log2 of the CTU size - required to match corresponding value in SPS
     uint8_t          m_ctuSize                           = 0;       //!< CTU size
     uint32_t         m_picWidthInCtu                     = 0;       //!< picture width in units of CTUs
     uint32_t         m_picHeightInCtu                    = 0;       //!< picture height in units of CTUs
-    // uint32_t         m_numExpTileCols                    = 0;       //!< number of explicitly specified tile columns
-    // uint32_t         m_numExpTileRows                    = 0;       //!< number of explicitly specified tile rows
-    // uint32_t         m_numTileCols                       = 0;       //!< number of tile columns
-    // uint32_t         m_numTileRows                       = 0;       //!< number of tile rows
-    // std::vector<int> m_tileColumnWidth;
-    // std::vector<int> m_tileRowHeight;
-
-    // bool                   m_rectSliceFlag            = true;
-    // bool                   m_singleSlicePerSubPicFlag = false;   //!< single slice per sub-picture flag
-    // uint32_t               m_numSlicesInPic           = 1;       //!< number of rectangular slices in the picture (raster-scan slice specified at slice level)
-    // bool                   m_tileIdxDeltaPresentFlag  = false;   //!< tile index delta present flag
-    // std::vector<uint32_t>  m_tileColBd;                          //!< tile column left-boundaries in units of CTUs
-    // std::vector<uint32_t>  m_tileRowBd;                          //!< tile row top-boundaries in units of CTUs
-    // std::vector<uint32_t>  m_ctuToTileCol;                       //!< mapping between CTU horizontal address and tile column index
-    // std::vector<uint32_t>  m_ctuToTileRow;                       //!< mapping between CTU vertical address and tile row index
-    // std::vector<RectSlice> m_rectSlices;                         //!< list of rectangular slice signalling parameters
-    // std::vector<SliceMap>  m_sliceMap;                           //!< list of CTU maps for each slice in the picture
-    //std::vector<SubPic>    m_subPics;                            //!< list of subpictures in the picture
+    uint32_t         m_numExpTileCols                    = 0;       //!< number of explicitly specified tile columns
+    uint32_t         m_numExpTileRows                    = 0;       //!< number of explicitly specified tile rows
+    uint32_t         m_numTileCols                       = 1;       //!< number of tile columns
+    uint32_t         m_numTileRows                       = 1;       //!< number of tile rows
+    std::vector<uint32_t> m_tileColumnWidth;
+    std::vector<uint32_t> m_tileRowHeight;
+
+    bool                   m_rectSliceFlag            = true;
+    bool                   m_singleSlicePerSubPicFlag = false;   //!< single slice per sub-picture flag
+    uint32_t               m_numSlicesInPic           = 1;       //!< number of rectangular slices in the picture (raster-scan slice specified at slice level)
+    bool                   m_tileIdxDeltaPresentFlag  = false;   //!< tile index delta present flag
+    std::vector<RectSlice> m_rectSlices;                         //!< list of rectangular slice signalling parameters
+
+    // Lookup tables derived from the partitioning by initTileSliceMaps(), so that address conversions in the CTU loop are loads
+    std::vector<uint32_t>  m_tileColBd;                          //!< tile column left-boundaries in units of CTUs, plus the picture width
+    std::vector<uint32_t>  m_tileRowBd;                          //!< tile row top-boundaries in units of CTUs, plus the picture height
+    std::vector<uint32_t>  m_ctuToTileCol;                       //!< mapping between CTU horizontal address and tile column index
+    std::vector<uint32_t>  m_ctuToTileRow;                       //!< mapping between CTU vertical address and tile row index
+    std::vector<uint32_t>  m_ctuRsToTs;                          //!< CtbAddrRsToTs, CTU raster scan to tile scan address
+    std::vector<uint32_t>  m_ctuTsToRs;                          //!< CtbAddrTsToRs
+    std::vector<uint32_t>  m_tileFirstCtuTs;                     //!< tile scan address of the first CTU of each tile, plus the number of CTUs
+    std::vector<uint32_t>  m_sliceCtuAddrs;                      //!< raster scan addresses of the CTUs of all rectangular slices, slice after slice
+    std::vector<uint32_t>  m_sliceFirstCtuIdx;                   //!< start of each rectangular slice in m_sliceCtuAddrs, plus its size
 
     bool             m_cabacInitPresentFlag                = false;
 
@@ -806,31 +991,31 @@ public:
     void                   setSliceChromaQpFlag( bool b )                                   { m_bSliceChromaQpFlag = b;                     }
 
 
-    // bool                   getJointCbCrQpOffsetPresentFlag() const                          { return m_chromaJointCbCrQpOffsetPresentFlag;   }
-    // void                   setJointCbCrQpOffsetPresentFlag(bool b)                          { m_chromaJointCbCrQpOffsetPresentFlag = b;      }
+    bool                   getJointCbCrQpOffsetPresentFlag() const                          { return m_chromaJointCbCrQpOffsetPresentFlag;   }
+    void                   setJointCbCrQpOffsetPresentFlag(bool b)                          { m_chromaJointCbCrQpOffsetPresentFlag = b;      }
 
-    // void                   setQpOffset( ComponentID compID, int val )                       { m_chromaQpOffset.set( compID, val ); }
-    // int                    getQpOffset( ComponentID compID ) const                          { return m_chromaQpOffset.get( compID ); }
+    void                   setQpOffset( ComponentID compID, int val )                       { m_chromaQpOffset.set( compID, val ); }
+    int                    getQpOffset( ComponentID compID ) const                          { return m_chromaQpOffset.get( compID ); }
 
-    // bool                   getCuChromaQpOffsetEnabledFlag() const                           { return getChromaQpOffsetListLen()>0;            }
-    // int                    getChromaQpOffsetListLen() const                                 { return m_chromaQpOffsetListLen;                 }
-    // void                   clearChromaQpOffsetList()                                        { m_chromaQpOffsetListLen = 0;                    }
+    bool                   getCuChromaQpOffsetEnabledFlag() const                           { return getChromaQpOffsetListLen()>0;            }
+    int                    getChromaQpOffsetListLen() const                                 { return m_chromaQpOffsetListLen;                 }
+    void                   clearChromaQpOffsetList()                                        { m_chromaQpOffsetListLen = 0;                    }
 
-    // const ChromaQpOffset&  getChromaQpOffsetListEntry( int cuChromaQpOffsetIdxPlus1 ) const
-    // {
-    //     CHECK(cuChromaQpOffsetIdxPlus1 >= m_chromaQpOffsetListLen+1, "Invalid chroma QP offset");
-    //     return m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1]; // Array includes entry [0] for the null offset used when cu_chroma_qp_offset_flag=0, and entries [cu_chroma_qp_offset_idx+1...] otherwise
-    // }
+    const ChromaQpOffset&  getChromaQpOffsetListEntry( int cuChromaQpOffsetIdxPlus1 ) const
+    {
+        CHECK(cuChromaQpOffsetIdxPlus1 >= m_chromaQpOffsetListLen+1, "Invalid chroma QP offset");
+        return m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1]; // Array includes entry [0] for the null offset used when cu_chroma_qp_offset_flag=0, and entries [cu_chroma_qp_offset_idx+1...] otherwise
+    }
 
-    // void                   setChromaQpOffsetListEntry( int cuChromaQpOffsetIdxPlus1, int cbOffset, int crOffset, int jointCbCrOffset )
-    // {
-    //     CHECK(cuChromaQpOffsetIdxPlus1 == 0 || cuChromaQpOffsetIdxPlus1 > MAX_QP_OFFSET_LIST_SIZE, "Invalid chroma QP offset");
-    //     // Array includes entry [0] for the null offset used when cu_chroma_qp_offset_flag=0, and entries [cu_chroma_qp_offset_idx+1...] otherwise
-    //     m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1].CbOffset        = cbOffset;
-    //     m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1].CrOffset        = crOffset;
-    //     m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1].JointCbCrOffset = jointCbCrOffset;
-    //     m_chromaQpOffsetListLen                                                        = std::max( m_chromaQpOffsetListLen, cuChromaQpOffsetIdxPlus1 );
-    // }
+    void                   setChromaQpOffsetListEntry( int cuChromaQpOffsetIdxPlus1, int cbOffset, int crOffset, int jointCbCrOffset )
+    {
+        CHECK(cuChromaQpOffsetIdxPlus1 == 0 || cuChromaQpOffsetIdxPlus1 > MAX_QP_OFFSET_LIST_SIZE, "Invalid chroma QP offset");
+        // Array includes entry [0] for the null offset used when cu_chroma_qp_offset_flag=0, and entries [cu_chroma_qp_offset_idx+1...] otherwise
+        m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1].set( COMPONENT_Cb, cbOffset );
+        m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1].set( COMPONENT_Cr, crOffset );
+        m_ChromaQpAdjTableIncludingNullEntry[cuChromaQpOffsetIdxPlus1].set( JOINT_CbCr, jointCbCrOffset );
+        m_chromaQpOffsetListLen                                                        = std::max( m_chromaQpOffsetListLen, cuChromaQpOffsetIdxPlus1 );
+    }
     
     void                   setNumRefIdxL0DefaultActive(uint32_t ui)                         { m_numRefIdxL0DefaultActive=ui;                }
     uint32_t               getNumRefIdxL0DefaultActive() const                              { return m_numRefIdxL0DefaultActive;            }
@@ -853,80 +1038,72 @@ public:
     unsigned               getWrapAroundOffset() const                                      { return m_wrapAroundOffset;                    }
     void                   setOutputFlagPresentFlag( bool b )                               { m_OutputFlagPresentFlag = b;                  }
     bool                   getOutputFlagPresentFlag() const                                 { return m_OutputFlagPresentFlag;               }
-    // void                   setNumSubPics( uint8_t u )                                       { m_numSubPics = u;                             }
-    // uint8_t                getNumSubPics( ) const                                           { return  m_numSubPics;                         }
-    // void                   setSubPicIdMappingPresentFlag( bool b )                          { m_subPicIdMappingPresentFlag = b;             }
-    // bool                   getSubPicIdMappingPresentFlag() const                            { return m_subPicIdMappingPresentFlag;          }
-    // void                   setSubPicIdLen( uint32_t u )                                     { CHECK( u > 16, "Sub-picture id len exceeds valid range" ); m_subPicIdLen = u;                   }
-    // uint32_t               getSubPicIdLen() const                                           { return  m_subPicIdLen;                                                                          }
-    // void                   setSubPicId( int i, uint16_t u )                                 { CHECK( i >= MAX_NUM_SUB_PICS, "Sub-picture index exceeds valid range" ); m_subPicId[i] = u;     }
-    // uint16_t               getSubPicId( int i ) const                                       { CHECK( i >= MAX_NUM_SUB_PICS, "Sub-picture index exceeds valid range" ); return  m_subPicId[i]; }
-    // uint32_t               getSubPicIdxFromSubPicId( uint32_t subPicId ) const;
-    // void                   setNoPicPartitionFlag( bool b )                                  { m_noPicPartitionFlag = b;                     }
-    // bool                   getNoPicPartitionFlag( ) const                                   { return  m_noPicPartitionFlag;                 }
+    void                   setNumSubPics( uint32_t u )                                      { CHECK( u > MAX_NUM_SUB_PICS, "Number of sub-pictures exceeds valid range" ); m_numSubPics = u; }
+    uint32_t               getNumSubPics( ) const                                           { return  m_numSubPics;                         }
+    void                   setSubPicIdMappingPresentFlag( bool b )                          { m_subPicIdMappingPresentFlag = b;             }
+    bool                   getSubPicIdMappingPresentFlag() const                            { return m_subPicIdMappingPresentFlag;          }
+    void                   setSubPicIdLen( uint32_t u )                                     { CHECK( u > 16, "Sub-picture id len exceeds valid range" ); m_subPicIdLen = u;                   }
+    uint32_t               getSubPicIdLen() const                                           { return  m_subPicIdLen;                                                                          }
+    void                   setSubPicId( int i, uint16_t u )                                 { CHECK( i >= MAX_NUM_SUB_PICS, "Sub-picture index exceeds valid range" ); m_subPicId[i] = u;     }
+    uint16_t               getSubPicId( int i ) const                                       { CHECK( i >= MAX_NUM_SUB_PICS, "Sub-picture index exceeds valid range" ); return  m_subPicId[i]; }
+    void                   setNoPicPartitionFlag( bool b )                                  { m_noPicPartitionFlag = b;                     }
+    bool                   getNoPicPartitionFlag( ) const                                   { return  m_noPicPartitionFlag;                 }
     void                   setLog2CtuSize( uint8_t u )                                      { m_log2CtuSize = u; m_ctuSize = 1 << m_log2CtuSize;
                                                                                                 m_picWidthInCtu = (m_picWidthInLumaSamples  + m_ctuSize - 1) / m_ctuSize;
                                                                                                 m_picHeightInCtu = (m_picHeightInLumaSamples  + m_ctuSize - 1) / m_ctuSize; }
     uint8_t                getLog2CtuSize( ) const                                          { return  m_log2CtuSize;                        }
     uint8_t                getCtuSize( ) const                                              { return  m_ctuSize;                            }
-    uint8_t                getPicWidthInCtu( ) const                                        { return  m_picWidthInCtu;                      }
-    uint8_t                getPicHeightInCtu( ) const                                       { return  m_picHeightInCtu;                     }
-    // void                   setNumExpTileColumns( uint32_t u )                               { m_numExpTileCols = u;                         }
-    // uint32_t               getNumExpTileColumns( ) const                                    { return  m_numExpTileCols;                     }
-    // void                   setNumExpTileRows( uint32_t u )                                  { m_numExpTileRows = u;                         }
-    // uint32_t               getNumExpTileRows( ) const                                       { return  m_numExpTileRows;                     }
-    // void                   setNumTileColumns( uint32_t u )                                  { m_numTileCols = u;                            }
-    // uint32_t               getNumTileColumns( ) const                                       { return  m_numTileCols;                        }
-    // void                   setNumTileRows( uint32_t u )                                     { m_numTileRows = u;                            }
-    // uint32_t               getNumTileRows( ) const                                          { return  m_numTileRows;                        }
-    // void                   addTileColumnWidth( uint32_t u )                                 { CHECK( m_tileColumnWidth.size()  >= MAX_TILE_COLS, "Number of tile columns exceeds valid range" ); m_tileColumnWidth.push_back(u);    }
-    // void                   addTileRowHeight( uint32_t u )                                   { m_tileRowHeight.push_back(u);   }
-
-    // void                   setTileColumnWidth(const std::vector<int>& columnWidth )         { m_tileColumnWidth = columnWidth;              }
-    // uint32_t               getTileColumnWidth(uint32_t columnIdx) const                     { return  m_tileColumnWidth[columnIdx];         }
-    // void                   setTileRowHeight(const std::vector<int>& rowHeight)              { m_tileRowHeight = rowHeight;                  }
-    // uint32_t               getTileRowHeight(uint32_t rowIdx) const                          { return m_tileRowHeight[rowIdx];               }
-    // uint32_t               getNumTiles() const                                              { return m_numTileCols * m_numTileRows;        }
-    // uint32_t               ctuToTileCol( int ctuX ) const                                   { CHECK( ctuX >= m_ctuToTileCol.size(), "CTU address index exceeds valid range" ); return  m_ctuToTileCol[ctuX];                  }
-    // uint32_t               ctuToTileRow( int ctuY ) const                                   { CHECK( ctuY >= m_ctuToTileRow.size(), "CTU address index exceeds valid range" ); return  m_ctuToTileRow[ctuY];                  }
-    // uint32_t               ctuToTileColBd( int ctuX ) const                                 { return  getTileColumnBd(ctuToTileCol( ctuX ));                                                                                  }
-    // uint32_t               ctuToTileRowBd( int ctuY ) const                                 { return  getTileRowBd(ctuToTileRow( ctuY ));                                                                                     }
-    // bool                   ctuIsTileColBd( int ctuX ) const                                 { return  ctuX == ctuToTileColBd( ctuX );                                                                                         }
-    // bool                   ctuIsTileRowBd( int ctuY ) const                                 { return  ctuY == ctuToTileRowBd( ctuY );                                                                                         }
-    // uint32_t               getTileIdx( uint32_t ctuX, uint32_t ctuY ) const                 { return (ctuToTileRow( ctuY ) * getNumTileColumns()) + ctuToTileCol( ctuX );                                                     }
-    // uint32_t               getTileIdx( uint32_t ctuRsAddr) const                            { return getTileIdx( ctuRsAddr % m_picWidthInCtu,  ctuRsAddr / m_picWidthInCtu );                                                 }
-    // uint32_t               getTileIdx( const Position& pos ) const                          { return getTileIdx( pos.x / m_ctuSize, pos.y / m_ctuSize );                                                                      }
-    // bool                   getRectSliceFlag() const                                         { return m_rectSliceFlag;                       }
-    // void                   setRectSliceFlag(bool val)                                       { m_rectSliceFlag = val;                        }
-    // void                   setSingleSlicePerSubPicFlag( bool b )                            { m_singleSlicePerSubPicFlag = b;                                                                                                 }
-    // bool                   getSingleSlicePerSubPicFlag( ) const                             { return  m_singleSlicePerSubPicFlag;                                                                                             }
-    // void                   setNumSlicesInPic( uint32_t u )                                  { CHECK( u > MAX_SLICES, "Number of slices in picture exceeds valid range" ); m_numSlicesInPic = u;                               }
-    // uint32_t               getNumSlicesInPic( ) const                                       { return  m_numSlicesInPic;                                                                                                       }
-    // void                   setTileIdxDeltaPresentFlag( bool b )                             { m_tileIdxDeltaPresentFlag = b;                                                                                                  }
-    // bool                   getTileIdxDeltaPresentFlag( ) const                              { return  m_tileIdxDeltaPresentFlag;                                                                                              }
-    // uint32_t               getTileColumnBd( int idx ) const                                 { CHECK( idx >= m_tileColBd.size(), "Tile column index exceeds valid range" );                    return  m_tileColBd[idx];       }
-    // uint32_t               getTileRowBd( int idx ) const                                    { CHECK( idx >= m_tileRowBd.size(), "Tile row index exceeds valid range" );                       return  m_tileRowBd[idx];       }
-    // void                   setSliceWidthInTiles( int idx, uint32_t u )                      { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    m_rectSlices[idx].setSliceWidthInTiles( u );            }
-    // uint32_t               getSliceWidthInTiles( int idx ) const                            { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    return  m_rectSlices[idx].getSliceWidthInTiles( );      }
-    // void                   setSliceHeightInTiles( int idx, uint32_t u )                     { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    m_rectSlices[idx].setSliceHeightInTiles( u );           }
-    // uint32_t               getSliceHeightInTiles( int idx ) const                           { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    return  m_rectSlices[idx].getSliceHeightInTiles( );     }
-    // void                   setNumSlicesInTile( int idx, uint32_t u )                        { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    m_rectSlices[idx].setNumSlicesInTile( u );              }
-    // uint32_t               getNumSlicesInTile( int idx ) const                              { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    return  m_rectSlices[idx].getNumSlicesInTile( );        }
-    // void                   setSliceHeightInCtu( int idx, uint32_t u )                       { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    m_rectSlices[idx].setSliceHeightInCtu( u );             }
-    // uint32_t               getSliceHeightInCtu( int idx ) const                             { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    return  m_rectSlices[idx].getSliceHeightInCtu( );       }
-    // void                   setSliceTileIdx(  int idx, uint32_t u )                          { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    m_rectSlices[idx].setTileIdx( u );                      }
-    // uint32_t               getSliceTileIdx( int idx ) const                                 { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    return  m_rectSlices[idx].getTileIdx( );                }
-    // void                   resetTileSliceInfo();
-    // void                   initTiles();
-    // void                   initRectSlices();
-    // void                   initRectSliceMap(const SPS *sps);
-    // const SubPic&          getSubPic(uint32_t idx) const                                    { return m_subPics[idx]; }
-    // void                   initSubPic(const SPS &sps);
-    // const SubPic&          getSubPicFromPos(const Position& pos)  const;
-    // const SubPic&          getSubPicFromCU (const CodingUnit& cu) const;
-    // void                   checkSliceMap();
-
-    // SliceMap               getSliceMap( int idx ) const                                     { CHECK( idx >= m_numSlicesInPic, "Slice index exceeds valid range" );    return m_sliceMap[idx];                             }
+    uint32_t               getPicWidthInCtu( ) const                                        { return  m_picWidthInCtu;                      }
+    uint32_t               getPicHeightInCtu( ) const                                       { return  m_picHeightInCtu;                     }
+    uint32_t               getNumCtusInPic( ) const                                         { return  m_picWidthInCtu * m_picHeightInCtu;   }
+    void                   setNumExpTileColumns( uint32_t u )                               { m_numExpTileCols = u;                         }
+    uint32_t               getNumExpTileColumns( ) const                                    { return  m_numExpTileCols;                     }
+    void                   setNumExpTileRows( uint32_t u )                                  { m_numExpTileRows = u;                         }
+    uint32_t               getNumExpTileRows( ) const                                       { return  m_numExpTileRows;                     }
+    uint32_t               getNumTileColumns( ) const                                       { return  m_numTileCols;                        }
+    uint32_t               getNumTileRows( ) const                                          { return  m_numTileRows;                        }
+    void                   addTileColumnWidth( uint32_t u )                                 { CHECK( m_tileColumnWidth.size()  >= MAX_TILE_COLS, "Number of tile columns exceeds valid range" ); m_tileColumnWidth.push_back(u);    }
+    void                   addTileRowHeight( uint32_t u )                                   { CHECK( m_tileRowHeight.size() >= MAX_TILES, "Number of tile rows exceeds valid range" ); m_tileRowHeight.push_back(u);   }
+    uint32_t               getTileColumnWidth(uint32_t columnIdx) const                     { return  m_tileColumnWidth[columnIdx];         }
+    uint32_t               getTileRowHeight(uint32_t rowIdx) const                          { return m_tileRowHeight[rowIdx];               }
+    uint32_t               getNumTiles() const                                              { return m_numTileCols * m_numTileRows;        }
+    uint32_t               ctuToTileCol( uint32_t ctuX ) const                              { CHECKD( ctuX >= m_ctuToTileCol.size(), "CTU address index exceeds valid range" ); return  m_ctuToTileCol[ctuX];                 }
+    uint32_t               ctuToTileRow( uint32_t ctuY ) const                              { CHECKD( ctuY >= m_ctuToTileRow.size(), "CTU address index exceeds valid range" ); return  m_ctuToTileRow[ctuY];                 }
+    uint32_t               ctuToTileColBd( uint32_t ctuX ) const                            { return  getTileColumnBd(ctuToTileCol( ctuX ));                                                                                  }
+    uint32_t               ctuToTileRowBd( uint32_t ctuY ) const                            { return  getTileRowBd(ctuToTileRow( ctuY ));                                                                                     }
+    bool                   ctuIsTileColBd( uint32_t ctuX ) const                            { return  ctuX == ctuToTileColBd( ctuX );                                                                                         }
+    bool                   ctuIsTileRowBd( uint32_t ctuY ) const                            { return  ctuY == ctuToTileRowBd( ctuY );                                                                                         }
+    uint32_t               getTileIdx( uint32_t ctuX, uint32_t ctuY ) const                 { return (ctuToTileRow( ctuY ) * getNumTileColumns()) + ctuToTileCol( ctuX );                                                     }
+    uint32_t               getTileIdx( uint32_t ctuRsAddr) const                            { return getTileIdx( ctuRsAddr % m_picWidthInCtu,  ctuRsAddr / m_picWidthInCtu );                                                 }
+    uint32_t               getCtuRsToTs( uint32_t ctuRsAddr ) const                         { CHECKD( ctuRsAddr >= m_ctuRsToTs.size(), "CTU address index exceeds valid range" ); return m_ctuRsToTs[ctuRsAddr];             }
+    uint32_t               getCtuTsToRs( uint32_t ctuTsAddr ) const                         { CHECKD( ctuTsAddr >= m_ctuTsToRs.size(), "CTU address index exceeds valid range" ); return m_ctuTsToRs[ctuTsAddr];             }
+    const uint32_t*        getCtuRsToTsTable() const                                        { return m_ctuRsToTs.data();                    }
+    const uint32_t*        getCtuTsToRsTable() const                                        { return m_ctuTsToRs.data();                    }
+    const uint32_t*        getCtuToTileColTable() const                                     { return m_ctuToTileCol.data();                 }
+    const uint32_t*        getCtuToTileRowTable() const                                     { return m_ctuToTileRow.data();                 }
+    uint32_t               getTileFirstCtuTs( uint32_t tileIdx ) const                      { CHECKD( tileIdx >= m_tileFirstCtuTs.size(), "Tile index exceeds valid range" );    return m_tileFirstCtuTs[tileIdx];           }
+    bool                   getRectSliceFlag() const                                         { return m_rectSliceFlag;                       }
+    void                   setRectSliceFlag(bool val)                                       { m_rectSliceFlag = val;                        }
+    void                   setSingleSlicePerSubPicFlag( bool b )                            { m_singleSlicePerSubPicFlag = b;                                                                                                 }
+    bool                   getSingleSlicePerSubPicFlag( ) const                             { return  m_singleSlicePerSubPicFlag;                                                                                             }
+    void                   setNumSlicesInPic( uint32_t u )                                  { CHECK( u > MAX_SLICES, "Number of slices in picture exceeds valid range" ); m_numSlicesInPic = u;                               }
+    uint32_t               getNumSlicesInPic( ) const                                       { return  m_numSlicesInPic;                                                                                                       }
+    void                   setTileIdxDeltaPresentFlag( bool b )                             { m_tileIdxDeltaPresentFlag = b;                                                                                                  }
+    bool                   getTileIdxDeltaPresentFlag( ) const                              { return  m_tileIdxDeltaPresentFlag;                                                                                              }
+    uint32_t               getTileColumnBd( uint32_t idx ) const                            { CHECKD( idx >= m_tileColBd.size(), "Tile column index exceeds valid range" );                   return  m_tileColBd[idx];       }
+    uint32_t               getTileRowBd( uint32_t idx ) const                               { CHECKD( idx >= m_tileRowBd.size(), "Tile row index exceeds valid range" );                      return  m_tileRowBd[idx];       }
+    std::vector<RectSlice>& getRectSlices()                                                 { return m_rectSlices;                          }
+    const RectSlice&       getRectSlice( uint32_t idx ) const                               { CHECK( idx >= m_rectSlices.size(), "Slice index exceeds valid range" ); return m_rectSlices[idx]; }
+
+    // Completes the tile sizes with the uniformly spaced tiles following the explicit ones and derives the tile
+    // boundaries. It is called by the parser, the rectangular slice syntax depends on the tile layout.
+    void                   initTiles();
+    // Derives the CTU address tables and the CTU lists of the rectangular slices. The SPS gives the CTU size when
+    // the picture is not partitioned and the sub-picture layout when there is one slice per sub-picture. It is called
+    // when the PPS is activated, the SPS may be received after the PPS or replaced while the PPS is kept.
+    void                   initTileSliceMaps( const SPS& sps );
+    SliceMap               getSliceMap( uint32_t idx ) const                                { CHECK( idx + 1 >= m_sliceFirstCtuIdx.size(), "Slice index exceeds valid range" );
+                                                                                                return SliceMap{ m_sliceCtuAddrs.data() + m_sliceFirstCtuIdx[idx], m_sliceFirstCtuIdx[idx + 1] - m_sliceFirstCtuIdx[idx] }; }
 
     void                   setCabacInitPresentFlag( bool flag )                             { m_cabacInitPresentFlag = flag;                }
     bool                   getCabacInitPresentFlag() const                                  { return m_cabacInitPresentFlag;                }
@@ -994,6 +1171,223 @@ public:
     void                    setScalingWindow( const Window& scalingWindow )                 { m_scalingWindow = scalingWindow; }
     int                     getMixedNaluTypesInPicFlag() const                              { return m_mixedNaluTypesInPicFlag; }
     void                    setMixedNaluTypesInPicFlag( const bool flag )                   { m_mixedNaluTypesInPicFlag = flag; }
+
+private:
+    // appends the CTUs of a rectangle to the current slice, tile by tile and in raster scan inside each tile
+    void                    xAddCtusInRect( uint32_t ctuX0, uint32_t ctuX1, uint32_t ctuY0, uint32_t ctuY1 );
+};
+
+// alf_data() of an APS as signalled, the luma filters are indexed by the signalled filter, not by the class
+struct AlfParam {
+    bool    lumaFilterSignalFlag                       = false;
+    bool    chromaFilterSignalFlag                     = false;
+    bool    ccAlfFilterSignalFlag[2]                   = { false, false };   //!< Cb, Cr
+    bool    lumaClipFlag                               = false;
+    bool    chromaClipFlag                             = false;
+
+    int     numLumaFilters                             = 0;
+    uint8_t lumaCoeffDeltaIdx[MAX_NUM_ALF_CLASSES]     = { 0 };   //!< signalled filter of each class
+    int16_t lumaCoeff  [MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF] = { { 0 } };
+    uint8_t lumaClipIdx[MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF] = { { 0 } };
+
+    int     numAltChroma                               = 0;
+    int16_t chromaCoeff  [MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF] = { { 0 } };
+    uint8_t chromaClipIdx[MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF] = { { 0 } };
+
+    int     numCcAlfFilters[2]                         = { 0, 0 };
+    int16_t ccAlfCoeff[2][MAX_NUM_CC_ALF_FILTERS][MAX_NUM_CC_ALF_COEFF] = { { { 0 } } };   //!< mapped to the coefficient values
+};
+
+// The ALF filters of an APS as the filter kernels read them: the filter of each luma class is resolved and the
+// clipping indices are replaced by the clipping values for the bit depth.
+struct AlfFilterBank {
+    int16_t lumaCoeff  [MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF];
+    int16_t lumaClip   [MAX_NUM_ALF_CLASSES][MAX_NUM_ALF_LUMA_COEFF];
+    int16_t chromaCoeff[MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF];
+    int16_t chromaClip [MAX_NUM_ALF_ALTERNATIVES_CHROMA][MAX_NUM_ALF_CHROMA_COEFF];
+    int16_t ccAlfCoeff [2][MAX_NUM_CC_ALF_FILTERS][MAX_NUM_CC_ALF_COEFF];
+};
+
+// lmcs_data() of an APS as signalled
+struct LmcsParam {
+    int     minBinIdx                                  = 0;
+    int     maxBinIdx                                  = LMCS_NUM_BINS - 1;   //!< LmcsMaxBinIdx
+    int     deltaCW[LMCS_NUM_BINS]                     = { 0 };               //!< lmcsDeltaCW
+    int     deltaCrs                                   = 0;                   //!< lmcsDeltaCrs
+};
+
+// The LMCS mapping of an APS for one bit depth: the piecewise linear model of the specification and the
+// forward mapping, the inverse mapping and the chroma residual scale of every luma value, so mapping a sample is
+// one load.
+struct LmcsTables {
+    int              inputPivot      [LMCS_NUM_BINS + 1] = { 0 };
+    int              lmcsPivot       [LMCS_NUM_BINS + 1] = { 0 };
+    int              scaleCoeff      [LMCS_NUM_BINS]     = { 0 };
+    int              invScaleCoeff   [LMCS_NUM_BINS]     = { 0 };
+    int              chromaScaleCoeff[LMCS_NUM_BINS]     = { 0 };
+
+    std::vector<Pel>     fwdLUT;              //!< indexed by a luma value in the original domain
+    std::vector<Pel>     invLUT;              //!< indexed by a luma value in the mapped domain
+    std::vector<int16_t> chromaScaleLUT;      //!< ChromaScaleCoeff[ idxYInv ], indexed by the mapped average luma
+};
+
+// Adaptation parameter set. The parsed ALF, LMCS or scaling list data is turned into the tables the kernels use
+// by deriveTables(), once per APS; the scaling matrices are read through getScalingList(). The map of the parser
+// keeps one APS per type and id, so every picture referencing an unchanged APS uses the same tables.
+class APS : public BasePS<APS> {
+public:
+    APS()  = default;
+    ~APS() = default;
+    CLASS_COPY_MOVE_DEFAULT( APS )
+
+    // index in the parameter set map, each APS type has its own id space
+    static int          getMapKey( ApsType type, int apsId )                          { return type * MAX_NUM_APS_IDS + apsId; }
+
+    void                setAPSId( int i )                                             { m_APSId = i;                }
+    int                 getAPSId() const                                              { return m_APSId;             }
+    void                setAPSType( ApsType type )                                    { m_APSType = type;           }
+    ApsType             getAPSType() const                                            { return m_APSType;           }
+    void                setLayerId( int i )                                           { m_layerId = i;              }
+    int                 getLayerId() const                                            { return m_layerId;           }
+    void                setChromaPresentFlag( bool b )                                { m_chromaPresentFlag = b;    }
+    bool                getChromaPresentFlag() const                                  { return m_chromaPresentFlag; }
+
+    AlfParam&           getAlfParam()                                                 { return m_alfParam;          }
+    const AlfParam&     getAlfParam() const                                           { return m_alfParam;          }
+    LmcsParam&          getLmcsParam()                                                { return m_lmcsParam;         }
+    const LmcsParam&    getLmcsParam() const                                          { return m_lmcsParam;         }
+    ScalingList&        getScalingList()                                              { return m_scalingList;       }
+    const ScalingList&  getScalingList() const                                        { return m_scalingList;       }
+
+    // Derives the tables of the APS type for samples with the bit depth. The ALF clipping values and all LMCS
+    // tables depend on it, but an APS is not tied to an SPS, so this happens when a picture first uses the APS.
+    void                deriveTables( int bitDepth );
+    int                 getTablesBitDepth() const                                     { return m_tablesBitDepth;    }
+
+    const AlfFilterBank& getAlfFilterBank() const                                     { return m_alfFilterBank;     }
+    const LmcsTables&   getLmcsTables() const                                         { return m_lmcsTables;        }
+
+private:
+    void                xDeriveAlfFilterBank( int bitDepth );
+    void                xDeriveLmcsTables( int bitDepth );
+
+    int                 m_APSId             = 0;
+    ApsType             m_APSType           = ALF_APS;
+    int                 m_layerId           = 0;
+    bool                m_chromaPresentFlag = false;
+
+    AlfParam            m_alfParam;
+    LmcsParam           m_lmcsParam;
+    ScalingList         m_scalingList;
+
+    int                 m_tablesBitDepth    = 0;   //!< 0 while the tables have not been derived
+    AlfFilterBank       m_alfFilterBank;
+    LmcsTables          m_lmcsTables;
+};
+
+// ALF and CC-ALF controls of a picture header or a slice header. The referenced APSs are looked up once, when the
+// picture starts for the controls in the picture header and when the slice is parsed for those in a slice header.
+// The arrays are indexed by ComponentID, the CC-ALF entries of luma are unused.
+struct AlfControls {
+    bool                       enabled  [MAX_NUM_COMPONENT]  = { false, false, false };   //!< alf_enabled_flag, alf_cb_enabled_flag, alf_cr_enabled_flag
+    bool                       ccEnabled[MAX_NUM_COMPONENT]  = { false, false, false };   //!< alf_cc_cb_enabled_flag, alf_cc_cr_enabled_flag
+    int                        numLumaAps                    = 0;
+    int                        lumaApsId[MAX_NUM_APS_IDS]    = { 0 };
+    int                        chromaApsId                   = 0;
+    int                        ccApsId  [MAX_NUM_COMPONENT]  = { 0 };
+
+    std::shared_ptr<const APS> lumaAps  [MAX_NUM_APS_IDS];
+    std::shared_ptr<const APS> chromaAps;
+    std::shared_ptr<const APS> ccAps    [MAX_NUM_COMPONENT];
+};
+
+// Weighted prediction parameters of one component of a reference picture, from pred_weight_table(). The weight
+// and the offset are the values of the specification, the offset in units of 8 bit samples.
+struct WPScalingParam {
+    bool     presentFlag     = false;   //!< luma_weight_lX_flag or chroma_weight_lX_flag
+    uint8_t  log2WeightDenom = 0;
+    int16_t  weight          = 1;
+    int16_t  offset          = 0;
+};
+
+typedef WPScalingParam PredWeightTable[NUM_REF_PIC_LIST_01][MAX_NUM_REF][MAX_NUM_COMPONENT];
+
+// Constants derived from an activated SPS and PPS pair. They are computed once at activation, so the CTU loop
+// reads them from here instead of deriving them per CU with getLog2() and divisions. A context is only handed
+// out as const; a new SPS or PPS content activates a new context, the previous one stays valid for the pictures
+// still using it.
+struct SeqPicContext {
+    // sub-picture rectangle in CTUs and in luma samples, the right and bottom boundaries are clipped to the picture
+    struct SubPicRect {
+        uint32_t ctuX0  = 0, ctuY0  = 0, ctuX1  = 0, ctuY1  = 0;
+        uint32_t lumaX0 = 0, lumaY0 = 0, lumaX1 = 0, lumaY1 = 0;
+        uint32_t subPicId      = 0;   //!< SubpicIdVal, the sh_subpic_id of its slices
+        uint32_t firstSliceIdx = 0;   //!< start of its rectangular slices in subPicSliceIdx
+        uint32_t numSlices     = 0;   //!< NumSlicesInSubpic
+    };
+
+    static std::shared_ptr<const SeqPicContext> create( std::shared_ptr<const SPS> sps, std::shared_ptr<const PPS> pps );
+
+    // the parameter sets are kept alive as long as the context, the lookup tables below point into the PPS
+    std::shared_ptr<const SPS> sps;
+    std::shared_ptr<const PPS> pps;
+
+    ChromaFormat    chromaFormat       = CHROMA_420;
+    uint32_t        numComponents      = 0;
+    uint8_t         compScaleX[MAX_NUM_COMPONENT] = { 0 };   //!< getComponentScaleX() of each component
+    uint8_t         compScaleY[MAX_NUM_COMPONENT] = { 0 };
+    int             bitDepth           = 8;
+    int             qpBdOffset         = 0;
+
+    uint32_t        picWidth           = 0;   //!< in luma samples
+    uint32_t        picHeight          = 0;
+
+    uint32_t        log2CtuSize        = 0;
+    uint32_t        ctuSize            = 0;
+    uint32_t        ctuMask            = 0;   //!< ctuSize - 1, the position of a sample inside its CTU
+    uint32_t        picWidthInCtu      = 0;
+    uint32_t        picHeightInCtu     = 0;
+    uint32_t        numCtusInPic       = 0;
+
+    uint32_t        log2MinCbSize      = 0;
+    uint32_t        minCbSize          = 0;
+    uint32_t        picWidthInMinCb    = 0;
+    uint32_t        picHeightInMinCb   = 0;
+
+    // the 4x4 grid of the mode and motion information
+    uint32_t        log2MinBlkSize     = 0;
+    uint32_t        picWidthInMinBlk   = 0;
+    uint32_t        picHeightInMinBlk  = 0;
+    uint32_t        numMinBlksInPic    = 0;
+
+    uint32_t        log2MaxTbSize      = 0;
+    uint32_t        log2MaxTsSize      = 0;
+
+    // partitioning defaults of the SPS in log2 units, indexed like PartitionConstraints (I slice luma, P/B slice
+    // luma, I slice chroma); a picture header may override them
+    uint8_t         log2MinQtSize[3]   = { 0 };
+    uint8_t         log2MaxBtSize[3]   = { 0 };
+    uint8_t         log2MaxTtSize[3]   = { 0 };
+    uint8_t         maxMttDepth[3]     = { 0 };
+
+    uint32_t        wrapAroundOffset   = 0;   //!< in luma samples, when reference wrap around is enabled
+
+    // tile lookup tables of the PPS
+    const uint32_t* ctuRsToTs          = nullptr;
+    const uint32_t* ctuTsToRs          = nullptr;
+    const uint32_t* ctuToTileCol       = nullptr;
+    const uint32_t* ctuToTileRow       = nullptr;
+
+    std::vector<SubPicRect> subPics;
+    // SliceSubpicToPicIdx, the picture level index of each rectangular slice of a sub-picture, sub-picture after
+    // sub-picture; the sh_slice_address of a rectangular slice indexes the slices of its sub-picture
+    std::vector<uint32_t>   subPicSliceIdx;
+
+    uint32_t        ctuRsAddr( uint32_t x, uint32_t y ) const { return ( y >> log2CtuSize ) * picWidthInCtu + ( x >> log2CtuSize ); }
+    uint32_t        minBlkIdx( uint32_t x, uint32_t y ) const { return ( y >> log2MinBlkSize ) * picWidthInMinBlk + ( x >> log2MinBlkSize ); }
+
+private:
+    SeqPicContext() = default;
 };
 
 class PicHeader {
@@ -1041,13 +1435,7 @@ private:
     bool                        m_jointCbCrSignFlag                             = false;  //!< joint Cb/Cr residual sign flag
     int                         m_qpDelta                                       = 0;      //!< value of Qp delta
     bool                        m_saoEnabledFlag[MAX_NUM_CHANNEL_TYPE]          = { false, false }; //!< sao enabled flags for each channel
-    bool                        m_alfEnabledFlag[MAX_NUM_COMPONENT]             = { false, false, false }; //!< alf enabled flags for each component
-    int                         m_numAlfAps                                     = 0;      //!< number of alf aps active for the picture
-    //AlfApsIdVec                 m_alfApsId;                                               //!< list of alf aps for the picture
-    bool                        m_ccalfEnabledFlag[MAX_NUM_COMPONENT]           = { false, false, false };
-    int                         m_ccalfCbApsId                                  = -1;
-    int                         m_ccalfCrApsId                                  = -1;
-    int                         m_alfChromaApsId                                = 0;      //!< chroma alf aps ID
+    AlfControls                 m_alf;                                                    //!< alf and cc-alf controls with the referenced APSs
     bool                        m_deblockingFilterOverrideFlag                  = false;  //!< deblocking filter override controls enabled
     bool                        m_deblockingFilterDisable                       = false;  //!< deblocking filter disabled flag
     int                         m_deblockingFilterBetaOffsetDiv2                = 0;      //!< beta offset for deblocking filter
@@ -1058,20 +1446,24 @@ private:
     int                         m_deblockingFilterCrTcOffsetDiv2                = 0;                         //!< tc offset for deblocking filter
     bool                        m_lmcsEnabledFlag                               = false;  //!< lmcs enabled flag
     int                         m_lmcsApsId                                     = -1;     //!< lmcs APS ID
-    //std::shared_ptr<const APS>  m_lmcsAps                                       = nullptr; //!< lmcs APS
+    std::shared_ptr<const APS>  m_lmcsAps                                       = nullptr; //!< lmcs APS
     bool                        m_lmcsChromaResidualScaleFlag                   = false;  //!< lmcs chroma residual scale flag
     bool                        m_explicitScalingListEnabledFlag                = false;  //!< explicit quantization scaling list enabled
     int                         m_scalingListApsId                              = -1;     //!< quantization scaling list APS ID
-    //std::shared_ptr<const APS>  m_scalingListAps                                = nullptr; //!< quantization scaling list APS
+    std::shared_ptr<const APS>  m_scalingListAps                                = nullptr; //!< quantization scaling list APS
     PartitionConstraints        m_minQT                                         = PartitionConstraints{ 0, 0, 0 }; //!< minimum quad-tree size  0: I slice luma; 1: P/B slice luma; 2: I slice chroma
     PartitionConstraints        m_maxMTTHierarchyDepth                          = PartitionConstraints{ 0, 0, 0 }; //!< maximum MTT depth
     PartitionConstraints        m_maxBTSize                                     = PartitionConstraints{ 0, 0, 0 }; //!< maximum BT size
     PartitionConstraints        m_maxTTSize                                     = PartitionConstraints{ 0, 0, 0 }; //!< maximum TT size
 
-    //WPScalingParam              m_weightPredTable[NUM_REF_PIC_LIST_01][MAX_NUM_REF][MAX_NUM_COMPONENT];   // [REF_PIC_LIST_0 or REF_PIC_LIST_1][refIdx][0:Y, 1:U, 2:V]
+    PredWeightTable             m_weightPredTable;                                        // [REF_PIC_LIST_0 or REF_PIC_LIST_1][refIdx][0:Y, 1:U, 2:V]
     int                         m_numL0Weights                                  = 0;  //!< number of weights for L0 list
     int                         m_numL1Weights                                  = 0;  //!< number of weights for L1 list
 
+    // derived when the first slice of the picture is parsed, the slices of the picture share them
+    std::shared_ptr<const SeqPicContext> m_seqPicCtx;                                     //!< activated parameter sets
+    int                         m_poc                                           = 0;      //!< PicOrderCntVal
+
 public:
                                 PicHeader() = default;
                                 ~PicHeader() { /*m_alfApsId.resize(0); */}
@@ -1159,19 +1551,23 @@ public:
     int                         getQpDelta() const                                        { return m_qpDelta;                                                                            }
     void                        setSaoEnabledFlag(ChannelType chType, bool b)             { m_saoEnabledFlag[chType] = b;                                                                }
     bool                        getSaoEnabledFlag(ChannelType chType) const               { return m_saoEnabledFlag[chType];                                                             }  
-    void                        setAlfEnabledFlag(ComponentID compId, bool b)             { m_alfEnabledFlag[compId] = b;                                                                }
-    bool                        getAlfEnabledFlag(ComponentID compId) const               { return m_alfEnabledFlag[compId];                                                             }
-    void                        setNumAlfAps(int i)                                       { m_numAlfAps = i;                                                                             }
-    int                         getNumAlfAps() const                                      { return m_numAlfAps;                                                                          }
-    void                        setAlfApsIdChroma(int i)                                  { m_alfChromaApsId = i;                                                                        }
-    int                         getAlfApsIdChroma() const                                 { return m_alfChromaApsId;                                                                     }  
-    void                        setCcAlfEnabledFlag(ComponentID compId, bool b)           { m_ccalfEnabledFlag[compId] = b; }
-    bool                        getCcAlfEnabledFlag(ComponentID compId) const             { return m_ccalfEnabledFlag[compId]; }
-
-    void                        setCcAlfCbApsId(int i)                                    { m_ccalfCbApsId = i; }
-    int                         getCcAlfCbApsId() const                                   { return m_ccalfCbApsId; }
-    void                        setCcAlfCrApsId(int i)                                    { m_ccalfCrApsId = i; }
-    int                         getCcAlfCrApsId() const                                   { return m_ccalfCrApsId; }
+    void                        setAlfEnabledFlag(ComponentID compId, bool b)             { m_alf.enabled[compId] = b;                                                                   }
+    bool                        getAlfEnabledFlag(ComponentID compId) const               { return m_alf.enabled[compId];                                                                }
+    void                        setNumAlfAps(int i)                                       { m_alf.numLumaAps = i;                                                                        }
+    int                         getNumAlfAps() const                                      { return m_alf.numLumaAps;                                                                     }
+    void                        setAlfApsIdLuma(int idx, int i)                           { CHECK( idx >= MAX_NUM_APS_IDS, "ALF APS index exceeds valid range" ); m_alf.lumaApsId[idx] = i; }
+    int                         getAlfApsIdLuma(int idx) const                            { CHECK( idx >= MAX_NUM_APS_IDS, "ALF APS index exceeds valid range" ); return m_alf.lumaApsId[idx]; }
+    void                        setAlfApsIdChroma(int i)                                  { m_alf.chromaApsId = i;                                                                       }
+    int                         getAlfApsIdChroma() const                                 { return m_alf.chromaApsId;                                                                    }  
+    void                        setCcAlfEnabledFlag(ComponentID compId, bool b)           { m_alf.ccEnabled[compId] = b; }
+    bool                        getCcAlfEnabledFlag(ComponentID compId) const             { return m_alf.ccEnabled[compId]; }
+
+    void                        setCcAlfCbApsId(int i)                                    { m_alf.ccApsId[COMPONENT_Cb] = i; }
+    int                         getCcAlfCbApsId() const                                   { return m_alf.ccApsId[COMPONENT_Cb]; }
+    void                        setCcAlfCrApsId(int i)                                    { m_alf.ccApsId[COMPONENT_Cr] = i; }
+    int                         getCcAlfCrApsId() const                                   { return m_alf.ccApsId[COMPONENT_Cr]; }
+    AlfControls&                getAlfControls()                                          { return m_alf;                    }
+    const AlfControls&          getAlfControls() const                                    { return m_alf;                    }
     void                        setDeblockingFilterOverrideFlag( bool b )                 { m_deblockingFilterOverrideFlag = b;                                                          }
     bool                        getDeblockingFilterOverrideFlag() const                   { return m_deblockingFilterOverrideFlag;                                                       }    
     void                        setDeblockingFilterDisable( bool b )                      { m_deblockingFilterDisable= b;                                                                }  
@@ -1191,15 +1587,15 @@ public:
     void                        setLmcsEnabledFlag(bool b)                                { m_lmcsEnabledFlag = b;                                                                       }
     bool                        getLmcsEnabledFlag()                                      { return m_lmcsEnabledFlag;                                                                    }
     const bool                  getLmcsEnabledFlag() const                                { return m_lmcsEnabledFlag;                                                                    }
-    // void                        setLmcsAPS(std::shared_ptr<const APS> aps)                { m_lmcsAps = aps; m_lmcsApsId = (aps) ? aps->getAPSId() : -1;                                 }
-    // std::shared_ptr<const APS>  getLmcsAPS() const                                        { return m_lmcsAps;                                                                            }
+    void                        setLmcsAPS(std::shared_ptr<const APS> aps)                { m_lmcsAps = aps; m_lmcsApsId = (aps) ? aps->getAPSId() : -1;                                 }
+    std::shared_ptr<const APS>  getLmcsAPS() const                                        { return m_lmcsAps;                                                                            }
     void                        setLmcsAPSId(int id)                                      { m_lmcsApsId = id;                                                                            }
     int                         getLmcsAPSId() const                                      { return m_lmcsApsId;                                                                          }
     void                        setLmcsChromaResidualScaleFlag(bool b)                    { m_lmcsChromaResidualScaleFlag = b;                                                           }
     bool                        getLmcsChromaResidualScaleFlag()                          { return m_lmcsChromaResidualScaleFlag;                                                        }
     const bool                  getLmcsChromaResidualScaleFlag() const                    { return m_lmcsChromaResidualScaleFlag;                                                        }
-    // void                        setScalingListAPS(std::shared_ptr<const APS> aps)         { m_scalingListAps = aps; m_scalingListApsId = ( aps ) ? aps->getAPSId() : -1;                 }
-    // std::shared_ptr<const APS>  getScalingListAPS() const                                 { return m_scalingListAps;                                                                     }
+    void                        setScalingListAPS(std::shared_ptr<const APS> aps)         { m_scalingListAps = aps; m_scalingListApsId = ( aps ) ? aps->getAPSId() : -1;                 }
+    std::shared_ptr<const APS>  getScalingListAPS() const                                 { return m_scalingListAps;                                                                     }
     void                        setScalingListAPSId( int id )                             { m_scalingListApsId = id;                                                                     }
     int                         getScalingListAPSId() const                               { return m_scalingListApsId;                                                                   }
     void                        setExplicitScalingListEnabledFlag( bool b )               { m_explicitScalingListEnabledFlag = b;                                                        }
@@ -1207,6 +1603,7 @@ public:
     bool                        getExplicitScalingListEnabledFlag() const                 { return m_explicitScalingListEnabledFlag;                                                     }
 
     const PartitionConstraints& getMinQTSizes() const                                     { return m_minQT;                                                                              }
+    const PartitionConstraints& getMaxMTTHierarchyDepths() const                          { return m_maxMTTHierarchyDepth;                                                               }
     const PartitionConstraints& getMaxBTSizes() const                                     { return m_maxBTSize;                                                                          }
     const PartitionConstraints& getMaxTTSizes() const                                     { return m_maxTTSize;                                                                          }
 
@@ -1226,18 +1623,17 @@ public:
     unsigned                    getMaxTTSize           ( SliceType slicetype, ChannelType chType = CHANNEL_TYPE_LUMA ) const { return m_maxTTSize           [chType == CHANNEL_TYPE_LUMA ? slicetype == I_SLICE ?  0 : 1 : 2]; }
 
 
-    // void                        setAlfAPSIds( const AlfApsIdVec& apsIDs )                { m_alfApsId = std::move( apsIDs ); }
-    // const AlfApsIdVec&          getAlfAPSIds() const                                     { return m_alfApsId;                }
-
-    // void                        setWpScaling(WPScalingParam *wp) {
-    //     memcpy(m_weightPredTable, wp, sizeof(WPScalingParam) * NUM_REF_PIC_LIST_01 * MAX_NUM_REF * MAX_NUM_COMPONENT);
-    // }
-    // void                        getWpScaling(RefPicList e, int iRefIdx, WPScalingParam *&wp) const;
-    // WPScalingParam*             getWpScalingAll()                                        { return (WPScalingParam *) m_weightPredTable; }
+    PredWeightTable&            getPredWeightTable()                                     { return m_weightPredTable;                    }
+    const WPScalingParam*       getWpScaling( RefPicList l, int refIdx ) const           { return m_weightPredTable[l][refIdx];         }
     void                        setNumL0Weights(int b)                                   { m_numL0Weights = b;                          }
-    int                         getNumL0Weights()                                        { return m_numL0Weights;                       }
+    int                         getNumL0Weights() const                                  { return m_numL0Weights;                       }
     void                        setNumL1Weights(int b)                                   { m_numL1Weights = b;                          }
-    int                         getNumL1Weights()                                        { return m_numL1Weights;                       }
+    int                         getNumL1Weights() const                                  { return m_numL1Weights;                       }
+
+    void                        setSeqPicContext( std::shared_ptr<const SeqPicContext> ctx ) { m_seqPicCtx = std::move( ctx );        }
+    const std::shared_ptr<const SeqPicContext>& getSeqPicContext() const                 { return m_seqPicCtx;                          }
+    void                        setPOC( int i )                                          { m_poc = i;                                   }
+    int                         getPOC() const                                           { return m_poc;                                }
 
     void                        setNoOutputBeforeRecoveryFlag( bool val )                { m_noOutputBeforeRecoveryFlag = val;  }
     bool                        getNoOutputBeforeRecoveryFlag() const                    { return m_noOutputBeforeRecoveryFlag; }
@@ -1296,7 +1692,7 @@ private:
   const SPS*                 m_pcSPS                         = nullptr;
   const PPS*                 m_pcPPS                         = nullptr;
   Picture*                   m_pcPic                         = nullptr;
-  PicHeader*                 m_pcPicHeader                   = nullptr;    //!< pointer to picture header structure
+  std::shared_ptr<const PicHeader> m_picHeader;                               //!< picture header, shared by the slices of the picture
   bool                       m_colFromL0Flag                 = true;   // collocated picture from List0 flag
 
   uint32_t                   m_colRefIdx                     = 0;
@@ -1314,7 +1710,109 @@ private:
   bool                       m_cabacInitFlag                 = false;
 
   uint32_t                   m_sliceSubPicId                 = 0;
+  uint32_t                   m_sliceAddr                     = 0;      //!< sh_slice_address, the picture level slice index of a rectangular slice
+  SliceMap                   m_sliceMap;
+
+  // coded in the slice header when the PPS does not put them into the picture header
+  AlfControls                m_alf;
+  PredWeightTable            m_weightPredTable;
+
+  std::shared_ptr<const SeqPicContext> m_seqPicCtx;
 
 public:
+  // Resets the slice to the state of a default-constructed one but keeps the storage of the substream sizes, so
+  // a slice reused by the parser does not allocate.
+  void                       initSlice();
+  void                       setSeqPicContext( std::shared_ptr<const SeqPicContext> ctx ) { m_seqPicCtx = std::move( ctx ); m_pcSPS = m_seqPicCtx->sps.get(); m_pcPPS = m_seqPicCtx->pps.get(); }
+  const SeqPicContext&       getSeqPicContext() const                            { return *m_seqPicCtx;                             }
+  const SPS*                 getSPS() const                                      { return m_pcSPS;                                  }
+  const PPS*                 getPPS() const                                      { return m_pcPPS;                                  }
+  void                       setSliceType( SliceType e )                         { m_eSliceType = e;                                }
+  SliceType                  getSliceType() const                                { return m_eSliceType;                             }
+  void                       setSliceQp( int i )                                 { m_iSliceQp = i;                                  }
+  int                        getSliceQp() const                                  { return m_iSliceQp;                               }
+  void                       setCabacInitFlag( bool val )                        { m_cabacInitFlag = val;                           }
+  bool                       getCabacInitFlag() const                            { return m_cabacInitFlag;                          }
+  void                       setPicHeader( std::shared_ptr<const PicHeader> ph ) { m_picHeader = std::move( ph );                   }
+  const PicHeader*           getPicHeader() const                                { return m_picHeader.get();                        }
+  void                       setPOC( int i )                                     { m_iPOC = i;                                      }
+  int                        getPOC() const                                      { return m_iPOC;                                   }
+  void                       setNalUnitType( NalUnitType e )                     { m_eNalUnitType = e;                              }
+  NalUnitType                getNalUnitType() const                              { return m_eNalUnitType;                           }
+  void                       setNalUnitLayerId( uint32_t i )                     { m_nuhLayerId = i;                                }
+  uint32_t                   getNalUnitLayerId() const                           { return m_nuhLayerId;                             }
+  void                       setTLayer( uint32_t i )                             { m_uiTLayer = i;                                  }
+  uint32_t                   getTLayer() const                                   { return m_uiTLayer;                               }
+  bool                       isIntra() const                                     { return m_eSliceType == I_SLICE;                  }
+  bool                       isInterB() const                                    { return m_eSliceType == B_SLICE;                  }
+  void                       setPictureHeaderInSliceHeader( bool b )             { m_pictureHeaderInSliceHeader = b;                }
+  bool                       getPictureHeaderInSliceHeader() const               { return m_pictureHeaderInSliceHeader;             }
+  void                       setNoOutputOfPriorPicsFlag( bool b )                { m_noOutputOfPriorPicsFlag = b;                   }
+  bool                       getNoOutputOfPriorPicsFlag() const                  { return m_noOutputOfPriorPicsFlag;                }
+  void                       setSliceSubPicId( uint32_t i )                      { m_sliceSubPicId = i;                             }
+  uint32_t                   getSliceSubPicId() const                            { return m_sliceSubPicId;                          }
+  void                       setSliceAddr( uint32_t i )                          { m_sliceAddr = i;                                 }
+  uint32_t                   getSliceAddr() const                                { return m_sliceAddr;                              }
+  void                       setSliceMap( const SliceMap& map )                  { m_sliceMap = map;                                }
+  const SliceMap&            getSliceMap() const                                 { return m_sliceMap;                               }
+
+  // the reference picture lists, the weights and the ALF controls come from the picture header when the PPS
+  // signals them there
+  ReferencePictureList*      getSliceRPL( RefPicList l )                         { return &m_RPL[l];                                }
+  int*                       getSliceRPLIdx()                                    { return m_RPLIdx;                                 }
+  const ReferencePictureList* getRPL( RefPicList l ) const                       { return m_pcPPS->getRplInfoInPhFlag() ? m_picHeader->getRPL( l ) : &m_RPL[l];       }
+  int                        getRPLIdx( RefPicList l ) const                     { return m_pcPPS->getRplInfoInPhFlag() ? m_picHeader->getRPLIdx( l ) : m_RPLIdx[l];  }
+  AlfControls&               getSliceAlfControls()                               { return m_alf;                                    }
+  const AlfControls&         getAlfControls() const                              { return m_pcPPS->getAlfInfoInPhFlag() ? m_picHeader->getAlfControls() : m_alf;      }
+  PredWeightTable&           getSlicePredWeightTable()                           { return m_weightPredTable;                        }
+  const WPScalingParam*      getWpScaling( RefPicList l, int refIdx ) const      { return m_pcPPS->getWpInfoInPhFlag() ? m_picHeader->getWpScaling( l, refIdx ) : m_weightPredTable[l][refIdx]; }
+
+  void                       setNumRefIdx( RefPicList l, int i )                 { m_aiNumRefIdx[l] = i;                            }
+  int                        getNumRefIdx( RefPicList l ) const                  { return m_aiNumRefIdx[l];                         }
+  void                       setColFromL0Flag( bool b )                          { m_colFromL0Flag = b;                             }
+  bool                       getColFromL0Flag() const                            { return m_colFromL0Flag;                          }
+  void                       setColRefIdx( uint32_t i )                          { m_colRefIdx = i;                                 }
+  uint32_t                   getColRefIdx() const                                { return m_colRefIdx;                              }
+  void                       setSaoEnabledFlag( ChannelType ch, bool b )         { m_saoEnabledFlag[ch] = b;                        }
+  bool                       getSaoEnabledFlag( ChannelType ch ) const           { return m_saoEnabledFlag[ch];                     }
+  void                       setSliceChromaQpDelta( ComponentID c, int i )       { m_iSliceChromaQpDelta[c] = i;                    }
+  int                        getSliceChromaQpDelta( ComponentID c ) const        { return m_iSliceChromaQpDelta[c];                 }
+  void                       setUseChromaQpAdj( bool b )                         { m_ChromaQpAdjEnabled = b;                        }
+  bool                       getUseChromaQpAdj() const                           { return m_ChromaQpAdjEnabled;                     }
+  void                       setDeblockingFilterOverrideFlag( bool b )           { m_deblockingFilterOverrideFlag = b;              }
+  bool                       getDeblockingFilterOverrideFlag() const             { return m_deblockingFilterOverrideFlag;           }
+  void                       setDeblockingFilterDisable( bool b )                { m_deblockingFilterDisable = b;                   }
+  bool                       getDeblockingFilterDisable() const                  { return m_deblockingFilterDisable;                }
+  void                       setDeblockingFilterBetaOffsetDiv2( int i )          { m_deblockingFilterBetaOffsetDiv2 = i;            }
+  int                        getDeblockingFilterBetaOffsetDiv2() const           { return m_deblockingFilterBetaOffsetDiv2;         }
+  void                       setDeblockingFilterTcOffsetDiv2( int i )            { m_deblockingFilterTcOffsetDiv2 = i;              }
+  int                        getDeblockingFilterTcOffsetDiv2() const             { return m_deblockingFilterTcOffsetDiv2;           }
+  void                       setDeblockingFilterCbBetaOffsetDiv2( int i )        { m_deblockingFilterCbBetaOffsetDiv2 = i;          }
+  int                        getDeblockingFilterCbBetaOffsetDiv2() const         { return m_deblockingFilterCbBetaOffsetDiv2;       }
+  void                       setDeblockingFilterCbTcOffsetDiv2( int i )          { m_deblockingFilterCbTcOffsetDiv2 = i;            }
+  int                        getDeblockingFilterCbTcOffsetDiv2() const           { return m_deblockingFilterCbTcOffsetDiv2;         }
+  void                       setDeblockingFilterCrBetaOffsetDiv2( int i )        { m_deblockingFilterCrBetaOffsetDiv2 = i;          }
+  int                        getDeblockingFilterCrBetaOffsetDiv2() const         { return m_deblockingFilterCrBetaOffsetDiv2;       }
+  void                       setDeblockingFilterCrTcOffsetDiv2( int i )          { m_deblockingFilterCrTcOffsetDiv2 = i;            }
+  int                        getDeblockingFilterCrTcOffsetDiv2() const           { return m_deblockingFilterCrTcOffsetDiv2;         }
+  void                       setLmcsEnabledFlag( bool b )                        { m_lmcsEnabledFlag = b;                           }
+  bool                       getLmcsEnabledFlag() const                          { return m_lmcsEnabledFlag;                        }
+  void                       setExplicitScalingListUsed( bool b )                { m_explicitScalingListUsed = b;                   }
+  bool                       getExplicitScalingListUsed() const                  { return m_explicitScalingListUsed;                }
+  void                       setTSResidualCodingDisabledFlag( bool b )           { m_tsResidualCodingDisabledFlag = b;              }
+  bool                       getTSResidualCodingDisabledFlag() const             { return m_tsResidualCodingDisabledFlag;           }
+  void                       setDepQuantEnabledFlag( bool b )                    { m_depQuantEnabledFlag = b;                       }
+  bool                       getDepQuantEnabledFlag() const                      { return m_depQuantEnabledFlag;                    }
+  void                       setSignDataHidingEnabledFlag( bool b )              { m_signDataHidingEnabledFlag = b;                 }
+  bool                       getSignDataHidingEnabledFlag() const                { return m_signDataHidingEnabledFlag;              }
+
+  // entry points of the slice data, the sizes count NAL unit bytes including emulation prevention bytes
+  void                       setNumEntryPoints( uint32_t val )                   { m_numEntryPoints = val;                          }
+  uint32_t                   getNumEntryPoints() const                           { return m_numEntryPoints;                         }
+  void                       clearSubstreamSizes()                               { m_substreamSizes.clear();                        }
+  void                       addSubstreamSize( uint32_t size )                   { m_substreamSizes.push_back( size );              }
+  uint32_t                   getNumberOfSubstreamSizes() const                   { return (uint32_t) m_substreamSizes.size();       }
+  uint32_t                   getSubstreamSize( int idx ) const                   { return m_substreamSizes[idx];                    }
+  const std::vector<uint32_t>& getSubstreamSizes() const                         { return m_substreamSizes;                         }
 
 };
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <string.h>
+#include <algorithm>
+
+#include "Trace.h"
+
+static constexpr size_t TRACE_BUFFER_SIZE = 1 << 20;
+
+SyntaxTrace& SyntaxTrace::get() {
+    static SyntaxTrace trace;
+    return trace;
+}
+
+int SyntaxTrace::open(const std::string& traceFile) {
+    close();
+
+    m_file = fopen(traceFile.c_str(), "wb");
+    if(m_file == nullptr) {
+        return -1;
+    }
+    m_buffer.reserve(TRACE_BUFFER_SIZE);
+
+    static const char magic[8] = { 'W', '2', '6', '6', 'T', 'R', 'C', 'E' };
+    xPut(magic, sizeof(magic));
+    const uint8_t version[4] = { VERSION & 0xff, (VERSION >> 8) & 0xff, (VERSION >> 16) & 0xff, VERSION >> 24 };
+    xPut(version, sizeof(version));
+    return 0;
+}
+
+void SyntaxTrace::close() {
+    if(m_file) {
+        xFlush();
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_buffer.clear();
+    m_symbolIds.clear();
+    m_symbolNames.clear();
+}
+
+void SyntaxTrace::nalUnit(NalUnitType nalUnitType, uint32_t layerId, uint32_t temporalId, uint32_t numBytes) {
+    if(!m_file) {
+        return;
+    }
+    const uint8_t record[8] = { TRACE_RECORD_NAL, (uint8_t)nalUnitType, (uint8_t)layerId, (uint8_t)temporalId,
+                                (uint8_t)numBytes, (uint8_t)(numBytes >> 8), (uint8_t)(numBytes >> 16), (uint8_t)(numBytes >> 24) };
+    xPut(record, sizeof(record));
+}
+
+void SyntaxTrace::symbol(const char* symbolName, TraceSymbolKind kind, uint32_t bitPos, uint32_t numBits, int64_t value) {
+    if(!m_file) {
+        return;
+    }
+    const uint16_t id = xGetSymbolId(symbolName);
+
+    uint8_t record[17] = { TRACE_RECORD_SYMBOL, (uint8_t)id, (uint8_t)(id >> 8), kind, (uint8_t)numBits,
+                           (uint8_t)bitPos, (uint8_t)(bitPos >> 8), (uint8_t)(bitPos >> 16), (uint8_t)(bitPos >> 24) };
+    for(int i = 0; i < 8; i++) {
+        record[9 + i] = (uint8_t)((uint64_t)value >> (8 * i));
+    }
+    xPut(record, sizeof(record));
+}
+
+uint16_t SyntaxTrace::xGetSymbolId(const char* symbolName) {
+    auto it = m_symbolIds.find(symbolName);
+    if(it != m_symbolIds.end()) {
+        return it->second;
+    }
+
+    // the same name may be passed from several string literals
+    const std::string name(symbolName);
+    auto nameIt = m_symbolNames.find(name);
+    if(nameIt != m_symbolNames.end()) {
+        m_symbolIds.emplace(symbolName, nameIt->second);
+        return nameIt->second;
+    }
+
+    CHECK(m_symbolNames.size() > UINT16_MAX, "Too many syntax element names for the trace file");
+    const uint16_t id  = (uint16_t)m_symbolNames.size();
+    const uint16_t len = (uint16_t)std::min<size_t>(name.size(), UINT16_MAX);
+    m_symbolNames.emplace(name, id);
+    m_symbolIds.emplace(symbolName, id);
+
+    const uint8_t record[5] = { TRACE_RECORD_NAME, (uint8_t)id, (uint8_t)(id >> 8), (uint8_t)len, (uint8_t)(len >> 8) };
+    xPut(record, sizeof(record));
+    xPut(name.data(), len);
+    return id;
+}
+
+void SyntaxTrace::xPut(const void* data, size_t size) {
+    if(m_buffer.size() + size > TRACE_BUFFER_SIZE) {
+        xFlush();
+    }
+    const uint8_t* bytes = (const uint8_t*)data;
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
+
+void SyntaxTrace::xFlush() {
+    if(!m_buffer.empty() && fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+        std::cerr << "W266 [warning]: failed to write the syntax trace" << std::endl;
+    }
+    m_buffer.clear();
+}
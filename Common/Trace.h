@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Def.h"
+
+// Syntax element tracing is selected at compile time (cmake -DENABLE_TRACING=ON). When it is off the
+// tracing calls are removed by the compiler, so the parser is the same as without them.
+#ifndef ENABLE_TRACING
+#define ENABLE_TRACING 0
+#endif
+
+static constexpr bool TRACING_ENABLED = ENABLE_TRACING != 0;
+
+enum TraceSymbolKind : uint8_t {
+    TRACE_FLAG  = 0,
+    TRACE_UVLC  = 1,
+    TRACE_SVLC  = 2,
+    TRACE_CODE  = 3,
+    TRACE_SCODE = 4,
+};
+
+// Writes the parsed syntax elements to a binary trace file. All values are little endian:
+//
+//   file header    "W266TRCE" uint32 version
+//   name record    uint8 TRACE_RECORD_NAME,   uint16 symbolId, uint16 length, length bytes of the name
+//   NAL record     uint8 TRACE_RECORD_NAL,    uint8 nalUnitType, uint8 layerId, uint8 temporalId, uint32 numBytes
+//   symbol record  uint8 TRACE_RECORD_SYMBOL, uint16 symbolId, uint8 kind, uint8 numBits, uint32 bitPos, int64 value
+//
+// A name record precedes the first symbol record using its id. bitPos is the position of the first
+// bit of the element in the RBSP of the NAL unit of the preceding NAL record.
+class SyntaxTrace {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    enum RecordType : uint8_t {
+        TRACE_RECORD_NAME   = 0,
+        TRACE_RECORD_NAL    = 1,
+        TRACE_RECORD_SYMBOL = 2,
+    };
+
+    SyntaxTrace() = default;
+    ~SyntaxTrace() { close(); }
+    CLASS_COPY_MOVE_DELETE( SyntaxTrace )
+
+    // The trace used by the parser, it only writes after open() was called.
+    static SyntaxTrace& get();
+
+    int  open ( const std::string& traceFile );
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    void nalUnit( NalUnitType nalUnitType, uint32_t layerId, uint32_t temporalId, uint32_t numBytes );
+    void symbol ( const char* symbolName, TraceSymbolKind kind, uint32_t bitPos, uint32_t numBits, int64_t value );
+
+private:
+    uint16_t xGetSymbolId( const char* symbolName );
+    void     xPut        ( const void* data, size_t size );
+    void     xFlush      ();
+
+    FILE*                                     m_file = nullptr;
+    std::vector<uint8_t>                      m_buffer;
+    std::unordered_map<const char*, uint16_t> m_symbolIds;     // by string literal address
+    std::unordered_map<std::string, uint16_t> m_symbolNames;   // equal names from other translation units
+};
@@ -0,0 +1,83 @@
+#include <algorithm>
+
+#include "BinDecoder.h"
+
+void BinDecoder::start( InputBitstream* bitstream ) {
+    CHECK( bitstream->getNumBitsUntilByteAligned() != 0, "CABAC data does not start byte aligned" );
+
+    m_bitstream = bitstream;
+    m_startPos  = bitstream->getNumBitsRead();
+    m_zeroBits  = 0;
+    m_range     = 510;
+    m_value     = 0;
+    m_bitsAvail = -9;   // the first refill also loads the 9 bits of ivlOffset
+    xRefill();
+
+    CHECK( ( m_value >> VALUE_SHIFT ) >= 510, "ivlOffset shall not be equal to 510 or 511" );
+}
+
+void BinDecoder::finish() {
+    // the last bit read into ivlOffset is the stop bit, it is followed by zero bits up to the byte boundary
+    const uint32_t lastBit = m_startPos + getNumBitsRead() - 1;
+    CHECK( lastBit / 8 >= m_bitstream->getByteSize(), "CABAC stream exceeds the slice data" );
+    const uint8_t  lastByte = m_bitstream->getData()[lastBit / 8];
+    CHECK( (uint8_t)( lastByte << ( lastBit & 7 ) ) != 0x80, "No proper stop/alignment pattern at end of CABAC stream" );
+}
+
+uint32_t BinDecoder::decodeBinsEP( int numBins ) {
+    CHECKD( numBins < 0 || numBins > 32, "Invalid number of bypass bins" );
+    uint32_t bins = 0;
+    while( numBins > MAX_BATCH ) {
+        bins     = ( bins << MAX_BATCH ) | xDecodeBinsEP( MAX_BATCH );
+        numBins -= MAX_BATCH;
+    }
+    return ( bins << numBins ) | xDecodeBinsEP( numBins );
+}
+
+uint32_t BinDecoder::decodeRemAbsEP( uint32_t goRicePar, uint32_t cutoff, int maxLog2TrDynamicRange ) {
+    const uint32_t maxPrefix = 32 - maxLog2TrDynamicRange;
+    uint32_t       prefix    = 0;
+    while( prefix < maxPrefix && decodeBinEP() ) {
+        prefix++;
+    }
+
+    if( prefix < cutoff ) {
+        return ( prefix << goRicePar ) + decodeBinsEP( goRicePar );
+    }
+    // without the terminating zero bin the escape code has a suffix of maxLog2TrDynamicRange bins
+    const int      suffixLen = prefix < maxPrefix ? prefix - cutoff + goRicePar : maxLog2TrDynamicRange;
+    const uint32_t suffix    = decodeBinsEP( suffixLen );
+    return ( ( ( 1u << ( prefix - cutoff ) ) + cutoff - 1 ) << goRicePar ) + suffix;
+}
+
+uint32_t BinDecoder::getNumBitsRead() const {
+    return m_bitstream->getNumBitsRead() - m_startPos + m_zeroBits - m_bitsAvail;
+}
+
+void BinDecoder::xRefill() {
+    const uint32_t numBits = std::min<uint32_t>( 32, m_bitstream->getNumBitsLeft() );
+    if( numBits ) {
+        m_value |= (uint64_t)m_bitstream->read( numBits ) << ( VALUE_SHIFT - m_bitsAvail - (int)numBits );
+    }
+    // past the end the bitstream is read as zero bits
+    m_zeroBits  += 32 - numBits;
+    m_bitsAvail += 32;
+}
+
+uint32_t BinDecoder::xDecodeBinsEP( int numBins ) {
+    if( m_bitsAvail < numBins ) {
+        xRefill();
+    }
+
+    // ivlOffset followed by the next numBins bits, at most 9 + MAX_BATCH bits
+    const uint32_t value = (uint32_t)( m_value >> ( VALUE_SHIFT - numBins ) );
+    const uint32_t bins  = value / m_range;
+    const uint64_t below = ( m_value << numBins ) & ( ( uint64_t( 1 ) << VALUE_SHIFT ) - 1 );
+
+    m_value      = ( (uint64_t)( value - bins * m_range ) << VALUE_SHIFT ) | below;
+    m_bitsAvail -= numBins;
+    if( m_bitsAvail < MIN_BITS ) {
+        xRefill();
+    }
+    return bins;
+}
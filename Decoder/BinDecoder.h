@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Common/Def.h"
+#include "Common/BitStream.h"
+#include "Common/Contexts.h"
+
+// CABAC arithmetic decoding engine. The 9 bit ivlOffset of the specification is kept at the top of a
+// 64 bit window, followed by bits that are already loaded from the bitstream. Renormalization shifts
+// the window by the clz of the range and the bitstream is only read when fewer than MIN_BITS remain.
+// n bypass bins are the n bit quotient of ivlOffset and the next n bits divided by the range, so
+// they are decoded with one division instead of n steps.
+class BinDecoder {
+public:
+    BinDecoder()  = default;
+    ~BinDecoder() = default;
+
+    // Starts decoding at the current, byte aligned position of bitstream.
+    void     start ( InputBitstream* bitstream );
+    // Checks the stop bit and the alignment bits following a terminating bin equal to 1.
+    void     finish();
+
+    uint32_t decodeBin   ( BinProbModel& ctx );
+    uint32_t decodeBinEP ();
+    // Decodes up to 32 bypass bins at once, the first bin is the MSB of the result.
+    uint32_t decodeBinsEP( int numBins );
+    uint32_t decodeBinTrm();
+
+    // abs_remainder and dec_abs_level: unary prefix, then the Rice/Exp-Golomb suffix as one bypass batch
+    uint32_t decodeRemAbsEP( uint32_t goRicePar, uint32_t cutoff, int maxLog2TrDynamicRange );
+
+    // bits consumed by the arithmetic decoder since start(), including the 9 bits of the initial offset
+    uint32_t getNumBitsRead() const;
+
+private:
+    static constexpr int VALUE_SHIFT = 54;   // position of the ivlOffset LSB, the bit above is needed by bypass bins
+    static constexpr int MIN_BITS    = 8;    // more than any renormalization shift
+    static constexpr int MAX_BATCH   = 16;   // bypass bins decoded by one division
+
+    void     xRefill();
+    uint32_t xDecodeBinsEP( int numBins );
+
+    inline void xRenorm() {
+        const int numBits = __builtin_clz( m_range ) - 23;   // shift the range MSB to bit 8
+        m_range    <<= numBits;
+        m_value    <<= numBits;
+        m_bitsAvail -= numBits;
+        if UNLIKELY( m_bitsAvail < MIN_BITS ) {
+            xRefill();
+        }
+    }
+
+    InputBitstream* m_bitstream = nullptr;
+    uint32_t        m_range     = 0;
+    uint64_t        m_value     = 0;   // ivlOffset << VALUE_SHIFT, followed by m_bitsAvail loaded bits
+    int             m_bitsAvail = 0;
+    uint32_t        m_startPos  = 0;   // bit position of the bitstream at start()
+    uint32_t        m_zeroBits  = 0;   // zero bits appended after the end of the bitstream
+};
+
+inline uint32_t BinDecoder::decodeBin( BinProbModel& ctx ) {
+    const uint32_t lps = ctx.getLPS( m_range );
+    uint32_t       bin = ctx.mps();
+
+    m_range -= lps;
+    const uint64_t scaledRange = (uint64_t)m_range << VALUE_SHIFT;
+    if( m_value >= scaledRange ) {
+        bin      ^= 1;
+        m_value  -= scaledRange;
+        m_range   = lps;
+    }
+    ctx.update( bin );
+
+    if( m_range < 256 ) {
+        xRenorm();
+    }
+    return bin;
+}
+
+inline uint32_t BinDecoder::decodeBinEP() {
+    m_value <<= 1;
+    if UNLIKELY( --m_bitsAvail < MIN_BITS ) {
+        xRefill();
+    }
+
+    const uint64_t scaledRange = (uint64_t)m_range << VALUE_SHIFT;
+    if( m_value >= scaledRange ) {
+        m_value -= scaledRange;
+        return 1;
+    }
+    return 0;
+}
+
+inline uint32_t BinDecoder::decodeBinTrm() {
+    m_range -= 2;
+    const uint64_t scaledRange = (uint64_t)m_range << VALUE_SHIFT;
+    if( m_value >= scaledRange ) {
+        // no renormalization, the last bit of the offset is the stop bit
+        return 1;
+    }
+    if( m_range < 256 ) {
+        xRenorm();
+    }
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <string.h>
+
+#include "CABACReader.h"
+
+#include "Common/Rom.h"
+#include "Common/Slice.h"
+
+// odr-used by std::min, C++14 needs a definition
+constexpr int CABACReader::TPL_MAX_ABS;
+
+// ctxOffset of last_sig_coeff_x_prefix and last_sig_coeff_y_prefix for luma, indexed by log2TbSize - 1
+static const uint8_t g_lastCtxOffsetLuma[] = { 0, 0, 3, 6, 10, 15 };
+
+// cRiceParam of abs_remainder and dec_abs_level, indexed by the clipped locSumAbs (table 128)
+static const uint8_t g_goRiceParsCoeff[32] = { 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 2, 2,
+                                               2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3 };
+
+// QStateTransTable[QState][k & 1] with 2 bits per entry
+static inline int nextQState( int state, int absLevel ) {
+    return ( 32040 >> ( ( state << 2 ) + ( ( absLevel & 1 ) << 1 ) ) ) & 3;
+}
+
+void CABACReader::initCtxModels( const Slice& slice ) {
+    unsigned initType = 0;
+    if( slice.getSliceType() == P_SLICE ) {
+        initType = slice.getCabacInitFlag() ? 2 : 1;
+    } else if( slice.getSliceType() == B_SLICE ) {
+        initType = slice.getCabacInitFlag() ? 1 : 2;
+    }
+    m_ctx.init( slice.getSliceQp(), initType );
+}
+
+unsigned CABACReader::xReadLastSigCoeffPrefix( int log2TbSize, int log2ZoTbSize, const CtxSet& ctxSet, ChannelType chType ) {
+    if( log2TbSize == 0 ) {
+        return 0;
+    }
+    const unsigned cMax     = ( log2ZoTbSize << 1 ) - 1;
+    const unsigned ctxOff   = isLuma( chType ) ? g_lastCtxOffsetLuma[log2TbSize - 1] : 0;
+    const unsigned ctxShift = isLuma( chType ) ? ( log2TbSize + 1 ) >> 2 : clip3( 0, 2, ( 1 << log2TbSize ) >> 3 );
+
+    unsigned prefix = 0;
+    while( prefix < cMax && m_binDecoder.decodeBin( m_ctx[ctxSet( ctxOff + ( prefix >> ctxShift ) )] ) ) {
+        prefix++;
+    }
+    return prefix;
+}
+
+unsigned CABACReader::xReadLastSigCoeffSuffix( unsigned prefix ) {
+    if( prefix <= 3 ) {
+        return prefix;
+    }
+    const int numBins = ( prefix >> 1 ) - 1;
+    return ( ( 2 + ( prefix & 1 ) ) << numBins ) + m_binDecoder.decodeBinsEP( numBins );
+}
+
+void CABACReader::residual_coding( TransformUnit& tu, ComponentID compID, CoeffSigBuf coeffs ) {
+    const Slice&      slice        = *tu.cu->slice;
+    const ChannelType chType       = toChannelType( compID );
+    const bool        luma         = isLuma( compID );
+    const bool        depQuant     = slice.getDepQuantEnabledFlag();
+    const bool        signHiding   = !depQuant && slice.getSignDataHidingEnabledFlag();
+    const int         log2TbWidth  = getLog2( tu.blocks[compID].width );
+    const int         log2TbHeight = getLog2( tu.blocks[compID].height );
+    CHECKD( coeffs.width != tu.blocks[compID].width || coeffs.height != tu.blocks[compID].height, "Coefficient buffer does not match the transform block" );
+
+    // only the top left 32x32 coefficients of larger blocks are coded
+    const int log2ZoWidth  = std::min( log2TbWidth,  5 );
+    const int log2ZoHeight = std::min( log2TbHeight, 5 );
+
+    for( unsigned y = 0; y < coeffs.height; y++ ) {
+        ::memset( coeffs.bufAt( 0, y ), 0, coeffs.width * sizeof( TCoeffSig ) );
+    }
+
+    const unsigned prefixX = xReadLastSigCoeffPrefix( log2TbWidth,  log2ZoWidth,  ContextSetCfg::LastX[chType], chType );
+    const unsigned prefixY = xReadLastSigCoeffPrefix( log2TbHeight, log2ZoHeight, ContextSetCfg::LastY[chType], chType );
+    const unsigned lastX   = xReadLastSigCoeffSuffix( prefixX );
+    const unsigned lastY   = xReadLastSigCoeffSuffix( prefixY );
+
+    // coefficient groups
+    int log2SbW = std::min( log2ZoWidth, log2ZoHeight ) < 2 ? 1 : 2;
+    int log2SbH = log2SbW;
+    if( log2ZoWidth + log2ZoHeight > 3 ) {
+        if( log2ZoWidth < 2 ) {
+            log2SbW = log2ZoWidth;
+            log2SbH = 4 - log2SbW;
+        } else if( log2ZoHeight < 2 ) {
+            log2SbH = log2ZoHeight;
+            log2SbW = 4 - log2SbH;
+        }
+    }
+    const int          numSbCoeff = 1 << ( log2SbW + log2SbH );
+    const ScanElement* sbScan     = g_scanOrder[log2ZoWidth - log2SbW][log2ZoHeight - log2SbH];
+    const ScanElement* scan       = g_scanOrder[log2SbW][log2SbH];
+
+    int lastSubBlock = 0;
+    while( sbScan[lastSubBlock].x != lastX >> log2SbW || sbScan[lastSubBlock].y != lastY >> log2SbH ) {
+        lastSubBlock++;
+    }
+    int lastScanPos = 0;
+    while( scan[lastScanPos].x != ( lastX & ( ( 1 << log2SbW ) - 1 ) ) || scan[lastScanPos].y != ( lastY & ( ( 1 << log2SbH ) - 1 ) ) ) {
+        lastScanPos++;
+    }
+
+    m_tplStride = ( 1 << log2ZoWidth ) + TPL_MARGIN;
+    ::memset( m_tplBuf + TPL_MARGIN * m_tplStride, 0, sizeof( uint32_t ) * m_tplStride * ( 1 << log2ZoHeight ) );
+    ::memset( m_sbCoded, 0, sizeof( m_sbCoded ) );
+    uint32_t* tplOrigin = m_tplBuf + TPL_MARGIN * m_tplStride + TPL_MARGIN;
+
+    const CtxSet* sigSets  = &ContextSetCfg::SigFlag[luma ? 0 : 3];
+    const CtxSet& gt1Set   = ContextSetCfg::GtxFlag[chType];
+    const CtxSet& parSet   = ContextSetCfg::ParFlag[chType];
+    const CtxSet& gt3Set   = ContextSetCfg::GtxFlag[chType + 2];
+    const CtxSet& sbSet    = ContextSetCfg::SigCoeffGroup[chType];
+
+    int remBinsPass1 = ( ( 1 << ( log2ZoWidth + log2ZoHeight ) ) * 7 ) >> 2;
+    int qState       = 0;
+    int maxX         = 0;
+    int maxY         = 0;
+
+    // abs_level_gtx_flag[n][0], par_level_flag[n] and abs_level_gtx_flag[n][1] of a significant level
+    auto readAbsLevelPass1 = [&]( unsigned ctxOff ) -> int {
+        remBinsPass1--;
+        if( !m_binDecoder.decodeBin( m_ctx[gt1Set( ctxOff )] ) ) {
+            return 1;
+        }
+        const int par = m_binDecoder.decodeBin( m_ctx[parSet( ctxOff )] );
+        const int gt3 = m_binDecoder.decodeBin( m_ctx[gt3Set( ctxOff )] );
+        remBinsPass1 -= 2;
+        return 2 + par + 2 * gt3;
+    };
+
+    for( int i = lastSubBlock; i >= 0; i-- ) {
+        const int xS    = sbScan[i].x;
+        const int yS    = sbScan[i].y;
+        const int sbIdx = yS * SB_STRIDE + xS;
+
+        bool inferSbDcSigCoeff = false;
+        if( i < lastSubBlock && i > 0 ) {
+            // the right and the lower coefficient group are inside m_sbCoded because of the extra row and column
+            const unsigned csbfCtx = m_sbCoded[sbIdx + 1] | m_sbCoded[sbIdx + SB_STRIDE];
+            m_sbCoded[sbIdx]  = m_binDecoder.decodeBin( m_ctx[sbSet( csbfCtx )] );
+            inferSbDcSigCoeff = true;
+        } else {
+            m_sbCoded[sbIdx]  = 1;
+        }
+        if( !m_sbCoded[sbIdx] ) {
+            // numSbCoeff is even, an even number of zero levels leaves QState unchanged
+            continue;
+        }
+
+        const int x0 = xS << log2SbW;
+        const int y0 = yS << log2SbH;
+
+        int      absLevel[16];
+        uint8_t  qOffset [16];   // QState > 1 when the level was decoded, for dependent quantization
+        uint32_t sigMask          = 0;
+        int      firstSigScanPos  = numSbCoeff;
+        int      lastSigScanPos   = -1;
+        auto     setAbsLevel      = [&]( int n, uint32_t* tpl, int level ) {
+            if( level ) {
+                xUpdateTpl( tpl, xTplInc( level ) );
+                sigMask        |= 1u << n;
+                lastSigScanPos  = std::max( lastSigScanPos, n );
+                firstSigScanPos = n;
+            }
+            absLevel[n] = level;
+            if( depQuant ) {
+                qOffset[n] = qState > 1;
+                qState     = nextQState( qState, level );
+            }
+        };
+
+        // first pass: sig_coeff_flag, abs_level_gtx_flag and par_level_flag while context coded bins remain
+        const int firstPosMode0 = i == lastSubBlock ? lastScanPos : numSbCoeff - 1;
+        int       n             = firstPosMode0;
+        if( i == lastSubBlock ) {
+            // sig_coeff_flag of the last position is inferred, its abs_level_gtx_flag contexts have offset 0
+            setAbsLevel( n, tplOrigin + ( y0 + scan[n].y ) * m_tplStride + x0 + scan[n].x, readAbsLevelPass1( 0 ) );
+            n--;
+        }
+        for( ; n >= 0 && remBinsPass1 >= 4; n-- ) {
+            const int      xC  = x0 + scan[n].x;
+            const int      yC  = y0 + scan[n].y;
+            uint32_t*      tpl = tplOrigin + yC * m_tplStride + xC;
+            const uint32_t sum = *tpl;
+            const int      d   = xC + yC;
+
+            bool sig = true;
+            if( n > 0 || !inferSbDcSigCoeff ) {
+                const unsigned sigCtx = std::min<unsigned>( ( ( sum & 0xff ) + 1 ) >> 1, 3 ) + ( luma ? ( d < 2 ? 8 : d < 5 ? 4 : 0 ) : ( d < 2 ? 4 : 0 ) );
+                sig = m_binDecoder.decodeBin( m_ctx[sigSets[std::max( 0, qState - 1 )]( sigCtx )] );
+                remBinsPass1--;
+                inferSbDcSigCoeff &= !sig;
+            }
+
+            int level = 0;
+            if( sig ) {
+                const unsigned gtxCtx = std::min<unsigned>( ( sum >> 8 ) & 0xff, 4 ) + 1 + ( luma ? ( d == 0 ? 15 : d < 3 ? 10 : d < 10 ? 5 : 0 ) : ( d == 0 ? 5 : 0 ) );
+                level = readAbsLevelPass1( gtxCtx );
+            }
+            setAbsLevel( n, tpl, level );
+        }
+        const int firstPosMode1 = n;
+
+        // second pass: abs_remainder of the levels with abs_level_gtx_flag[n][1] equal to 1
+        for( int k = firstPosMode0; k > firstPosMode1; k-- ) {
+            if( absLevel[k] < 4 ) {
+                continue;
+            }
+            uint32_t*      tpl   = tplOrigin + ( y0 + scan[k].y ) * m_tplStride + x0 + scan[k].x;
+            const int      rice  = g_goRiceParsCoeff[clip3( 0, 31, (int) ( ( *tpl >> 16 ) & 0xff ) - 4 * 5 )];
+            const uint32_t rem   = m_binDecoder.decodeRemAbsEP( rice, COEF_REMAIN_BIN_REDUCTION, MAX_LOG2_TR_DYNAMIC_RANGE );
+            const int      level = absLevel[k] + 2 * (int) rem;
+            xUpdateTpl( tpl, ( std::min( level, TPL_MAX_ABS ) - absLevel[k] ) << 16 );
+            absLevel[k] = level;
+        }
+
+        // third pass: dec_abs_level of the remaining positions
+        for( n = firstPosMode1; n >= 0; n-- ) {
+            uint32_t*      tpl     = tplOrigin + ( y0 + scan[n].y ) * m_tplStride + x0 + scan[n].x;
+            const int      rice    = g_goRiceParsCoeff[std::min<int>( ( *tpl >> 16 ) & 0xff, 31 )];
+            const uint32_t zeroPos = ( qState < 2 ? 1u : 2u ) << rice;
+            const uint32_t rem     = m_binDecoder.decodeRemAbsEP( rice, COEF_REMAIN_BIN_REDUCTION, MAX_LOG2_TR_DYNAMIC_RANGE );
+            setAbsLevel( n, tpl, rem == zeroPos ? 0 : rem < zeroPos ? rem + 1 : rem );
+        }
+
+        // coeff_sign_flag of all significant levels as one bypass batch, the first sign is the MSB
+        const bool signHidden = signHiding && lastSigScanPos - firstSigScanPos > 3;
+        int        numSigns   = __builtin_popcount( sigMask ) - signHidden;
+        const uint32_t signs  = m_binDecoder.decodeBinsEP( numSigns );
+
+        int sumAbsLevel = 0;
+        while( sigMask ) {
+            const int k = 31 - __builtin_clz( sigMask );
+            sigMask    &= ~( 1u << k );
+
+            const int xC    = x0 + scan[k].x;
+            const int yC    = y0 + scan[k].y;
+            const int level = depQuant ? 2 * absLevel[k] - qOffset[k] : absLevel[k];
+            sumAbsLevel    += absLevel[k];
+
+            bool negative;
+            if( signHidden && k == firstSigScanPos ) {
+                negative = sumAbsLevel & 1;
+            } else {
+                negative = ( signs >> --numSigns ) & 1;
+            }
+            coeffs.at( xC, yC ) = (TCoeffSig) ( negative ? -level : level );
+            maxX = std::max( maxX, xC );
+            maxY = std::max( maxY, yC );
+        }
+    }
+
+    tu.maxScanPosX[compID] = (uint8_t) maxX;
+    tu.maxScanPosY[compID] = (uint8_t) maxY;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "Common/Def.h"
+#include "Common/Buffer.h"
+#include "Common/Contexts.h"
+#include "Common/Unit.h"
+#include "BinDecoder.h"
+
+class Slice;
+
+// Parser of the CABAC coded syntax elements of the slice data.
+class CABACReader {
+public:
+    CABACReader()  = default;
+    ~CABACReader() = default;
+
+    void initCtxModels( const Slice& slice );
+    void initBitstream( InputBitstream* bitstream ) { m_binDecoder.start( bitstream ); }
+
+    // residual_coding() of a transform block with transform_skip_flag equal to 0. The TransCoeffLevel
+    // values are written to coeffs, which has the size of the transform block, and the largest column
+    // and row holding a non-zero level are stored in tu.maxScanPosX/maxScanPosY[compID].
+    void residual_coding( TransformUnit& tu, ComponentID compID, CoeffSigBuf coeffs );
+
+private:
+    // The template of a position are the two positions to its right, the two below it and the one below
+    // right. Instead of reading the five neighbours for every context, each decoded non-zero level is
+    // added to the sums of the five positions whose template contains it, so a context selection is one
+    // load. The three sums of a position are packed into one word and updated by one addition:
+    //   bits  0..7   sum of the AbsLevelPass1 values, Min( 4 + ( AbsLevel & 1 ), AbsLevel )
+    //   bits  8..15  the same sum minus the number of significant levels
+    //   bits 16..23  sum of Min( AbsLevel, TPL_MAX_ABS ), the Rice parameter saturates before that
+    static constexpr int      TPL_MAX_ABS  = 51;
+    static constexpr int      TPL_MAX_SIZE = 32;   // of the non zeroed-out part of a transform block
+    static constexpr int      TPL_MARGIN   = 2;    // the updates of the left and top positions need no bounds check
+    static constexpr int      SB_STRIDE    = 9;    // at most 8 coefficient groups per row, plus one for the right neighbour
+
+    static uint32_t xTplInc( int absLevel ) {
+        const int absPass1 = std::min( 4 + ( absLevel & 1 ), absLevel );
+        return absPass1 | ( absPass1 - 1 ) << 8 | std::min( absLevel, TPL_MAX_ABS ) << 16;
+    }
+    void xUpdateTpl( uint32_t* tpl, uint32_t inc ) const {
+        tpl[-1]                 += inc;
+        tpl[-2]                 += inc;
+        tpl[-m_tplStride]       += inc;
+        tpl[-m_tplStride - 1]   += inc;
+        tpl[-2 * m_tplStride]   += inc;
+    }
+
+    unsigned xReadLastSigCoeffPrefix( int log2TbSize, int log2ZoTbSize, const CtxSet& ctxSet, ChannelType chType );
+    unsigned xReadLastSigCoeffSuffix( unsigned prefix );
+
+    BinDecoder m_binDecoder;
+    CtxStore   m_ctx;
+
+    ptrdiff_t  m_tplStride = 0;
+    uint32_t   m_tplBuf  [( TPL_MAX_SIZE + TPL_MARGIN ) * ( TPL_MAX_SIZE + TPL_MARGIN )];
+    uint8_t    m_sbCoded [SB_STRIDE * SB_STRIDE];
+};
@@ -9,6 +9,6 @@ void DecLib::create() {
 
 Picture* DecLib::decode( InputNALUnit& nalu ) {
     bool newPic = m_decLibParser.parse( nalu );
-    Picture *pic = new Picture;
-    return pic;
+    // no picture is reconstructed yet
+    return nullptr;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <memory>
 #include <cmath>
+#include <algorithm>
 
 #include "DecLibParser.h"
 #include "Common/Slice.h"
@@ -7,6 +8,10 @@
 #include "Common/Common.h"
 
 bool DecLibParser::parse( InputNALUnit& nalu ) {
+    if( TRACING_ENABLED ) {
+        SyntaxTrace::get().nalUnit( nalu.m_nalUnitType, nalu.m_nuhLayerId, nalu.m_temporalId, nalu.getBitstream().getByteSize() );
+    }
+
     switch( nalu.m_nalUnitType ) {
     case NAL_UNIT_CODED_SLICE_TRAIL:
     case NAL_UNIT_CODED_SLICE_STSA:
@@ -16,6 +21,8 @@ bool DecLibParser::parse( InputNALUnit& nalu ) {
     case NAL_UNIT_CODED_SLICE_IDR_N_LP:
     case NAL_UNIT_CODED_SLICE_CRA:
     case NAL_UNIT_CODED_SLICE_GDR:
+        return xDecodeSlice( nalu );
+
     case NAL_UNIT_OPI:
         // NOT IMPLEMENTED
         return false;
@@ -31,22 +38,24 @@ bool DecLibParser::parse( InputNALUnit& nalu ) {
         return false;
 
     case NAL_UNIT_PPS:
-        //xDecodePPS( nalu );
+        xDecodePPS( nalu );
         return false;
 
     case NAL_UNIT_PREFIX_APS:
     case NAL_UNIT_SUFFIX_APS:
-        //xDecodeAPS( nalu );
+        xDecodeAPS( nalu );
         return false;
 
     case NAL_UNIT_PH:
-        //xDecodePicHeader( nalu );
+        xDecodePicHeader( nalu );
         return false;
 
     case NAL_UNIT_ACCESS_UNIT_DELIMITER:
         return false;
 
     case NAL_UNIT_EOS:
+        // the next picture starts a new coded video sequence
+        m_firstPicInSequence = true;
         return false;
 
     case NAL_UNIT_EOB:
@@ -84,9 +93,290 @@ bool DecLibParser::parse( InputNALUnit& nalu ) {
 }
 
 void DecLibParser::xDecodeSPS( InputNALUnit& nalu ) {
-    std::unique_ptr<SPS> sps( new SPS() );
-    m_HLSReader.setBitstream( &nalu.getBitstream() );
+    // the RBSP follows the NAL unit header, it starts with the 4 bit sps_seq_parameter_set_id
+    InputBitstream& bitstream = nalu.getBitstream();
+    const uint32_t  rbspStart = bitstream.getNumBitsRead() / 8;
+    CHECK( bitstream.getNumBitsUntilByteAligned() != 0 || rbspStart >= bitstream.getByteSize(), "Empty SPS NAL unit" );
+
+    const uint8_t*  rbsp      = bitstream.getData() + rbspStart;
+    const size_t    rbspSize  = bitstream.getByteSize() - rbspStart;
+    const int       spsId     = rbsp[0] >> 4;
+    const uint64_t  rbspHash  = decltype( m_spsMap )::hashRbsp( rbsp, rbspSize );
+
+    // a repetition of the stored SPS is neither parsed nor replaced, so it stays the active one
+    if( m_spsMap.getIdenticalPS( spsId, rbsp, rbspSize, rbspHash ) ) {
+        return;
+    }
+
+    std::shared_ptr<SPS> sps = std::make_shared<SPS>();
+    m_HLSReader.setBitstream( &bitstream );
     m_HLSReader.parseSPS( sps.get() );
+    m_spsMap.storePS( spsId, std::move( sps ), rbsp, rbspSize, rbspHash );
+}
+
+void DecLibParser::xDecodePPS( InputNALUnit& nalu ) {
+    // the RBSP starts with the 6 bit pps_pic_parameter_set_id
+    InputBitstream& bitstream = nalu.getBitstream();
+    const uint32_t  rbspStart = bitstream.getNumBitsRead() / 8;
+    CHECK( bitstream.getNumBitsUntilByteAligned() != 0 || rbspStart >= bitstream.getByteSize(), "Empty PPS NAL unit" );
+
+    const uint8_t*  rbsp      = bitstream.getData() + rbspStart;
+    const size_t    rbspSize  = bitstream.getByteSize() - rbspStart;
+    const int       ppsId     = rbsp[0] >> 2;
+    const uint64_t  rbspHash  = decltype( m_ppsMap )::hashRbsp( rbsp, rbspSize );
+
+    if( m_ppsMap.getIdenticalPS( ppsId, rbsp, rbspSize, rbspHash ) ) {
+        return;
+    }
+
+    std::shared_ptr<PPS> pps = std::make_shared<PPS>();
+    m_HLSReader.setBitstream( &bitstream );
+    m_HLSReader.parsePPS( pps.get() );
+    pps->setLayerId( nalu.m_nuhLayerId );
+    m_ppsMap.storePS( ppsId, std::move( pps ), rbsp, rbspSize, rbspHash );
+}
+
+void DecLibParser::xDecodeAPS( InputNALUnit& nalu ) {
+    // the RBSP starts with the 3 bit aps_params_type and the 5 bit aps_adaptation_parameter_set_id
+    InputBitstream& bitstream = nalu.getBitstream();
+    const uint32_t  rbspStart = bitstream.getNumBitsRead() / 8;
+    CHECK( bitstream.getNumBitsUntilByteAligned() != 0 || rbspStart >= bitstream.getByteSize(), "Empty APS NAL unit" );
+
+    const uint8_t*  rbsp      = bitstream.getData() + rbspStart;
+    const size_t    rbspSize  = bitstream.getByteSize() - rbspStart;
+    const int       apsType   = rbsp[0] >> 5;
+    const int       apsId     = rbsp[0] & 31;
+
+    // APSs with a reserved type are ignored
+    if( apsType >= NUM_APS_TYPES ) {
+        return;
+    }
+    CHECK( apsId >= ( apsType == LMCS_APS ? MAX_NUM_LMCS_APS_IDS : MAX_NUM_APS_IDS ), "Invalid aps_adaptation_parameter_set_id" );
+
+    const int       apsKey    = APS::getMapKey( ApsType( apsType ), apsId );
+    const uint64_t  rbspHash  = decltype( m_apsMap )::hashRbsp( rbsp, rbspSize );
+
+    // a repeated APS keeps its derived tables
+    if( m_apsMap.getIdenticalPS( apsKey, rbsp, rbspSize, rbspHash ) ) {
+        return;
+    }
+
+    std::shared_ptr<APS> aps = std::make_shared<APS>();
+    m_HLSReader.setBitstream( &bitstream );
+    m_HLSReader.parseAPS( aps.get() );
+    aps->setLayerId( nalu.m_nuhLayerId );
+    m_apsMap.storePS( apsKey, std::move( aps ), rbsp, rbspSize, rbspHash );
+}
+
+// Starts a new picture. The slices of the previous picture go back to the pool, and its picture header is
+// reused unless something else still holds on to it.
+void DecLibParser::xNewPicHeader() {
+    for( auto& slice : m_slices )
+    {
+        slice->setPicHeader( nullptr );
+        m_unusedSlices.push_back( std::move( slice ) );
+    }
+    m_slices.clear();
+
+    if( m_picHeader && m_picHeader.use_count() == 1 )
+    {
+        *m_picHeader = PicHeader();
+    }
+    else
+    {
+        m_picHeader = std::make_shared<PicHeader>();
+    }
+}
+
+void DecLibParser::xDecodePicHeader( InputNALUnit& nalu ) {
+    // a picture header NAL unit starts a new picture, the picture header is shared by all its slices
+    xNewPicHeader();
+
+    m_HLSReader.setBitstream( &nalu.getBitstream() );
+    m_HLSReader.parsePicHeader( m_picHeader.get(), m_spsMap, m_ppsMap, true );
+}
+
+bool DecLibParser::xDecodeSlice( InputNALUnit& nalu ) {
+    m_HLSReader.setBitstream( &nalu.getBitstream() );
+
+    const bool picHeaderInSliceHeader = m_HLSReader.parsePictureHeaderInSliceHeaderFlag();
+    if( picHeaderInSliceHeader )
+    {
+        xNewPicHeader();
+        m_HLSReader.parsePicHeader( m_picHeader.get(), m_spsMap, m_ppsMap, false );
+    }
+    CHECK( !m_picHeader, "Slice without a picture header" );
+    CHECK( !picHeaderInSliceHeader && !m_slices.empty() && m_slices.front()->getPictureHeaderInSliceHeader(),
+           "A picture with the picture header in the slice header has only one slice" );
+
+    // the state derived from the picture header is derived with the first slice and reused by the others
+    if( !m_picHeader->isValid() )
+    {
+        xStartPicture( nalu );
+    }
+
+    std::unique_ptr<Slice> slice;
+    if( m_unusedSlices.empty() )
+    {
+        slice.reset( new Slice );
+    }
+    else
+    {
+        slice = std::move( m_unusedSlices.back() );
+        m_unusedSlices.pop_back();
+        slice->initSlice();
+    }
+    slice->setSeqPicContext( m_picHeader->getSeqPicContext() );
+    slice->setPicHeader( m_picHeader );
+    slice->setPictureHeaderInSliceHeader( picHeaderInSliceHeader );
+    slice->setPOC( m_picHeader->getPOC() );
+    slice->setNalUnitType( nalu.m_nalUnitType );
+    slice->setTLayer( nalu.m_temporalId );
+    slice->setNalUnitLayerId( nalu.m_nuhLayerId );
+    m_HLSReader.parseSliceHeader( slice.get() );
+
+    const SeqPicContext& ctx = slice->getSeqPicContext();
+    if( !ctx.pps->getRplInfoInPhFlag() )
+    {
+        slice->getSliceRPL( REF_PIC_LIST_0 )->derivePOCs( slice->getPOC(), ctx.sps->getBitsForPOC() );
+        slice->getSliceRPL( REF_PIC_LIST_1 )->derivePOCs( slice->getPOC(), ctx.sps->getBitsForPOC() );
+    }
+    if( !ctx.pps->getAlfInfoInPhFlag() )
+    {
+        xResolveAlfAPSs( slice->getSliceAlfControls(), ctx.bitDepth );
+    }
+
+    m_slices.push_back( std::move( slice ) );
+    return false;
+}
+
+void DecLibParser::xStartPicture( const InputNALUnit& nalu ) {
+    PicHeader& picHeader = *m_picHeader;
+    picHeader.setSeqPicContext( xActivateParameterSets( picHeader.getPPSId() ) );
+
+    const SeqPicContext& ctx     = *picHeader.getSeqPicContext();
+    const NalUnitType    nalType = nalu.m_nalUnitType;
+
+    // PicOrderCntVal, the MSBs continue from the previous temporal sub-layer 0 picture unless they are signalled
+    // or the picture starts a coded layer video sequence
+    const int  maxPocLsb = 1 << ctx.sps->getBitsForPOC();
+    const int  pocLsb    = picHeader.getPocLsb();
+    const bool isIdr     = nalType == NAL_UNIT_CODED_SLICE_IDR_W_RADL || nalType == NAL_UNIT_CODED_SLICE_IDR_N_LP;
+    const bool isClvss   = isIdr || ( ( nalType == NAL_UNIT_CODED_SLICE_CRA || nalType == NAL_UNIT_CODED_SLICE_GDR ) && m_firstPicInSequence );
+
+    int pocMsb = 0;
+    if( picHeader.getPocMsbPresentFlag() )
+    {
+        pocMsb = picHeader.getPocMsbVal() * maxPocLsb;
+    }
+    else if( !isClvss )
+    {
+        const int prevPocLsb = m_prevTid0POC & ( maxPocLsb - 1 );
+        const int prevPocMsb = m_prevTid0POC - prevPocLsb;
+        if( pocLsb < prevPocLsb && prevPocLsb - pocLsb >= maxPocLsb / 2 )
+        {
+            pocMsb = prevPocMsb + maxPocLsb;
+        }
+        else if( pocLsb > prevPocLsb && pocLsb - prevPocLsb > maxPocLsb / 2 )
+        {
+            pocMsb = prevPocMsb - maxPocLsb;
+        }
+        else
+        {
+            pocMsb = prevPocMsb;
+        }
+    }
+
+    const int poc = pocMsb + pocLsb;
+    picHeader.setPOC( poc );
+    if( nalu.m_temporalId == 0 && nalType != NAL_UNIT_CODED_SLICE_RASL && nalType != NAL_UNIT_CODED_SLICE_RADL && !picHeader.getNonReferencePictureFlag() )
+    {
+        m_prevTid0POC = poc;
+    }
+    m_prevPOC            = poc;
+    m_firstPicInSequence = false;
+
+    if( ctx.pps->getRplInfoInPhFlag() )
+    {
+        picHeader.getRPL( REF_PIC_LIST_0 )->derivePOCs( poc, ctx.sps->getBitsForPOC() );
+        picHeader.getRPL( REF_PIC_LIST_1 )->derivePOCs( poc, ctx.sps->getBitsForPOC() );
+    }
+
+    // the APSs are looked up once, a later APS with the same id does not affect the current picture
+    if( ctx.pps->getAlfInfoInPhFlag() )
+    {
+        xResolveAlfAPSs( picHeader.getAlfControls(), ctx.bitDepth );
+    }
+    if( picHeader.getLmcsEnabledFlag() )
+    {
+        picHeader.setLmcsAPS( xGetAPS( LMCS_APS, picHeader.getLmcsAPSId(), ctx.bitDepth ) );
+    }
+    if( picHeader.getExplicitScalingListEnabledFlag() )
+    {
+        picHeader.setScalingListAPS( xGetAPS( SCALING_LIST_APS, picHeader.getScalingListAPSId(), ctx.bitDepth ) );
+    }
+
+    picHeader.setValid();
+}
+
+void DecLibParser::xResolveAlfAPSs( AlfControls& alf, int bitDepth ) {
+    if( alf.enabled[COMPONENT_Y] )
+    {
+        for( int i = 0; i < alf.numLumaAps; i++ )
+        {
+            alf.lumaAps[i] = xGetAPS( ALF_APS, alf.lumaApsId[i], bitDepth );
+        }
+    }
+    if( alf.enabled[COMPONENT_Cb] || alf.enabled[COMPONENT_Cr] )
+    {
+        alf.chromaAps = xGetAPS( ALF_APS, alf.chromaApsId, bitDepth );
+    }
+    for( int comp = COMPONENT_Cb; comp <= COMPONENT_Cr; comp++ )
+    {
+        if( alf.ccEnabled[comp] )
+        {
+            alf.ccAps[comp] = xGetAPS( ALF_APS, alf.ccApsId[comp], bitDepth );
+        }
+    }
+}
+
+std::shared_ptr<const APS> DecLibParser::xGetAPS( ApsType apsType, int apsId, int bitDepth ) {
+    const int            apsKey = APS::getMapKey( apsType, apsId );
+    std::shared_ptr<APS> aps    = m_apsMap.getPS( apsKey );
+    CHECK( !aps, "The referenced APS has not been received" );
+
+    if( aps->getTablesBitDepth() != bitDepth ) {
+        // tables derived for another bit depth may still be in use by pictures of the previous CLVS
+        if( aps->getTablesBitDepth() != 0 ) {
+            aps = std::make_shared<APS>( *aps );
+            m_apsMap.replacePS( apsKey, aps );
+        }
+        aps->deriveTables( bitDepth );
+    }
+    return aps;
+}
+
+std::shared_ptr<const SeqPicContext> DecLibParser::xActivateParameterSets( int ppsId ) {
+    std::shared_ptr<PPS> pps = m_ppsMap.getPS( ppsId );
+    CHECK( !pps, "The referenced PPS has not been received" );
+    const std::shared_ptr<SPS> sps = m_spsMap.getPS( pps->getSPSId() );
+    CHECK( !sps, "The SPS referenced by the PPS has not been received" );
+
+    // the context stays valid until the SPS or the PPS is replaced by a parameter set with different content
+    std::shared_ptr<const SeqPicContext>& ctx = m_seqPicCtx[ppsId];
+    if( ctx && ctx->sps == sps && ctx->pps == pps ) {
+        return ctx;
+    }
+
+    // the tile and slice lookup tables depend on the CTU size and the sub-pictures of the SPS
+    if( ctx && ctx->pps == pps ) {
+        // the maps derived for the previous SPS may still be in use by pictures of the previous CLVS
+        pps = std::make_shared<PPS>( *pps );
+        m_ppsMap.replacePS( ppsId, pps );
+    }
+    pps->initTileSliceMaps( *sps );
+    ctx = SeqPicContext::create( sps, pps );
+    return ctx;
 }
 
 void HLSyntaxReader::parseSPS( SPS* sps ) {
@@ -119,7 +409,7 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
     sps->setPtlDpbHrdParamsPresentFlag( sps_ptl_dpb_hrd_params_present_flag );
 
     if( sps_ptl_dpb_hrd_params_present_flag ) {
-        // parseProfileTierLevel( sps->getProfileTierLevel(), true, sps->getMaxTLayers() - 1 );
+        parseProfileTierLevel( true, sps_max_sublayers_minus1 );
     }
 
     X_READ_FLAG( sps_gdr_enabled_flag );
@@ -169,6 +459,7 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
             "When sps_res_change_in_clvs_allowed_flag is equal to 1, the value of sps_subpic_info_present_flag shall be equal to 0." )
     sps->setSubPicInfoPresentFlag( sps_subpic_info_present_flag );
 
+    if( sps_subpic_info_present_flag )
     {
         X_READ_UVLC_NO_RANGE( sps_num_subpics_minus1 );
         CHECK( sps_num_subpics_minus1 + 1 > ( ( sps_pic_width_max_in_luma_samples + CtbSizeY - 1 ) / CtbSizeY )
@@ -367,9 +658,50 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
     X_READ_CODE( sps_num_extra_ph_bytes, 2, 0, 2 );
     sps->setNumExtraPHBitsBytes( sps_num_extra_ph_bytes );
 
+    std::vector<bool> extraPhBitPresentFlags( 8 * sps_num_extra_ph_bytes );
+    for( unsigned i = 0; i < 8 * sps_num_extra_ph_bytes; i++ )
+    {
+        X_READ_FLAG_idx( sps_extra_ph_bit_present_flag, "[ i ]" );
+        extraPhBitPresentFlags[i] = sps_extra_ph_bit_present_flag;
+    }
+    sps->setExtraPHBitPresentFlags( std::move( extraPhBitPresentFlags ) );
+
     X_READ_CODE( sps_num_extra_sh_bytes, 2, 0, 2 );
     sps->setNumExtraSHBitsBytes( sps_num_extra_sh_bytes );
 
+    std::vector<bool> extraShBitPresentFlags( 8 * sps_num_extra_sh_bytes );
+    for( unsigned i = 0; i < 8 * sps_num_extra_sh_bytes; i++ )
+    {
+        X_READ_FLAG_idx( sps_extra_sh_bit_present_flag, "[ i ]" );
+        extraShBitPresentFlags[i] = sps_extra_sh_bit_present_flag;
+    }
+    sps->setExtraSHBitPresentFlags( std::move( extraShBitPresentFlags ) );
+
+    if( sps_ptl_dpb_hrd_params_present_flag )
+    {
+        if( sps_max_sublayers_minus1 > 0 )
+        {
+            X_READ_FLAG( sps_sublayer_dpb_params_flag );
+            sps->setSubLayerDpbParamsFlag( sps_sublayer_dpb_params_flag );
+        }
+
+        // dpb_parameters( sps_max_sublayers_minus1, sps_sublayer_dpb_params_flag )
+        for( unsigned i = sps->getSubLayerDpbParamsFlag() ? 0 : sps_max_sublayers_minus1; i <= sps_max_sublayers_minus1; i++ )
+        {
+            X_READ_UVLC_idx( dpb_max_dec_pic_buffering_minus1, "[ i ]", 0, MAX_NUM_REF_PICS - 1 );
+            X_READ_UVLC_idx( dpb_max_num_reorder_pics, "[ i ]", 0, dpb_max_dec_pic_buffering_minus1 );
+            X_READ_UVLC_NO_RANGE_idx( dpb_max_latency_increase_plus1, "[ i ]" );
+
+            // values of lower sublayers that are not signalled are inferred from the highest one
+            for( unsigned j = sps->getSubLayerDpbParamsFlag() ? i : 0; j <= i; j++ )
+            {
+                sps->setMaxDecPicBuffering( dpb_max_dec_pic_buffering_minus1 + 1, j );
+                sps->setNumReorderPics( dpb_max_num_reorder_pics, j );
+                sps->setMaxLatencyIncreasePlus1( dpb_max_latency_increase_plus1, j );
+            }
+        }
+    }
+
     X_READ_UVLC( sps_log2_min_luma_coding_block_size_minus2, 0, std::min( 4u, sps_log2_ctu_size_minus5 + 3 ) );
     sps->setLog2MinCodingBlockSize( sps_log2_min_luma_coding_block_size_minus2 + 2 );
 
@@ -517,6 +849,32 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
 
         X_READ_FLAG( sps_same_qp_table_for_chroma_flag );
 
+        ChromaQpMappingTableParams chromaQpMappingTableParams;
+        chromaQpMappingTableParams.m_qpBdOffset                   = QpBdOffset;
+        chromaQpMappingTableParams.m_sameCQPTableForAllChromaFlag = sps_same_qp_table_for_chroma_flag;
+        chromaQpMappingTableParams.m_numQpTables                  = sps_same_qp_table_for_chroma_flag ? 1 : ( sps_joint_cbcr_enabled_flag ? 3 : 2 );
+
+        for( int i = 0; i < chromaQpMappingTableParams.m_numQpTables; i++ )
+        {
+            X_READ_SVLC_idx( sps_qp_table_start_minus26, "[ i ]", -26 - QpBdOffset, 36 );
+            chromaQpMappingTableParams.m_qpTableStartMinus26[i] = sps_qp_table_start_minus26;
+
+            X_READ_UVLC_idx( sps_num_points_in_qp_table_minus1, "[ i ]", 0, 36 - sps_qp_table_start_minus26 );
+            chromaQpMappingTableParams.m_numPtsInCQPTableMinus1[i] = sps_num_points_in_qp_table_minus1;
+            chromaQpMappingTableParams.m_deltaQpInValMinus1[i].resize( sps_num_points_in_qp_table_minus1 + 1 );
+            chromaQpMappingTableParams.m_deltaQpOutVal     [i].resize( sps_num_points_in_qp_table_minus1 + 1 );
+
+            for( unsigned j = 0; j <= sps_num_points_in_qp_table_minus1; j++ )
+            {
+                X_READ_UVLC_idx( sps_delta_qp_in_val_minus1, "[ i ][ j ]", 0, MAX_QP + QpBdOffset );
+                chromaQpMappingTableParams.m_deltaQpInValMinus1[i][j] = sps_delta_qp_in_val_minus1;
+
+                X_READ_UVLC_idx( sps_delta_qp_diff_val, "[ i ][ j ]", 0, MAX_QP + QpBdOffset );
+                chromaQpMappingTableParams.m_deltaQpOutVal[i][j] = sps_delta_qp_diff_val;
+            }
+        }
+        sps->setChromaQpMappingTableFromParams( chromaQpMappingTableParams );
+        sps->deriveChromaQPMappingTables();
     }
 
 
@@ -563,10 +921,20 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
     X_READ_FLAG( sps_rpl1_same_as_rpl0_flag );
     sps->setRPL1CopyFromRPL0Flag( sps_rpl1_same_as_rpl0_flag );
 
-    for( unsigned i = 0; i < ( sps_rpl1_same_as_rpl0_flag ? 1 : 2 ); i++ ) {
-        X_READ_UVLC_idx( sps_num_ref_pic_lists, "[i]", 0, 64 );
+    for( unsigned i = 0; i < ( sps_rpl1_same_as_rpl0_flag ? 1 : 2 ); i++ )
+    {
+        X_READ_UVLC_idx( sps_num_ref_pic_lists, "[ i ]", 0, 64 );
+
+        RPLList& rplList = sps->createRPLList( i, sps_num_ref_pic_lists );
+        for( unsigned j = 0; j < sps_num_ref_pic_lists; j++ )
+        {
+            parseRefPicList( sps, &rplList[j], j );
+        }
     }
-    if( sps_rpl1_same_as_rpl0_flag ) {
+
+    if( sps_rpl1_same_as_rpl0_flag )
+    {
+        sps->createRPLList( 1, sps->getNumRPL( 0 ) ) = sps->getRPLList( 0 );
     }
 
 
@@ -636,6 +1004,7 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
     if( sps_affine_enabled_flag )
     {
         X_READ_UVLC( sps_five_minus_max_num_subblock_merge_cand, 0, 5 - sps->getSBTMVPEnabledFlag() );
+        sps->setMaxNumAffineMergeCand( AFFINE_MRG_MAX_NUM_CANDS - sps_five_minus_max_num_subblock_merge_cand );
         X_READ_FLAG( sps_6param_affine_enabled_flag );
         sps->setUseAffineType( sps_6param_affine_enabled_flag );
 
@@ -722,6 +1091,33 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
     X_READ_FLAG( sps_ibc_enabled_flag );
     sps->setIBCFlag( sps_ibc_enabled_flag );
 
+    if( sps_ibc_enabled_flag )
+    {
+        X_READ_UVLC( sps_six_minus_max_num_ibc_merge_cand, 0, 5 );
+        sps->setMaxNumIBCMergeCand( IBC_MRG_MAX_NUM_CANDS - sps_six_minus_max_num_ibc_merge_cand );
+    }
+
+    X_READ_FLAG( sps_ladf_enabled_flag );
+    sps->setLadfEnabled( sps_ladf_enabled_flag );
+
+    if( sps_ladf_enabled_flag )
+    {
+        X_READ_CODE( sps_num_ladf_intervals_minus2, 2, 0, 3 );
+        sps->setLadfNumIntervals( sps_num_ladf_intervals_minus2 + 2 );
+
+        X_READ_SVLC( sps_ladf_lowest_interval_qp_offset, -63, 63 );
+        sps->setLadfQpOffset( sps_ladf_lowest_interval_qp_offset, 0 );
+
+        for( unsigned i = 0; i < sps_num_ladf_intervals_minus2 + 1; i++ )
+        {
+            X_READ_SVLC_idx( sps_ladf_qp_offset, "[ i ]", -63, 63 );
+            sps->setLadfQpOffset( sps_ladf_qp_offset, i + 1 );
+
+            X_READ_UVLC_idx( sps_ladf_delta_threshold_minus1, "[ i ]", 0, ( 1u << BitDepth ) - 3 );
+            sps->setLadfIntervalLowerBound( sps->getLadfIntervalLowerBound( i ) + sps_ladf_delta_threshold_minus1 + 1, i + 1 );
+        }
+    }
+
     X_READ_FLAG( sps_explicit_scaling_list_enabled_flag );
     sps->setScalingListFlag( sps_explicit_scaling_list_enabled_flag );
 
@@ -759,7 +1155,7 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
 
         if( sps_virtual_boundaries_present_flag )
         {
-        X_READ_UVLC( sps_num_ver_virtual_boundaries, 0, sps_pic_width_max_in_luma_samples <= 8 ? 0 : 3 );
+        X_READ_CODE( sps_num_ver_virtual_boundaries, 2, 0, sps_pic_width_max_in_luma_samples <= 8 ? 0 : 3 );
         sps->setNumVerVirtualBoundaries( sps_num_ver_virtual_boundaries );
 
         for( unsigned i = 0; i < sps_num_ver_virtual_boundaries; i++ )
@@ -768,7 +1164,7 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
             sps->setVirtualBoundariesPosX( ( sps_virtual_boundary_pos_x_minus1 + 1 ) << 3, i );
         }
 
-        X_READ_UVLC_idx( sps_num_hor_virtual_boundaries, "[i]", 0, sps_pic_height_max_in_luma_samples <= 8 ? 0 : 3  );
+        X_READ_CODE( sps_num_hor_virtual_boundaries, 2, 0, sps_pic_height_max_in_luma_samples <= 8 ? 0 : 3 );
         sps->setNumHorVirtualBoundaries( sps_num_hor_virtual_boundaries );
 
         for( unsigned i = 0; i <sps_num_hor_virtual_boundaries; i++ )
@@ -779,8 +1175,25 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
         }
     }
 
-    if( sps_ptl_dpb_hrd_params_present_flag ) {
+    if( sps_ptl_dpb_hrd_params_present_flag )
+    {
+        X_READ_FLAG( sps_timing_hrd_params_present_flag );
+        sps->setGeneralHrdParametersPresentFlag( sps_timing_hrd_params_present_flag );
+
+        if( sps_timing_hrd_params_present_flag )
+        {
+            GeneralHrdParams hrd;
+            parseGeneralHrdParameters( hrd );
+
+            if( sps_max_sublayers_minus1 > 0 )
+            {
+                X_READ_FLAG( sps_sublayer_cpb_params_present_flag );
+                sps->setSubLayerParametersPresentFlag( sps_sublayer_cpb_params_present_flag );
+            }
 
+            const int firstSubLayer = sps->getSubLayerParametersPresentFlag() ? 0 : sps_max_sublayers_minus1;
+            parseOlsHrdParameters( hrd, firstSubLayer, sps_max_sublayers_minus1 );
+        }
     }
 
     X_READ_FLAG( sps_field_seq_flag );
@@ -799,240 +1212,2316 @@ void HLSyntaxReader::parseSPS( SPS* sps ) {
         X_READ_FLAG( sps_vui_alignment_zero_bit );
         CHECK( sps_vui_alignment_zero_bit, "sps_vui_alignment_zero_bit not equal to 0" );
         }
+
+        // vui_payload() only carries display information
+        CHECK( m_pcBitstream->getNumBitsLeft() < 8 * sps->getVuiPayloadSize(), "sps_vui_payload_size_minus1 exceeds the SPS size" );
+        for( unsigned i = 0; i < sps->getVuiPayloadSize(); i++ )
+        {
+            m_pcBitstream->read( 8 );
+        }
     }
 
     X_READ_FLAG( sps_extension_present_flag );
     if( sps_extension_present_flag )
     {
-        while( xMoreRbspData() )
+        X_READ_FLAG( sps_range_extension_flag );
+        X_READ_CODE_NO_RANGE( sps_extension_7bits, 7 );
+
+        if( sps_range_extension_flag )
+        {
+            X_READ_FLAG( sps_extended_precision_flag );
+            CHECK( sps_extended_precision_flag, "extended precision processing is not yet supported" );
+
+            if( sps_transform_skip_enabled_flag )
+            {
+                X_READ_FLAG( sps_ts_residual_coding_rice_present_in_sh_flag );
+                CHECK( sps_ts_residual_coding_rice_present_in_sh_flag, "sps_ts_residual_coding_rice_present_in_sh_flag is not yet supported" );
+            }
+
+            X_READ_FLAG( sps_rrc_rice_extension_flag );
+            CHECK( sps_rrc_rice_extension_flag, "sps_rrc_rice_extension_flag is not yet supported" );
+
+            X_READ_FLAG( sps_persistent_rice_adaptation_enabled_flag );
+            CHECK( sps_persistent_rice_adaptation_enabled_flag, "persistent Rice adaptation is not yet supported" );
+
+            X_READ_FLAG( sps_reverse_last_sig_coeff_enabled_flag );
+            CHECK( sps_reverse_last_sig_coeff_enabled_flag, "sps_reverse_last_sig_coeff_enabled_flag is not yet supported" );
+        }
+
+        if( sps_extension_7bits )
         {
-        X_READ_FLAG( sps_extension_data_flag );
-        (void)sps_extension_data_flag;
+            while( xMoreRbspData() )
+            {
+            X_READ_FLAG( sps_extension_data_flag );
+            (void)sps_extension_data_flag;
+            }
         }
     }
 
     xReadRbspTrailingBits();
 }
 
-bool HLSyntaxReader::xMoreRbspData() {
-    int bitsLeft = m_pcBitstream->getNumBitsLeft();
+void HLSyntaxReader::parsePPS( PPS* pps ) {
+    X_READ_CODE_NO_RANGE( pps_pic_parameter_set_id, 6 );
+    pps->setPPSId( pps_pic_parameter_set_id );
 
-    // if there are more than 8 bits, it cannot be rbsp_trailing_bits
-    if( bitsLeft > 8 )
-    {
-        return true;
-    }
+    X_READ_CODE_NO_RANGE( pps_seq_parameter_set_id, 4 );
+    pps->setSPSId( pps_seq_parameter_set_id );
 
-    uint8_t lastByte = m_pcBitstream->peekBits( bitsLeft );
-    int cnt = bitsLeft;
+    X_READ_FLAG( pps_mixed_nalu_types_in_pic_flag );
+    pps->setMixedNaluTypesInPicFlag( pps_mixed_nalu_types_in_pic_flag );
 
-    // remove trailing bits equal to zero
-    while( ( cnt > 0 ) && ( ( lastByte & 1 ) == 0 ) )
+    X_READ_UVLC_NO_RANGE( pps_pic_width_in_luma_samples );
+    pps->setPicWidthInLumaSamples( pps_pic_width_in_luma_samples );
+
+    X_READ_UVLC_NO_RANGE( pps_pic_height_in_luma_samples );
+    pps->setPicHeightInLumaSamples( pps_pic_height_in_luma_samples );
+    CHECK( pps_pic_width_in_luma_samples == 0 || pps_pic_height_in_luma_samples == 0, "Invalid picture size in the PPS" );
+
+    X_READ_FLAG( pps_conformance_window_flag );
+    pps->setConformanceWindowPresentFlag( pps_conformance_window_flag );
+
+    if( pps_conformance_window_flag )
     {
-        lastByte >>= 1;
-        cnt--;
+        X_READ_UVLC_NO_RANGE( pps_conf_win_left_offset );
+        X_READ_UVLC_NO_RANGE( pps_conf_win_right_offset );
+        X_READ_UVLC_NO_RANGE( pps_conf_win_top_offset );
+        X_READ_UVLC_NO_RANGE( pps_conf_win_bottom_offset );
+        pps->getConformanceWindow().setWindow( pps_conf_win_left_offset, pps_conf_win_right_offset, pps_conf_win_top_offset, pps_conf_win_bottom_offset );
     }
-    // remove bit equal to one
-    cnt--;
 
-    // we should not have a negative number of bits
-    CHECK( cnt<0, "Negative number of bits") ;
+    X_READ_FLAG( pps_scaling_window_explicit_signalling_flag );
+    if( pps_scaling_window_explicit_signalling_flag )
+    {
+        X_READ_SVLC_NO_RANGE( pps_scaling_win_left_offset );
+        X_READ_SVLC_NO_RANGE( pps_scaling_win_right_offset );
+        X_READ_SVLC_NO_RANGE( pps_scaling_win_top_offset );
+        X_READ_SVLC_NO_RANGE( pps_scaling_win_bottom_offset );
+        pps->getScalingWindow().setWindow( pps_scaling_win_left_offset, pps_scaling_win_right_offset, pps_scaling_win_top_offset, pps_scaling_win_bottom_offset );
+    }
+    else
+    {
+        // when not present, the scaling window is the conformance window
+        pps->setScalingWindow( pps->getConformanceWindow() );
+    }
 
-    // we have more data, if cnt is not zero
-    return ( cnt>0 );
-}
+    X_READ_FLAG( pps_output_flag_present_flag );
+    pps->setOutputFlagPresentFlag( pps_output_flag_present_flag );
 
-void VLCReader::xReadFlag( uint32_t& ruiCode )
-{
-    ruiCode = m_pcBitstream->read( 1 );
-}
+    X_READ_FLAG( pps_no_pic_partition_flag );
+    pps->setNoPicPartitionFlag( pps_no_pic_partition_flag );
 
-void VLCReader::xReadUvlc( uint32_t& ruiVal )
-{
-    uint32_t uiVal = 0;
-    uint32_t uiCode = 0;
-    uint32_t uiLength = 0;
+    X_READ_FLAG( pps_subpic_id_mapping_present_flag );
+    pps->setSubPicIdMappingPresentFlag( pps_subpic_id_mapping_present_flag );
 
-    uiCode = m_pcBitstream->read( 1 );
-    if( 0 == uiCode )
+    if( pps_subpic_id_mapping_present_flag )
     {
-        uiLength = 0;
-
-        while( ! ( uiCode & 1 ) )
+        if( !pps_no_pic_partition_flag )
+        {
+            X_READ_UVLC( pps_num_subpics_minus1, 0, MAX_NUM_SUB_PICS - 1 );
+            pps->setNumSubPics( pps_num_subpics_minus1 + 1 );
+        }
+        else
         {
-            uiCode = m_pcBitstream->read( 1 );
-            uiLength++;
+            pps->setNumSubPics( 1 );
         }
 
-        uiVal = m_pcBitstream->read( uiLength );
+        X_READ_UVLC( pps_subpic_id_len_minus1, 0, 15 );
+        pps->setSubPicIdLen( pps_subpic_id_len_minus1 + 1 );
 
-        uiVal += ( 1 << uiLength ) - 1;
+        for( uint32_t picIdx = 0; picIdx < pps->getNumSubPics(); picIdx++ )
+        {
+            X_READ_CODE_NO_RANGE_idx( pps_subpic_id, "[ i ]", pps->getSubPicIdLen() );
+            pps->setSubPicId( picIdx, pps_subpic_id );
+        }
     }
 
-    ruiVal = uiVal;
-}
-
-void VLCReader::xReadSvlc( int32_t& riVal )
-{
-    uint32_t uiBits = m_pcBitstream->read( 1 );
-    if( 0 == uiBits )
+    if( !pps_no_pic_partition_flag )
     {
-        uint32_t uiLength = 0;
+        X_READ_CODE( pps_log2_ctu_size_minus5, 2, 0, 2 );
+        pps->setLog2CtuSize( pps_log2_ctu_size_minus5 + 5 );
+
+        X_READ_UVLC( pps_num_exp_tile_columns_minus1, 0, std::min<uint32_t>( pps->getPicWidthInCtu(), MAX_TILE_COLS ) - 1 );
+        pps->setNumExpTileColumns( pps_num_exp_tile_columns_minus1 + 1 );
+
+        X_READ_UVLC( pps_num_exp_tile_rows_minus1, 0, std::min<uint32_t>( pps->getPicHeightInCtu(), MAX_TILES ) - 1 );
+        pps->setNumExpTileRows( pps_num_exp_tile_rows_minus1 + 1 );
 
-        while( ! ( uiBits & 1 ) )
+        for( uint32_t colIdx = 0; colIdx <= pps_num_exp_tile_columns_minus1; colIdx++ )
         {
-            uiBits = m_pcBitstream->read( 1 );
-            uiLength++;
+            X_READ_UVLC_idx( pps_tile_column_width_minus1, "[ i ]", 0, pps->getPicWidthInCtu() - 1 );
+            pps->addTileColumnWidth( pps_tile_column_width_minus1 + 1 );
         }
+        for( uint32_t rowIdx = 0; rowIdx <= pps_num_exp_tile_rows_minus1; rowIdx++ )
+        {
+            X_READ_UVLC_idx( pps_tile_row_height_minus1, "[ i ]", 0, pps->getPicHeightInCtu() - 1 );
+            pps->addTileRowHeight( pps_tile_row_height_minus1 + 1 );
+        }
+        pps->initTiles();
 
-        uiBits = m_pcBitstream->read( uiLength );
-
-        uiBits += ( 1 << uiLength );
-        riVal = ( uiBits & 1 ) ? -(int32_t)( uiBits>>1 ) : (int32_t)( uiBits>>1 );
-    }
-    else
-    {
-        riVal = 0;
-    }
-}
+        const uint32_t NumTileColumns = pps->getNumTileColumns();
+        const uint32_t NumTileRows    = pps->getNumTileRows();
 
-void VLCReader::xReadCode( uint32_t uiLength, uint32_t& ruiCode )
-{
-    CHECK( uiLength == 0, "Reading a code of lenght '0'" );
-    ruiCode = m_pcBitstream->read( uiLength );
-}
+        if( pps->getNumTiles() > 1 )
+        {
+            X_READ_FLAG( pps_loop_filter_across_tiles_enabled_flag );
+            pps->setLoopFilterAcrossTilesEnabledFlag( pps_loop_filter_across_tiles_enabled_flag );
 
-void VLCReader::xReadSCode( uint32_t length, int32_t& value )
-{
-    CHECK( length == 0 || length > 31, "wrong" );
-    uint32_t val = m_pcBitstream->read( length );
-    value = length >= 32 ? int32_t( val ) : ( ( -int32_t( val & ( uint32_t( 1 ) << ( length - 1 ) ) ) ) | int32_t( val ) );
-}
+            X_READ_FLAG( pps_rect_slice_flag );
+            pps->setRectSliceFlag( pps_rect_slice_flag );
+        }
+        else
+        {
+            pps->setLoopFilterAcrossTilesEnabledFlag( false );
+            pps->setRectSliceFlag( true );
+        }
 
-void VLCReader::xReadFlag( uint32_t& rValue, const char *pSymbolName )
-{
-    xReadFlag( rValue );
-}
+        if( pps->getRectSliceFlag() )
+        {
+            X_READ_FLAG( pps_single_slice_per_subpic_flag );
+            pps->setSingleSlicePerSubPicFlag( pps_single_slice_per_subpic_flag );
+        }
 
-void VLCReader::xReadUvlc( uint32_t& rValue, const char *pSymbolName )
-{
-    xReadUvlc( rValue );
-}
+        if( pps->getRectSliceFlag() && !pps->getSingleSlicePerSubPicFlag() )
+        {
+            X_READ_UVLC( pps_num_slices_in_pic_minus1, 0, MAX_SLICES - 1 );
+            pps->setNumSlicesInPic( pps_num_slices_in_pic_minus1 + 1 );
 
-void VLCReader::xReadSvlc( int32_t& rValue, const char *pSymbolName )
-{
-    xReadSvlc( rValue );
-}
+            if( pps_num_slices_in_pic_minus1 > 1 )
+            {
+                X_READ_FLAG( pps_tile_idx_delta_present_flag );
+                pps->setTileIdxDeltaPresentFlag( pps_tile_idx_delta_present_flag );
+            }
 
-void VLCReader::xReadCode( uint32_t length, uint32_t& rValue, const char *pSymbolName )
-{
-    xReadCode( length, rValue );
-}
+            std::vector<RectSlice>& rectSlices = pps->getRectSlices();
+            rectSlices.resize( pps_num_slices_in_pic_minus1 + 1 );
 
-void VLCReader::xReadSCode( uint32_t length, int32_t& value, const char *pSymbolName )
-{
-    xReadSCode( length, value );
+            // SliceTopLeftTileIdx of the current slice
+            int32_t  tileIdx  = 0;
+            uint32_t sliceIdx = 0;
+            for( ; sliceIdx < pps_num_slices_in_pic_minus1; sliceIdx++ )
+            {
+                CHECK( tileIdx < 0 || tileIdx >= (int32_t)pps->getNumTiles(), "Invalid top left tile index of a rectangular slice" );
+                RectSlice& slice = rectSlices[sliceIdx];
+                slice.tileIdx    = tileIdx;
+
+                const uint32_t tileX = tileIdx % NumTileColumns;
+                const uint32_t tileY = tileIdx / NumTileColumns;
+
+                slice.sliceWidthInTiles = 1;
+                if( tileX != NumTileColumns - 1 )
+                {
+                    X_READ_UVLC_idx( pps_slice_width_in_tiles_minus1, "[ i ]", 0, NumTileColumns - 1 - tileX );
+                    slice.sliceWidthInTiles = pps_slice_width_in_tiles_minus1 + 1;
+                }
+
+                if( tileY == NumTileRows - 1 )
+                {
+                    slice.sliceHeightInTiles = 1;
+                }
+                else if( pps->getTileIdxDeltaPresentFlag() || tileX == 0 )
+                {
+                    X_READ_UVLC_idx( pps_slice_height_in_tiles_minus1, "[ i ]", 0, NumTileRows - 1 - tileY );
+                    slice.sliceHeightInTiles = pps_slice_height_in_tiles_minus1 + 1;
+                }
+                else
+                {
+                    // inferred to be the height of the previous slice
+                    CHECK( sliceIdx == 0, "pps_slice_height_in_tiles_minus1[ 0 ] cannot be inferred" );
+                    slice.sliceHeightInTiles = std::min( rectSlices[sliceIdx - 1].sliceHeightInTiles, NumTileRows - tileY );
+                }
+
+                if( slice.sliceWidthInTiles == 1 && slice.sliceHeightInTiles == 1 && pps->getTileRowHeight( tileY ) > 1 )
+                {
+                    const uint32_t tileHeightInCtu = pps->getTileRowHeight( tileY );
+                    X_READ_UVLC_idx( pps_num_exp_slices_in_tile, "[ i ]", 0, tileHeightInCtu - 1 );
+
+                    if( pps_num_exp_slices_in_tile == 0 )
+                    {
+                        slice.numSlicesInTile  = 1;
+                        slice.sliceHeightInCtu = 0;
+                    }
+                    else
+                    {
+                        // explicit slice heights, then slices of the last explicit height and the rest of the tile
+                        std::vector<uint32_t> sliceHeights;
+                        uint32_t              remainingHeightInCtu = tileHeightInCtu;
+                        for( uint32_t j = 0; j < pps_num_exp_slices_in_tile; j++ )
+                        {
+                            X_READ_UVLC_idx( pps_exp_slice_height_in_ctus_minus1, "[ i ][ j ]", 0, tileHeightInCtu - 1 );
+                            CHECK( pps_exp_slice_height_in_ctus_minus1 + 1 > remainingHeightInCtu, "Explicit slice heights exceed the height of the tile" );
+                            sliceHeights.push_back( pps_exp_slice_height_in_ctus_minus1 + 1 );
+                            remainingHeightInCtu -= pps_exp_slice_height_in_ctus_minus1 + 1;
+                        }
+                        const uint32_t uniformSliceHeight = sliceHeights.back();
+                        while( remainingHeightInCtu >= uniformSliceHeight )
+                        {
+                            sliceHeights.push_back( uniformSliceHeight );
+                            remainingHeightInCtu -= uniformSliceHeight;
+                        }
+                        if( remainingHeightInCtu > 0 )
+                        {
+                            sliceHeights.push_back( remainingHeightInCtu );
+                        }
+
+                        const uint32_t numSlicesInTile = (uint32_t)sliceHeights.size();
+                        CHECK( sliceIdx + numSlicesInTile > pps_num_slices_in_pic_minus1 + 1, "Slices in a tile exceed the number of slices in the picture" );
+                        for( uint32_t j = 0; j < numSlicesInTile; j++ )
+                        {
+                            RectSlice& sliceInTile       = rectSlices[sliceIdx + j];
+                            sliceInTile                  = slice;
+                            sliceInTile.numSlicesInTile  = numSlicesInTile;
+                            sliceInTile.sliceHeightInCtu = sliceHeights[j];
+                        }
+                        sliceIdx += numSlicesInTile - 1;
+                    }
+                }
+
+                if( pps->getTileIdxDeltaPresentFlag() && sliceIdx < pps_num_slices_in_pic_minus1 )
+                {
+                    X_READ_SVLC_idx( pps_tile_idx_delta_val, "[ i ]", -(int32_t)pps->getNumTiles() + 1, (int32_t)pps->getNumTiles() - 1 );
+                    CHECK( pps_tile_idx_delta_val == 0, "pps_tile_idx_delta_val[ i ] shall not be equal to 0" );
+                    tileIdx += pps_tile_idx_delta_val;
+                }
+                else
+                {
+                    tileIdx += slice.sliceWidthInTiles;
+                    if( tileIdx % NumTileColumns == 0 )
+                    {
+                        tileIdx += ( slice.sliceHeightInTiles - 1 ) * NumTileColumns;
+                    }
+                }
+            }
+
+            // the last slice, unless it is the last one of several slices in a tile, covers the remaining tiles
+            if( sliceIdx == pps_num_slices_in_pic_minus1 )
+            {
+                CHECK( tileIdx < 0 || tileIdx >= (int32_t)pps->getNumTiles(), "Invalid top left tile index of a rectangular slice" );
+                RectSlice& slice         = rectSlices[sliceIdx];
+                slice.tileIdx            = tileIdx;
+                slice.sliceWidthInTiles  = NumTileColumns - tileIdx % NumTileColumns;
+                slice.sliceHeightInTiles = NumTileRows    - tileIdx / NumTileColumns;
+                slice.numSlicesInTile    = 1;
+                slice.sliceHeightInCtu   = 0;
+            }
+        }
+
+        if( !pps->getRectSliceFlag() || pps->getSingleSlicePerSubPicFlag() || pps->getNumSlicesInPic() > 1 )
+        {
+            X_READ_FLAG( pps_loop_filter_across_slices_enabled_flag );
+            pps->setLoopFilterAcrossSlicesEnabledFlag( pps_loop_filter_across_slices_enabled_flag );
+        }
+        else
+        {
+            pps->setLoopFilterAcrossSlicesEnabledFlag( false );
+        }
+    }
+
+    X_READ_FLAG( pps_cabac_init_present_flag );
+    pps->setCabacInitPresentFlag( pps_cabac_init_present_flag );
+
+    X_READ_UVLC( pps_num_ref_idx_l0_default_active_minus1, 0, 14 );
+    pps->setNumRefIdxL0DefaultActive( pps_num_ref_idx_l0_default_active_minus1 + 1 );
+
+    X_READ_UVLC( pps_num_ref_idx_l1_default_active_minus1, 0, 14 );
+    pps->setNumRefIdxL1DefaultActive( pps_num_ref_idx_l1_default_active_minus1 + 1 );
+
+    X_READ_FLAG( pps_rpl1_idx_present_flag );
+    pps->setRpl1IdxPresentFlag( pps_rpl1_idx_present_flag );
+
+    X_READ_FLAG( pps_weighted_pred_flag );
+    pps->setUseWP( pps_weighted_pred_flag );
+
+    X_READ_FLAG( pps_weighted_bipred_flag );
+    pps->setWPBiPred( pps_weighted_bipred_flag );
+
+    X_READ_FLAG( pps_ref_wraparound_enabled_flag );
+    pps->setUseWrapAround( pps_ref_wraparound_enabled_flag );
+
+    if( pps_ref_wraparound_enabled_flag )
+    {
+        // the wraparound offset in luma samples needs the minimum coding block size of the SPS
+        X_READ_UVLC_NO_RANGE( pps_pic_width_minus_wraparound_offset );
+        pps->setPicWidthMinusWrapAroundOffset( pps_pic_width_minus_wraparound_offset );
+    }
+
+    X_READ_SVLC( pps_init_qp_minus26, -( 26 + MAX_QP_BD_OFFSET ), 37 );
+    pps->setPicInitQPMinus26( pps_init_qp_minus26 );
+
+    X_READ_FLAG( pps_cu_qp_delta_enabled_flag );
+    pps->setUseDQP( pps_cu_qp_delta_enabled_flag );
+
+    X_READ_FLAG( pps_chroma_tool_offsets_present_flag );
+    pps->setPPSChromaToolFlag( pps_chroma_tool_offsets_present_flag );
+
+    if( pps_chroma_tool_offsets_present_flag )
+    {
+        X_READ_SVLC( pps_cb_qp_offset, -12, 12 );
+        pps->setQpOffset( COMPONENT_Cb, pps_cb_qp_offset );
+
+        X_READ_SVLC( pps_cr_qp_offset, -12, 12 );
+        pps->setQpOffset( COMPONENT_Cr, pps_cr_qp_offset );
+
+        X_READ_FLAG( pps_joint_cbcr_qp_offset_present_flag );
+        pps->setJointCbCrQpOffsetPresentFlag( pps_joint_cbcr_qp_offset_present_flag );
+
+        if( pps_joint_cbcr_qp_offset_present_flag )
+        {
+            X_READ_SVLC( pps_joint_cbcr_qp_offset_value, -12, 12 );
+            pps->setQpOffset( JOINT_CbCr, pps_joint_cbcr_qp_offset_value );
+        }
+        else
+        {
+            pps->setQpOffset( JOINT_CbCr, 0 );
+        }
+
+        X_READ_FLAG( pps_slice_chroma_qp_offsets_present_flag );
+        pps->setSliceChromaQpFlag( pps_slice_chroma_qp_offsets_present_flag );
+
+        X_READ_FLAG( pps_cu_chroma_qp_offset_list_enabled_flag );
+        pps->clearChromaQpOffsetList();
+
+        if( pps_cu_chroma_qp_offset_list_enabled_flag )
+        {
+            X_READ_UVLC( pps_chroma_qp_offset_list_len_minus1, 0, MAX_QP_OFFSET_LIST_SIZE - 1 );
+
+            for( int cuChromaQpOffsetIdx = 0; cuChromaQpOffsetIdx <= (int)pps_chroma_qp_offset_list_len_minus1; cuChromaQpOffsetIdx++ )
+            {
+                X_READ_SVLC_idx( pps_cb_qp_offset_list, "[ i ]", -12, 12 );
+                X_READ_SVLC_idx( pps_cr_qp_offset_list, "[ i ]", -12, 12 );
+
+                int jointCbCrOffset = 0;
+                if( pps_joint_cbcr_qp_offset_present_flag )
+                {
+                    X_READ_SVLC_idx( pps_joint_cbcr_qp_offset_list, "[ i ]", -12, 12 );
+                    jointCbCrOffset = pps_joint_cbcr_qp_offset_list;
+                }
+                // table uses +1 for index (see comment inside the function)
+                pps->setChromaQpOffsetListEntry( cuChromaQpOffsetIdx + 1, pps_cb_qp_offset_list, pps_cr_qp_offset_list, jointCbCrOffset );
+            }
+        }
+    }
+    else
+    {
+        pps->setQpOffset( COMPONENT_Cb, 0 );
+        pps->setQpOffset( COMPONENT_Cr, 0 );
+        pps->setJointCbCrQpOffsetPresentFlag( false );
+        pps->setSliceChromaQpFlag( false );
+        pps->clearChromaQpOffsetList();
+    }
+
+    X_READ_FLAG( pps_deblocking_filter_control_present_flag );
+    pps->setDeblockingFilterControlPresentFlag( pps_deblocking_filter_control_present_flag );
+
+    if( pps_deblocking_filter_control_present_flag )
+    {
+        X_READ_FLAG( pps_deblocking_filter_override_enabled_flag );
+        pps->setDeblockingFilterOverrideEnabledFlag( pps_deblocking_filter_override_enabled_flag );
+
+        X_READ_FLAG( pps_deblocking_filter_disabled_flag );
+        pps->setPPSDeblockingFilterDisabledFlag( pps_deblocking_filter_disabled_flag );
+
+        if( !pps_no_pic_partition_flag && pps_deblocking_filter_override_enabled_flag )
+        {
+            X_READ_FLAG( pps_dbf_info_in_ph_flag );
+            pps->setDbfInfoInPhFlag( pps_dbf_info_in_ph_flag );
+        }
+
+        if( !pps_deblocking_filter_disabled_flag )
+        {
+            X_READ_SVLC( pps_luma_beta_offset_div2, -12, 12 );
+            pps->setDeblockingFilterBetaOffsetDiv2( pps_luma_beta_offset_div2 );
+
+            X_READ_SVLC( pps_luma_tc_offset_div2, -12, 12 );
+            pps->setDeblockingFilterTcOffsetDiv2( pps_luma_tc_offset_div2 );
+
+            if( pps_chroma_tool_offsets_present_flag )
+            {
+                X_READ_SVLC( pps_cb_beta_offset_div2, -12, 12 );
+                pps->setDeblockingFilterCbBetaOffsetDiv2( pps_cb_beta_offset_div2 );
+
+                X_READ_SVLC( pps_cb_tc_offset_div2, -12, 12 );
+                pps->setDeblockingFilterCbTcOffsetDiv2( pps_cb_tc_offset_div2 );
+
+                X_READ_SVLC( pps_cr_beta_offset_div2, -12, 12 );
+                pps->setDeblockingFilterCrBetaOffsetDiv2( pps_cr_beta_offset_div2 );
+
+                X_READ_SVLC( pps_cr_tc_offset_div2, -12, 12 );
+                pps->setDeblockingFilterCrTcOffsetDiv2( pps_cr_tc_offset_div2 );
+            }
+            else
+            {
+                // the chroma offsets are inferred to be the luma offsets
+                pps->setDeblockingFilterCbBetaOffsetDiv2( pps_luma_beta_offset_div2 );
+                pps->setDeblockingFilterCbTcOffsetDiv2  ( pps_luma_tc_offset_div2 );
+                pps->setDeblockingFilterCrBetaOffsetDiv2( pps_luma_beta_offset_div2 );
+                pps->setDeblockingFilterCrTcOffsetDiv2  ( pps_luma_tc_offset_div2 );
+            }
+        }
+    }
+
+    if( !pps_no_pic_partition_flag )
+    {
+        X_READ_FLAG( pps_rpl_info_in_ph_flag );
+        pps->setRplInfoInPhFlag( pps_rpl_info_in_ph_flag );
+
+        X_READ_FLAG( pps_sao_info_in_ph_flag );
+        pps->setSaoInfoInPhFlag( pps_sao_info_in_ph_flag );
+
+        X_READ_FLAG( pps_alf_info_in_ph_flag );
+        pps->setAlfInfoInPhFlag( pps_alf_info_in_ph_flag );
+
+        if( ( pps_weighted_pred_flag || pps_weighted_bipred_flag ) && pps_rpl_info_in_ph_flag )
+        {
+            X_READ_FLAG( pps_wp_info_in_ph_flag );
+            pps->setWpInfoInPhFlag( pps_wp_info_in_ph_flag );
+        }
+
+        X_READ_FLAG( pps_qp_delta_info_in_ph_flag );
+        pps->setQpDeltaInfoInPhFlag( pps_qp_delta_info_in_ph_flag );
+    }
+
+    X_READ_FLAG( pps_picture_header_extension_present_flag );
+    pps->setPictureHeaderExtensionPresentFlag( pps_picture_header_extension_present_flag );
+
+    X_READ_FLAG( pps_slice_header_extension_present_flag );
+    pps->setSliceHeaderExtensionPresentFlag( pps_slice_header_extension_present_flag );
+
+    X_READ_FLAG( pps_extension_flag );
+    if( pps_extension_flag )
+    {
+        while( xMoreRbspData() )
+        {
+            X_READ_FLAG( pps_extension_data_flag );
+            (void)pps_extension_data_flag;
+        }
+    }
+
+    xReadRbspTrailingBits();
+}
+
+void HLSyntaxReader::parseAPS( APS* aps ) {
+    X_READ_CODE( aps_params_type, 3, 0, NUM_APS_TYPES - 1 );
+    aps->setAPSType( ApsType( aps_params_type ) );
+
+    X_READ_CODE_NO_RANGE( aps_adaptation_parameter_set_id, 5 );
+    aps->setAPSId( aps_adaptation_parameter_set_id );
+
+    X_READ_FLAG( aps_chroma_present_flag );
+    aps->setChromaPresentFlag( aps_chroma_present_flag );
+
+    switch( aps_params_type )
+    {
+    case ALF_APS:
+        parseAlfAps( aps );
+        break;
+    case LMCS_APS:
+        parseLmcsAps( aps );
+        break;
+    case SCALING_LIST_APS:
+        parseScalingListAps( aps );
+        break;
+    }
+
+    X_READ_FLAG( aps_extension_flag );
+    if( aps_extension_flag )
+    {
+        while( xMoreRbspData() )
+        {
+            X_READ_FLAG( aps_extension_data_flag );
+            (void)aps_extension_data_flag;
+        }
+    }
+
+    xReadRbspTrailingBits();
+}
+
+void HLSyntaxReader::parseAlfAps( APS* aps ) {
+    AlfParam& param = aps->getAlfParam();
+
+    X_READ_FLAG( alf_luma_filter_signal_flag );
+    param.lumaFilterSignalFlag = alf_luma_filter_signal_flag;
+
+    if( aps->getChromaPresentFlag() )
+    {
+        X_READ_FLAG( alf_chroma_filter_signal_flag );
+        param.chromaFilterSignalFlag = alf_chroma_filter_signal_flag;
+
+        X_READ_FLAG( alf_cc_cb_filter_signal_flag );
+        param.ccAlfFilterSignalFlag[0] = alf_cc_cb_filter_signal_flag;
+
+        X_READ_FLAG( alf_cc_cr_filter_signal_flag );
+        param.ccAlfFilterSignalFlag[1] = alf_cc_cr_filter_signal_flag;
+    }
+    CHECK( !param.lumaFilterSignalFlag && !param.chromaFilterSignalFlag && !param.ccAlfFilterSignalFlag[0] && !param.ccAlfFilterSignalFlag[1],
+           "An ALF APS shall signal at least one filter" );
+
+    if( param.lumaFilterSignalFlag )
+    {
+        X_READ_FLAG( alf_luma_clip_flag );
+        param.lumaClipFlag = alf_luma_clip_flag;
+
+        X_READ_UVLC( alf_luma_num_filters_signalled_minus1, 0, MAX_NUM_ALF_CLASSES - 1 );
+        param.numLumaFilters = alf_luma_num_filters_signalled_minus1 + 1;
+
+        if( alf_luma_num_filters_signalled_minus1 > 0 )
+        {
+            const int length = (int) ceil( log2( alf_luma_num_filters_signalled_minus1 + 1 ) );
+            for( int filtIdx = 0; filtIdx < MAX_NUM_ALF_CLASSES; filtIdx++ )
+            {
+                X_READ_CODE_idx( alf_luma_coeff_delta_idx, "[ filtIdx ]", length, 0, alf_luma_num_filters_signalled_minus1 );
+                param.lumaCoeffDeltaIdx[filtIdx] = (uint8_t) alf_luma_coeff_delta_idx;
+            }
+        }
+
+        for( int sfIdx = 0; sfIdx < param.numLumaFilters; sfIdx++ )
+        {
+            for( int j = 0; j < MAX_NUM_ALF_LUMA_COEFF; j++ )
+            {
+                X_READ_UVLC_idx( alf_luma_coeff_abs, "[ sfIdx ][ j ]", 0, 128 );
+                bool alf_luma_coeff_sign = false;
+                if( alf_luma_coeff_abs )
+                {
+                    alf_luma_coeff_sign = xReadFlag( "alf_luma_coeff_sign[ sfIdx ][ j ]" );
+                }
+                CHECK( alf_luma_coeff_abs == 128 && !alf_luma_coeff_sign, "alf_luma_coeff out of bounds" );
+                param.lumaCoeff[sfIdx][j] = (int16_t) ( alf_luma_coeff_sign ? -(int) alf_luma_coeff_abs : (int) alf_luma_coeff_abs );
+            }
+        }
+
+        if( param.lumaClipFlag )
+        {
+            for( int sfIdx = 0; sfIdx < param.numLumaFilters; sfIdx++ )
+            {
+                for( int j = 0; j < MAX_NUM_ALF_LUMA_COEFF; j++ )
+                {
+                    X_READ_CODE_NO_RANGE_idx( alf_luma_clip_idx, "[ sfIdx ][ j ]", 2 );
+                    param.lumaClipIdx[sfIdx][j] = (uint8_t) alf_luma_clip_idx;
+                }
+            }
+        }
+    }
+
+    if( param.chromaFilterSignalFlag )
+    {
+        X_READ_FLAG( alf_chroma_clip_flag );
+        param.chromaClipFlag = alf_chroma_clip_flag;
+
+        X_READ_UVLC( alf_chroma_num_alt_filters_minus1, 0, MAX_NUM_ALF_ALTERNATIVES_CHROMA - 1 );
+        param.numAltChroma = alf_chroma_num_alt_filters_minus1 + 1;
+
+        for( int altIdx = 0; altIdx < param.numAltChroma; altIdx++ )
+        {
+            for( int j = 0; j < MAX_NUM_ALF_CHROMA_COEFF; j++ )
+            {
+                X_READ_UVLC_idx( alf_chroma_coeff_abs, "[ altIdx ][ j ]", 0, 128 );
+                bool alf_chroma_coeff_sign = false;
+                if( alf_chroma_coeff_abs )
+                {
+                    alf_chroma_coeff_sign = xReadFlag( "alf_chroma_coeff_sign[ altIdx ][ j ]" );
+                }
+                CHECK( alf_chroma_coeff_abs == 128 && !alf_chroma_coeff_sign, "alf_chroma_coeff out of bounds" );
+                param.chromaCoeff[altIdx][j] = (int16_t) ( alf_chroma_coeff_sign ? -(int) alf_chroma_coeff_abs : (int) alf_chroma_coeff_abs );
+            }
+
+            if( param.chromaClipFlag )
+            {
+                for( int j = 0; j < MAX_NUM_ALF_CHROMA_COEFF; j++ )
+                {
+                    X_READ_CODE_NO_RANGE_idx( alf_chroma_clip_idx, "[ altIdx ][ j ]", 2 );
+                    param.chromaClipIdx[altIdx][j] = (uint8_t) alf_chroma_clip_idx;
+                }
+            }
+        }
+    }
+
+    // the mapped coefficient magnitudes code the powers of two 0, 1, 2, ..., 64
+    const auto ccAlfCoeff = []( uint32_t mappedAbs, bool sign ) {
+        const int val = mappedAbs ? 1 << ( mappedAbs - 1 ) : 0;
+        return (int16_t) ( sign ? -val : val );
+    };
+
+    if( param.ccAlfFilterSignalFlag[0] )
+    {
+        X_READ_UVLC( alf_cc_cb_filters_signalled_minus1, 0, MAX_NUM_CC_ALF_FILTERS - 1 );
+        param.numCcAlfFilters[0] = alf_cc_cb_filters_signalled_minus1 + 1;
+
+        for( int k = 0; k < param.numCcAlfFilters[0]; k++ )
+        {
+            for( int j = 0; j < MAX_NUM_CC_ALF_COEFF; j++ )
+            {
+                X_READ_CODE_NO_RANGE_idx( alf_cc_cb_mapped_coeff_abs, "[ k ][ j ]", 3 );
+                bool alf_cc_cb_coeff_sign = false;
+                if( alf_cc_cb_mapped_coeff_abs )
+                {
+                    alf_cc_cb_coeff_sign = xReadFlag( "alf_cc_cb_coeff_sign[ k ][ j ]" );
+                }
+                param.ccAlfCoeff[0][k][j] = ccAlfCoeff( alf_cc_cb_mapped_coeff_abs, alf_cc_cb_coeff_sign );
+            }
+        }
+    }
+
+    if( param.ccAlfFilterSignalFlag[1] )
+    {
+        X_READ_UVLC( alf_cc_cr_filters_signalled_minus1, 0, MAX_NUM_CC_ALF_FILTERS - 1 );
+        param.numCcAlfFilters[1] = alf_cc_cr_filters_signalled_minus1 + 1;
+
+        for( int k = 0; k < param.numCcAlfFilters[1]; k++ )
+        {
+            for( int j = 0; j < MAX_NUM_CC_ALF_COEFF; j++ )
+            {
+                X_READ_CODE_NO_RANGE_idx( alf_cc_cr_mapped_coeff_abs, "[ k ][ j ]", 3 );
+                bool alf_cc_cr_coeff_sign = false;
+                if( alf_cc_cr_mapped_coeff_abs )
+                {
+                    alf_cc_cr_coeff_sign = xReadFlag( "alf_cc_cr_coeff_sign[ k ][ j ]" );
+                }
+                param.ccAlfCoeff[1][k][j] = ccAlfCoeff( alf_cc_cr_mapped_coeff_abs, alf_cc_cr_coeff_sign );
+            }
+        }
+    }
+}
+
+void HLSyntaxReader::parseLmcsAps( APS* aps ) {
+    LmcsParam& param = aps->getLmcsParam();
+
+    X_READ_UVLC( lmcs_min_bin_idx, 0, LMCS_NUM_BINS - 1 );
+    param.minBinIdx = lmcs_min_bin_idx;
+
+    X_READ_UVLC( lmcs_delta_max_bin_idx, 0, LMCS_NUM_BINS - 1 - lmcs_min_bin_idx );
+    param.maxBinIdx = LMCS_NUM_BINS - 1 - lmcs_delta_max_bin_idx;
+
+    X_READ_UVLC( lmcs_delta_cw_prec_minus1, 0, 14 );
+
+    for( int i = param.minBinIdx; i <= param.maxBinIdx; i++ )
+    {
+        X_READ_CODE_NO_RANGE_idx( lmcs_delta_abs_cw, "[ i ]", lmcs_delta_cw_prec_minus1 + 1 );
+        bool lmcs_delta_sign_cw_flag = false;
+        if( lmcs_delta_abs_cw > 0 )
+        {
+            lmcs_delta_sign_cw_flag = xReadFlag( "lmcs_delta_sign_cw_flag[ i ]" );
+        }
+        param.deltaCW[i] = lmcs_delta_sign_cw_flag ? -(int) lmcs_delta_abs_cw : (int) lmcs_delta_abs_cw;
+    }
+
+    if( aps->getChromaPresentFlag() )
+    {
+        X_READ_CODE_NO_RANGE( lmcs_delta_abs_crs, 3 );
+        bool lmcs_delta_sign_crs_flag = false;
+        if( lmcs_delta_abs_crs > 0 )
+        {
+            lmcs_delta_sign_crs_flag = xReadFlag( "lmcs_delta_sign_crs_flag" );
+        }
+        param.deltaCrs = lmcs_delta_sign_crs_flag ? -(int) lmcs_delta_abs_crs : (int) lmcs_delta_abs_crs;
+    }
+}
+
+void HLSyntaxReader::parseScalingListAps( APS* aps ) {
+    ScalingList& scalingList = aps->getScalingList();
+
+    for( int id = 0; id < SCALING_LIST_1D_NUM; id++ )
+    {
+        const int matrixSize = ScalingList::matrixSize( id );
+
+        // the chroma lists of an APS without chroma are copies of the default
+        if( !aps->getChromaPresentFlag() && !ScalingList::isLumaScalingList( id ) )
+        {
+            scalingList.processRefMatrix( id, id );
+            continue;
+        }
+
+        X_READ_FLAG( scaling_list_copy_mode_flag );
+        bool scaling_list_pred_mode_flag = false;
+        if( !scaling_list_copy_mode_flag )
+        {
+            scaling_list_pred_mode_flag = xReadFlag( "scaling_list_pred_mode_flag" );
+        }
+
+        // refId equal to id selects the default list
+        int refId = id;
+        if( ( scaling_list_copy_mode_flag || scaling_list_pred_mode_flag ) && id != SCALING_LIST_1D_START_2x2
+            && id != SCALING_LIST_1D_START_4x4 && id != SCALING_LIST_1D_START_8x8 )
+        {
+            const int maxIdDelta = id < SCALING_LIST_1D_START_4x4 ? id : id < SCALING_LIST_1D_START_8x8 ? id - SCALING_LIST_1D_START_4x4 : id - SCALING_LIST_1D_START_8x8;
+            X_READ_UVLC( scaling_list_pred_id_delta, 0, maxIdDelta );
+            refId = id - scaling_list_pred_id_delta * ( id == SCALING_LIST_1D_NUM - 1 ? 3 : 1 );
+            CHECK( refId < ( id < SCALING_LIST_1D_START_4x4 ? SCALING_LIST_1D_START_2x2 : id < SCALING_LIST_1D_START_8x8 ? SCALING_LIST_1D_START_4x4 : SCALING_LIST_1D_START_8x8 ),
+                   "scaling_list_pred_id_delta refers to a list of another size" );
+        }
+
+        if( scaling_list_copy_mode_flag )
+        {
+            scalingList.processRefMatrix( id, refId );
+            continue;
+        }
+
+        // ScalingMatrixPred and ScalingMatrixDcPred: 8 for an explicitly coded list, otherwise the reference list
+        // or the flat default when refId is id
+        int pred[8 * 8];
+        int predDc = 8;
+        std::fill_n( pred, matrixSize * matrixSize, 8 );
+        if( scaling_list_pred_mode_flag )
+        {
+            if( refId == id )
+            {
+                std::fill_n( pred, matrixSize * matrixSize, SCALING_LIST_DC );
+                predDc = SCALING_LIST_DC;
+            }
+            else
+            {
+                std::copy_n( scalingList.getScalingListAddress( refId ), matrixSize * matrixSize, pred );
+                predDc = refId >= SCALING_LIST_1D_START_16x16 ? scalingList.getScalingListDC( refId ) : pred[0];
+            }
+        }
+
+        int nextCoef = 0;
+        if( id >= SCALING_LIST_1D_START_16x16 )
+        {
+            X_READ_SVLC( scaling_list_dc_coef, -128, 127 );
+            nextCoef += scaling_list_dc_coef;
+            scalingList.setScalingListDC( id, ( predDc + scaling_list_dc_coef ) & 255 );
+            CHECK( scalingList.getScalingListDC( id ) == 0, "ScalingMatrixDcRec shall be greater than 0" );
+        }
+
+        const int          log2MatrixSize = getLog2( matrixSize );
+        const ScanElement* scan           = g_scanOrder[log2MatrixSize][log2MatrixSize];
+        uint8_t*           coef           = scalingList.getScalingListAddress( id );
+        for( int i = 0; i < matrixSize * matrixSize; i++ )
+        {
+            const int x   = scan[i].x;
+            const int y   = scan[i].y;
+            const int pos = y * matrixSize + x;
+            // the coefficients of the 64x64 lists that cover the zeroed-out region are not coded
+            if( id >= SCALING_LIST_1D_START_64x64 && x >= 4 && y >= 4 )
+            {
+                coef[pos] = 0;
+                continue;
+            }
+            X_READ_SVLC_idx( scaling_list_delta_coef, "[ id ][ i ]", -128, 127 );
+            nextCoef += scaling_list_delta_coef;
+            coef[pos] = (uint8_t) ( ( pred[pos] + nextCoef ) & 255 );
+            CHECK( coef[pos] == 0, "ScalingMatrixRec shall be greater than 0" );
+        }
+    }
+}
+
+void HLSyntaxReader::parseRefPicList( const SPS* sps, ReferencePictureList* rpl, int rplIdx ) {
+    X_READ_UVLC( num_ref_entries, 0, MAX_NUM_REF_PICS );
+
+    if( sps->getLongTermRefsPresent() && num_ref_entries > 0 && rplIdx != -1 )
+    {
+        X_READ_FLAG( ltrp_in_header_flag );
+        rpl->setLtrpInSliceHeaderFlag( ltrp_in_header_flag );
+    }
+    else if( sps->getLongTermRefsPresent() )
+    {
+        rpl->setLtrpInSliceHeaderFlag( true );
+    }
+    rpl->setInterLayerPresentFlag( sps->getInterLayerPresentFlag() );
+
+    int numStrp = 0;
+    int numLtrp = 0;
+    int numIlrp = 0;
+    int prevDelta = 0;
+    for( unsigned ii = 0; ii < num_ref_entries; ii++ )
+    {
+        bool isInterLayerRefPic = false;
+        if( sps->getInterLayerPresentFlag() )
+        {
+            X_READ_FLAG_idx( inter_layer_ref_pic_flag, "[ i ]" );
+            isInterLayerRefPic = inter_layer_ref_pic_flag;
+        }
+
+        if( isInterLayerRefPic )
+        {
+            X_READ_UVLC_NO_RANGE_idx( ilrp_idx, "[ i ]" );
+            rpl->setRefPicIdentifier( ii, 0, true, true, ilrp_idx );
+            numIlrp++;
+            continue;
+        }
+
+        bool isLongTerm = false;
+        if( sps->getLongTermRefsPresent() )
+        {
+            X_READ_FLAG_idx( st_ref_pic_flag, "[ i ]" );
+            isLongTerm = !st_ref_pic_flag;
+        }
+
+        if( !isLongTerm )
+        {
+            X_READ_UVLC_NO_RANGE_idx( abs_delta_poc_st, "[ i ]" );
+            // AbsDeltaPocSt, the first entry and entries of sequences without weighted prediction can not repeat a picture
+            int deltaPocSt = abs_delta_poc_st;
+            if( ( !sps->getUseWP() && !sps->getUseWPBiPred() ) || ii == 0 )
+            {
+                deltaPocSt++;
+            }
+            if( deltaPocSt > 0 )
+            {
+                X_READ_FLAG_idx( strp_entry_sign_flag, "[ i ]" );
+                if( strp_entry_sign_flag )
+                {
+                    deltaPocSt = -deltaPocSt;
+                }
+            }
+            // the entries are coded relative to the previous short-term entry, the identifier is the delta to the current picture
+            prevDelta += deltaPocSt;
+            rpl->setRefPicIdentifier( ii, prevDelta, false, false, 0 );
+            numStrp++;
+        }
+        else
+        {
+            int pocLsbLt = 0;
+            if( !rpl->getLtrpInSliceHeaderFlag() )
+            {
+                X_READ_CODE_NO_RANGE_idx( rpls_poc_lsb_lt, "[ i ]", sps->getBitsForPOC() );
+                pocLsbLt = rpls_poc_lsb_lt;
+            }
+            rpl->setRefPicIdentifier( ii, pocLsbLt, true, false, 0 );
+            numLtrp++;
+        }
+    }
+    rpl->setNumberOfShorttermPictures( numStrp );
+    rpl->setNumberOfLongtermPictures( numLtrp );
+    rpl->setNumberOfInterLayerPictures( numIlrp );
+}
+
+void HLSyntaxReader::parseRefPicLists( const SPS* sps, const PPS* pps, ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01], int rplIdx[NUM_REF_PIC_LIST_01] ) {
+    bool rplSpsFlag[NUM_REF_PIC_LIST_01] = { false, false };
+    for( int listIdx = 0; listIdx < NUM_REF_PIC_LIST_01; listIdx++ )
+    {
+        const int  numRplsInSps = (int)sps->getNumRPL( listIdx );
+        const bool rplIdxCoded  = listIdx == 0 || pps->getRpl1IdxPresentFlag();
+
+        if( numRplsInSps > 0 && rplIdxCoded )
+        {
+            X_READ_FLAG_idx( rpl_sps_flag, "[ i ]" );
+            rplSpsFlag[listIdx] = rpl_sps_flag;
+        }
+        else
+        {
+            // without pps_rpl1_idx_present_flag list 1 is selected like list 0
+            rplSpsFlag[listIdx] = numRplsInSps > 0 && rplSpsFlag[0];
+        }
+
+        if( rplSpsFlag[listIdx] )
+        {
+            int idx = 0;
+            if( numRplsInSps > 1 && rplIdxCoded )
+            {
+                X_READ_CODE_idx( rpl_idx, "[ i ]", (int) ceil( log2( numRplsInSps ) ), 0, numRplsInSps - 1 );
+                idx = rpl_idx;
+            }
+            else if( !rplIdxCoded )
+            {
+                idx = rplIdx[0];
+            }
+            CHECK( idx >= numRplsInSps, "Invalid rpl_idx" );
+            *rpl[listIdx]    = sps->getRPLList( listIdx )[idx];
+            rplIdx[listIdx] = idx;
+        }
+        else
+        {
+            parseRefPicList( sps, rpl[listIdx], -1 );
+            rplIdx[listIdx] = -1;
+        }
+
+        // the long-term entries signalled in the header, DeltaPocMsbCycleLt accumulates over them
+        ReferencePictureList* list             = rpl[listIdx];
+        int                   deltaPocMsbCycle = 0;
+        for( int i = 0; i < list->getNumRefEntries(); i++ )
+        {
+            if( !list->isRefPicLongterm( i ) || list->isInterLayerRefPic( i ) )
+            {
+                continue;
+            }
+
+            if( list->getLtrpInSliceHeaderFlag() )
+            {
+                X_READ_CODE_NO_RANGE_idx( poc_lsb_lt, "[ i ][ j ]", sps->getBitsForPOC() );
+                list->setRefPicIdentifier( i, poc_lsb_lt, true, false, 0 );
+            }
+
+            X_READ_FLAG_idx( delta_poc_msb_cycle_present_flag, "[ i ][ j ]" );
+            list->setDeltaPocMSBPresentFlag( i, delta_poc_msb_cycle_present_flag );
+
+            if( delta_poc_msb_cycle_present_flag )
+            {
+                X_READ_UVLC_idx( delta_poc_msb_cycle_lt, "[ i ][ j ]", 0, 1u << ( 32 - sps->getBitsForPOC() ) );
+                deltaPocMsbCycle += delta_poc_msb_cycle_lt;
+            }
+            list->setDeltaPocMSBCycleLT( i, deltaPocMsbCycle );
+        }
+    }
+}
+
+void HLSyntaxReader::parsePredWeightTable( PredWeightTable& wp, int numWeights[NUM_REF_PIC_LIST_01], const SPS* sps, const PPS* pps,
+                                           const ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01], const int* numRefIdxActive ) {
+    const bool hasChroma = sps->getChromaFormatIdc() != CHROMA_400;
+    const bool wpInPh    = pps->getWpInfoInPhFlag();
+    CHECK( !wpInPh && !numRefIdxActive, "The weights of a slice need the number of active references" );
+
+    X_READ_UVLC( luma_log2_weight_denom, 0, 7 );
+
+    int chromaLog2WeightDenom = luma_log2_weight_denom;
+    if( hasChroma )
+    {
+        X_READ_SVLC( delta_chroma_log2_weight_denom, -(int)luma_log2_weight_denom, 7 - (int)luma_log2_weight_denom );
+        chromaLog2WeightDenom += delta_chroma_log2_weight_denom;
+    }
+
+    for( int listIdx = 0; listIdx < NUM_REF_PIC_LIST_01; listIdx++ )
+    {
+        const int numEntries = rpl[listIdx]->getNumRefEntries();
+
+        int numWeightsLX = 0;
+        if( listIdx == 0 )
+        {
+            if( wpInPh )
+            {
+                X_READ_UVLC( num_l0_weights, 0, std::min( 15, numEntries ) );
+                numWeightsLX = num_l0_weights;
+            }
+            else
+            {
+                numWeightsLX = numRefIdxActive[0];
+            }
+        }
+        else if( pps->getWPBiPred() && !( wpInPh && numEntries == 0 ) )
+        {
+            if( wpInPh )
+            {
+                X_READ_UVLC( num_l1_weights, 0, std::min( 15, numEntries ) );
+                numWeightsLX = num_l1_weights;
+            }
+            else
+            {
+                numWeightsLX = numRefIdxActive[1];
+            }
+        }
+        numWeights[listIdx] = numWeightsLX;
+
+        // references without explicit weights use the default weight and no offset
+        for( int i = 0; i < MAX_NUM_REF; i++ )
+        {
+            for( int comp = 0; comp < MAX_NUM_COMPONENT; comp++ )
+            {
+                const int       log2Denom = comp == COMPONENT_Y ? luma_log2_weight_denom : chromaLog2WeightDenom;
+                WPScalingParam& param     = wp[listIdx][i][comp];
+                param.presentFlag     = false;
+                param.log2WeightDenom = (uint8_t)log2Denom;
+                param.weight          = (int16_t)( 1 << log2Denom );
+                param.offset          = 0;
+            }
+        }
+
+        for( int i = 0; i < numWeightsLX; i++ )
+        {
+            X_READ_FLAG_idx( luma_weight_lX_flag, "[ i ]" );
+            wp[listIdx][i][COMPONENT_Y].presentFlag = luma_weight_lX_flag;
+        }
+        if( hasChroma )
+        {
+            for( int i = 0; i < numWeightsLX; i++ )
+            {
+                X_READ_FLAG_idx( chroma_weight_lX_flag, "[ i ]" );
+                wp[listIdx][i][COMPONENT_Cb].presentFlag = chroma_weight_lX_flag;
+                wp[listIdx][i][COMPONENT_Cr].presentFlag = chroma_weight_lX_flag;
+            }
+        }
+
+        for( int i = 0; i < numWeightsLX; i++ )
+        {
+            WPScalingParam* param = wp[listIdx][i];
+            if( param[COMPONENT_Y].presentFlag )
+            {
+                X_READ_SVLC_idx( delta_luma_weight_lX, "[ i ]", -128, 127 );
+                param[COMPONENT_Y].weight += delta_luma_weight_lX;
+
+                X_READ_SVLC_idx( luma_offset_lX, "[ i ]", -128, 127 );
+                param[COMPONENT_Y].offset = luma_offset_lX;
+            }
+            if( param[COMPONENT_Cb].presentFlag )
+            {
+                for( int comp = COMPONENT_Cb; comp <= COMPONENT_Cr; comp++ )
+                {
+                    X_READ_SVLC_idx( delta_chroma_weight_lX, "[ i ][ j ]", -128, 127 );
+                    param[comp].weight += delta_chroma_weight_lX;
+
+                    X_READ_SVLC_idx( delta_chroma_offset_lX, "[ i ][ j ]", -4 * 128, 4 * 127 );
+                    // ChromaOffsetLX is coded relative to the offset that compensates the weight at mid level
+                    param[comp].offset = (int16_t)clip3( -128, 127, 128 + delta_chroma_offset_lX - ( ( 128 * param[comp].weight ) >> chromaLog2WeightDenom ) );
+                }
+            }
+        }
+    }
+}
+
+bool HLSyntaxReader::parsePictureHeaderInSliceHeaderFlag() {
+    X_READ_FLAG( sh_picture_header_in_slice_header_flag );
+    return sh_picture_header_in_slice_header_flag;
+}
+
+void HLSyntaxReader::parsePicHeader( PicHeader* picHeader, const ParameterSetMap<SPS, MAX_NUM_SPS>& spsMap, const ParameterSetMap<PPS, MAX_NUM_PPS>& ppsMap, bool readRbspTrailingBits ) {
+    X_READ_FLAG( ph_gdr_or_irap_pic_flag );
+    picHeader->setGdrOrIrapPicFlag( ph_gdr_or_irap_pic_flag );
+
+    X_READ_FLAG( ph_non_ref_pic_flag );
+    picHeader->setNonReferencePictureFlag( ph_non_ref_pic_flag );
+
+    if( ph_gdr_or_irap_pic_flag )
+    {
+        X_READ_FLAG( ph_gdr_pic_flag );
+        picHeader->setGdrPicFlag( ph_gdr_pic_flag );
+    }
+
+    X_READ_FLAG( ph_inter_slice_allowed_flag );
+    picHeader->setPicInterSliceAllowedFlag( ph_inter_slice_allowed_flag );
+
+    if( ph_inter_slice_allowed_flag )
+    {
+        X_READ_FLAG( ph_intra_slice_allowed_flag );
+        picHeader->setPicIntraSliceAllowedFlag( ph_intra_slice_allowed_flag );
+    }
+    else
+    {
+        picHeader->setPicIntraSliceAllowedFlag( true );
+    }
+
+    X_READ_UVLC( ph_pic_parameter_set_id, 0, MAX_NUM_PPS - 1 );
+    const std::shared_ptr<const PPS> pps = ppsMap.getPS( ph_pic_parameter_set_id );
+    CHECK( !pps, "The PPS referenced by the picture header has not been received" );
+    const std::shared_ptr<const SPS> sps = spsMap.getPS( pps->getSPSId() );
+    CHECK( !sps, "The SPS referenced by the picture header has not been received" );
+    picHeader->setPPSId( ph_pic_parameter_set_id );
+    picHeader->setSPSId( pps->getSPSId() );
+    CHECK( picHeader->getGdrPicFlag() && !sps->getGDREnabledFlag(), "GDR picture without sps_gdr_enabled_flag" );
+
+    X_READ_CODE_NO_RANGE( ph_pic_order_cnt_lsb, sps->getBitsForPOC() );
+    picHeader->setPocLsb( ph_pic_order_cnt_lsb );
+
+    if( picHeader->getGdrPicFlag() )
+    {
+        X_READ_UVLC( ph_recovery_poc_cnt, 0, ( 1u << sps->getBitsForPOC() ) - 1 );
+        picHeader->setRecoveryPocCnt( ph_recovery_poc_cnt );
+    }
+
+    const std::vector<bool>& extraPhBitPresentFlags = sps->getExtraPHBitPresentFlags();
+    const int                numExtraPhBits         = (int) std::count( extraPhBitPresentFlags.begin(), extraPhBitPresentFlags.end(), true );
+    for( int i = 0; i < numExtraPhBits; i++ )
+    {
+        X_READ_FLAG_idx( ph_extra_bit, "[ i ]" );
+        (void)ph_extra_bit;
+    }
+
+    if( sps->getPocMsbFlag() )
+    {
+        X_READ_FLAG( ph_poc_msb_cycle_present_flag );
+        picHeader->setPocMsbPresentFlag( ph_poc_msb_cycle_present_flag );
+
+        if( ph_poc_msb_cycle_present_flag )
+        {
+            X_READ_CODE_NO_RANGE( ph_poc_msb_cycle_val, sps->getPocMsbLen() );
+            picHeader->setPocMsbVal( ph_poc_msb_cycle_val );
+        }
+    }
+
+    const bool hasChroma = sps->getChromaFormatIdc() != CHROMA_400;
+
+    if( sps->getUseALF() && pps->getAlfInfoInPhFlag() )
+    {
+        AlfControls& alf = picHeader->getAlfControls();
+
+        X_READ_FLAG( ph_alf_enabled_flag );
+        alf.enabled[COMPONENT_Y] = ph_alf_enabled_flag;
+
+        if( ph_alf_enabled_flag )
+        {
+            X_READ_CODE_NO_RANGE( ph_num_alf_aps_ids_luma, 3 );
+            alf.numLumaAps = ph_num_alf_aps_ids_luma;
+
+            for( int i = 0; i < alf.numLumaAps; i++ )
+            {
+                X_READ_CODE_NO_RANGE_idx( ph_alf_aps_id_luma, "[ i ]", 3 );
+                alf.lumaApsId[i] = ph_alf_aps_id_luma;
+            }
+
+            if( hasChroma )
+            {
+                X_READ_FLAG( ph_alf_cb_enabled_flag );
+                alf.enabled[COMPONENT_Cb] = ph_alf_cb_enabled_flag;
+
+                X_READ_FLAG( ph_alf_cr_enabled_flag );
+                alf.enabled[COMPONENT_Cr] = ph_alf_cr_enabled_flag;
+            }
+
+            if( alf.enabled[COMPONENT_Cb] || alf.enabled[COMPONENT_Cr] )
+            {
+                X_READ_CODE_NO_RANGE( ph_alf_aps_id_chroma, 3 );
+                alf.chromaApsId = ph_alf_aps_id_chroma;
+            }
+
+            if( sps->getUseCCALF() )
+            {
+                X_READ_FLAG( ph_alf_cc_cb_enabled_flag );
+                alf.ccEnabled[COMPONENT_Cb] = ph_alf_cc_cb_enabled_flag;
+
+                if( ph_alf_cc_cb_enabled_flag )
+                {
+                    X_READ_CODE_NO_RANGE( ph_alf_cc_cb_aps_id, 3 );
+                    alf.ccApsId[COMPONENT_Cb] = ph_alf_cc_cb_aps_id;
+                }
+
+                X_READ_FLAG( ph_alf_cc_cr_enabled_flag );
+                alf.ccEnabled[COMPONENT_Cr] = ph_alf_cc_cr_enabled_flag;
+
+                if( ph_alf_cc_cr_enabled_flag )
+                {
+                    X_READ_CODE_NO_RANGE( ph_alf_cc_cr_aps_id, 3 );
+                    alf.ccApsId[COMPONENT_Cr] = ph_alf_cc_cr_aps_id;
+                }
+            }
+        }
+    }
+
+    if( sps->getUseReshaper() )
+    {
+        X_READ_FLAG( ph_lmcs_enabled_flag );
+        picHeader->setLmcsEnabledFlag( ph_lmcs_enabled_flag );
+
+        if( ph_lmcs_enabled_flag )
+        {
+            X_READ_CODE_NO_RANGE( ph_lmcs_aps_id, 2 );
+            picHeader->setLmcsAPSId( ph_lmcs_aps_id );
+
+            if( hasChroma )
+            {
+                X_READ_FLAG( ph_chroma_residual_scale_flag );
+                picHeader->setLmcsChromaResidualScaleFlag( ph_chroma_residual_scale_flag );
+            }
+        }
+    }
+
+    if( sps->getScalingListFlag() )
+    {
+        X_READ_FLAG( ph_explicit_scaling_list_enabled_flag );
+        picHeader->setExplicitScalingListEnabledFlag( ph_explicit_scaling_list_enabled_flag );
+
+        if( ph_explicit_scaling_list_enabled_flag )
+        {
+            X_READ_CODE_NO_RANGE( ph_scaling_list_aps_id, 3 );
+            picHeader->setScalingListAPSId( ph_scaling_list_aps_id );
+        }
+    }
+
+    if( sps->getVirtualBoundariesEnabledFlag() && !sps->getVirtualBoundariesPresentFlag() )
+    {
+        X_READ_FLAG( ph_virtual_boundaries_present_flag );
+        picHeader->setVirtualBoundariesPresentFlag( ph_virtual_boundaries_present_flag );
+
+        if( ph_virtual_boundaries_present_flag )
+        {
+            const int picWidth  = pps->getPicWidthInLumaSamples();
+            const int picHeight = pps->getPicHeightInLumaSamples();
+
+            X_READ_UVLC( ph_num_ver_virtual_boundaries, 0, picWidth <= 8 ? 0 : 3 );
+            picHeader->setNumVerVirtualBoundaries( ph_num_ver_virtual_boundaries );
+
+            for( unsigned i = 0; i < ph_num_ver_virtual_boundaries; i++ )
+            {
+                X_READ_UVLC_idx( ph_virtual_boundary_pos_x_minus1, "[ i ]", 0, ( picWidth + 7 ) / 8 - 2 );
+                picHeader->setVirtualBoundariesPosX( ( ph_virtual_boundary_pos_x_minus1 + 1 ) << 3, i );
+            }
+
+            X_READ_UVLC( ph_num_hor_virtual_boundaries, 0, picHeight <= 8 ? 0 : 3 );
+            picHeader->setNumHorVirtualBoundaries( ph_num_hor_virtual_boundaries );
+
+            for( unsigned i = 0; i < ph_num_hor_virtual_boundaries; i++ )
+            {
+                X_READ_UVLC_idx( ph_virtual_boundary_pos_y_minus1, "[ i ]", 0, ( picHeight + 7 ) / 8 - 2 );
+                picHeader->setVirtualBoundariesPosY( ( ph_virtual_boundary_pos_y_minus1 + 1 ) << 3, i );
+            }
+        }
+    }
+    else if( sps->getVirtualBoundariesEnabledFlag() )
+    {
+        // the virtual boundaries of the SPS apply to every picture
+        picHeader->setVirtualBoundariesPresentFlag( true );
+        picHeader->setNumVerVirtualBoundaries( sps->getNumVerVirtualBoundaries() );
+        for( unsigned i = 0; i < sps->getNumVerVirtualBoundaries(); i++ )
+        {
+            picHeader->setVirtualBoundariesPosX( sps->getVirtualBoundariesPosX( i ), i );
+        }
+        picHeader->setNumHorVirtualBoundaries( sps->getNumHorVirtualBoundaries() );
+        for( unsigned i = 0; i < sps->getNumHorVirtualBoundaries(); i++ )
+        {
+            picHeader->setVirtualBoundariesPosY( sps->getVirtualBoundariesPosY( i ), i );
+        }
+    }
+
+    if( pps->getOutputFlagPresentFlag() && !ph_non_ref_pic_flag )
+    {
+        X_READ_FLAG( ph_pic_output_flag );
+        picHeader->setPicOutputFlag( ph_pic_output_flag );
+    }
+
+    if( pps->getRplInfoInPhFlag() )
+    {
+        ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01] = { picHeader->getRPL( REF_PIC_LIST_0 ), picHeader->getRPL( REF_PIC_LIST_1 ) };
+        int                         rplIdx[NUM_REF_PIC_LIST_01];
+        parseRefPicLists( sps.get(), pps.get(), rpl, rplIdx );
+        picHeader->setRPLIdx( REF_PIC_LIST_0, rplIdx[0] );
+        picHeader->setRPLIdx( REF_PIC_LIST_1, rplIdx[1] );
+    }
+
+    if( sps->getSplitConsOverrideEnabledFlag() )
+    {
+        X_READ_FLAG( ph_partition_constraints_override_flag );
+        picHeader->setSplitConsOverrideFlag( ph_partition_constraints_override_flag );
+    }
+
+    // the partitioning of the SPS, unless the picture header overrides it
+    const int            CtbLog2SizeY   = getLog2( sps->getCTUSize() );
+    const int            MinCbLog2SizeY = sps->getLog2MinCodingBlockSize();
+    PartitionConstraints minQT     = sps->getMinQTSizes();
+    PartitionConstraints maxBTD    = sps->getMaxMTTHierarchyDepths();
+    PartitionConstraints maxBTSize = sps->getMaxBTSizes();
+    PartitionConstraints maxTTSize = sps->getMaxTTSizes();
+
+    if( picHeader->getPicIntraSliceAllowedFlag() )
+    {
+        if( picHeader->getSplitConsOverrideFlag() )
+        {
+            X_READ_UVLC( ph_log2_diff_min_qt_min_cb_intra_slice_luma, 0, std::min( 6, CtbLog2SizeY ) - MinCbLog2SizeY );
+            const int MinQtLog2SizeIntraY = ph_log2_diff_min_qt_min_cb_intra_slice_luma + MinCbLog2SizeY;
+
+            X_READ_UVLC( ph_max_mtt_hierarchy_depth_intra_slice_luma, 0, 2 * ( CtbLog2SizeY - MinCbLog2SizeY ) );
+            maxBTD[0] = ph_max_mtt_hierarchy_depth_intra_slice_luma;
+
+            minQT[0] = 1 << MinQtLog2SizeIntraY;
+            maxTTSize[0] = maxBTSize[0] = minQT[0];
+            if( ph_max_mtt_hierarchy_depth_intra_slice_luma != 0 )
+            {
+                X_READ_UVLC( ph_log2_diff_max_bt_min_qt_intra_slice_luma, 0, CtbLog2SizeY - MinQtLog2SizeIntraY );
+                maxBTSize[0] <<= ph_log2_diff_max_bt_min_qt_intra_slice_luma;
+
+                X_READ_UVLC( ph_log2_diff_max_tt_min_qt_intra_slice_luma, 0, std::min( 6, CtbLog2SizeY ) - MinQtLog2SizeIntraY );
+                maxTTSize[0] <<= ph_log2_diff_max_tt_min_qt_intra_slice_luma;
+            }
+
+            if( sps->getUseDualITree() )
+            {
+                X_READ_UVLC( ph_log2_diff_min_qt_min_cb_intra_slice_chroma, 0, std::min( 6, CtbLog2SizeY ) - MinCbLog2SizeY );
+                const int MinQtLog2SizeIntraC = ph_log2_diff_min_qt_min_cb_intra_slice_chroma + MinCbLog2SizeY;
+
+                X_READ_UVLC( ph_max_mtt_hierarchy_depth_intra_slice_chroma, 0, 2 * ( CtbLog2SizeY - MinCbLog2SizeY ) );
+                maxBTD[2] = ph_max_mtt_hierarchy_depth_intra_slice_chroma;
+
+                minQT[2] = 1 << MinQtLog2SizeIntraC;
+                maxTTSize[2] = maxBTSize[2] = minQT[2];
+                if( ph_max_mtt_hierarchy_depth_intra_slice_chroma != 0 )
+                {
+                    X_READ_UVLC( ph_log2_diff_max_bt_min_qt_intra_slice_chroma, 0, std::min( 6, CtbLog2SizeY ) - MinQtLog2SizeIntraC );
+                    maxBTSize[2] <<= ph_log2_diff_max_bt_min_qt_intra_slice_chroma;
+
+                    X_READ_UVLC( ph_log2_diff_max_tt_min_qt_intra_slice_chroma, 0, std::min( 6, CtbLog2SizeY ) - MinQtLog2SizeIntraC );
+                    maxTTSize[2] <<= ph_log2_diff_max_tt_min_qt_intra_slice_chroma;
+                }
+            }
+        }
+
+        const int maxSubdivIntra = 2 * ( CtbLog2SizeY - getLog2( minQT[0] ) + (int)maxBTD[0] );
+        if( pps->getUseDQP() )
+        {
+            X_READ_UVLC( ph_cu_qp_delta_subdiv_intra_slice, 0, maxSubdivIntra );
+            picHeader->setCuQpDeltaSubdivIntra( ph_cu_qp_delta_subdiv_intra_slice );
+        }
+
+        if( pps->getCuChromaQpOffsetEnabledFlag() )
+        {
+            X_READ_UVLC( ph_cu_chroma_qp_offset_subdiv_intra_slice, 0, maxSubdivIntra );
+            picHeader->setCuChromaQpOffsetSubdivIntra( ph_cu_chroma_qp_offset_subdiv_intra_slice );
+        }
+    }
+
+    if( ph_inter_slice_allowed_flag )
+    {
+        if( picHeader->getSplitConsOverrideFlag() )
+        {
+            X_READ_UVLC( ph_log2_diff_min_qt_min_cb_inter_slice, 0, std::min( 6, CtbLog2SizeY ) - MinCbLog2SizeY );
+            const int MinQtLog2SizeInterY = ph_log2_diff_min_qt_min_cb_inter_slice + MinCbLog2SizeY;
+
+            X_READ_UVLC( ph_max_mtt_hierarchy_depth_inter_slice, 0, 2 * ( CtbLog2SizeY - MinCbLog2SizeY ) );
+            maxBTD[1] = ph_max_mtt_hierarchy_depth_inter_slice;
+
+            minQT[1] = 1 << MinQtLog2SizeInterY;
+            maxTTSize[1] = maxBTSize[1] = minQT[1];
+            if( ph_max_mtt_hierarchy_depth_inter_slice != 0 )
+            {
+                X_READ_UVLC( ph_log2_diff_max_bt_min_qt_inter_slice, 0, CtbLog2SizeY - MinQtLog2SizeInterY );
+                maxBTSize[1] <<= ph_log2_diff_max_bt_min_qt_inter_slice;
+
+                X_READ_UVLC( ph_log2_diff_max_tt_min_qt_inter_slice, 0, std::min( 6, CtbLog2SizeY ) - MinQtLog2SizeInterY );
+                maxTTSize[1] <<= ph_log2_diff_max_tt_min_qt_inter_slice;
+            }
+        }
+
+        const int maxSubdivInter = 2 * ( CtbLog2SizeY - getLog2( minQT[1] ) + (int)maxBTD[1] );
+        if( pps->getUseDQP() )
+        {
+            X_READ_UVLC( ph_cu_qp_delta_subdiv_inter_slice, 0, maxSubdivInter );
+            picHeader->setCuQpDeltaSubdivInter( ph_cu_qp_delta_subdiv_inter_slice );
+        }
+
+        if( pps->getCuChromaQpOffsetEnabledFlag() )
+        {
+            X_READ_UVLC( ph_cu_chroma_qp_offset_subdiv_inter_slice, 0, maxSubdivInter );
+            picHeader->setCuChromaQpOffsetSubdivInter( ph_cu_chroma_qp_offset_subdiv_inter_slice );
+        }
+
+        const ReferencePictureList* rpl0 = picHeader->getRPL( REF_PIC_LIST_0 );
+        const ReferencePictureList* rpl1 = picHeader->getRPL( REF_PIC_LIST_1 );
+
+        // the collocated picture is only signalled here, when the lists are known
+        picHeader->setPicColFromL0Flag( true );
+        if( sps->getSPSTemporalMVPEnabledFlag() )
+        {
+            X_READ_FLAG( ph_temporal_mvp_enabled_flag );
+            picHeader->setEnableTMVPFlag( ph_temporal_mvp_enabled_flag );
+
+            if( ph_temporal_mvp_enabled_flag && pps->getRplInfoInPhFlag() )
+            {
+                if( rpl1->getNumRefEntries() > 0 )
+                {
+                    X_READ_FLAG( ph_collocated_from_l0_flag );
+                    picHeader->setPicColFromL0Flag( ph_collocated_from_l0_flag );
+                }
+
+                const int numEntries = ( picHeader->getPicColFromL0Flag() ? rpl0 : rpl1 )->getNumRefEntries();
+                if( numEntries > 1 )
+                {
+                    X_READ_UVLC( ph_collocated_ref_idx, 0, numEntries - 1 );
+                    picHeader->setColRefIdx( ph_collocated_ref_idx );
+                }
+            }
+        }
+
+        if( sps->getFpelMmvdEnabledFlag() )
+        {
+            X_READ_FLAG( ph_mmvd_fullpel_only_flag );
+            picHeader->setDisFracMMVD( ph_mmvd_fullpel_only_flag );
+        }
+
+        // when the control flags are not coded, BDOF and DMVR follow the SPS
+        picHeader->setMvdL1ZeroFlag( true );
+        picHeader->setDisBdofFlag( sps->getBdofControlPresentInPhFlag() || !sps->getUseBIO() );
+        picHeader->setDisDmvrFlag( sps->getDmvrControlPresentInPhFlag() || !sps->getUseDMVR() );
+
+        const bool presenceFlag = !pps->getRplInfoInPhFlag() || rpl1->getNumRefEntries() > 0;
+        if( presenceFlag )
+        {
+            X_READ_FLAG( ph_mvd_l1_zero_flag );
+            picHeader->setMvdL1ZeroFlag( ph_mvd_l1_zero_flag );
+
+            if( sps->getBdofControlPresentInPhFlag() )
+            {
+                X_READ_FLAG( ph_bdof_disabled_flag );
+                picHeader->setDisBdofFlag( ph_bdof_disabled_flag );
+            }
+
+            if( sps->getDmvrControlPresentInPhFlag() )
+            {
+                X_READ_FLAG( ph_dmvr_disabled_flag );
+                picHeader->setDisDmvrFlag( ph_dmvr_disabled_flag );
+            }
+        }
+
+        if( sps->getProfControlPresentInPhFlag() )
+        {
+            X_READ_FLAG( ph_prof_disabled_flag );
+            picHeader->setDisProfFlag( ph_prof_disabled_flag );
+        }
+        else
+        {
+            picHeader->setDisProfFlag( !sps->getUsePROF() );
+        }
+
+        if( ( pps->getUseWP() || pps->getWPBiPred() ) && pps->getWpInfoInPhFlag() )
+        {
+            const ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01] = { rpl0, rpl1 };
+            int                               numWeights[NUM_REF_PIC_LIST_01];
+            parsePredWeightTable( picHeader->getPredWeightTable(), numWeights, sps.get(), pps.get(), rpl, nullptr );
+            picHeader->setNumL0Weights( numWeights[0] );
+            picHeader->setNumL1Weights( numWeights[1] );
+        }
+    }
+
+    picHeader->setMinQTSizes( minQT );
+    picHeader->setMaxMTTHierarchyDepths( maxBTD );
+    picHeader->setMaxBTSizes( maxBTSize );
+    picHeader->setMaxTTSizes( maxTTSize );
+
+    if( pps->getQpDeltaInfoInPhFlag() )
+    {
+        const int initQp = 26 + pps->getPicInitQPMinus26();
+        X_READ_SVLC( ph_qp_delta, -sps->getQpBDOffset() - initQp, MAX_QP - initQp );
+        picHeader->setQpDelta( ph_qp_delta );
+    }
+
+    if( sps->getJointCbCrEnabledFlag() )
+    {
+        X_READ_FLAG( ph_joint_cbcr_sign_flag );
+        picHeader->setJointCbCrSignFlag( ph_joint_cbcr_sign_flag );
+    }
+
+    if( sps->getUseSAO() && pps->getSaoInfoInPhFlag() )
+    {
+        X_READ_FLAG( ph_sao_luma_enabled_flag );
+        picHeader->setSaoEnabledFlag( CHANNEL_TYPE_LUMA, ph_sao_luma_enabled_flag );
+
+        if( hasChroma )
+        {
+            X_READ_FLAG( ph_sao_chroma_enabled_flag );
+            picHeader->setSaoEnabledFlag( CHANNEL_TYPE_CHROMA, ph_sao_chroma_enabled_flag );
+        }
+    }
+
+    // the deblocking parameters of the PPS, unless the picture header overrides them
+    picHeader->setDeblockingFilterDisable( pps->getPPSDeblockingFilterDisabledFlag() );
+    picHeader->setDeblockingFilterBetaOffsetDiv2( pps->getDeblockingFilterBetaOffsetDiv2() );
+    picHeader->setDeblockingFilterTcOffsetDiv2( pps->getDeblockingFilterTcOffsetDiv2() );
+    picHeader->setDeblockingFilterCbBetaOffsetDiv2( pps->getDeblockingFilterCbBetaOffsetDiv2() );
+    picHeader->setDeblockingFilterCbTcOffsetDiv2( pps->getDeblockingFilterCbTcOffsetDiv2() );
+    picHeader->setDeblockingFilterCrBetaOffsetDiv2( pps->getDeblockingFilterCrBetaOffsetDiv2() );
+    picHeader->setDeblockingFilterCrTcOffsetDiv2( pps->getDeblockingFilterCrTcOffsetDiv2() );
+
+    if( pps->getDbfInfoInPhFlag() )
+    {
+        X_READ_FLAG( ph_deblocking_params_present_flag );
+        picHeader->setDeblockingFilterOverrideFlag( ph_deblocking_params_present_flag );
+
+        if( ph_deblocking_params_present_flag )
+        {
+            if( !pps->getPPSDeblockingFilterDisabledFlag() )
+            {
+                X_READ_FLAG( ph_deblocking_filter_disabled_flag );
+                picHeader->setDeblockingFilterDisable( ph_deblocking_filter_disabled_flag );
+            }
+            else
+            {
+                // present parameters enable the deblocking the PPS disables
+                picHeader->setDeblockingFilterDisable( false );
+            }
+
+            if( !picHeader->getDeblockingFilterDisable() )
+            {
+                X_READ_SVLC( ph_luma_beta_offset_div2, -12, 12 );
+                picHeader->setDeblockingFilterBetaOffsetDiv2( ph_luma_beta_offset_div2 );
+
+                X_READ_SVLC( ph_luma_tc_offset_div2, -12, 12 );
+                picHeader->setDeblockingFilterTcOffsetDiv2( ph_luma_tc_offset_div2 );
+
+                if( pps->getPPSChromaToolFlag() )
+                {
+                    X_READ_SVLC( ph_cb_beta_offset_div2, -12, 12 );
+                    picHeader->setDeblockingFilterCbBetaOffsetDiv2( ph_cb_beta_offset_div2 );
+
+                    X_READ_SVLC( ph_cb_tc_offset_div2, -12, 12 );
+                    picHeader->setDeblockingFilterCbTcOffsetDiv2( ph_cb_tc_offset_div2 );
+
+                    X_READ_SVLC( ph_cr_beta_offset_div2, -12, 12 );
+                    picHeader->setDeblockingFilterCrBetaOffsetDiv2( ph_cr_beta_offset_div2 );
+
+                    X_READ_SVLC( ph_cr_tc_offset_div2, -12, 12 );
+                    picHeader->setDeblockingFilterCrTcOffsetDiv2( ph_cr_tc_offset_div2 );
+                }
+                else
+                {
+                    picHeader->setDeblockingFilterCbBetaOffsetDiv2( ph_luma_beta_offset_div2 );
+                    picHeader->setDeblockingFilterCbTcOffsetDiv2  ( ph_luma_tc_offset_div2 );
+                    picHeader->setDeblockingFilterCrBetaOffsetDiv2( ph_luma_beta_offset_div2 );
+                    picHeader->setDeblockingFilterCrTcOffsetDiv2  ( ph_luma_tc_offset_div2 );
+                }
+            }
+        }
+    }
+
+    if( pps->getPictureHeaderExtensionPresentFlag() )
+    {
+        X_READ_UVLC( ph_extension_length, 0, 256 );
+        for( uint32_t i = 0; i < ph_extension_length; i++ )
+        {
+            X_READ_CODE_NO_RANGE_idx( ph_extension_data_byte, "[ i ]", 8 );
+            (void)ph_extension_data_byte;
+        }
+    }
+
+    if( readRbspTrailingBits )
+    {
+        xReadRbspTrailingBits();
+    }
+}
+
+void HLSyntaxReader::parseSliceHeader( Slice* slice ) {
+    const PicHeader*     picHeader = slice->getPicHeader();
+    const SeqPicContext& ctx       = slice->getSeqPicContext();
+    const SPS*           sps       = slice->getSPS();
+    const PPS*           pps       = slice->getPPS();
+    const bool           hasChroma = ctx.chromaFormat != CHROMA_400;
+    const NalUnitType    nalType   = slice->getNalUnitType();
+
+    // CurrSubpicIdx, the sub-picture with the SubpicIdVal of the slice
+    uint32_t subPicIdx = 0;
+    if( sps->getSubPicInfoPresentFlag() )
+    {
+        X_READ_CODE_NO_RANGE( sh_subpic_id, sps->getSubPicIdLen() );
+        slice->setSliceSubPicId( sh_subpic_id );
+
+        while( subPicIdx < ctx.subPics.size() && ctx.subPics[subPicIdx].subPicId != sh_subpic_id )
+        {
+            subPicIdx++;
+        }
+        CHECK( subPicIdx == ctx.subPics.size(), "Invalid sh_subpic_id" );
+    }
+    const SeqPicContext::SubPicRect& subPic = ctx.subPics[subPicIdx];
+
+    const uint32_t numTilesInPic = pps->getNumTiles();
+    uint32_t       sliceAddr     = 0;
+    if( ( pps->getRectSliceFlag() && subPic.numSlices > 1 ) || ( !pps->getRectSliceFlag() && numTilesInPic > 1 ) )
+    {
+        const uint32_t numAddrs = pps->getRectSliceFlag() ? subPic.numSlices : numTilesInPic;
+        X_READ_CODE( sh_slice_address, (int) ceil( log2( numAddrs ) ), 0, numAddrs - 1 );
+        sliceAddr = sh_slice_address;
+    }
+
+    const std::vector<bool>& extraShBitPresentFlags = sps->getExtraSHBitPresentFlags();
+    const int                numExtraShBits         = (int) std::count( extraShBitPresentFlags.begin(), extraShBitPresentFlags.end(), true );
+    for( int i = 0; i < numExtraShBits; i++ )
+    {
+        X_READ_FLAG_idx( sh_extra_bit, "[ i ]" );
+        (void)sh_extra_bit;
+    }
+
+    uint32_t numTilesInSlice = 1;
+    if( !pps->getRectSliceFlag() && numTilesInPic - sliceAddr > 1 )
+    {
+        X_READ_UVLC( sh_num_tiles_in_slice_minus1, 0, numTilesInPic - sliceAddr - 1 );
+        numTilesInSlice = sh_num_tiles_in_slice_minus1 + 1;
+    }
+
+    if( pps->getRectSliceFlag() )
+    {
+        // the address of a rectangular slice indexes the slices of its sub-picture
+        const uint32_t sliceIdx = ctx.subPicSliceIdx[subPic.firstSliceIdx + sliceAddr];
+        slice->setSliceAddr( sliceIdx );
+        slice->setSliceMap( pps->getSliceMap( sliceIdx ) );
+    }
+    else
+    {
+        // a raster scan slice consists of complete tiles, its CTUs are consecutive in tile scan
+        const uint32_t firstCtuTs = pps->getTileFirstCtuTs( sliceAddr );
+        const uint32_t endCtuTs   = pps->getTileFirstCtuTs( sliceAddr + numTilesInSlice );
+        slice->setSliceAddr( sliceAddr );
+        slice->setSliceMap( SliceMap{ ctx.ctuTsToRs + firstCtuTs, endCtuTs - firstCtuTs } );
+    }
+
+    if( picHeader->getPicInterSliceAllowedFlag() )
+    {
+        X_READ_UVLC( sh_slice_type, 0, 2 );
+        slice->setSliceType( SliceType( sh_slice_type ) );
+    }
+    else
+    {
+        slice->setSliceType( I_SLICE );
+    }
+    CHECK( slice->isIntra() && !picHeader->getPicIntraSliceAllowedFlag(), "Intra slice in a picture without intra slices" );
+    const SliceType sliceType = slice->getSliceType();
+
+    if( nalType == NAL_UNIT_CODED_SLICE_IDR_W_RADL || nalType == NAL_UNIT_CODED_SLICE_IDR_N_LP || nalType == NAL_UNIT_CODED_SLICE_CRA
+        || nalType == NAL_UNIT_CODED_SLICE_GDR )
+    {
+        X_READ_FLAG( sh_no_output_of_prior_pics_flag );
+        slice->setNoOutputOfPriorPicsFlag( sh_no_output_of_prior_pics_flag );
+    }
+
+    if( sps->getUseALF() && !pps->getAlfInfoInPhFlag() )
+    {
+        AlfControls& alf = slice->getSliceAlfControls();
+
+        X_READ_FLAG( sh_alf_enabled_flag );
+        alf.enabled[COMPONENT_Y] = sh_alf_enabled_flag;
+
+        if( sh_alf_enabled_flag )
+        {
+            X_READ_CODE_NO_RANGE( sh_num_alf_aps_ids_luma, 3 );
+            alf.numLumaAps = sh_num_alf_aps_ids_luma;
+
+            for( int i = 0; i < alf.numLumaAps; i++ )
+            {
+                X_READ_CODE_NO_RANGE_idx( sh_alf_aps_id_luma, "[ i ]", 3 );
+                alf.lumaApsId[i] = sh_alf_aps_id_luma;
+            }
+
+            if( hasChroma )
+            {
+                X_READ_FLAG( sh_alf_cb_enabled_flag );
+                alf.enabled[COMPONENT_Cb] = sh_alf_cb_enabled_flag;
+
+                X_READ_FLAG( sh_alf_cr_enabled_flag );
+                alf.enabled[COMPONENT_Cr] = sh_alf_cr_enabled_flag;
+            }
+
+            if( alf.enabled[COMPONENT_Cb] || alf.enabled[COMPONENT_Cr] )
+            {
+                X_READ_CODE_NO_RANGE( sh_alf_aps_id_chroma, 3 );
+                alf.chromaApsId = sh_alf_aps_id_chroma;
+            }
+
+            if( sps->getUseCCALF() )
+            {
+                X_READ_FLAG( sh_alf_cc_cb_enabled_flag );
+                alf.ccEnabled[COMPONENT_Cb] = sh_alf_cc_cb_enabled_flag;
+
+                if( sh_alf_cc_cb_enabled_flag )
+                {
+                    X_READ_CODE_NO_RANGE( sh_alf_cc_cb_aps_id, 3 );
+                    alf.ccApsId[COMPONENT_Cb] = sh_alf_cc_cb_aps_id;
+                }
+
+                X_READ_FLAG( sh_alf_cc_cr_enabled_flag );
+                alf.ccEnabled[COMPONENT_Cr] = sh_alf_cc_cr_enabled_flag;
+
+                if( sh_alf_cc_cr_enabled_flag )
+                {
+                    X_READ_CODE_NO_RANGE( sh_alf_cc_cr_aps_id, 3 );
+                    alf.ccApsId[COMPONENT_Cr] = sh_alf_cc_cr_aps_id;
+                }
+            }
+        }
+    }
+
+    // with the picture header in the slice header, LMCS and the scaling list follow the picture header
+    if( picHeader->getLmcsEnabledFlag() && !slice->getPictureHeaderInSliceHeader() )
+    {
+        X_READ_FLAG( sh_lmcs_used_flag );
+        slice->setLmcsEnabledFlag( sh_lmcs_used_flag );
+    }
+    else
+    {
+        slice->setLmcsEnabledFlag( slice->getPictureHeaderInSliceHeader() && picHeader->getLmcsEnabledFlag() );
+    }
+
+    if( picHeader->getExplicitScalingListEnabledFlag() && !slice->getPictureHeaderInSliceHeader() )
+    {
+        X_READ_FLAG( sh_explicit_scaling_list_used_flag );
+        slice->setExplicitScalingListUsed( sh_explicit_scaling_list_used_flag );
+    }
+    else
+    {
+        slice->setExplicitScalingListUsed( slice->getPictureHeaderInSliceHeader() && picHeader->getExplicitScalingListEnabledFlag() );
+    }
+
+    if( !pps->getRplInfoInPhFlag()
+        && ( ( nalType != NAL_UNIT_CODED_SLICE_IDR_W_RADL && nalType != NAL_UNIT_CODED_SLICE_IDR_N_LP ) || sps->getIDRRefParamListPresent() ) )
+    {
+        ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01] = { slice->getSliceRPL( REF_PIC_LIST_0 ), slice->getSliceRPL( REF_PIC_LIST_1 ) };
+        parseRefPicLists( sps, pps, rpl, slice->getSliceRPLIdx() );
+    }
+
+    const ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01] = { slice->getRPL( REF_PIC_LIST_0 ), slice->getRPL( REF_PIC_LIST_1 ) };
+    const int numEntries[NUM_REF_PIC_LIST_01] = { rpl[0]->getNumRefEntries(), rpl[1]->getNumRefEntries() };
+
+    bool numRefIdxActiveOverride                    = true;
+    int  numRefIdxActiveMinus1[NUM_REF_PIC_LIST_01] = { 0, 0 };
+    if( ( sliceType != I_SLICE && numEntries[0] > 1 ) || ( sliceType == B_SLICE && numEntries[1] > 1 ) )
+    {
+        X_READ_FLAG( sh_num_ref_idx_active_override_flag );
+        numRefIdxActiveOverride = sh_num_ref_idx_active_override_flag;
+
+        if( sh_num_ref_idx_active_override_flag )
+        {
+            for( int i = 0; i < ( sliceType == B_SLICE ? 2 : 1 ); i++ )
+            {
+                if( numEntries[i] > 1 )
+                {
+                    X_READ_UVLC_idx( sh_num_ref_idx_active_minus1, "[ i ]", 0, 14 );
+                    numRefIdxActiveMinus1[i] = sh_num_ref_idx_active_minus1;
+                }
+            }
+        }
+    }
+
+    int numRefIdxActive[NUM_REF_PIC_LIST_01] = { 0, 0 };
+    for( int i = 0; i < NUM_REF_PIC_LIST_01; i++ )
+    {
+        if( sliceType == B_SLICE || ( sliceType == P_SLICE && i == 0 ) )
+        {
+            const int numDefaultActive = i == 0 ? pps->getNumRefIdxL0DefaultActive() : pps->getNumRefIdxL1DefaultActive();
+            numRefIdxActive[i]         = numRefIdxActiveOverride ? numRefIdxActiveMinus1[i] + 1 : std::min( numEntries[i], numDefaultActive );
+            CHECK( numRefIdxActive[i] > numEntries[i], "NumRefIdxActive exceeds the number of reference picture list entries" );
+        }
+        slice->setNumRefIdx( RefPicList( i ), numRefIdxActive[i] );
+    }
+
+    if( sliceType != I_SLICE )
+    {
+        if( pps->getCabacInitPresentFlag() )
+        {
+            X_READ_FLAG( sh_cabac_init_flag );
+            slice->setCabacInitFlag( sh_cabac_init_flag );
+        }
+
+        if( picHeader->getEnableTMVPFlag() )
+        {
+            if( !pps->getRplInfoInPhFlag() )
+            {
+                bool colFromL0 = true;
+                if( sliceType == B_SLICE )
+                {
+                    X_READ_FLAG( sh_collocated_from_l0_flag );
+                    colFromL0 = sh_collocated_from_l0_flag;
+                }
+                slice->setColFromL0Flag( colFromL0 );
+
+                const int numActive = numRefIdxActive[colFromL0 ? 0 : 1];
+                if( numActive > 1 )
+                {
+                    X_READ_UVLC( sh_collocated_ref_idx, 0, numActive - 1 );
+                    slice->setColRefIdx( sh_collocated_ref_idx );
+                }
+                else
+                {
+                    slice->setColRefIdx( 0 );
+                }
+            }
+            else
+            {
+                slice->setColFromL0Flag( sliceType == P_SLICE || picHeader->getPicColFromL0Flag() );
+                slice->setColRefIdx( picHeader->getColRefIdx() );
+            }
+        }
+
+        if( !pps->getWpInfoInPhFlag() && ( ( pps->getUseWP() && sliceType == P_SLICE ) || ( pps->getWPBiPred() && sliceType == B_SLICE ) ) )
+        {
+            int numWeights[NUM_REF_PIC_LIST_01];
+            parsePredWeightTable( slice->getSlicePredWeightTable(), numWeights, sps, pps, rpl, numRefIdxActive );
+        }
+    }
+
+    int qpDelta = picHeader->getQpDelta();
+    if( !pps->getQpDeltaInfoInPhFlag() )
+    {
+        const int initQp = 26 + pps->getPicInitQPMinus26();
+        X_READ_SVLC( sh_qp_delta, -ctx.qpBdOffset - initQp, MAX_QP - initQp );
+        qpDelta = sh_qp_delta;
+    }
+    slice->setSliceQp( 26 + pps->getPicInitQPMinus26() + qpDelta );
+
+    if( pps->getSliceChromaQpFlag() )
+    {
+        X_READ_SVLC( sh_cb_qp_offset, -12, 12 );
+        CHECK_READ_RANGE( sh_cb_qp_offset + pps->getQpOffset( COMPONENT_Cb ), -12, 12, "pps_cb_qp_offset + sh_cb_qp_offset" );
+        slice->setSliceChromaQpDelta( COMPONENT_Cb, sh_cb_qp_offset );
+
+        X_READ_SVLC( sh_cr_qp_offset, -12, 12 );
+        CHECK_READ_RANGE( sh_cr_qp_offset + pps->getQpOffset( COMPONENT_Cr ), -12, 12, "pps_cr_qp_offset + sh_cr_qp_offset" );
+        slice->setSliceChromaQpDelta( COMPONENT_Cr, sh_cr_qp_offset );
+
+        if( sps->getJointCbCrEnabledFlag() )
+        {
+            X_READ_SVLC( sh_joint_cbcr_qp_offset, -12, 12 );
+            CHECK_READ_RANGE( sh_joint_cbcr_qp_offset + pps->getQpOffset( JOINT_CbCr ), -12, 12, "pps_joint_cbcr_qp_offset_value + sh_joint_cbcr_qp_offset" );
+            slice->setSliceChromaQpDelta( JOINT_CbCr, sh_joint_cbcr_qp_offset );
+        }
+    }
+
+    if( pps->getCuChromaQpOffsetEnabledFlag() )
+    {
+        X_READ_FLAG( sh_cu_chroma_qp_offset_enabled_flag );
+        slice->setUseChromaQpAdj( sh_cu_chroma_qp_offset_enabled_flag );
+    }
+
+    if( sps->getUseSAO() && !pps->getSaoInfoInPhFlag() )
+    {
+        X_READ_FLAG( sh_sao_luma_used_flag );
+        slice->setSaoEnabledFlag( CHANNEL_TYPE_LUMA, sh_sao_luma_used_flag );
+
+        if( hasChroma )
+        {
+            X_READ_FLAG( sh_sao_chroma_used_flag );
+            slice->setSaoEnabledFlag( CHANNEL_TYPE_CHROMA, sh_sao_chroma_used_flag );
+        }
+    }
+    else
+    {
+        slice->setSaoEnabledFlag( CHANNEL_TYPE_LUMA,   picHeader->getSaoEnabledFlag( CHANNEL_TYPE_LUMA ) );
+        slice->setSaoEnabledFlag( CHANNEL_TYPE_CHROMA, picHeader->getSaoEnabledFlag( CHANNEL_TYPE_CHROMA ) );
+    }
+
+    // the deblocking parameters of the picture header, unless the slice header overrides them
+    slice->setDeblockingFilterDisable( picHeader->getDeblockingFilterDisable() );
+    slice->setDeblockingFilterBetaOffsetDiv2( picHeader->getDeblockingFilterBetaOffsetDiv2() );
+    slice->setDeblockingFilterTcOffsetDiv2( picHeader->getDeblockingFilterTcOffsetDiv2() );
+    slice->setDeblockingFilterCbBetaOffsetDiv2( picHeader->getDeblockingFilterCbBetaOffsetDiv2() );
+    slice->setDeblockingFilterCbTcOffsetDiv2( picHeader->getDeblockingFilterCbTcOffsetDiv2() );
+    slice->setDeblockingFilterCrBetaOffsetDiv2( picHeader->getDeblockingFilterCrBetaOffsetDiv2() );
+    slice->setDeblockingFilterCrTcOffsetDiv2( picHeader->getDeblockingFilterCrTcOffsetDiv2() );
+
+    if( pps->getDeblockingFilterOverrideEnabledFlag() && !pps->getDbfInfoInPhFlag() )
+    {
+        X_READ_FLAG( sh_deblocking_params_present_flag );
+        slice->setDeblockingFilterOverrideFlag( sh_deblocking_params_present_flag );
+
+        if( sh_deblocking_params_present_flag )
+        {
+            if( !pps->getPPSDeblockingFilterDisabledFlag() )
+            {
+                X_READ_FLAG( sh_deblocking_filter_disabled_flag );
+                slice->setDeblockingFilterDisable( sh_deblocking_filter_disabled_flag );
+            }
+            else
+            {
+                slice->setDeblockingFilterDisable( false );
+            }
+
+            if( !slice->getDeblockingFilterDisable() )
+            {
+                X_READ_SVLC( sh_luma_beta_offset_div2, -12, 12 );
+                slice->setDeblockingFilterBetaOffsetDiv2( sh_luma_beta_offset_div2 );
+
+                X_READ_SVLC( sh_luma_tc_offset_div2, -12, 12 );
+                slice->setDeblockingFilterTcOffsetDiv2( sh_luma_tc_offset_div2 );
+
+                if( pps->getPPSChromaToolFlag() )
+                {
+                    X_READ_SVLC( sh_cb_beta_offset_div2, -12, 12 );
+                    slice->setDeblockingFilterCbBetaOffsetDiv2( sh_cb_beta_offset_div2 );
+
+                    X_READ_SVLC( sh_cb_tc_offset_div2, -12, 12 );
+                    slice->setDeblockingFilterCbTcOffsetDiv2( sh_cb_tc_offset_div2 );
+
+                    X_READ_SVLC( sh_cr_beta_offset_div2, -12, 12 );
+                    slice->setDeblockingFilterCrBetaOffsetDiv2( sh_cr_beta_offset_div2 );
+
+                    X_READ_SVLC( sh_cr_tc_offset_div2, -12, 12 );
+                    slice->setDeblockingFilterCrTcOffsetDiv2( sh_cr_tc_offset_div2 );
+                }
+                else
+                {
+                    slice->setDeblockingFilterCbBetaOffsetDiv2( sh_luma_beta_offset_div2 );
+                    slice->setDeblockingFilterCbTcOffsetDiv2  ( sh_luma_tc_offset_div2 );
+                    slice->setDeblockingFilterCrBetaOffsetDiv2( sh_luma_beta_offset_div2 );
+                    slice->setDeblockingFilterCrTcOffsetDiv2  ( sh_luma_tc_offset_div2 );
+                }
+            }
+        }
+    }
+
+    if( sps->getDepQuantEnabledFlag() )
+    {
+        X_READ_FLAG( sh_dep_quant_used_flag );
+        slice->setDepQuantEnabledFlag( sh_dep_quant_used_flag );
+    }
+
+    if( sps->getSignDataHidingEnabledFlag() && !slice->getDepQuantEnabledFlag() )
+    {
+        X_READ_FLAG( sh_sign_data_hiding_used_flag );
+        slice->setSignDataHidingEnabledFlag( sh_sign_data_hiding_used_flag );
+    }
+
+    if( sps->getTransformSkipEnabledFlag() && !slice->getDepQuantEnabledFlag() && !slice->getSignDataHidingEnabledFlag() )
+    {
+        X_READ_FLAG( sh_ts_residual_coding_disabled_flag );
+        slice->setTSResidualCodingDisabledFlag( sh_ts_residual_coding_disabled_flag );
+    }
+
+    if( pps->getSliceHeaderExtensionPresentFlag() )
+    {
+        X_READ_UVLC( sh_slice_header_extension_length, 0, 256 );
+        for( uint32_t i = 0; i < sh_slice_header_extension_length; i++ )
+        {
+            X_READ_CODE_NO_RANGE_idx( sh_slice_header_extension_data_byte, "[ i ]", 8 );
+            (void)sh_slice_header_extension_data_byte;
+        }
+    }
+
+    // NumEntryPoints, a substream starts at every tile and, with WPP, at every CTU row of the slice
+    uint32_t numEntryPoints = 0;
+    if( sps->getEntryPointsPresentFlag() )
+    {
+        const SliceMap& sliceMap = slice->getSliceMap();
+        for( uint32_t i = 1; i < sliceMap.numCtus; i++ )
+        {
+            const uint32_t ctuX     = sliceMap[i] % ctx.picWidthInCtu;
+            const uint32_t ctuY     = sliceMap[i] / ctx.picWidthInCtu;
+            const uint32_t prevCtuX = sliceMap[i - 1] % ctx.picWidthInCtu;
+            const uint32_t prevCtuY = sliceMap[i - 1] / ctx.picWidthInCtu;
+
+            if( ctx.ctuToTileRow[ctuY] != ctx.ctuToTileRow[prevCtuY] || ctx.ctuToTileCol[ctuX] != ctx.ctuToTileCol[prevCtuX]
+                || ( ctuY != prevCtuY && sps->getEntropyCodingSyncEnabledFlag() ) )
+            {
+                numEntryPoints++;
+            }
+        }
+    }
+    slice->setNumEntryPoints( numEntryPoints );
+    slice->clearSubstreamSizes();
+
+    if( numEntryPoints > 0 )
+    {
+        X_READ_UVLC( sh_entry_offset_len_minus1, 0, 31 );
+        for( uint32_t i = 0; i < numEntryPoints; i++ )
+        {
+            X_READ_CODE_NO_RANGE_idx( sh_entry_point_offset_minus1, "[ i ]", sh_entry_offset_len_minus1 + 1 );
+            slice->addSubstreamSize( sh_entry_point_offset_minus1 + 1 );
+        }
+    }
+
+    // byte_alignment()
+    X_READ_FLAG( byte_alignment_bit_equal_to_one );
+    CHECK( !byte_alignment_bit_equal_to_one, "Slice header alignment bit is not '1'" );
+    while( !isByteAligned() )
+    {
+        X_READ_FLAG( byte_alignment_bit_equal_to_zero );
+        CHECK( byte_alignment_bit_equal_to_zero, "Slice header alignment bit is not '0'" );
+    }
 }
 
-// ====================================================================================================================
-//  read functions returning the result value
-// ====================================================================================================================
+void HLSyntaxReader::parseProfileTierLevel( bool profileTierPresentFlag, int maxNumSubLayersMinus1 ) {
+    if( profileTierPresentFlag )
+    {
+        X_READ_CODE_NO_RANGE( general_profile_idc, 7 );
+        X_READ_FLAG( general_tier_flag );
+        (void)general_profile_idc;
+        (void)general_tier_flag;
+    }
 
-bool VLCReader::xReadFlag()
-{
-  return m_pcBitstream->read( 1 ) & 0x1;
+    X_READ_CODE_NO_RANGE( general_level_idc, 8 );
+    X_READ_FLAG( ptl_frame_only_constraint_flag );
+    X_READ_FLAG( ptl_multilayer_enabled_flag );
+    (void)general_level_idc;
+    (void)ptl_frame_only_constraint_flag;
+    (void)ptl_multilayer_enabled_flag;
+
+    if( profileTierPresentFlag )
+    {
+        parseConstraintInfo();
+    }
+
+    bool subLayerLevelPresentFlag[MAX_TLAYER] = { false };
+    for( int i = maxNumSubLayersMinus1 - 1; i >= 0; i-- )
+    {
+        X_READ_FLAG_idx( ptl_sublayer_level_present_flag, "[ i ]" );
+        subLayerLevelPresentFlag[i] = ptl_sublayer_level_present_flag;
+    }
+
+    while( !isByteAligned() )
+    {
+        X_READ_FLAG( ptl_reserved_zero_bit );
+        (void)ptl_reserved_zero_bit;
+    }
+
+    for( int i = maxNumSubLayersMinus1 - 1; i >= 0; i-- )
+    {
+        if( subLayerLevelPresentFlag[i] )
+        {
+            X_READ_CODE_NO_RANGE_idx( sublayer_level_idc, "[ i ]", 8 );
+            (void)sublayer_level_idc;
+        }
+    }
+
+    if( profileTierPresentFlag )
+    {
+        X_READ_CODE_NO_RANGE( ptl_num_sub_profiles, 8 );
+        for( unsigned i = 0; i < ptl_num_sub_profiles; i++ )
+        {
+            X_READ_CODE_NO_RANGE_idx( general_sub_profile_idc, "[ i ]", 32 );
+            (void)general_sub_profile_idc;
+        }
+    }
 }
 
-uint32_t VLCReader::xReadUvlc()
-{
-    uint32_t uiVal = 0;
-    uint32_t uiCode = 0;
-    uint32_t uiLength = 0;
+void HLSyntaxReader::parseConstraintInfo() {
+    // general_constraints_info() up to gci_num_additional_bits, in syntax order
+    static const struct {
+        const char* name;
+        uint32_t    length;
+    } constraintFields[] = {
+        { "gci_intra_only_constraint_flag",                      1 },
+        { "gci_all_layers_independent_constraint_flag",          1 },
+        { "gci_one_au_only_constraint_flag",                     1 },
+        { "gci_sixteen_minus_max_bitdepth_constraint_idc",       4 },
+        { "gci_three_minus_max_chroma_format_constraint_idc",    2 },
+        { "gci_no_mixed_nalu_types_in_pic_constraint_flag",      1 },
+        { "gci_no_trail_constraint_flag",                        1 },
+        { "gci_no_stsa_constraint_flag",                         1 },
+        { "gci_no_rasl_constraint_flag",                         1 },
+        { "gci_no_radl_constraint_flag",                         1 },
+        { "gci_no_idr_constraint_flag",                          1 },
+        { "gci_no_cra_constraint_flag",                          1 },
+        { "gci_no_gdr_constraint_flag",                          1 },
+        { "gci_no_aps_constraint_flag",                          1 },
+        { "gci_no_idr_rpl_constraint_flag",                      1 },
+        { "gci_one_tile_per_pic_constraint_flag",                1 },
+        { "gci_pic_header_in_slice_header_constraint_flag",      1 },
+        { "gci_one_slice_per_pic_constraint_flag",               1 },
+        { "gci_no_rectangular_slice_constraint_flag",            1 },
+        { "gci_one_slice_per_subpic_constraint_flag",            1 },
+        { "gci_no_subpic_info_constraint_flag",                  1 },
+        { "gci_three_minus_max_log2_ctu_size_constraint_idc",    2 },
+        { "gci_no_partition_constraints_override_constraint_flag", 1 },
+        { "gci_no_mtt_constraint_flag",                          1 },
+        { "gci_no_qtbtt_dual_tree_intra_constraint_flag",        1 },
+        { "gci_no_palette_constraint_flag",                      1 },
+        { "gci_no_ibc_constraint_flag",                          1 },
+        { "gci_no_isp_constraint_flag",                          1 },
+        { "gci_no_mrl_constraint_flag",                          1 },
+        { "gci_no_mip_constraint_flag",                          1 },
+        { "gci_no_cclm_constraint_flag",                         1 },
+        { "gci_no_ref_pic_resampling_constraint_flag",           1 },
+        { "gci_no_res_change_in_clvs_constraint_flag",           1 },
+        { "gci_no_weighted_prediction_constraint_flag",          1 },
+        { "gci_no_ref_wraparound_constraint_flag",               1 },
+        { "gci_no_temporal_mvp_constraint_flag",                 1 },
+        { "gci_no_sbtmvp_constraint_flag",                       1 },
+        { "gci_no_amvr_constraint_flag",                         1 },
+        { "gci_no_bdof_constraint_flag",                         1 },
+        { "gci_no_smvd_constraint_flag",                         1 },
+        { "gci_no_dmvr_constraint_flag",                         1 },
+        { "gci_no_mmvd_constraint_flag",                         1 },
+        { "gci_no_affine_motion_constraint_flag",                1 },
+        { "gci_no_prof_constraint_flag",                         1 },
+        { "gci_no_bcw_constraint_flag",                          1 },
+        { "gci_no_ciip_constraint_flag",                         1 },
+        { "gci_no_gpm_constraint_flag",                          1 },
+        { "gci_no_luma_transform_size_64_constraint_flag",       1 },
+        { "gci_no_transform_skip_constraint_flag",               1 },
+        { "gci_no_bdpcm_constraint_flag",                        1 },
+        { "gci_no_mts_constraint_flag",                          1 },
+        { "gci_no_lfnst_constraint_flag",                        1 },
+        { "gci_no_joint_cbcr_constraint_flag",                   1 },
+        { "gci_no_sbt_constraint_flag",                          1 },
+        { "gci_no_act_constraint_flag",                          1 },
+        { "gci_no_explicit_scaling_list_constraint_flag",        1 },
+        { "gci_no_dep_quant_constraint_flag",                    1 },
+        { "gci_no_sign_data_hiding_constraint_flag",             1 },
+        { "gci_no_cu_qp_delta_constraint_flag",                  1 },
+        { "gci_no_chroma_qp_offset_constraint_flag",             1 },
+        { "gci_no_sao_constraint_flag",                          1 },
+        { "gci_no_alf_constraint_flag",                          1 },
+        { "gci_no_ccalf_constraint_flag",                        1 },
+        { "gci_no_lmcs_constraint_flag",                         1 },
+        { "gci_no_ladf_constraint_flag",                         1 },
+        { "gci_no_virtual_boundaries_constraint_flag",           1 },
+    };
+
+    X_READ_FLAG( gci_present_flag );
+    if( gci_present_flag )
+    {
+        for( const auto& field : constraintFields )
+        {
+            xReadCode( field.length, field.name );
+        }
+
+        // the additional bits include the constraint flags of the range extensions, which are not supported anyway
+        X_READ_CODE_NO_RANGE( gci_num_additional_bits, 8 );
+        for( unsigned i = 0; i < gci_num_additional_bits; i++ )
+        {
+            X_READ_FLAG_idx( gci_additional_bit, "[ i ]" );
+            (void)gci_additional_bit;
+        }
+    }
+
+    while( !isByteAligned() )
+    {
+        X_READ_FLAG( gci_alignment_zero_bit );
+        CHECK( gci_alignment_zero_bit, "gci_alignment_zero_bit not equal to 0" );
+    }
+}
+
+void HLSyntaxReader::parseGeneralHrdParameters( GeneralHrdParams& hrd ) {
+    X_READ_CODE_NO_RANGE( num_units_in_tick, 32 );
+    X_READ_CODE_NO_RANGE( time_scale, 32 );
+    CHECK( num_units_in_tick == 0, "num_units_in_tick shall be greater than 0" );
+    CHECK( time_scale == 0, "time_scale shall be greater than 0" );
+
+    X_READ_FLAG( general_nal_hrd_params_present_flag );
+    hrd.nalHrdParamsPresentFlag = general_nal_hrd_params_present_flag;
+
+    X_READ_FLAG( general_vcl_hrd_params_present_flag );
+    hrd.vclHrdParamsPresentFlag = general_vcl_hrd_params_present_flag;
 
-    uiCode = m_pcBitstream->read( 1 );
-    if( 0 == uiCode )
+    if( general_nal_hrd_params_present_flag || general_vcl_hrd_params_present_flag )
     {
-        uiLength = 0;
+        X_READ_FLAG( general_same_pic_timing_in_all_ols_flag );
+        (void)general_same_pic_timing_in_all_ols_flag;
 
-        while( ! ( uiCode & 1 ) )
+        X_READ_FLAG( general_du_hrd_params_present_flag );
+        hrd.duHrdParamsPresentFlag = general_du_hrd_params_present_flag;
+
+        if( general_du_hrd_params_present_flag )
         {
-            uiCode = m_pcBitstream->read( 1 );
-            uiLength++;
+            X_READ_CODE_NO_RANGE( tick_divisor_minus2, 8 );
+            (void)tick_divisor_minus2;
         }
 
-        uiVal = m_pcBitstream->read( uiLength );
+        X_READ_CODE_NO_RANGE( bit_rate_scale, 4 );
+        X_READ_CODE_NO_RANGE( cpb_size_scale, 4 );
+        (void)bit_rate_scale;
+        (void)cpb_size_scale;
+
+        if( general_du_hrd_params_present_flag )
+        {
+            X_READ_CODE_NO_RANGE( cpb_size_du_scale, 4 );
+            (void)cpb_size_du_scale;
+        }
 
-        uiVal += ( 1 << uiLength ) - 1;
+        X_READ_UVLC( hrd_cpb_cnt_minus1, 0, 31 );
+        hrd.cpbCntMinus1 = hrd_cpb_cnt_minus1;
     }
+}
+
+void HLSyntaxReader::parseOlsHrdParameters( const GeneralHrdParams& hrd, int firstSubLayer, int maxSubLayersVal ) {
+    for( int i = firstSubLayer; i <= maxSubLayersVal; i++ )
+    {
+        X_READ_FLAG_idx( fixed_pic_rate_general_flag, "[ i ]" );
+
+        bool fixedPicRateWithinCvsFlag = true;
+        if( !fixed_pic_rate_general_flag )
+        {
+            X_READ_FLAG_idx( fixed_pic_rate_within_cvs_flag, "[ i ]" );
+            fixedPicRateWithinCvsFlag = fixed_pic_rate_within_cvs_flag;
+        }
+
+        if( fixedPicRateWithinCvsFlag )
+        {
+            X_READ_UVLC_idx( elemental_duration_in_tc_minus1, "[ i ]", 0, 2047 );
+            (void)elemental_duration_in_tc_minus1;
+        }
+        else if( ( hrd.nalHrdParamsPresentFlag || hrd.vclHrdParamsPresentFlag ) && hrd.cpbCntMinus1 == 0 )
+        {
+            X_READ_FLAG_idx( low_delay_hrd_flag, "[ i ]" );
+            (void)low_delay_hrd_flag;
+        }
 
-    return uiVal;
+        if( hrd.nalHrdParamsPresentFlag )
+        {
+            parseSubLayerHrdParameters( hrd );
+        }
+        if( hrd.vclHrdParamsPresentFlag )
+        {
+            parseSubLayerHrdParameters( hrd );
+        }
+    }
 }
 
-int32_t VLCReader::xReadSvlc()
-{
-    uint32_t uiBits = m_pcBitstream->read( 1 );
-    if( 0 == uiBits )
+void HLSyntaxReader::parseSubLayerHrdParameters( const GeneralHrdParams& hrd ) {
+    for( unsigned j = 0; j <= hrd.cpbCntMinus1; j++ )
     {
-        uint32_t uiLength = 0;
+        X_READ_UVLC_NO_RANGE_idx( bit_rate_value_minus1, "[ i ][ j ]" );
+        X_READ_UVLC_NO_RANGE_idx( cpb_size_value_minus1, "[ i ][ j ]" );
+        (void)bit_rate_value_minus1;
+        (void)cpb_size_value_minus1;
 
-        while( ! ( uiBits & 1 ) )
+        if( hrd.duHrdParamsPresentFlag )
         {
-            uiBits = m_pcBitstream->read( 1 );
-            uiLength++;
+            X_READ_UVLC_NO_RANGE_idx( cpb_size_du_value_minus1, "[ i ][ j ]" );
+            X_READ_UVLC_NO_RANGE_idx( bit_rate_du_value_minus1, "[ i ][ j ]" );
+            (void)cpb_size_du_value_minus1;
+            (void)bit_rate_du_value_minus1;
         }
 
-        uiBits = m_pcBitstream->read( uiLength );
+        X_READ_FLAG_idx( cbr_flag, "[ i ][ j ]" );
+        (void)cbr_flag;
+    }
+}
+
+bool HLSyntaxReader::xMoreRbspData() {
+    int bitsLeft = m_pcBitstream->getNumBitsLeft();
 
-        uiBits += ( 1 << uiLength );
-        return ( uiBits & 1 ) ? -(int32_t)( uiBits>>1 ) : (int32_t)( uiBits>>1 );
+    // if there are more than 8 bits, it cannot be rbsp_trailing_bits
+    if( bitsLeft > 8 )
+    {
+        return true;
     }
-    else
+
+    uint8_t lastByte = m_pcBitstream->peekBits( bitsLeft );
+    int cnt = bitsLeft;
+
+    // remove trailing bits equal to zero
+    while( ( cnt > 0 ) && ( ( lastByte & 1 ) == 0 ) )
     {
-        return  0;
+        lastByte >>= 1;
+        cnt--;
     }
+    // remove bit equal to one
+    cnt--;
+
+    // we should not have a negative number of bits
+    CHECK( cnt<0, "Negative number of bits") ;
+
+    // we have more data, if cnt is not zero
+    return ( cnt>0 );
 }
 
-uint32_t VLCReader::xReadCode( uint32_t uiLength )
+void VLCReader::xReadFlag( uint32_t& ruiCode )
+{
+    ruiCode = m_pcBitstream->read( 1 );
+}
+
+void VLCReader::xReadUvlc( uint32_t& ruiVal )
+{
+    ruiVal = m_pcBitstream->readUvlc();
+}
+
+void VLCReader::xReadSvlc( int32_t& riVal )
+{
+    riVal = m_pcBitstream->readSvlc();
+}
+
+void VLCReader::xReadCode( uint32_t uiLength, uint32_t& ruiCode )
 {
     CHECK( uiLength == 0, "Reading a code of lenght '0'" );
-    return m_pcBitstream->read( uiLength );
+    ruiCode = m_pcBitstream->read( uiLength );
 }
 
-int32_t VLCReader::xReadSCode( uint32_t length )
+void VLCReader::xReadSCode( uint32_t length, int32_t& value )
 {
     CHECK( length == 0 || length > 31, "wrong" );
     uint32_t val = m_pcBitstream->read( length );
-    return length >= 32 ? int32_t( val ) : ( ( -int32_t( val & ( uint32_t( 1 ) << ( length - 1 ) ) ) ) | int32_t( val ) );
+    value = length >= 32 ? int32_t( val ) : ( ( -int32_t( val & ( uint32_t( 1 ) << ( length - 1 ) ) ) ) | int32_t( val ) );
 }
 
-bool VLCReader::xReadFlag( const char* pSymbolName )
+// ====================================================================================================================
+//  read functions returning the result value
+// ====================================================================================================================
+
+bool VLCReader::xReadFlag()
 {
-    bool value = xReadFlag();
-    return value;
+  return m_pcBitstream->read( 1 ) & 0x1;
 }
 
-uint32_t VLCReader::xReadUvlc( const char* pSymbolName )
+uint32_t VLCReader::xReadUvlc()
 {
-    uint32_t value = xReadUvlc();
-    return value;
+    return m_pcBitstream->readUvlc();
 }
 
-int32_t VLCReader::xReadSvlc( const char* pSymbolName )
+int32_t VLCReader::xReadSvlc()
 {
-    int32_t value = xReadSvlc();
-    return value;
+    return m_pcBitstream->readSvlc();
 }
 
-uint32_t VLCReader::xReadCode( uint32_t length, const char* pSymbolName )
+uint32_t VLCReader::xReadCode( uint32_t uiLength )
 {
-    uint32_t value = xReadCode( length );
-    return value;
+    CHECK( uiLength == 0, "Reading a code of lenght '0'" );
+    return m_pcBitstream->read( uiLength );
 }
 
-int32_t VLCReader::xReadSCode( uint32_t length, const char* pSymbolName )
+int32_t VLCReader::xReadSCode( uint32_t length )
 {
-    int32_t value = xReadSCode( length );
-    return value;
+    CHECK( length == 0 || length > 31, "wrong" );
+    uint32_t val = m_pcBitstream->read( length );
+    return length >= 32 ? int32_t( val ) : ( ( -int32_t( val & ( uint32_t( 1 ) << ( length - 1 ) ) ) ) | int32_t( val ) );
 }
 
 void VLCReader::xReadRbspTrailingBits()
@@ -3,24 +3,26 @@
 #include "Common/Def.h"
 #include "Common/PicListManager.h"
 #include "Common/BitStream.h"
+#include "Common/Slice.h"
+#include "Common/Trace.h"
 
 class DecLib;
 
 #define CHECK_READ( cond, msg, val )            CHECK( cond, msg << " (read:" << val << ")" )
 #define CHECK_READ_RANGE( val, min, max, name ) CHECK( (val) < (min) || (val) > (max), name << " out of bounds (read:" << (val) << ")." )
 
-#  define X_READ_FLAG( name )                              const bool     name = xReadFlag ()
-#  define X_READ_FLAG_idx( name, idx )                     const bool     name = xReadFlag ()
+#  define X_READ_FLAG( name )                              const bool     name = xReadFlag (         #name )
+#  define X_READ_FLAG_idx( name, idx )                     const bool     name = xReadFlag (         #name idx )
 
-#  define X_READ_UVLC_NO_RANGE(  name         )            const uint32_t name = xReadUvlc (        )
-#  define X_READ_SVLC_NO_RANGE(  name         )            const int32_t  name = xReadSvlc (        )
-#  define X_READ_CODE_NO_RANGE(  name, length )            const uint32_t name = xReadCode ( length )
-#  define X_READ_SCODE_NO_RANGE( name, length )            const int32_t  name = xReadSCode( length )
+#  define X_READ_UVLC_NO_RANGE(  name         )            const uint32_t name = xReadUvlc (         #name )
+#  define X_READ_SVLC_NO_RANGE(  name         )            const int32_t  name = xReadSvlc (         #name )
+#  define X_READ_CODE_NO_RANGE(  name, length )            const uint32_t name = xReadCode ( length, #name )
+#  define X_READ_SCODE_NO_RANGE( name, length )            const int32_t  name = xReadSCode( length, #name )
 
-#  define X_READ_UVLC_NO_RANGE_idx(  name, idx         )   const uint32_t name = xReadUvlc (        )
-#  define X_READ_SVLC_NO_RANGE_idx(  name, idx         )   const int32_t  name = xReadSvlc (        )
-#  define X_READ_CODE_NO_RANGE_idx(  name, idx, length )   const uint32_t name = xReadCode ( length )
-#  define X_READ_SCODE_NO_RANGE_idx( name, idx, length )   const int32_t  name = xReadSCode( length )
+#  define X_READ_UVLC_NO_RANGE_idx(  name, idx         )   const uint32_t name = xReadUvlc (         #name idx )
+#  define X_READ_SVLC_NO_RANGE_idx(  name, idx         )   const int32_t  name = xReadSvlc (         #name idx )
+#  define X_READ_CODE_NO_RANGE_idx(  name, idx, length )   const uint32_t name = xReadCode ( length, #name idx )
+#  define X_READ_SCODE_NO_RANGE_idx( name, idx, length )   const int32_t  name = xReadSCode( length, #name idx )
 
 #define X_READ_FLAG_CHECK( name,          chk_cond, chk_msg ) const bool name = [&]{ X_READ_FLAG     ( name      ); CHECK_READ( chk_cond, chk_msg, name ); return name; }()
 #define X_READ_FLAG_CHECK_idx( name, idx, chk_cond, chk_msg ) const bool name = [&]{ X_READ_FLAG_idx ( name, idx ); CHECK_READ( chk_cond, chk_msg, name ); return name; }()
@@ -50,11 +52,11 @@ protected:
     void xReadSCode( uint32_t length, int32_t&  val );
 
     // read functions taking a reference for the result - tracing overloads
-    void xReadFlag (                  uint32_t& rValue, const char* pSymbolName );
-    void xReadUvlc (                  uint32_t& rValue, const char* pSymbolName );
-    void xReadSvlc (                  int32_t&  rValue, const char* pSymbolName );
-    void xReadCode ( uint32_t length, uint32_t& rValue, const char* pSymbolName );
-    void xReadSCode( uint32_t length, int32_t&  rValue, const char* pSymbolName );
+    void xReadFlag (                  uint32_t& rValue, const char* pSymbolName ) { const uint32_t pos = xTracePos(); xReadFlag (         rValue ); xTrace( pSymbolName, TRACE_FLAG,  pos, rValue ); }
+    void xReadUvlc (                  uint32_t& rValue, const char* pSymbolName ) { const uint32_t pos = xTracePos(); xReadUvlc (         rValue ); xTrace( pSymbolName, TRACE_UVLC,  pos, rValue ); }
+    void xReadSvlc (                  int32_t&  rValue, const char* pSymbolName ) { const uint32_t pos = xTracePos(); xReadSvlc (         rValue ); xTrace( pSymbolName, TRACE_SVLC,  pos, rValue ); }
+    void xReadCode ( uint32_t length, uint32_t& rValue, const char* pSymbolName ) { const uint32_t pos = xTracePos(); xReadCode ( length, rValue ); xTrace( pSymbolName, TRACE_CODE,  pos, rValue ); }
+    void xReadSCode( uint32_t length, int32_t&  rValue, const char* pSymbolName ) { const uint32_t pos = xTracePos(); xReadSCode( length, rValue ); xTrace( pSymbolName, TRACE_SCODE, pos, rValue ); }
 
     // read functions returning the result value
     bool     xReadFlag();
@@ -64,11 +66,19 @@ protected:
     int32_t  xReadSCode( uint32_t length );
 
     // read functions returning the result value - tracing overloads
-    bool     xReadFlag (                  const char* pSymbolName );
-    uint32_t xReadUvlc (                  const char* pSymbolName );
-    int32_t  xReadSvlc (                  const char* pSymbolName );
-    uint32_t xReadCode ( uint32_t length, const char* pSymbolName );
-    int32_t  xReadSCode( uint32_t length, const char* pSymbolName );
+    bool     xReadFlag (                  const char* pSymbolName ) { const uint32_t pos = xTracePos(); const bool     v = xReadFlag (        ); xTrace( pSymbolName, TRACE_FLAG,  pos, v ); return v; }
+    uint32_t xReadUvlc (                  const char* pSymbolName ) { const uint32_t pos = xTracePos(); const uint32_t v = xReadUvlc (        ); xTrace( pSymbolName, TRACE_UVLC,  pos, v ); return v; }
+    int32_t  xReadSvlc (                  const char* pSymbolName ) { const uint32_t pos = xTracePos(); const int32_t  v = xReadSvlc (        ); xTrace( pSymbolName, TRACE_SVLC,  pos, v ); return v; }
+    uint32_t xReadCode ( uint32_t length, const char* pSymbolName ) { const uint32_t pos = xTracePos(); const uint32_t v = xReadCode ( length ); xTrace( pSymbolName, TRACE_CODE,  pos, v ); return v; }
+    int32_t  xReadSCode( uint32_t length, const char* pSymbolName ) { const uint32_t pos = xTracePos(); const int32_t  v = xReadSCode( length ); xTrace( pSymbolName, TRACE_SCODE, pos, v ); return v; }
+
+    // TRACING_ENABLED is a constant, so without tracing these are removed together with the symbol names
+    uint32_t xTracePos() const { return TRACING_ENABLED ? m_pcBitstream->getNumBitsRead() : 0; }
+    void     xTrace( const char* pSymbolName, TraceSymbolKind kind, uint32_t pos, int64_t value ) const {
+        if( TRACING_ENABLED ) {
+            SyntaxTrace::get().symbol( pSymbolName, kind, pos, m_pcBitstream->getNumBitsRead() - pos, value );
+        }
+    }
 
 public:
     void            setBitstream( InputBitstream* p ) { m_pcBitstream = p; }
@@ -86,8 +96,47 @@ public:
 
     void  parseSPS                 ( SPS* pcSPS );
     void  parsePPS                 ( PPS* pcPPS );
+    void  parseAPS                 ( APS* aps );
+
+    // rplIdx is -1 for a list signalled in a picture or slice header
+    void  parseRefPicList          ( const SPS* sps, ReferencePictureList* rpl, int rplIdx );
+
+    // The picture header syntax elements that are not present are inferred here, from the SPS and PPS the picture
+    // header refers to, so the slices only copy them. Without readRbspTrailingBits the picture header is part of a
+    // slice header.
+    bool  parsePictureHeaderInSliceHeaderFlag();
+    void  parsePicHeader           ( PicHeader* picHeader, const ParameterSetMap<SPS, MAX_NUM_SPS>& spsMap, const ParameterSetMap<PPS, MAX_NUM_PPS>& ppsMap, bool readRbspTrailingBits );
+    // the slice has its parameter sets, picture header and NAL unit information set, the bitstream is positioned
+    // after sh_picture_header_in_slice_header_flag or the picture header it contains
+    void  parseSliceHeader         ( Slice* slice );
 
     bool  xMoreRbspData();
+
+private:
+    // general_timing_hrd_parameters() values the ols_timing_hrd_parameters() syntax depends on
+    struct GeneralHrdParams {
+        bool     nalHrdParamsPresentFlag = false;
+        bool     vclHrdParamsPresentFlag = false;
+        bool     duHrdParamsPresentFlag  = false;
+        uint32_t cpbCntMinus1            = 0;
+    };
+
+    // profile, tier, level, HRD and VUI information do not affect the decoding process, they are read and discarded
+    void  parseProfileTierLevel           ( bool profileTierPresentFlag, int maxNumSubLayersMinus1 );
+    void  parseConstraintInfo             ();
+    void  parseGeneralHrdParameters       ( GeneralHrdParams& hrd );
+    void  parseOlsHrdParameters           ( const GeneralHrdParams& hrd, int firstSubLayer, int maxSubLayersVal );
+    void  parseSubLayerHrdParameters      ( const GeneralHrdParams& hrd );
+
+    // ref_pic_lists() and pred_weight_table() of a picture or slice header
+    void  parseRefPicLists                ( const SPS* sps, const PPS* pps, ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01], int rplIdx[NUM_REF_PIC_LIST_01] );
+    // numRefIdxActive is only used for a table in a slice header
+    void  parsePredWeightTable            ( PredWeightTable& wp, int numWeights[NUM_REF_PIC_LIST_01], const SPS* sps, const PPS* pps,
+                                            const ReferencePictureList* const rpl[NUM_REF_PIC_LIST_01], const int* numRefIdxActive );
+
+    void  parseAlfAps                     ( APS* aps );
+    void  parseLmcsAps                    ( APS* aps );
+    void  parseScalingListAps             ( APS* aps );
 };
 
 struct NALUnit {
@@ -156,7 +205,7 @@ class InputNALUnit : public NALUnit {
     const InputBitstream & getBitstream() const { return m_Bitstream; }
           InputBitstream & getBitstream()       { return m_Bitstream; }
 
-    bool empty() { return m_Bitstream.getFifo().empty(); }
+    bool empty() { return m_Bitstream.empty(); }
 
     void readNalUnitHeader();
 };
@@ -176,9 +225,41 @@ private:
 
     HLSyntaxReader            m_HLSReader;
 
+    ParameterSetMap<SPS, MAX_NUM_SPS> m_spsMap;
+    ParameterSetMap<PPS, MAX_NUM_PPS> m_ppsMap;
+    ParameterSetMap<APS, MAX_NUM_APS_IDS * NUM_APS_TYPES> m_apsMap;   // indexed by APS::getMapKey()
+
+    // derived constants of the last activation of each PPS
+    std::shared_ptr<const SeqPicContext> m_seqPicCtx[MAX_NUM_PPS];
+
+    // the picture header of the current picture and the slices parsed so far, the slices share the picture header
+    std::shared_ptr<PicHeader>          m_picHeader;
+    std::vector<std::unique_ptr<Slice>> m_slices;
+    std::vector<std::unique_ptr<Slice>> m_unusedSlices;   // slices of previous pictures, reused without allocating
+    bool                                m_firstPicInSequence = true;   //!< no picture since the start or an end of sequence
+
 public:
     DecLibParser( DecLib& decLib, PicListManager& picListManager ) : m_decLib( decLib ), m_picListManager( picListManager ) {}
     bool     parse                ( InputNALUnit& nalu );
 
+    // the picture header and the slices of the current picture, they are replaced when the next picture starts
+    const PicHeader*                           getPicHeader() const { return m_picHeader.get(); }
+    const std::vector<std::unique_ptr<Slice>>& getSlices()    const { return m_slices; }
+
     void xDecodeSPS             ( InputNALUnit& nalu );
+    void xDecodePPS             ( InputNALUnit& nalu );
+    void xDecodeAPS             ( InputNALUnit& nalu );
+    void xDecodePicHeader       ( InputNALUnit& nalu );
+    bool xDecodeSlice           ( InputNALUnit& nalu );
+
+    // activates the parameter sets of the picture, derives its POC and looks up the APSs of the picture header
+    void xNewPicHeader          ();
+    void xStartPicture          ( const InputNALUnit& nalu );
+    void xResolveAlfAPSs        ( AlfControls& alf, int bitDepth );
+
+    // returns the derived constants of the PPS and its SPS, they are only recomputed when one of them changed
+    std::shared_ptr<const SeqPicContext> xActivateParameterSets( int ppsId );
+
+    // returns the APS with its tables derived for the bit depth, they are derived once per APS and bit depth
+    std::shared_ptr<const APS> xGetAPS( ApsType apsType, int apsId, int bitDepth );
 };
\ No newline at end of file
@@ -1,3 +1,6 @@
+#include <string.h>
+#include <algorithm>
+
 #include "Decode.h"
 #include "Common/Rom.h"
 #include "Common/Picture.h"
@@ -28,6 +31,15 @@ NalType DecImpl::getNalUnitType (AccessUnit& rcAccessUnit) {
     unsigned char* pcBuf = rcAccessUnit.payload;
     int iOffset=0;
 
+    if (rcAccessUnit.nalLengthSize > 0) {
+        // NAL unit header directly follows the length prefix
+        iOffset = rcAccessUnit.nalLengthSize + 1;
+        if (iOffset >= rcAccessUnit.payloadUsedSize) {
+            return eNalType;
+        }
+        return (NalType)((pcBuf[iOffset] >> 3) & 0x1F);
+    }
+
     int found = 1;
     int i=0;
     for (i = 0; i < 3; i++) {
@@ -70,83 +82,54 @@ NalType DecImpl::getNalUnitType (AccessUnit& rcAccessUnit) {
 }
 
 int DecImpl::decode(AccessUnit& rcAccessUnit, Frame** ppcFrame) {
-    InputNALUnit nalu;
+    InputNALUnit& nalu = m_nalu;
     Picture * pcPic = nullptr;
 
     if( rcAccessUnit.payloadUsedSize ) {
-        bool bStartCodeFound = false;
-        std::vector<size_t> iStartCodePosVec;
-        std::vector<size_t> iAUEndPosVec;
-        std::vector<size_t> iStartCodeSizeVec;
-
-        int pos = 0;
-        while( pos+3 < rcAccessUnit.payloadUsedSize ) {
-            int iFound = xRetrieveNalStartCode( &rcAccessUnit.payload[pos], 3 );
-            if( iFound == 1 ) {
-                bStartCodeFound = true;
-
-                iStartCodePosVec.push_back( pos+4 );
-                iStartCodeSizeVec.push_back( 4 );
-
-                if( pos > 0 ) {
-                    iAUEndPosVec.push_back(pos);
+        const NalBoundary* pcNals = rcAccessUnit.nals;
+        size_t             uiNumNals = rcAccessUnit.numNals;
+        if( pcNals == nullptr || uiNumNals == 0 ) {
+            m_nalBoundaries.clear();
+            if( rcAccessUnit.nalLengthSize ) {
+                // length-prefixed NAL units, the sizes are known and nothing has to be scanned
+                if( rcAccessUnit.nalLengthSize != 1 && rcAccessUnit.nalLengthSize != 2 && rcAccessUnit.nalLengthSize != 4 ) {
+                    return W266_ERR_PARAMETER;
                 }
-
-                pos+=3;
-            } else {
-                iFound = xRetrieveNalStartCode(&rcAccessUnit.payload[pos], 2);
-                if( iFound == 1 ) {
-                    bStartCodeFound = true;
-
-                    iStartCodePosVec.push_back( pos+3 );
-                    iStartCodeSizeVec.push_back( 3 );
-                    if( pos > 0 )
-                    {
-                        iAUEndPosVec.push_back(pos);
-                    }
-
-                    pos+=2;
+                if( !splitLengthPrefixedNalUnits( rcAccessUnit.payload, rcAccessUnit.payloadUsedSize, rcAccessUnit.nalLengthSize, m_nalBoundaries ) ) {
+                    return W266_ERR_DEC_INPUT;
                 }
+            } else {
+                scanNalUnits( rcAccessUnit.payload, rcAccessUnit.payloadUsedSize, m_nalBoundaries );
             }
-            pos++;
-        }
-
-        // if( !bStartCodeFound ) {
-        //     assert(0); //error
-        // }
-
-        int iLastPos = rcAccessUnit.payloadUsedSize;
-        while( iLastPos > 0 && rcAccessUnit.payload[iLastPos-1] == 0 ) {
-            iLastPos--;
+            uiNumNals = m_nalBoundaries.size();
+            pcNals    = m_nalBoundaries.data();
         }
-        iAUEndPosVec.push_back( iLastPos );
 
         InputBitstream& rBitstream = nalu.getBitstream();
         // iterate over all AU´s
-        for( size_t iAU = 0; iAU < iStartCodePosVec.size(); iAU++ ) {
+        for( size_t iAU = 0; iAU < uiNumNals; iAU++ ) {
             //rBitstream.resetToStart();
             //rBitstream.getFifo().clear();
             //rBitstream.clearEmulationPreventionByteLocation();
 
-            size_t numNaluBytes = iAUEndPosVec[iAU] - iStartCodePosVec[iAU];
+            size_t numNaluBytes = pcNals[iAU].size;
             if( numNaluBytes ) {
-                const uint8_t*    naluData = &rcAccessUnit.payload[iStartCodePosVec[iAU]];
+                const uint8_t*    naluData = &rcAccessUnit.payload[pcNals[iAU].offset];
                 const NalUnitType nut      = (NalUnitType) ( ( naluData[1] >> 3 ) & 0x1f );
-                // perform anti-emulation prevention
-                // if( 0 != xConvertPayloadToRBSP( naluData, numNaluBytes, &rBitstream, NALUnit::isVclNalUnitType( nut ) ) )
-                // {
-                //     return VVDEC_ERR_UNSPECIFIED;
-                // }
-
-                // rBitstream.resetToStart();
-                xConvertPayloadToRBSP( naluData, numNaluBytes, &rBitstream, NALUnit::isVclNalUnitType( nut ) );
+                // bytes that may be read behind the NAL unit start, including the remaining payload buffer
+                const size_t      readable = (size_t)std::max( rcAccessUnit.payloadSize, rcAccessUnit.payloadUsedSize ) - pcNals[iAU].offset;
+                // perform anti-emulation prevention, the bitstream is left pointing at the payload if there is nothing to remove
+                if( 0 != xConvertPayloadToRBSP( naluData, numNaluBytes, readable, &rBitstream, NALUnit::isVclNalUnitType( nut ) ) )
+                {
+                    return W266_ERR_UNSPECIFIED;
+                }
 
                 xReadNalUnitHeader( nalu );
 
-                if( rcAccessUnit.ctsValid ){  nalu.m_cts = rcAccessUnit.cts; }
-                if( rcAccessUnit.dtsValid ){  nalu.m_dts = rcAccessUnit.dts; }
+                nalu.m_cts = rcAccessUnit.ctsValid ? rcAccessUnit.cts : 0;
+                nalu.m_dts = rcAccessUnit.dtsValid ? rcAccessUnit.dts : 0;
                 nalu.m_rap = rcAccessUnit.rap;
-                nalu.m_bits = ( numNaluBytes + iStartCodeSizeVec[iAU] ) * 8;
+                nalu.m_bits = ( numNaluBytes + pcNals[iAU].startCodeLen ) * 8;
 
                 pcPic = m_cDecLib->decode( nalu );
 
@@ -158,25 +141,6 @@ int DecImpl::decode(AccessUnit& rcAccessUnit, Frame** ppcFrame) {
     return 0;
 }
 
-int DecImpl::xRetrieveNalStartCode( unsigned char *pB, int iZerosInStartcode ) {
-    int found = 1;
-    int i=0;
-    for ( i = 0; i < iZerosInStartcode; i++)
-    {
-        if( pB[i] != 0 )
-        {
-            found = 0;
-        }
-    }
-
-    if( pB[i] != 1 )
-    {
-        found = 0;
-    }
-
-    return found;
-}
-
 int DecImpl::xReadNalUnitHeader(InputNALUnit& nalu)
 {
     InputBitstream& bs = nalu.getBitstream();
@@ -206,38 +170,59 @@ int DecImpl::xReadNalUnitHeader(InputNALUnit& nalu)
     return 0;
 }
 
-int DecImpl::xConvertPayloadToRBSP( const uint8_t* payload, size_t payloadLen, InputBitstream* bitstream, bool isVclNalUnit )
+int DecImpl::xConvertPayloadToRBSP( const uint8_t* payload, size_t payloadLen, size_t readableLen, InputBitstream* bitstream, bool isVclNalUnit )
 {
     uint32_t zeroCount = 0;
 
     AlignedByteVec& nalUnitBuf = bitstream->getFifo();
-    nalUnitBuf.resize( payloadLen );
-
-    const uint8_t*           it_read  = payload;
-    AlignedByteVec::iterator it_write = nalUnitBuf.begin();
-    for( size_t pos = 0; pos < payloadLen; it_read++, it_write++, pos++ )
+    bitstream->clearEmulationPreventionByteLocation();
+
+    // Emulation prevention bytes can only follow 00 00, so only the byte following each zero pair is
+    // inspected. Nothing is copied until the first emulation prevention byte is found; NAL units
+    // without any are read directly from the payload.
+    const uint8_t* it_read  = payload;
+    const uint8_t* run      = payload;   // start of the bytes not yet copied
+    const uint8_t* end      = payload + payloadLen;
+    uint8_t*       it_write = nullptr;
+    while( it_read < end )
     {
-        if(zeroCount >= 2 && *it_read < 0x03 )
+        const uint8_t* zeroPair = findZeroPair( it_read, end );
+        if( zeroPair == end )
+        {
+            zeroCount = ( end[-1] == 0x00 ) ? 1 : 0;
+            break;
+        }
+
+        it_read = zeroPair + 2;
+        if( it_read == end )
+        {
+            zeroCount = 2;
+            break;
+        }
+        if( *it_read < 0x03 )
         {
             return -1;
         }
-        if (zeroCount == 2 && *it_read == 0x03)
+        if( *it_read == 0x03 )
         {
-            pos++;
-            it_read++;
-            zeroCount = 0;
-            if( pos >= payloadLen )
+            if( it_write == nullptr )
             {
-                break;
+                nalUnitBuf.resize( payloadLen );
+                it_write = nalUnitBuf.data();
             }
+            ::memcpy( it_write, run, it_read - run );
+            it_write += it_read - run;
+            // kept to map the entry point offsets of the slice header to the RBSP
+            bitstream->pushEmulationPreventionByteLocation( (uint32_t)( it_read - payload ) );
 
-            if( *it_read > 0x03 )
+            it_read++;
+            run = it_read;
+            if( it_read < end && *it_read > 0x03 )
             {
                 return -1;
             }
         }
-        zeroCount = (*it_read == 0x00) ? zeroCount+1 : 0;
-        *it_write = *it_read;
+        zeroCount = 0;
     }
 
     if( zeroCount != 0 && !isVclNalUnit )
@@ -245,19 +230,33 @@ int DecImpl::xConvertPayloadToRBSP( const uint8_t* payload, size_t payloadLen, I
         return -1;
     }
 
+    const uint8_t* begin = payload;
+    if( it_write != nullptr )
+    {
+        ::memcpy( it_write, run, end - run );
+        it_write += end - run;
+        begin = nalUnitBuf.data();
+        end   = it_write;
+    }
+
     if (isVclNalUnit)
     {
         // Remove cabac_zero_word from payload if present
-        int n = 0;
-
-        while (it_write[-1] == 0x00)
+        while( end > begin && end[-1] == 0x00 )
         {
-            it_write--;
-            n++;
+            end--;
         }
     }
 
-    nalUnitBuf.resize(it_write - nalUnitBuf.begin());
+    if( it_write != nullptr )
+    {
+        nalUnitBuf.resize( end - begin );
+        bitstream->attachFifo();
+    }
+    else
+    {
+        bitstream->attachView( begin, end - begin, readableLen );
+    }
 
     return 0;
 }
@@ -275,6 +274,9 @@ void accessUnitDefault(AccessUnit *accessUnit) {
     accessUnit->ctsValid = false;
     accessUnit->dtsValid = false;
     accessUnit->rap = false;
+    accessUnit->nals = NULL;
+    accessUnit->numNals = 0;
+    accessUnit->nalLengthSize = 0;
 }
 
 AccessUnit* accessUnitAlloc() {
@@ -319,8 +321,11 @@ NalType getNalUnitType(AccessUnit *accessUnit) {
 int decode(Decoder *dec, AccessUnit* accessUnit, Frame** frame) {
     *frame = nullptr;
     auto d = (DecImpl*)dec;
-    d->decode(*accessUnit, frame);
-    return 0;
+    return d->decode(*accessUnit, frame);
+}
+
+uint64_t getDecoderAllocationCount() {
+    return DecImpl::getNumAllocations();
 }
 
 bool handleFrame() {
@@ -6,6 +6,7 @@
 #include <map>
 
 #include "Common/Def.h"
+#include "Common/NalScanner.h"
 #include "DecLib.h"
 
 #define MAX_CODED_PICTURE_SIZE  800000
@@ -37,6 +38,9 @@ typedef struct AccessUnit {
     bool ctsValid;
     bool dtsValid;
     bool rap;
+    const NalBoundary* nals;    // optional NAL unit boundaries inside payload, found by the reader
+    int numNals;                // 0: the decoder scans the payload for start codes itself
+    int nalLengthSize;          // 0: Annex-B payload, 1, 2 or 4: NAL units preceded by a big-endian size of this many bytes
 } AccessUnit;
 
 typedef struct Plane {
@@ -167,18 +171,23 @@ public:
     // int reset();
     static NalType getNalUnitType       (AccessUnit& accessUnit);
     int decode( AccessUnit& accessUnit, Frame** ppframe );
+    static uint64_t getNumAllocations() { return getNumAlignedAllocations(); }
 
 
 private:
+    friend class RbspConversionTest;   // Test/TestRbspConversion.cpp
+
     typedef std::tuple<Frame, Picture*> FrameListEntry;
     typedef std::map<uint64_t, FrameStorage> FrameStorageMap;
     typedef FrameStorageMap::value_type      FrameStorageMapType;
 
     std::unique_ptr<DecLib>                  m_cDecLib;
 
-    static int xRetrieveNalStartCode ( unsigned char *pB, int iZerosInStartcode );
+    // scratch reused by every decode() call, its capacity only grows so the steady state does not allocate
+    NalBoundaryVec                           m_nalBoundaries;
+    InputNALUnit                             m_nalu;
 
-    static int xConvertPayloadToRBSP ( const uint8_t* payload, size_t payloadLen, InputBitstream* bitstream, bool isVclNalUnit );
+    static int xConvertPayloadToRBSP ( const uint8_t* payload, size_t payloadLen, size_t readableLen, InputBitstream* bitstream, bool isVclNalUnit );
     static int xReadNalUnitHeader    ( InputNALUnit& nalu );
 };
 
@@ -188,5 +197,6 @@ Decoder* decoderOpen();
 NalType getNalUnitType(AccessUnit *accessUnit);
 int decode(Decoder *dec, AccessUnit* accessUnit, Frame** frame);
 bool handleFrame();
+uint64_t getDecoderAllocationCount();
 int decoderClose();
 void accessUnitFree();
\ No newline at end of file
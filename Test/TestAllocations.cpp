@@ -0,0 +1,65 @@
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "Decoder/Decode.h"
+#include "TestCommon.h"
+
+// Every heap allocation of the process goes through these replacements, including the ones made by
+// std::vector growth, std::make_shared and the standard library, not only xMalloc/AlignedAllocator.
+static std::atomic<uint64_t> g_numAllocations{ 0 };
+
+void* operator new(size_t size) {
+    g_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    g_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void  operator delete(void* p) noexcept { free(p); }
+void  operator delete[](void* p) noexcept { free(p); }
+void  operator delete(void* p, size_t) noexcept { free(p); }
+void  operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Decodes the same access unit over and over: after the first calls have sized the reusable scratch,
+// parameter sets are recognized as repetitions and every picture reuses the buffers of the previous one,
+// so the steady state must not touch the heap at all.
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: TestAllocations <bitstream>\n");
+        return 1;
+    }
+    std::vector<uint8_t> data = readFile(argv[1]);
+    TEST_CHECK(!data.empty());
+
+    Decoder* dec = decoderOpen();
+    TEST_CHECK(dec != nullptr);
+
+    AccessUnit& accessUnit     = *accessUnitAlloc();
+    accessUnit.payload         = data.data();
+    accessUnit.payloadSize     = (int)data.size();
+    accessUnit.payloadUsedSize = (int)data.size();
+
+    Frame* frame = nullptr;
+    for(int i = 0; i < 4; i++) {
+        TEST_CHECK_EQ(decode(dec, &accessUnit, &frame), W266_OK);
+    }
+
+    const uint64_t numAllocationsBefore        = g_numAllocations.load();
+    const uint64_t numDecoderAllocationsBefore = getDecoderAllocationCount();
+    for(int i = 0; i < 1000; i++) {
+        decode(dec, &accessUnit, &frame);
+    }
+    TEST_CHECK_EQ(g_numAllocations.load() - numAllocationsBefore, 0);
+    TEST_CHECK_EQ(getDecoderAllocationCount() - numDecoderAllocationsBefore, 0);
+
+    decoderClose();
+    return testResult("TestAllocations");
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Common/Contexts.h"
+#include "TestCommon.h"
+
+// CABAC arithmetic encoder of the VVC reference encoder, used to produce the bin strings the decoding
+// engine is tested with. The context models are the decoder's BinProbModel, so both sides adapt the
+// probabilities with the same code. finish() writes the terminating bin and the stop and alignment bits.
+class TestBinEncoder {
+public:
+    explicit TestBinEncoder(TestBitWriter& writer) : m_writer(writer) {}
+
+    void encodeBin(uint32_t bin, BinProbModel& ctx) {
+        const uint32_t lps = ctx.getLPS(m_range);
+        m_range -= lps;
+        if(bin != ctx.mps()) {
+            const int numBits = __builtin_clz(lps) - 23;
+            m_low   = (m_low + m_range) << numBits;
+            m_range = lps << numBits;
+            m_bitsLeft -= numBits;
+        } else if(m_range < 256) {
+            m_low <<= 1;
+            m_range <<= 1;
+            m_bitsLeft--;
+        }
+        ctx.update(bin);
+        xTestAndWriteOut();
+    }
+
+    void encodeBinEP(uint32_t bin) {
+        m_low <<= 1;
+        if(bin) {
+            m_low += m_range;
+        }
+        m_bitsLeft--;
+        xTestAndWriteOut();
+    }
+
+    // numBins bypass bins, the first one is the MSB of bins
+    void encodeBinsEP(uint32_t bins, int numBins) {
+        for(int i = numBins; i-- > 0;) {
+            encodeBinEP((bins >> i) & 1);
+        }
+    }
+
+    void encodeBinTrm(uint32_t bin) {
+        m_range -= 2;
+        if(bin) {
+            m_low += m_range;
+            m_low <<= 7;
+            m_range = 2 << 7;
+            m_bitsLeft -= 7;
+        } else if(m_range >= 256) {
+            return;
+        } else {
+            m_low <<= 1;
+            m_range <<= 1;
+            m_bitsLeft--;
+        }
+        xTestAndWriteOut();
+    }
+
+    // abs_remainder and dec_abs_level binarization: Rice code below cutoff, then a limited Exp-Golomb escape
+    void encodeRemAbsEP(uint32_t value, uint32_t goRicePar, uint32_t cutoff, int maxLog2TrDynamicRange) {
+        const uint32_t prefix = value >> goRicePar;
+        const uint32_t mask   = (1u << goRicePar) - 1;
+        if(prefix < cutoff) {
+            encodeBinsEP((1u << prefix) - 1, prefix);
+            encodeBinEP(0);
+            encodeBinsEP(value & mask, goRicePar);
+            return;
+        }
+        const uint32_t maxPrefix = 32 - cutoff - maxLog2TrDynamicRange;
+        const uint32_t codeValue = prefix - cutoff;
+        uint32_t       egLen     = 0;
+        while(egLen < maxPrefix && codeValue > (2u << egLen) - 2) {
+            egLen++;
+        }
+        encodeBinsEP((1u << (egLen + cutoff)) - 1, egLen + cutoff);
+        const uint32_t suffix = ((codeValue - ((1u << egLen) - 1)) << goRicePar) | (value & mask);
+        if(egLen == maxPrefix) {
+            encodeBinsEP(suffix, maxLog2TrDynamicRange);
+        } else {
+            encodeBinEP(0);
+            encodeBinsEP(suffix, egLen + goRicePar);
+        }
+    }
+
+    // end_of_slice_segment_flag equal to 1, the flush and the byte alignment of the slice data
+    void finish() {
+        encodeBinTrm(1);
+        if(m_low >> (32 - m_bitsLeft)) {
+            m_writer.write(m_bufferedByte + 1, 8);
+            for(; m_numBufferedBytes > 1; m_numBufferedBytes--) {
+                m_writer.write(0x00, 8);
+            }
+            m_low -= 1u << (32 - m_bitsLeft);
+        } else {
+            if(m_numBufferedBytes > 0) {
+                m_writer.write(m_bufferedByte, 8);
+            }
+            for(; m_numBufferedBytes > 1; m_numBufferedBytes--) {
+                m_writer.write(0xff, 8);
+            }
+        }
+        m_writer.write(m_low >> 8, 24 - m_bitsLeft);
+        m_writer.writeBit(1);
+        while(m_writer.getNumBits() % 8) {
+            m_writer.writeBit(0);
+        }
+    }
+
+private:
+    void xTestAndWriteOut() {
+        if(m_bitsLeft < 12) {
+            xWriteOut();
+        }
+    }
+
+    // Outputs the top byte of low. 0xff bytes are held back until it is known whether a carry reaches them.
+    void xWriteOut() {
+        const uint32_t leadByte = m_low >> (24 - m_bitsLeft);
+        m_bitsLeft += 8;
+        m_low &= 0xffffffffu >> m_bitsLeft;
+        if(leadByte == 0xff) {
+            m_numBufferedBytes++;
+        } else if(m_numBufferedBytes > 0) {
+            const uint32_t carry = leadByte >> 8;
+            m_writer.write(m_bufferedByte + carry, 8);
+            m_bufferedByte = leadByte & 0xff;
+            for(; m_numBufferedBytes > 1; m_numBufferedBytes--) {
+                m_writer.write((0xff + carry) & 0xff, 8);
+            }
+        } else {
+            m_numBufferedBytes = 1;
+            m_bufferedByte     = leadByte;
+        }
+    }
+
+    TestBitWriter& m_writer;
+    uint32_t       m_low              = 0;
+    uint32_t       m_range            = 510;
+    int            m_bitsLeft         = 23;
+    uint32_t       m_numBufferedBytes = 0;
+    uint32_t       m_bufferedByte     = 0xff;
+};
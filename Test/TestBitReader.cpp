@@ -0,0 +1,323 @@
+#include <string.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TEST_HAS_RDTSC 1
+#endif
+
+#include "Common/BitStream.h"
+#include "TestCommon.h"
+
+static uint32_t readRef(const std::vector<uint8_t>& data, size_t& bitPos, uint32_t numBits) {
+    uint32_t value = 0;
+    for(uint32_t i = 0; i < numBits; i++, bitPos++) {
+        const uint32_t bit = bitPos < 8 * data.size() ? (data[bitPos / 8] >> (7 - bitPos % 8)) & 1 : 0;
+        value = (value << 1) | bit;
+    }
+    return value;
+}
+
+// The reader InputBitstream used before the unaligned refill: aligned 8 byte loads, a byte by byte switch
+// at unaligned positions and the end of the data, and the width check on every refill. Kept out of line
+// like InputBitstream::read as the benchmark baseline.
+class SwitchBitReader {
+public:
+    SwitchBitReader(const uint8_t* data, uint32_t size) : m_data(data), m_size(size) {}
+
+    __attribute__((noinline)) uint32_t read(uint32_t numBits) {
+        static const uint64_t ONES   = ~(uint64_t)0;
+        uint32_t              retval = 0;
+        if(numBits <= m_numHeldBits) {
+            retval = (uint32_t)(m_heldBits >> (m_numHeldBits - numBits)) & ~(ONES << numBits);
+            m_numHeldBits -= numBits;
+            return retval;
+        }
+        CHECK(numBits > 32, "Too many bits read");
+        if(m_numHeldBits) {
+            numBits -= m_numHeldBits;
+            retval = ((uint32_t)m_heldBits & ~(ONES << m_numHeldBits)) << numBits;
+        }
+        loadNextBits(numBits);
+        m_numHeldBits -= numBits;
+        return retval | (uint32_t)(m_heldBits >> m_numHeldBits);
+    }
+
+private:
+    void loadNextBits(uint32_t requiredBits) {
+        uint32_t       numBytes     = 8;
+        const uint32_t misalignment = (uint32_t)((uintptr_t)(m_data + m_idx) & 0x7);
+        if(m_idx + numBytes > m_size || misalignment != 0) {
+            const uint32_t requiredBytes = (requiredBits + 7) >> 3;
+            CHECK(m_idx + requiredBytes > m_size, "Exceeded FIFO size");
+            numBytes = m_size - m_idx;
+            if(misalignment != 0 && 8 - misalignment >= requiredBytes && numBytes > 8 - misalignment) {
+                numBytes = 8 - misalignment;
+            }
+            numBytes   = std::min<uint32_t>(numBytes, 8);
+            m_heldBits = 0;
+            for(uint32_t i = 0; i < numBytes; i++) {
+                m_heldBits = (m_heldBits << 8) | m_data[m_idx++];
+            }
+        } else {
+            uint64_t word;
+            memcpy(&word, m_data + m_idx, sizeof(word));
+            m_heldBits = __builtin_bswap64(word);
+            m_idx += 8;
+        }
+        m_numHeldBits = numBytes * 8;
+    }
+
+    const uint8_t* m_data;
+    uint32_t       m_size;
+    uint32_t       m_idx         = 0;
+    uint32_t       m_numHeldBits = 0;
+    uint64_t       m_heldBits    = 0;
+};
+
+// Reads random widths from FIFOs and borrowed views of every size up to 80 bytes at every alignment,
+// with and without readable bytes behind the view, and compares read(), peekBits() and the bit counters
+// with a bit by bit reference.
+static void testReadPeek() {
+    TestRandom           rnd(13);
+    std::vector<uint8_t> buffer(128 + 16);
+
+    for(int iter = 0; iter < 20000; iter++) {
+        const size_t size   = rnd.next(81);
+        const size_t offset = rnd.next(16);
+        for(uint8_t& b: buffer) {
+            b = (uint8_t)rnd.next();
+        }
+        const std::vector<uint8_t> data(buffer.begin() + offset, buffer.begin() + offset + size);
+
+        InputBitstream bs;
+        switch(iter % 3) {
+        case 0:   // owned FIFO with padding
+            bs.getFifo().assign(data.begin(), data.end());
+            bs.attachFifo();
+            break;
+        case 1:   // view without anything readable behind it: the tail is loaded byte by byte
+            bs.attachView(buffer.data() + offset, size, size);
+            break;
+        default:  // view followed by more data, as for NAL units inside an access unit
+            bs.attachView(buffer.data() + offset, size, buffer.size() - offset);
+            break;
+        }
+
+        size_t bitPos = 0;
+        while(bitPos < 8 * size) {
+            const uint32_t left    = (uint32_t)(8 * size - bitPos);
+            const uint32_t numBits = std::min<uint32_t>(1 + rnd.next(32), left);
+
+            size_t         peekPos  = bitPos;
+            const uint32_t peekBits = 1 + rnd.next(32);
+            TEST_CHECK_EQ(bs.peekBits(peekBits), readRef(data, peekPos, peekBits));   // zeros past the end
+
+            TEST_CHECK_EQ(bs.read(numBits), readRef(data, bitPos, numBits));
+            TEST_CHECK_EQ(bs.getNumBitsRead(), bitPos);
+            TEST_CHECK_EQ(bs.getNumBitsLeft(), 8 * size - bitPos);
+        }
+
+        bool thrown = false;
+        try {
+            bs.read(1);
+        } catch(...) {
+            thrown = true;
+        }
+        TEST_CHECK(thrown);
+    }
+}
+
+// Emulation prevention as the encoder applies it to the whole NAL unit: 03 is inserted before every byte
+// up to 3 that follows 00 00. nalPos receives the NAL unit position of every RBSP byte.
+static void insertEmulationPrevention(const std::vector<uint8_t>& rbsp, std::vector<uint8_t>& nal,
+                                      std::vector<uint32_t>& epbLocations, std::vector<uint32_t>& nalPos) {
+    nal.clear();
+    epbLocations.clear();
+    nalPos.clear();
+    int zeros = 0;
+    for(uint8_t b: rbsp) {
+        if(zeros >= 2 && b <= 3) {
+            epbLocations.push_back((uint32_t)nal.size());
+            nal.push_back(3);
+            zeros = 0;
+        }
+        nalPos.push_back((uint32_t)nal.size());
+        nal.push_back(b);
+        zeros = b == 0 ? zeros + 1 : 0;
+    }
+}
+
+// Slice data split into substreams whose boundaries put an emulation prevention byte just before, on and
+// just after each entry point. The entry point offsets count NAL unit bytes; an emulation prevention byte
+// directly before a substream may be counted to either side. The views returned by extractSubstreams()
+// must hold exactly the RBSP bytes of each substream, at every slice header length.
+static void testExtractSubstreams() {
+    TestRandom rnd(14);
+
+    for(int iter = 0; iter < 5000; iter++) {
+        std::vector<uint8_t> rbsp;
+        // slice header, the last byte holds the alignment bit and is never zero
+        const uint32_t headerSize = 2 + rnd.next(6);
+        for(uint32_t i = 0; i < headerSize; i++) {
+            rbsp.push_back(rnd.next(2) ? 0 : (uint8_t)rnd.next());
+        }
+        rbsp.back() |= 0x80;
+
+        const uint32_t        numSubstreams = 1 + rnd.next(6);
+        std::vector<uint32_t> rbspStart;
+        for(uint32_t k = 0; k < numSubstreams; k++) {
+            if(k > 0) {
+                switch(rnd.next(4)) {
+                case 0:   // 00 00 | 01: the emulation prevention byte is just before or on the entry point
+                    rbsp.push_back(0); rbsp.push_back(0);
+                    rbspStart.push_back((uint32_t)rbsp.size());
+                    rbsp.push_back(1);
+                    break;
+                case 1:   // 00 | 00 01: just after it
+                    rbsp.push_back(0);
+                    rbspStart.push_back((uint32_t)rbsp.size());
+                    rbsp.push_back(0); rbsp.push_back(2);
+                    break;
+                case 2:   // | 00 00 00: two bytes after it
+                    rbspStart.push_back((uint32_t)rbsp.size());
+                    rbsp.push_back(0); rbsp.push_back(0); rbsp.push_back(0);
+                    break;
+                default:
+                    rbspStart.push_back((uint32_t)rbsp.size());
+                    break;
+                }
+            } else {
+                rbspStart.push_back((uint32_t)rbsp.size());
+            }
+            for(uint32_t i = 1 + rnd.next(40); i > 0; i--) {
+                rbsp.push_back(rnd.next(2) ? 0 : (uint8_t)rnd.next(5));
+            }
+        }
+        rbsp.push_back(0x80);
+        rbspStart.push_back((uint32_t)rbsp.size());
+
+        std::vector<uint8_t>  nal;
+        std::vector<uint32_t> epbLocations, nalPos;
+        insertEmulationPrevention(rbsp, nal, epbLocations, nalPos);
+
+        std::vector<uint32_t> entryPointOffsets;
+        uint32_t              prevNalStart = nalPos[rbspStart[0]];
+        for(uint32_t k = 1; k < numSubstreams; k++) {
+            uint32_t nalStart = nalPos[rbspStart[k]];
+            if(nalStart > 0 && nal[nalStart - 1] == 3 && nalPos[rbspStart[k] - 1] != nalStart - 1 && rnd.next(2)) {
+                nalStart--;   // count the emulation prevention byte to the substream that follows it
+            }
+            entryPointOffsets.push_back(nalStart - prevNalStart);
+            prevNalStart = nalStart;
+        }
+
+        InputBitstream bs;
+        bs.getFifo().assign(rbsp.begin(), rbsp.end());
+        bs.attachFifo();
+        for(uint32_t pos: epbLocations) {
+            bs.pushEmulationPreventionByteLocation(pos);
+        }
+        for(uint32_t i = 0; i < headerSize; i++) {
+            bs.read(8);
+        }
+
+        std::vector<InputBitstream> substreams;
+        bs.extractSubstreams(entryPointOffsets, substreams);
+        TEST_CHECK_EQ(substreams.size(), numSubstreams);
+        for(uint32_t k = 0; k < std::min<size_t>(substreams.size(), numSubstreams); k++) {
+            const uint32_t size = rbspStart[k + 1] - rbspStart[k];
+            TEST_CHECK_EQ(substreams[k].getByteSize(), size);
+            TEST_CHECK(substreams[k].getData() == bs.getData() + rbspStart[k]);
+            for(uint32_t i = 0; i < std::min(size, substreams[k].getByteSize()); i++) {
+                TEST_CHECK_EQ(substreams[k].read(8), rbsp[rbspStart[k] + i]);
+            }
+        }
+
+        // an offset past the end of the slice data is rejected
+        entryPointOffsets.push_back((uint32_t)nal.size());
+        bool thrown = false;
+        try {
+            bs.extractSubstreams(entryPointOffsets, substreams);
+        } catch(...) {
+            thrown = true;
+        }
+        TEST_CHECK(thrown);
+    }
+}
+
+static uint64_t readCycles() {
+#if TEST_HAS_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Cycles (TSC on x86) and nanoseconds per bit of read() for random field widths as in headers and for
+// byte reads, over a 16 MiB view starting at an odd address, compared with the old switch based reader.
+template<class Reader>
+static void benchReader(const std::vector<uint8_t>& data, const std::vector<uint8_t>& widths, double& bestSec,
+                        uint64_t& bestCycles, uint64_t& numBits, uint32_t& sum) {
+    bestSec    = 1e9;
+    bestCycles = UINT64_MAX;
+    sum        = 0;
+    for(int run = 0; run < 5; run++) {
+        Reader         reader(data.data() + 1, (uint32_t)data.size() - 1);
+        const uint64_t limit = 8 * (uint64_t)data.size() - 64;
+        size_t         idx   = 0;
+        numBits = 0;
+
+        BenchTimer     timer;
+        const uint64_t startCycles = readCycles();
+        while(numBits < limit) {
+            const uint32_t w = widths[idx++ & 0xffff];
+            sum += reader.read(w);
+            numBits += w;
+        }
+        bestCycles = std::min<uint64_t>(bestCycles, readCycles() - startCycles);
+        bestSec    = std::min(bestSec, timer.elapsedSec());
+    }
+}
+
+struct ViewBitReader {
+    ViewBitReader(const uint8_t* data, uint32_t size) { bs.attachView(data, size, size); }
+    uint32_t       read(uint32_t numBits) { return bs.read(numBits); }
+    InputBitstream bs;
+};
+
+static void benchmark(const char* name, uint32_t minBits, uint32_t maxBits) {
+    TestRandom           rnd(17);
+    std::vector<uint8_t> data(16 << 20);
+    std::vector<uint8_t> widths(1 << 16);
+    for(uint8_t& b: data) {
+        b = (uint8_t)rnd.next();
+    }
+    for(uint8_t& w: widths) {
+        w = (uint8_t)(minBits + rnd.next(maxBits - minBits + 1));
+    }
+
+    double   secOld, secNew;
+    uint64_t cyclesOld, cyclesNew, bitsOld, bitsNew;
+    uint32_t sumOld, sumNew;
+    benchReader<SwitchBitReader>(data, widths, secOld, cyclesOld, bitsOld, sumOld);
+    benchReader<ViewBitReader>(data, widths, secNew, cyclesNew, bitsNew, sumNew);
+    TEST_CHECK_EQ(sumOld, sumNew);
+
+#if TEST_HAS_RDTSC
+    printf("read() %s: switch %.3f cycles/bit %.3f ns/bit, unaligned load %.3f cycles/bit %.3f ns/bit, %.1fx\n", name,
+           (double)cyclesOld / bitsOld, secOld / bitsOld * 1e9, (double)cyclesNew / bitsNew, secNew / bitsNew * 1e9,
+           secOld / secNew);
+#else
+    printf("read() %s: switch %.3f ns/bit, unaligned load %.3f ns/bit, %.1fx\n", name, secOld / bitsOld * 1e9,
+           secNew / bitsNew * 1e9, secOld / secNew);
+#endif
+}
+
+int main() {
+    testReadPeek();
+    testExtractSubstreams();
+    benchmark("widths 1..32", 1, 32);
+    benchmark("widths 1..8", 1, 8);
+    benchmark("bytes", 8, 8);
+    return testResult("TestBitReader");
+}
@@ -0,0 +1,177 @@
+#include <vector>
+
+#include "Decoder/BinDecoder.h"
+#include "TestBinEncoder.h"
+#include "TestCommon.h"
+
+struct Op {
+    enum Kind { BIN, BIN_EP, BINS_EP, TRM, REM_ABS } kind;
+    uint32_t value;
+    uint8_t  ctx;       // BIN
+    uint8_t  numBins;   // BINS_EP, goRicePar of REM_ABS
+    uint8_t  cutoff;    // REM_ABS
+};
+
+static const int NUM_CTX = 16;
+
+static void initContexts(TestRandom& rnd, BinProbModel* ctx, int qp) {
+    for(int i = 0; i < NUM_CTX; i++) {
+        ctx[i].init(qp, rnd.next(64));
+        ctx[i].setShiftIdx(rnd.next(16));
+    }
+}
+
+// Random mixes of regular bins with skewed and even probabilities, single and batched bypass bins,
+// remainder codes with escapes up to the maximum prefix and non-terminating end_of_subset bins, encoded
+// with the reference encoder and decoded back. The stop bit after the last terminating bin is checked
+// by finish().
+static void testRoundTrip() {
+    TestRandom rnd(16);
+
+    for(int iter = 0; iter < 2000; iter++) {
+        const int       qp     = rnd.next(64);
+        const uint64_t  seed   = rnd.next64();
+        const int       numOps = 1 + rnd.next(iter < 1000 ? 64 : 4000);
+        const uint32_t  pOne   = rnd.next(65536);   // probability of 1 for regular bins
+        std::vector<Op> ops;
+
+        TestRandom    ctxRnd(seed);
+        BinProbModel  encCtx[NUM_CTX];
+        TestBitWriter writer;
+        initContexts(ctxRnd, encCtx, qp);
+        TestBinEncoder encoder(writer);
+
+        for(int i = 0; i < numOps; i++) {
+            Op op   = {};
+            op.kind = (Op::Kind)rnd.next(5);
+            switch(op.kind) {
+            case Op::BIN:
+                op.ctx   = (uint8_t)rnd.next(NUM_CTX);
+                op.value = rnd.next(65536) < pOne;
+                encoder.encodeBin(op.value, encCtx[op.ctx]);
+                break;
+            case Op::BIN_EP:
+                op.value = rnd.next(2);
+                encoder.encodeBinEP(op.value);
+                break;
+            case Op::BINS_EP:
+                op.numBins = (uint8_t)rnd.next(33);
+                op.value   = op.numBins ? rnd.next() >> (32 - op.numBins) : 0;
+                encoder.encodeBinsEP(op.value, op.numBins);
+                break;
+            case Op::TRM:
+                op.value = 0;
+                encoder.encodeBinTrm(0);
+                break;
+            default: {
+                const int maxLog2TrDynamicRange = 15;
+                op.numBins = (uint8_t)rnd.next(5);
+                op.cutoff  = (uint8_t)(rnd.next(2) ? 5 : 4);
+                op.value   = rnd.next() & ((1u << rnd.next(maxLog2TrDynamicRange + 1)) - 1);
+                encoder.encodeRemAbsEP(op.value, op.numBins, op.cutoff, maxLog2TrDynamicRange);
+                break;
+            }
+            }
+            ops.push_back(op);
+        }
+        encoder.finish();
+
+        ctxRnd = TestRandom(seed);
+        BinProbModel decCtx[NUM_CTX];
+        initContexts(ctxRnd, decCtx, qp);
+
+        InputBitstream bs;
+        attach(bs, writer);
+        BinDecoder decoder;
+        decoder.start(&bs);
+        bool ok = true;
+        for(const Op& op: ops) {
+            uint32_t value = 0;
+            switch(op.kind) {
+            case Op::BIN:     value = decoder.decodeBin(decCtx[op.ctx]); break;
+            case Op::BIN_EP:  value = decoder.decodeBinEP(); break;
+            case Op::BINS_EP: value = decoder.decodeBinsEP(op.numBins); break;
+            case Op::TRM:     value = decoder.decodeBinTrm(); break;
+            default:          value = decoder.decodeRemAbsEP(op.numBins, op.cutoff, 15); break;
+            }
+            if(value != op.value) {
+                ok = false;
+                break;
+            }
+        }
+        TEST_CHECK(ok);
+        if(!ok) {
+            continue;
+        }
+        TEST_CHECK_EQ(decoder.decodeBinTrm(), 1);
+        decoder.finish();
+        // the stop bit is the last bit read by the decoder
+        TEST_CHECK_EQ(decoder.getNumBitsRead(), writer.getNumBits() - __builtin_ctz(writer.getBytes().back()));
+    }
+}
+
+// Decoded bins per second for regular bins at a typical skew, for bypass bins one at a time and in
+// batches of 8 as for sign and remainder suffix bins.
+static void benchmark() {
+    const int     numBins = 1 << 24;
+    TestRandom    rnd(3);
+    TestBitWriter regular, bypass;
+    {
+        BinProbModel ctx[NUM_CTX];
+        TestBinEncoder encoder(regular);
+        for(int i = 0; i < numBins; i++) {
+            encoder.encodeBin(rnd.next(8) == 0, ctx[i & (NUM_CTX - 1)]);
+        }
+        encoder.finish();
+
+        TestBinEncoder bypassEncoder(bypass);
+        for(int i = 0; i < numBins / 8; i++) {
+            bypassEncoder.encodeBinsEP(rnd.next(256), 8);
+        }
+        bypassEncoder.finish();
+    }
+
+    double   bestRegular = 1e9, bestSingle = 1e9, bestBatch = 1e9;
+    uint32_t sumRegular = 0, sumSingle = 0, sumBatch = 0;
+    for(int run = 0; run < 5; run++) {
+        InputBitstream bs;
+        BinDecoder     decoder;
+        BinProbModel   ctx[NUM_CTX];
+        attach(bs, regular);
+        decoder.start(&bs);
+        BenchTimer regularTimer;
+        for(int i = 0; i < numBins; i++) {
+            sumRegular += decoder.decodeBin(ctx[i & (NUM_CTX - 1)]);
+        }
+        bestRegular = std::min(bestRegular, regularTimer.elapsedSec());
+
+        attach(bs, bypass);
+        decoder.start(&bs);
+        BenchTimer singleTimer;
+        for(int i = 0; i < numBins; i++) {
+            sumSingle += decoder.decodeBinEP();
+        }
+        bestSingle = std::min(bestSingle, singleTimer.elapsedSec());
+
+        attach(bs, bypass);
+        decoder.start(&bs);
+        BenchTimer batchTimer;
+        for(int i = 0; i < numBins / 8; i++) {
+            sumBatch += __builtin_popcount(decoder.decodeBinsEP(8));
+        }
+        bestBatch = std::min(bestBatch, batchTimer.elapsedSec());
+    }
+    TEST_CHECK_EQ(sumSingle, sumBatch);
+    benchKeep(sumRegular);
+
+    printf("regular bins (p(1)=1/8): %.1f Mbins/s, %.2f bits/bin\n", numBins / bestRegular * 1e-6,
+           (double)regular.getNumBits() / numBins);
+    printf("bypass bins: single %.1f Mbins/s, batches of 8 %.1f Mbins/s\n", numBins / bestSingle * 1e-6,
+           numBins / bestBatch * 1e-6);
+}
+
+int main() {
+    testRoundTrip();
+    benchmark();
+    return testResult("TestCabac");
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Common/BitStream.h"
+
+// Helpers shared by the tests in this directory. A failed TEST_CHECK reports its location and makes
+// testResult() return non-zero, the remaining checks still run.
+
+static int g_numTestFailures = 0;
+
+#define TEST_CHECK(cond)                                                                                    \
+    do {                                                                                                    \
+        if(!(cond)) {                                                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                        \
+            g_numTestFailures++;                                                                            \
+        }                                                                                                   \
+    } while(0)
+
+#define TEST_CHECK_EQ(a, b)                                                                                 \
+    do {                                                                                                    \
+        const long long _a = (long long)(a), _b = (long long)(b);                                           \
+        if(_a != _b) {                                                                                      \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b,   \
+                    _a, _b);                                                                                \
+            g_numTestFailures++;                                                                            \
+        }                                                                                                   \
+    } while(0)
+
+static inline int testResult(const char* name) {
+    if(g_numTestFailures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, g_numTestFailures);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    return 0;
+}
+
+// xorshift64*, deterministic across platforms so failures can be reproduced
+class TestRandom {
+public:
+    explicit TestRandom(uint64_t seed = 0x9E3779B97F4A7C15ull) : m_state(seed ? seed : 1) {}
+
+    uint64_t next64() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545F4914F6CDD1Dull;
+    }
+    uint32_t next()               { return (uint32_t)(next64() >> 32); }
+    uint32_t next(uint32_t range) { return (uint32_t)(((uint64_t)next() * range) >> 32); }   // [0, range)
+
+private:
+    uint64_t m_state;
+};
+
+// MSB-first bit writer producing the bitstreams the readers under test consume.
+class TestBitWriter {
+public:
+    void write(uint32_t value, uint32_t numBits) {
+        CHECK(numBits > 32, "TestBitWriter::write takes at most 32 bits, use writeZeros for longer prefixes");
+        for(uint32_t i = numBits; i-- > 0;) {
+            writeBit((value >> i) & 1);
+        }
+    }
+    void writeBit(uint32_t bit) {
+        if(m_numBits % 8 == 0) {
+            m_bytes.push_back(0);
+        }
+        m_bytes.back() |= (uint8_t)((bit & 1) << (7 - m_numBits % 8));
+        m_numBits++;
+    }
+    void writeZeros(uint32_t numBits) {
+        for(uint32_t i = 0; i < numBits; i++) {
+            writeBit(0);
+        }
+    }
+    void writeUvlc(uint32_t value) {
+        const uint64_t codeNumPlus1 = (uint64_t)value + 1;
+        const uint32_t prefixLen    = 63 - __builtin_clzll(codeNumPlus1);
+        writeZeros(prefixLen);
+        writeBit(1);
+        write((uint32_t)(codeNumPlus1 - ((uint64_t)1 << prefixLen)), prefixLen);
+    }
+    void writeSvlc(int32_t value) { writeUvlc(value <= 0 ? (uint32_t)(-(int64_t)value * 2) : (uint32_t)value * 2 - 1); }
+
+    size_t                      getNumBits() const { return m_numBits; }
+    const std::vector<uint8_t>& getBytes()   const { return m_bytes; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    size_t               m_numBits = 0;
+};
+
+// Reads the bits written so far from the FIFO of bs.
+static inline void attach(InputBitstream& bs, const TestBitWriter& writer) {
+    bs.getFifo().assign(writer.getBytes().begin(), writer.getBytes().end());
+    bs.attachFifo();
+}
+
+// Whole file contents, empty if the file cannot be read.
+static inline std::vector<uint8_t> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class BenchTimer {
+public:
+    BenchTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+    double elapsedSec() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count(); }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Keeps the optimizer from discarding a benchmarked result.
+template<typename T>
+static inline void benchKeep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
@@ -0,0 +1,143 @@
+#include <vector>
+
+#include "Common/BitStream.h"
+#include "TestCommon.h"
+
+// The bit by bit ue(v) loop VLCReader::xReadUvlc used before InputBitstream::readUvlc, kept as the
+// reference and as the benchmark baseline.
+static uint32_t readUvlcBitLoop(InputBitstream& bs) {
+    uint32_t val  = 0;
+    uint32_t code = bs.read(1);
+    if(code == 0) {
+        uint32_t length = 0;
+        while(!(code & 1)) {
+            code = bs.read(1);
+            length++;
+        }
+        val = bs.read(length);
+        val += (1u << length) - 1;
+    }
+    return val;
+}
+
+struct Symbol {
+    enum Kind { UVLC, SVLC, CODE } kind;
+    uint32_t numBits;   // CODE only
+    uint32_t value;
+};
+
+// Random values of every code length mixed with fixed length fields, so that codes start at every bit
+// position of the held bits and cross the refills.
+static void testRoundTrip() {
+    TestRandom          rnd(11);
+    TestBitWriter       writer;
+    std::vector<Symbol> symbols;
+
+    for(int i = 0; i < 200000; i++) {
+        Symbol         sym;
+        const uint32_t magnitudeBits = rnd.next(33);
+        const uint64_t magnitude     = rnd.next64() & (((uint64_t)1 << magnitudeBits) - 1);
+        sym.kind    = (Symbol::Kind)rnd.next(3);
+        sym.numBits = 0;
+        if(sym.kind == Symbol::UVLC) {
+            sym.value = (uint32_t)std::min<uint64_t>(magnitude, 0xfffffffe);   // the largest ue(v) of 32 bit
+            writer.writeUvlc(sym.value);
+        } else if(sym.kind == Symbol::SVLC) {
+            const int32_t value = (int32_t)(magnitude >> 2) * (rnd.next(2) ? 1 : -1);
+            sym.value = (uint32_t)value;
+            writer.writeSvlc(value);
+        } else {
+            sym.numBits = 1 + rnd.next(32);
+            sym.value   = (uint32_t)(magnitude & (((uint64_t)1 << sym.numBits) - 1));
+            writer.write(sym.value, sym.numBits);
+        }
+        symbols.push_back(sym);
+    }
+
+    InputBitstream bs, ref;
+    attach(bs, writer);
+    attach(ref, writer);
+    for(const Symbol& sym: symbols) {
+        if(sym.kind == Symbol::UVLC) {
+            TEST_CHECK_EQ(bs.readUvlc(), sym.value);
+            TEST_CHECK_EQ(readUvlcBitLoop(ref), sym.value);
+        } else if(sym.kind == Symbol::SVLC) {
+            TEST_CHECK_EQ(bs.readSvlc(), (int32_t)sym.value);
+            readUvlcBitLoop(ref);
+        } else {
+            TEST_CHECK_EQ(bs.read(sym.numBits), sym.value);
+            ref.read(sym.numBits);
+        }
+        TEST_CHECK_EQ(bs.getNumBitsRead(), ref.getNumBitsRead());
+    }
+    TEST_CHECK_EQ(bs.getNumBitsRead(), writer.getNumBits());
+}
+
+// The largest ue(v) has a 31 bit prefix. Longer prefixes do not fit a 32 bit value and are rejected
+// instead of wrapping around, including a 32 bit prefix with non-zero info bits.
+static bool readUvlcThrows(uint32_t prefixLen, uint64_t info) {
+    TestBitWriter writer;
+    writer.writeZeros(prefixLen);
+    writer.write(1, 1);
+    writer.write((uint32_t)(info >> 32), prefixLen > 32 ? prefixLen - 32 : 0);
+    writer.write((uint32_t)info, std::min<uint32_t>(prefixLen, 32));
+
+    InputBitstream bs;
+    attach(bs, writer);
+    try {
+        bs.readUvlc();
+    } catch(...) {
+        return true;
+    }
+    return false;
+}
+
+static void testTooLong() {
+    TEST_CHECK(!readUvlcThrows(31, 0x7fffffff));
+    TEST_CHECK(readUvlcThrows(32, 0));
+    TEST_CHECK(readUvlcThrows(32, 1));
+    TEST_CHECK(readUvlcThrows(32, 0xffffffff));
+    TEST_CHECK(readUvlcThrows(33, 0));
+}
+
+// ns per code word for the distribution of header syntax elements, mostly short codes, and for long
+// codes that take several refills.
+static void benchmark(const char* name, uint32_t maxMagnitudeBits) {
+    const int     numCodes = 1 << 20;
+    TestRandom    rnd(5);
+    TestBitWriter writer;
+    for(int i = 0; i < numCodes; i++) {
+        const uint32_t bits = rnd.next(maxMagnitudeBits + 1);
+        writer.writeUvlc(rnd.next() & ((1u << bits) - 1));
+    }
+
+    double   bestLoop = 1e9, bestClz = 1e9;
+    uint64_t sumLoop = 0, sumClz = 0;
+    for(int run = 0; run < 5; run++) {
+        InputBitstream bs;
+        attach(bs, writer);
+        BenchTimer loopTimer;
+        for(int i = 0; i < numCodes; i++) {
+            sumLoop += readUvlcBitLoop(bs);
+        }
+        bestLoop = std::min(bestLoop, loopTimer.elapsedSec());
+
+        attach(bs, writer);
+        BenchTimer clzTimer;
+        for(int i = 0; i < numCodes; i++) {
+            sumClz += bs.readUvlc();
+        }
+        bestClz = std::min(bestClz, clzTimer.elapsedSec());
+    }
+    TEST_CHECK_EQ(sumLoop, sumClz);
+    printf("ue(v) %s: bit loop %.2f ns/code, clz %.2f ns/code, %.1fx\n", name, bestLoop / numCodes * 1e9,
+           bestClz / numCodes * 1e9, bestLoop / bestClz);
+}
+
+int main() {
+    testRoundTrip();
+    testTooLong();
+    benchmark("values < 2^6", 6);
+    benchmark("values < 2^16", 16);
+    return testResult("TestExpGolomb");
+}
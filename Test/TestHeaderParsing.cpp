@@ -0,0 +1,186 @@
+#include <exception>
+#include <vector>
+
+#include "Common/NalScanner.h"
+#include "Common/Rom.h"
+#include "Decoder/DecLib.h"
+#include "TestCommon.h"
+
+// headers.266 is a synthetic stream for the picture and slice header parsing that bs.266 does not reach. Its
+// slice data is filler, only the headers are meaningful. The 96x64 pictures have 32x32 CTUs in 3 tile columns
+// of one CTU and one tile row of two CTUs, so the CTU raster addresses in tile scan are 0 3 1 4 2 5. Raster
+// scan slices, WPP and entry point offsets are enabled, the POC LSBs have 4 bits. The SPS has the RPLs
+// L0 { -6 } and L1 { -14 }. PPS 0 signals the RPLs and the weights in the picture header, PPS 1 in the slice
+// headers. Every picture has a picture header NAL unit:
+//
+//   POC  NAL unit     TId  PPS  slices
+//    0   IDR_N_LP      0    1   I tiles 0-1, I tile 2
+//    8   TRAIL         0    0   P tiles 0-2
+//   14   TRAIL         0    0   B tiles 0-2
+//   10   TRAIL, non-ref 1   1   B tile 0, B tiles 1-2
+//   19   TRAIL         0    1   P tiles 0-1, I tile 2   (POC LSB 3, wraps around the previous TId 0 POC 14)
+
+struct ExpectedSlice {
+    uint32_t              sliceAddr;
+    SliceType             sliceType;
+    int                   sliceQp;
+    std::vector<uint32_t> ctuAddrs;
+    std::vector<uint32_t> substreamSizes;   // all but the last substream, from the entry point offsets
+    std::vector<int>      refPocs[NUM_REF_PIC_LIST_01];
+    int                   numRefIdx[NUM_REF_PIC_LIST_01];
+};
+
+struct ExpectedPicture {
+    int                        poc;
+    bool                       rplInPh;
+    std::vector<ExpectedSlice> slices;
+};
+
+static const ExpectedPicture g_expected[] = {
+    { 0, false, {
+        { 0, I_SLICE, 27, { 0, 3, 1, 4 }, { 10, 20, 30 }, { {}, {} }, { 0, 0 } },
+        { 2, I_SLICE, 25, { 2, 5 },       { 12 },         { {}, {} }, { 0, 0 } } } },
+    { 8, true, {
+        { 0, P_SLICE, 23, { 0, 3, 1, 4, 2, 5 }, { 3, 5, 7, 9, 11 }, { { 0 }, {} }, { 1, 0 } } } },
+    { 14, true, {
+        { 0, B_SLICE, 26, { 0, 3, 1, 4, 2, 5 }, { 1, 2, 3, 4, 5 }, { { 8 }, { 0 } }, { 1, 1 } } } },
+    { 10, false, {
+        { 0, B_SLICE, 28, { 0, 3 },       { 6 },       { { 8, 14 }, { 14 } }, { 2, 1 } },
+        { 1, B_SLICE, 28, { 1, 4, 2, 5 }, { 7, 8, 9 }, { { 8, 14 }, { 14 } }, { 2, 1 } } } },
+    { 19, false, {
+        { 0, P_SLICE, 26, { 0, 3, 1, 4 }, { 100, 150, 200 }, { { 14 }, {} },  { 1, 0 } },
+        { 2, I_SLICE, 31, { 2, 5 },       { 2 },             { { 13 }, { 5 } }, { 0, 0 } } } },
+};
+static const int g_numExpectedPictures = sizeof(g_expected) / sizeof(g_expected[0]);
+
+static void checkWeight(const WPScalingParam& param, bool present, int log2Denom, int weight, int offset) {
+    TEST_CHECK_EQ(param.presentFlag, present);
+    TEST_CHECK_EQ(param.log2WeightDenom, log2Denom);
+    TEST_CHECK_EQ(param.weight, weight);
+    TEST_CHECK_EQ(param.offset, offset);
+}
+
+// The weights of each picture, derived by hand from the coded deltas. ChromaOffset is
+// Clip3( -128, 127, 128 + delta_chroma_offset - ( ( 128 * ChromaWeight ) >> ChromaLog2WeightDenom ) ).
+static void checkWeights(int picIdx, const PicHeader& picHeader, const Slice& slice) {
+    switch(picIdx) {
+    case 1:   // in the picture header: luma denominator 6, chroma 6 - 2
+        TEST_CHECK_EQ(picHeader.getNumL0Weights(), 1);
+        TEST_CHECK_EQ(picHeader.getNumL1Weights(), 0);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Y],  true, 6, 64 + 3, -5);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Cb], true, 4, 16 - 2, 128 + 10 - 112);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Cr], true, 4, 16 + 4, 128 - 20 - 160);
+        break;
+    case 2:   // in the picture header, only for L1
+        TEST_CHECK_EQ(picHeader.getNumL0Weights(), 0);
+        TEST_CHECK_EQ(picHeader.getNumL1Weights(), 1);
+        TEST_CHECK(picHeader.getMvdL1ZeroFlag());
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Y],  false, 3, 8, 0);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_1, 0)[COMPONENT_Y],  true, 3, 8 - 2, 4);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_1, 0)[COMPONENT_Cb], false, 3, 8, 0);
+        break;
+    case 3:   // in each slice header, one weight per active reference
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Y],  true, 2, 4 - 1, 7);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Cb], false, 2, 4, 0);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 1)[COMPONENT_Y],  false, 2, 4, 0);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_1, 0)[COMPONENT_Y],  false, 2, 4, 0);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_1, 0)[COMPONENT_Cb], true, 2, 4 + 1, 128 - 160);
+        checkWeight(slice.getWpScaling(REF_PIC_LIST_1, 0)[COMPONENT_Cr], true, 2, 4 - 1, 128 - 96);
+        break;
+    case 4:   // the P slice codes a table without explicit weights
+        if(slice.getSliceType() == P_SLICE) {
+            checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Y],  false, 0, 1, 0);
+            checkWeight(slice.getWpScaling(REF_PIC_LIST_0, 0)[COMPONENT_Cr], false, 0, 1, 0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void checkPicture(int picIdx, const DecLibParser& parser) {
+    TEST_CHECK(picIdx < g_numExpectedPictures);
+    if(picIdx >= g_numExpectedPictures) {
+        return;
+    }
+    const ExpectedPicture& expected  = g_expected[picIdx];
+    const PicHeader&       picHeader = *parser.getPicHeader();
+    TEST_CHECK_EQ(picHeader.getPOC(), expected.poc);
+
+    const std::vector<std::unique_ptr<Slice>>& slices = parser.getSlices();
+    TEST_CHECK_EQ(slices.size(), expected.slices.size());
+    for(size_t i = 0; i < std::min(slices.size(), expected.slices.size()); i++) {
+        const Slice&         slice = *slices[i];
+        const ExpectedSlice& exp   = expected.slices[i];
+        TEST_CHECK(!slice.getPictureHeaderInSliceHeader());
+        TEST_CHECK_EQ(slice.getPOC(), expected.poc);
+        TEST_CHECK_EQ(slice.getSliceAddr(), exp.sliceAddr);
+        TEST_CHECK_EQ(slice.getSliceType(), exp.sliceType);
+        TEST_CHECK_EQ(slice.getSliceQp(), exp.sliceQp);
+        TEST_CHECK(std::vector<uint32_t>(slice.getSliceMap().begin(), slice.getSliceMap().end()) == exp.ctuAddrs);
+        TEST_CHECK_EQ(slice.getNumEntryPoints(), exp.substreamSizes.size());
+        TEST_CHECK(slice.getSubstreamSizes() == exp.substreamSizes);
+
+        for(int l = 0; l < NUM_REF_PIC_LIST_01; l++) {
+            const ReferencePictureList* rpl = slice.getRPL(RefPicList(l));
+            TEST_CHECK(!expected.rplInPh || rpl == picHeader.getRPL(RefPicList(l)));
+            TEST_CHECK_EQ(rpl->getNumRefEntries(), exp.refPocs[l].size());
+            for(int j = 0; j < std::min<int>(rpl->getNumRefEntries(), (int)exp.refPocs[l].size()); j++) {
+                TEST_CHECK_EQ(rpl->getPOC(j), exp.refPocs[l][j]);
+            }
+            TEST_CHECK_EQ(slice.getNumRefIdx(RefPicList(l)), exp.numRefIdx[l]);
+        }
+        checkWeights(picIdx, picHeader, slice);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: TestHeaderParsing <bitstream>\n");
+        return 1;
+    }
+    const std::vector<uint8_t> data = readFile(argv[1]);
+    TEST_CHECK(!data.empty());
+    NalBoundaryVec nals;
+    scanNalUnits(data.data(), data.size(), nals);
+
+    initROM();
+    DecLib         decLib;
+    PicListManager picListManager;
+    DecLibParser   parser(decLib, picListManager);
+    int            numPictures = 0;
+    try {
+        for(size_t i = 0; i < nals.size(); i++) {
+            const uint8_t* nal = data.data() + nals[i].offset;
+
+            // the RBSP without emulation prevention bytes, read from the FIFO like a converted NAL unit
+            InputNALUnit   nalu;
+            AlignedByteVec& rbsp = nalu.getBitstream().getFifo();
+            for(size_t j = 0; j < nals[i].size; j++) {
+                if(!(j >= 2 && nal[j] == 3 && nal[j - 1] == 0 && nal[j - 2] == 0)) {
+                    rbsp.push_back(nal[j]);
+                }
+            }
+            nalu.getBitstream().attachFifo();
+            InputBitstream& bs      = nalu.getBitstream();
+            nalu.m_forbiddenZeroBit   = bs.read(1);
+            nalu.m_nuhReservedZeroBit = bs.read(1);
+            nalu.m_nuhLayerId         = bs.read(6);
+            nalu.m_nalUnitType        = (NalUnitType)bs.read(5);
+            nalu.m_temporalId         = bs.read(3) - 1;
+            parser.parse(nalu);
+
+            // a picture is complete before the picture header of the next one
+            const bool lastOfPicture = i + 1 == nals.size() || getNalUnitHeaderType(data.data() + nals[i + 1].offset) == NAL_UNIT_PH;
+            if(lastOfPicture && !parser.getSlices().empty()) {
+                checkPicture(numPictures++, parser);
+            }
+        }
+    } catch(const std::exception& e) {
+        fprintf(stderr, "parsing failed: %s\n", e.what());
+        g_numTestFailures++;
+    }
+    TEST_CHECK_EQ(numPictures, g_numExpectedPictures);
+
+    return testResult("TestHeaderParsing");
+}
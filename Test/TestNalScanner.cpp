@@ -0,0 +1,193 @@
+#include <string.h>
+#include <vector>
+
+#include "Common/NalScanner.h"
+#include "TestCommon.h"
+
+static const uint8_t* findStartCodeRef(const uint8_t* p, const uint8_t* end) {
+    for(; p + 3 <= end; p++) {
+        if(p[0] == 0 && p[1] == 0 && p[2] == 1) {
+            return p;
+        }
+    }
+    return end;
+}
+
+static const uint8_t* findZeroPairRef(const uint8_t* p, const uint8_t* end) {
+    for(; p + 2 <= end; p++) {
+        if(p[0] == 0 && p[1] == 0) {
+            return p;
+        }
+    }
+    return end;
+}
+
+// Bytes drawn mostly from {0, 1} so that start codes and zero pairs land at every position relative to
+// the 16 and 32 byte SIMD blocks, including the ones straddling two blocks.
+static void fillDense(TestRandom& rnd, uint8_t* p, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        const uint32_t r = rnd.next(8);
+        p[i] = r < 4 ? 0 : r < 6 ? 1 : (uint8_t)rnd.next();
+    }
+}
+
+static void testSearchFunctions() {
+    TestRandom           rnd;
+    std::vector<uint8_t> buf(256 + 64);
+
+    for(int iter = 0; iter < 20000; iter++) {
+        const size_t offset = rnd.next(64);
+        const size_t size   = rnd.next(257);
+        fillDense(rnd, buf.data(), buf.size());
+
+        const uint8_t* begin = buf.data() + offset;
+        const uint8_t* end   = begin + size;
+        for(const uint8_t* p = begin;;) {
+            const uint8_t* hit = findStartCode(p, end);
+            TEST_CHECK(hit == findStartCodeRef(p, end));
+            if(hit == end) {
+                break;
+            }
+            p = hit + 1;
+        }
+        for(const uint8_t* p = begin;;) {
+            const uint8_t* hit = findZeroPair(p, end);
+            TEST_CHECK(hit == findZeroPairRef(p, end));
+            if(hit == end) {
+                break;
+            }
+            p = hit + 1;
+        }
+    }
+
+    // no match in long runs without the pattern, and a match in the last possible position
+    std::vector<uint8_t> ones(4096, 0xff);
+    TEST_CHECK(findStartCode(ones.data(), ones.data() + ones.size()) == ones.data() + ones.size());
+    TEST_CHECK(findZeroPair(ones.data(), ones.data() + ones.size()) == ones.data() + ones.size());
+    ones[4093] = 0; ones[4094] = 0; ones[4095] = 1;
+    TEST_CHECK(findStartCode(ones.data(), ones.data() + ones.size()) == ones.data() + 4093);
+    TEST_CHECK(findZeroPair(ones.data(), ones.data() + ones.size()) == ones.data() + 4093);
+}
+
+// NAL unit payloads follow the emulation prevention rules: no 00 00 0x inside and a non-zero last byte.
+static void appendNalPayload(TestRandom& rnd, std::vector<uint8_t>& out, size_t size) {
+    int zeros = 0;
+    for(size_t i = 0; i < size; i++) {
+        uint8_t b = rnd.next(4) == 0 ? 0 : (uint8_t)rnd.next();
+        if(zeros >= 2 && b <= 3) {
+            b = 0x80;
+        }
+        if(i + 1 == size && b == 0) {
+            b = 0x80;
+        }
+        zeros = b == 0 ? zeros + 1 : 0;
+        out.push_back(b);
+    }
+}
+
+static void testScanNalUnits() {
+    TestRandom rnd(7);
+
+    for(int iter = 0; iter < 2000; iter++) {
+        std::vector<uint8_t> stream;
+        NalBoundaryVec       expected;
+
+        // leading_zero_8bits
+        stream.resize(rnd.next(4), 0);
+        const int numNals = 1 + rnd.next(8);
+        for(int i = 0; i < numNals; i++) {
+            // leading or trailing zero bytes turn the next 00 00 01 into a four byte start code as well
+            const bool longStartCode = rnd.next(2) != 0 || (!stream.empty() && stream.back() == 0);
+            if(longStartCode) {
+                stream.push_back(0);
+            }
+            stream.push_back(0); stream.push_back(0); stream.push_back(1);
+
+            NalBoundary nal;
+            nal.offset       = stream.size();
+            nal.size         = 2 + rnd.next(200);
+            nal.startCodeLen = longStartCode ? 4 : 3;
+            appendNalPayload(rnd, stream, nal.size);
+            expected.push_back(nal);
+
+            // trailing_zero_8bits, also between the NAL units of one access unit
+            stream.resize(stream.size() + rnd.next(4), 0);
+        }
+
+        NalBoundaryVec nals;
+        TEST_CHECK_EQ(scanNalUnits(stream.data(), stream.size(), nals), expected.size());
+        for(size_t i = 0; i < std::min(nals.size(), expected.size()); i++) {
+            TEST_CHECK_EQ(nals[i].offset, expected[i].offset);
+            TEST_CHECK_EQ(nals[i].size, expected[i].size);
+            TEST_CHECK_EQ(nals[i].startCodeLen, expected[i].startCodeLen);
+        }
+    }
+
+    NalBoundaryVec nals;
+    TEST_CHECK_EQ(scanNalUnits(nullptr, 0, nals), 0);
+    const uint8_t noStartCode[] = { 0x12, 0x00, 0x00, 0x03, 0x00, 0x00 };
+    TEST_CHECK_EQ(scanNalUnits(noStartCode, sizeof(noStartCode), nals), 0);
+}
+
+static void testLengthPrefixed() {
+    const uint8_t  data[] = { 0x00, 0x02, 0x40, 0x01, 0x00, 0x03, 0x42, 0x01, 0x01 };
+    NalBoundaryVec nals;
+    TEST_CHECK(splitLengthPrefixedNalUnits(data, sizeof(data), 2, nals));
+    TEST_CHECK_EQ(nals.size(), 2);
+    if(nals.size() == 2) {
+        TEST_CHECK_EQ(nals[0].offset, 2);
+        TEST_CHECK_EQ(nals[0].size, 2);
+        TEST_CHECK_EQ(nals[1].offset, 6);
+        TEST_CHECK_EQ(nals[1].size, 3);
+        TEST_CHECK_EQ(nals[1].startCodeLen, 2);
+    }
+    nals.clear();
+    TEST_CHECK(!splitLengthPrefixedNalUnits(data, sizeof(data) - 1, 2, nals));
+}
+
+// Throughput on a synthetic stream of 64 KiB NAL units with the byte statistics of coded slice data,
+// where zero bytes are frequent but start codes only occur at NAL unit boundaries.
+static void benchScanNalUnits() {
+    const size_t         streamSize = 128 << 20;
+    const size_t         nalSize    = 64 << 10;
+    std::vector<uint8_t> stream;
+    stream.reserve(streamSize + nalSize);
+
+    TestRandom rnd(3);
+    while(stream.size() < streamSize) {
+        stream.push_back(0); stream.push_back(0); stream.push_back(1);
+        appendNalPayload(rnd, stream, nalSize);
+    }
+
+    NalBoundaryVec nals;
+    nals.reserve(stream.size() / nalSize + 1);
+
+    double bestSec = 1e9;
+    for(int run = 0; run < 5; run++) {
+        nals.clear();
+        BenchTimer timer;
+        scanNalUnits(stream.data(), stream.size(), nals);
+        bestSec = std::min(bestSec, timer.elapsedSec());
+    }
+    TEST_CHECK_EQ(nals.size(), (stream.size() + nalSize) / (nalSize + 3));
+
+    size_t     numZeroPairs = 0;
+    BenchTimer zeroPairTimer;
+    for(const uint8_t* p = stream.data(), *end = p + stream.size(); (p = findZeroPair(p, end)) != end; p += 2) {
+        numZeroPairs++;
+    }
+    const double zeroPairSec = zeroPairTimer.elapsedSec();
+    benchKeep(numZeroPairs);
+
+    printf("scanNalUnits: %.1f MiB in %.2f ms, %.2f GB/s\n", stream.size() / 1048576.0, bestSec * 1e3,
+           stream.size() / bestSec * 1e-9);
+    printf("findZeroPair: %zu zero pairs, %.2f GB/s\n", numZeroPairs, stream.size() / zeroPairSec * 1e-9);
+}
+
+int main() {
+    testSearchFunctions();
+    testScanNalUnits();
+    testLengthPrefixed();
+    benchScanNalUnits();
+    return testResult("TestNalScanner");
+}
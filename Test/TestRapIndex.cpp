@@ -0,0 +1,70 @@
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "App/RapIndex.h"
+#include "TestCommon.h"
+
+static void writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)data.data(), data.size());
+}
+
+static void setMtime(const std::string& path, time_t sec) {
+    const struct timespec times[2] = { { sec, 0 }, { sec, 0 } };
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: TestRapIndex <bitstream>\n");
+        return 1;
+    }
+
+    char tmpDir[] = "/tmp/w266-rapidx-XXXXXX";
+    TEST_CHECK(mkdtemp(tmpDir) != nullptr);
+    const std::string bitstream = std::string(tmpDir) + "/bs.266";
+    const std::string indexFile = RapIndex::getDefaultIndexFile(bitstream);
+
+    // two copies of the sample stream give two random access points
+    std::vector<uint8_t> data = readFile(argv[1]);
+    TEST_CHECK(!data.empty());
+    data.insert(data.end(), data.begin(), data.end());
+    writeFile(bitstream, data);
+    setMtime(bitstream, 1000000000);
+
+    RapIndex built;
+    TEST_CHECK_EQ(built.build(bitstream, 1), 0);
+    TEST_CHECK_EQ(built.getEntries().size(), 2);
+    TEST_CHECK_EQ(built.getBitstreamMtime(), 1000000000ll * 1000000000);
+    TEST_CHECK_EQ(built.save(indexFile), 0);
+
+    RapIndex loaded;
+    TEST_CHECK_EQ(loaded.load(indexFile, bitstream), 0);
+    TEST_CHECK_EQ(loaded.getEntries().size(), built.getEntries().size());
+    TEST_CHECK_EQ(loaded.getParamSets().size(), built.getParamSets().size());
+    if(loaded.getEntries().size() == 2) {
+        TEST_CHECK_EQ(loaded.getEntries()[1].offset, data.size() / 2);
+    }
+
+    // rewritten in place with the same size: the index must not be reused
+    data[data.size() / 2 + 4] ^= 0xff;
+    writeFile(bitstream, data);
+    setMtime(bitstream, 1000000001);
+    TEST_CHECK(loaded.load(indexFile, bitstream) != 0);
+
+    // a different size is rejected as well
+    data.push_back(0);
+    writeFile(bitstream, data);
+    setMtime(bitstream, 1000000000);
+    TEST_CHECK(loaded.load(indexFile, bitstream) != 0);
+
+    unlink(indexFile.c_str());
+    unlink(bitstream.c_str());
+    rmdir(tmpDir);
+    return testResult("TestRapIndex");
+}
@@ -0,0 +1,198 @@
+#include <string.h>
+#include <vector>
+
+#include "Decoder/Decode.h"
+#include "TestCommon.h"
+
+// Gives the tests access to the private NAL unit to RBSP conversion of DecImpl.
+class RbspConversionTest {
+public:
+    static int convert(const uint8_t* payload, size_t payloadLen, size_t readableLen, InputBitstream* bitstream,
+                       bool isVclNalUnit) {
+        return DecImpl::xConvertPayloadToRBSP(payload, payloadLen, readableLen, bitstream, isVclNalUnit);
+    }
+};
+
+// The byte loop xConvertPayloadToRBSP used before it searched for zero pairs, kept as the reference and as
+// the benchmark baseline. It also records the positions of the removed bytes, which the old loop did not.
+static int convertPayloadToRbspByteLoop(const uint8_t* payload, size_t payloadLen, bool isVclNalUnit,
+                                        std::vector<uint8_t>& rbsp, std::vector<uint32_t>& epbLocations) {
+    uint32_t zeroCount = 0;
+
+    rbsp.resize(payloadLen);
+    epbLocations.clear();
+
+    const uint8_t* it_read  = payload;
+    uint8_t*       it_write = rbsp.data();
+    for(size_t pos = 0; pos < payloadLen; it_read++, it_write++, pos++) {
+        if(zeroCount >= 2 && *it_read < 0x03) {
+            return -1;
+        }
+        if(zeroCount == 2 && *it_read == 0x03) {
+            epbLocations.push_back((uint32_t)pos);
+            pos++;
+            it_read++;
+            zeroCount = 0;
+            if(pos >= payloadLen) {
+                break;
+            }
+            if(*it_read > 0x03) {
+                return -1;
+            }
+        }
+        zeroCount = (*it_read == 0x00) ? zeroCount + 1 : 0;
+        *it_write = *it_read;
+    }
+
+    if(zeroCount != 0 && !isVclNalUnit) {
+        return -1;
+    }
+
+    if(isVclNalUnit) {
+        // remove cabac_zero_word from payload if present
+        while(it_write > rbsp.data() && it_write[-1] == 0x00) {
+            it_write--;
+        }
+    }
+
+    rbsp.resize(it_write - rbsp.data());
+    return 0;
+}
+
+// Payloads with frequent zero runs and 00 00 03 sequences, so that valid and invalid emulation prevention,
+// cabac_zero_words and zero pairs straddling the 16 and 32 byte blocks of findZeroPair all occur.
+static void fillPayload(TestRandom& rnd, uint8_t* p, size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        const uint32_t r = rnd.next(16);
+        p[i] = r < 6 ? 0 : r < 9 ? 3 : r < 10 ? (uint8_t)rnd.next(3) : (uint8_t)rnd.next();
+    }
+    // mostly well-formed: an invalid 00 00 0x is kept only in some payloads
+    if(rnd.next(4)) {
+        for(size_t i = 2; i < size; i++) {
+            if(p[i - 2] == 0 && p[i - 1] == 0 && p[i] < 3) {
+                p[i] = 3;
+            } else if(i >= 3 && p[i - 3] == 0 && p[i - 2] == 0 && p[i - 1] == 3 && p[i] > 3) {
+                p[i] = 0;
+            }
+        }
+    }
+}
+
+// Random payloads of VCL and non-VCL NAL units, some ending in 00 00 03 or in zero bytes, converted with
+// one reused InputBitstream. The RBSP, the removed byte positions and the return code must match the byte
+// loop; NAL units without emulation prevention bytes must be left as a view of the payload, the others
+// read from the FIFO.
+static void testConversion() {
+    TestRandom           rnd(3);
+    InputBitstream       bs;
+    std::vector<uint8_t> buffer(600);
+    std::vector<uint8_t> rbsp;
+    std::vector<uint32_t> epbLocations;
+    size_t               numViews = 0, numFifos = 0, numErrors = 0;
+
+    for(int iter = 0; iter < 100000; iter++) {
+        const size_t offset = rnd.next(32);
+        const size_t size   = 1 + rnd.next(iter % 8 == 0 ? 512 : 40);
+        fillPayload(rnd, buffer.data(), buffer.size());
+
+        uint8_t* payload = buffer.data() + offset;
+        switch(rnd.next(5)) {
+        case 0:   // trailing emulation prevention byte
+            if(size >= 3) {
+                payload[size - 3] = 0; payload[size - 2] = 0; payload[size - 1] = 3;
+            }
+            break;
+        case 1:   // cabac_zero_words or a trailing zero pair
+            if(size >= 2) {
+                payload[size - 2] = 0; payload[size - 1] = 0;
+            }
+            break;
+        default:
+            break;
+        }
+
+        const bool   isVcl    = rnd.next(2) != 0;
+        const size_t readable = rnd.next(2) ? size : buffer.size() - offset;
+
+        const int refResult = convertPayloadToRbspByteLoop(payload, size, isVcl, rbsp, epbLocations);
+        const int result    = RbspConversionTest::convert(payload, size, readable, &bs, isVcl);
+        TEST_CHECK_EQ(result, refResult);
+        if(result != 0 || refResult != 0) {
+            numErrors++;
+            continue;
+        }
+
+        TEST_CHECK_EQ(bs.getByteSize(), rbsp.size());
+        TEST_CHECK(bs.getByteSize() == rbsp.size() && memcmp(bs.getData(), rbsp.data(), rbsp.size()) == 0);
+        TEST_CHECK(bs.getEmulationPreventionByteLocations() == epbLocations);
+        if(epbLocations.empty()) {
+            TEST_CHECK(bs.isBorrowed() && bs.getData() == payload);
+            numViews++;
+        } else {
+            TEST_CHECK(!bs.isBorrowed());
+            numFifos++;
+        }
+
+        // reading goes through the same path as the decoder
+        for(size_t i = 0; i < rbsp.size(); i++) {
+            TEST_CHECK_EQ(bs.read(8), rbsp[i]);
+        }
+    }
+    TEST_CHECK(numViews > 1000 && numFifos > 1000 && numErrors > 1000);
+
+    // the edge cases spelled out
+    const uint8_t trailingEpb[] = { 0x40, 0x01, 0x00, 0x00, 0x03 };
+    TEST_CHECK_EQ(RbspConversionTest::convert(trailingEpb, sizeof(trailingEpb), sizeof(trailingEpb), &bs, false), 0);
+    TEST_CHECK_EQ(bs.getByteSize(), 4);   // the zeros before the removed byte stay
+    const uint8_t cabacZeroWords[] = { 0x02, 0x01, 0x80, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x00 };
+    TEST_CHECK_EQ(RbspConversionTest::convert(cabacZeroWords, sizeof(cabacZeroWords), sizeof(cabacZeroWords), &bs, true), 0);
+    TEST_CHECK_EQ(bs.getByteSize(), 3);
+    TEST_CHECK_EQ(RbspConversionTest::convert(cabacZeroWords, sizeof(cabacZeroWords), sizeof(cabacZeroWords), &bs, false), -1);
+    const uint8_t startCode[] = { 0x40, 0x01, 0x00, 0x00, 0x01, 0x80 };
+    TEST_CHECK_EQ(RbspConversionTest::convert(startCode, sizeof(startCode), sizeof(startCode), &bs, true), -1);
+}
+
+// Conversion throughput for slice data sized NAL units with and without emulation prevention bytes.
+static void benchmark(const char* name, uint32_t epbInterval) {
+    const size_t         nalSize = 64 << 10;
+    const int            numNals = 512;
+    TestRandom           rnd(9);
+    std::vector<uint8_t> payload(nalSize);
+    for(size_t i = 0; i < nalSize; i++) {
+        // isolated zero bytes as in coded slice data
+        payload[i] = (rnd.next(8) == 0 && (i == 0 || payload[i - 1] != 0)) ? 0 : (uint8_t)(1 + rnd.next(255));
+    }
+    for(size_t i = epbInterval; epbInterval && i + 4 < nalSize; i += epbInterval) {
+        payload[i] = 0x80; payload[i + 1] = 0; payload[i + 2] = 0; payload[i + 3] = 3; payload[i + 4] = 1;
+    }
+
+    InputBitstream        bs;
+    std::vector<uint8_t>  rbsp;
+    std::vector<uint32_t> epbLocations;
+    double                bestLoop = 1e9, bestNew = 1e9;
+    for(int run = 0; run < 5; run++) {
+        BenchTimer loopTimer;
+        for(int i = 0; i < numNals; i++) {
+            TEST_CHECK_EQ(convertPayloadToRbspByteLoop(payload.data(), nalSize, true, rbsp, epbLocations), 0);
+        }
+        bestLoop = std::min(bestLoop, loopTimer.elapsedSec());
+
+        BenchTimer newTimer;
+        for(int i = 0; i < numNals; i++) {
+            TEST_CHECK_EQ(RbspConversionTest::convert(payload.data(), nalSize, nalSize, &bs, true), 0);
+        }
+        bestNew = std::min(bestNew, newTimer.elapsedSec());
+    }
+    TEST_CHECK_EQ(bs.getByteSize(), rbsp.size());
+
+    const double bytes = (double)nalSize * numNals;
+    printf("xConvertPayloadToRBSP %s: byte loop %.2f GB/s, zero pair search %.2f GB/s, %.1fx\n", name,
+           bytes / bestLoop * 1e-9, bytes / bestNew * 1e-9, bestLoop / bestNew);
+}
+
+int main() {
+    testConversion();
+    benchmark("no emulation prevention", 0);
+    benchmark("one per KiB", 1024);
+    return testResult("TestRbspConversion");
+}
@@ -0,0 +1,457 @@
+#include <vector>
+
+#include "Common/Rom.h"
+#include "Common/Slice.h"
+#include "Decoder/CABACReader.h"
+#include "TestBinEncoder.h"
+#include "TestCommon.h"
+
+// Levels of one transform block with transform_skip_flag equal to 0, and the TransCoeffLevel values
+// residual_coding() has to reconstruct from them.
+struct TestBlock {
+    ComponentID      compID;
+    int              log2W;
+    int              log2H;
+    std::vector<int> absLevel;   // row-major, zero outside the top left 32x32
+    std::vector<int> negative;
+    std::vector<int> expected;
+};
+
+static int nextQState(int state, int absLevel) {
+    static const int transTable[4][2] = { { 0, 2 }, { 2, 0 }, { 1, 3 }, { 3, 1 } };
+    return transTable[state][absLevel & 1];
+}
+
+// Encoder side of residual_coding() (7.3.11.11) with the context selection of 9.3.4.2. The neighbour
+// sums are computed directly from the levels, independently of the decoder's incremental templates.
+class TestResidualEncoder {
+public:
+    TestResidualEncoder(TestBinEncoder& encoder, CtxStore& ctx, bool depQuant, bool signHiding)
+        : m_enc(encoder), m_ctx(ctx), m_depQuant(depQuant), m_signHiding(signHiding && !depQuant) {}
+
+    void encode(TestBlock& blk) {
+        const bool luma  = isLuma(blk.compID);
+        const int  w     = 1 << blk.log2W;
+        const int  zoW   = std::min(blk.log2W, 5);
+        const int  zoH   = std::min(blk.log2H, 5);
+        m_blk    = &blk;
+        m_width  = w;
+        m_height = 1 << blk.log2H;
+
+        int log2SbW = std::min(zoW, zoH) < 2 ? 1 : 2;
+        int log2SbH = log2SbW;
+        if(zoW + zoH > 3) {
+            if(zoW < 2) {
+                log2SbW = zoW;
+                log2SbH = 4 - zoW;
+            } else if(zoH < 2) {
+                log2SbH = zoH;
+                log2SbW = 4 - zoH;
+            }
+        }
+        const int          numSb      = 1 << (zoW + zoH - log2SbW - log2SbH);
+        const int          numSbCoeff = 1 << (log2SbW + log2SbH);
+        const ScanElement* sbScan     = g_scanOrder[zoW - log2SbW][zoH - log2SbH];
+        const ScanElement* scan       = g_scanOrder[log2SbW][log2SbH];
+        auto posX = [&](int i, int n) { return (sbScan[i].x << log2SbW) + scan[n].x; };
+        auto posY = [&](int i, int n) { return (sbScan[i].y << log2SbH) + scan[n].y; };
+        auto level = [&](int i, int n) { return blk.absLevel[posY(i, n) * w + posX(i, n)]; };
+
+        int lastSb = -1, lastPos = -1;
+        for(int i = 0; i < numSb; i++) {
+            for(int n = 0; n < numSbCoeff; n++) {
+                if(level(i, n)) {
+                    lastSb  = i;
+                    lastPos = n;
+                }
+            }
+        }
+        const int lastX = posX(lastSb, lastPos);
+        const int lastY = posY(lastSb, lastPos);
+        xEncodeLastPrefix(lastX, blk.log2W, zoW, luma ? ContextSetCfg::LastX[0] : ContextSetCfg::LastX[1], luma);
+        xEncodeLastPrefix(lastY, blk.log2H, zoH, luma ? ContextSetCfg::LastY[0] : ContextSetCfg::LastY[1], luma);
+        xEncodeLastSuffix(lastX);
+        xEncodeLastSuffix(lastY);
+
+        const CtxSet* sigSets = &ContextSetCfg::SigFlag[luma ? 0 : 3];
+        const CtxSet& gt1Set  = ContextSetCfg::GtxFlag[luma ? 0 : 1];
+        const CtxSet& parSet  = ContextSetCfg::ParFlag[luma ? 0 : 1];
+        const CtxSet& gt3Set  = ContextSetCfg::GtxFlag[luma ? 2 : 3];
+        const CtxSet& sbSet   = ContextSetCfg::SigCoeffGroup[luma ? 0 : 1];
+
+        std::vector<int> sbFlag((1 << (zoW - log2SbW)) * (1 << (zoH - log2SbH)), 0);
+        const int        sbStride = 1 << (zoW - log2SbW);
+        auto sbFlagAt = [&](int xS, int yS) {
+            return xS < sbStride && yS < (1 << (zoH - log2SbH)) ? sbFlag[yS * sbStride + xS] : 0;
+        };
+
+        int remBinsPass1 = ((1 << (zoW + zoH)) * 7) >> 2;
+        int qState       = 0;
+        blk.expected.assign(blk.absLevel.size(), 0);
+
+        for(int i = lastSb; i >= 0; i--) {
+            const int xS = sbScan[i].x;
+            const int yS = sbScan[i].y;
+
+            bool coded = false;
+            for(int n = 0; n < numSbCoeff; n++) {
+                coded |= level(i, n) != 0;
+            }
+            bool inferSbDcSigCoeff = false;
+            if(i < lastSb && i > 0) {
+                m_enc.encodeBin(coded, m_ctx[sbSet(std::min(sbFlagAt(xS + 1, yS) + sbFlagAt(xS, yS + 1), 1))]);
+                inferSbDcSigCoeff = true;
+            } else {
+                coded = true;
+            }
+            sbFlag[yS * sbStride + xS] = coded;
+            if(!coded) {
+                continue;
+            }
+
+            int qStateAt[16];
+            int firstPosMode0 = i == lastSb ? lastPos : numSbCoeff - 1;
+            int n             = firstPosMode0;
+            for(; n >= 0 && remBinsPass1 >= 4; n--) {
+                const int xC = posX(i, n);
+                const int yC = posY(i, n);
+                const int a  = level(i, n);
+                const int d  = xC + yC;
+                int sumAbs1, numSig, sumAbs;
+                xTemplate(xC, yC, sumAbs1, numSig, sumAbs);
+
+                if(i == lastSb && n == lastPos) {
+                    // sig_coeff_flag inferred to be 1
+                } else if(n > 0 || !inferSbDcSigCoeff) {
+                    const int sigCtx = std::min((sumAbs1 + 1) >> 1, 3) + (luma ? (d < 2 ? 8 : d < 5 ? 4 : 0) : (d < 2 ? 4 : 0));
+                    m_enc.encodeBin(a != 0, m_ctx[sigSets[std::max(0, qState - 1)](sigCtx)]);
+                    remBinsPass1--;
+                    inferSbDcSigCoeff &= a == 0;
+                }
+                if(a) {
+                    const int gtxCtx = i == lastSb && n == lastPos ? 0 :
+                        std::min(sumAbs1 - numSig, 4) + 1 + (luma ? (d == 0 ? 15 : d < 3 ? 10 : d < 10 ? 5 : 0) : (d == 0 ? 5 : 0));
+                    m_enc.encodeBin(a > 1, m_ctx[gt1Set(gtxCtx)]);
+                    remBinsPass1--;
+                    if(a > 1) {
+                        m_enc.encodeBin(a & 1, m_ctx[parSet(gtxCtx)]);
+                        m_enc.encodeBin(a > 3, m_ctx[gt3Set(gtxCtx)]);
+                        remBinsPass1 -= 2;
+                    }
+                }
+                qStateAt[n] = qState;
+                qState      = m_depQuant ? nextQState(qState, a) : 0;
+            }
+            const int firstPosMode1 = n;
+
+            for(int k = firstPosMode0; k > firstPosMode1; k--) {
+                const int a = level(i, k);
+                if(a >= 4) {
+                    int sumAbs1, numSig, sumAbs;
+                    xTemplate(posX(i, k), posY(i, k), sumAbs1, numSig, sumAbs);
+                    const int rice = g_goRiceParsCoeffRef[std::max(0, std::min(31, sumAbs - 4 * 5))];
+                    m_enc.encodeRemAbsEP((a - 4 - (a & 1)) / 2, rice, COEF_REMAIN_BIN_REDUCTION, MAX_LOG2_TR_DYNAMIC_RANGE);
+                }
+            }
+            for(n = firstPosMode1; n >= 0; n--) {
+                const int a = level(i, n);
+                int sumAbs1, numSig, sumAbs;
+                xTemplate(posX(i, n), posY(i, n), sumAbs1, numSig, sumAbs);
+                const int rice    = g_goRiceParsCoeffRef[std::min(31, sumAbs)];
+                const int zeroPos = (qState < 2 ? 1 : 2) << rice;
+                m_enc.encodeRemAbsEP(a == 0 ? zeroPos : a <= zeroPos ? a - 1 : a, rice, COEF_REMAIN_BIN_REDUCTION, MAX_LOG2_TR_DYNAMIC_RANGE);
+                qStateAt[n] = qState;
+                qState      = m_depQuant ? nextQState(qState, a) : 0;
+            }
+
+            int firstSig = numSbCoeff, lastSig = -1, sumAbsLevel = 0;
+            for(int k = numSbCoeff - 1; k >= 0; k--) {
+                if(level(i, k)) {
+                    lastSig     = std::max(lastSig, k);
+                    firstSig    = k;
+                    sumAbsLevel += level(i, k);
+                }
+            }
+            const bool signHidden = m_signHiding && lastSig - firstSig > 3;
+            for(int k = numSbCoeff - 1; k >= 0; k--) {
+                const int a = level(i, k);
+                if(!a) {
+                    continue;
+                }
+                const int idx = posY(i, k) * w + posX(i, k);
+                if(signHidden && k == firstSig) {
+                    blk.negative[idx] = sumAbsLevel & 1;
+                    m_numHiddenSigns++;
+                } else {
+                    m_enc.encodeBinEP(blk.negative[idx]);
+                }
+                const int value   = m_depQuant ? 2 * a - (qStateAt[k] > 1) : a;
+                blk.expected[idx] = blk.negative[idx] ? -value : value;
+            }
+        }
+    }
+
+    int getNumHiddenSigns() const { return m_numHiddenSigns; }
+
+private:
+    // cRiceParam for the clipped locSumAbs (table 128)
+    static const int g_goRiceParsCoeffRef[32];
+
+    // Sums over the neighbours at (x+1, y), (x+2, y), (x, y+1), (x, y+2) and (x+1, y+1), which are all
+    // coded before (x, y).
+    void xTemplate(int x, int y, int& sumAbs1, int& numSig, int& sumAbs) const {
+        static const int dx[5] = { 1, 2, 0, 0, 1 };
+        static const int dy[5] = { 0, 0, 1, 2, 1 };
+        sumAbs1 = numSig = sumAbs = 0;
+        for(int k = 0; k < 5; k++) {
+            if(x + dx[k] < m_width && y + dy[k] < m_height) {
+                const int a = m_blk->absLevel[(y + dy[k]) * m_width + x + dx[k]];
+                sumAbs1 += std::min(4 + (a & 1), a);
+                numSig  += a != 0;
+                sumAbs  += a;
+            }
+        }
+    }
+
+    void xEncodeLastPrefix(int pos, int log2TbSize, int log2ZoSize, const CtxSet& ctxSet, bool luma) {
+        static const int lumaCtxOffset[7] = { 0, 0, 0, 3, 6, 10, 15 };
+        int prefix = pos;
+        if(pos > 3) {
+            prefix = 4;
+            while(((2 + ((prefix + 1) & 1)) << (((prefix + 1) >> 1) - 1)) <= pos) {
+                prefix++;
+            }
+        }
+        const int cMax     = (log2ZoSize << 1) - 1;
+        const int ctxOff   = luma ? lumaCtxOffset[log2TbSize] : 0;
+        const int ctxShift = luma ? (log2TbSize + 1) >> 2 : std::max(0, std::min(2, (1 << log2TbSize) >> 3));
+        for(int k = 0; k < prefix; k++) {
+            m_enc.encodeBin(1, m_ctx[ctxSet(ctxOff + (k >> ctxShift))]);
+        }
+        if(prefix < cMax) {
+            m_enc.encodeBin(0, m_ctx[ctxSet(ctxOff + (prefix >> ctxShift))]);
+        }
+    }
+
+    void xEncodeLastSuffix(int pos) {
+        int prefix = pos;
+        if(pos > 3) {
+            prefix = 4;
+            while(((2 + ((prefix + 1) & 1)) << (((prefix + 1) >> 1) - 1)) <= pos) {
+                prefix++;
+            }
+            const int numBins = (prefix >> 1) - 1;
+            m_enc.encodeBinsEP(pos - ((2 + (prefix & 1)) << numBins), numBins);
+        }
+    }
+
+    TestBinEncoder&  m_enc;
+    CtxStore&        m_ctx;
+    const bool       m_depQuant;
+    const bool       m_signHiding;
+    const TestBlock* m_blk            = nullptr;
+    int              m_width          = 0;
+    int              m_height         = 0;
+    int              m_numHiddenSigns = 0;
+};
+
+const int TestResidualEncoder::g_goRiceParsCoeffRef[32] = { 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 2, 2,
+                                                            2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3 };
+
+// Random levels in the top left 32x32 of the block: sparse blocks with a few small levels, dense ones
+// with large levels that take the escape codes, and every density in between.
+static TestBlock randomBlock(TestRandom& rnd, bool luma) {
+    TestBlock blk;
+    blk.compID = luma ? COMPONENT_Y : (rnd.next(2) ? COMPONENT_Cb : COMPONENT_Cr);
+    blk.log2W  = luma ? 2 + rnd.next(5) : 1 + rnd.next(5);
+    blk.log2H  = luma ? 2 + rnd.next(5) : 1 + rnd.next(5);
+    const int w = 1 << blk.log2W;
+    const int h = 1 << blk.log2H;
+    blk.absLevel.assign(w * h, 0);
+    blk.negative.assign(w * h, 0);
+
+    const uint32_t density  = 1 + rnd.next(256);
+    const uint32_t maxLog2  = rnd.next(4) == 0 ? 14 : 1 + rnd.next(5);
+    for(int y = 0; y < std::min(h, 32); y++) {
+        for(int x = 0; x < std::min(w, 32); x++) {
+            if(rnd.next(256) < density) {
+                blk.absLevel[y * w + x] = 1 + (rnd.next() & ((1u << rnd.next(maxLog2 + 1)) - 1));
+                blk.negative[y * w + x] = rnd.next(2);
+            }
+        }
+    }
+    const int x = rnd.next(std::min(w, 32));
+    const int y = rnd.next(std::min(h, 32));
+    if(!blk.absLevel[y * w + x]) {
+        blk.absLevel[y * w + x] = 1;   // at least one significant level
+    }
+    return blk;
+}
+
+struct SliceCfg {
+    SliceType type;
+    bool      cabacInitFlag;
+    int       qp;
+    bool      depQuant;
+    bool      signHiding;
+};
+
+static unsigned initType(const SliceCfg& cfg) {
+    return cfg.type == I_SLICE ? 0 : cfg.type == P_SLICE ? (cfg.cabacInitFlag ? 2 : 1) : (cfg.cabacInitFlag ? 1 : 2);
+}
+
+// Returns the number of signs inferred by sign data hiding.
+static int encodeBlocks(const SliceCfg& cfg, std::vector<TestBlock>& blocks, TestBitWriter& writer) {
+    TestBinEncoder encoder(writer);
+    CtxStore       ctx;
+    ctx.init(cfg.qp, initType(cfg));
+    TestResidualEncoder residual(encoder, ctx, cfg.depQuant, cfg.signHiding);
+    for(TestBlock& blk: blocks) {
+        residual.encode(blk);
+    }
+    encoder.finish();
+    return residual.getNumHiddenSigns();
+}
+
+struct DecodeContext {
+    Slice         slice;
+    CodingUnit    cu;
+    TransformUnit tu;
+    CABACReader   reader;
+
+    explicit DecodeContext(const SliceCfg& cfg) {
+        slice.setSliceType(cfg.type);
+        slice.setCabacInitFlag(cfg.cabacInitFlag);
+        slice.setSliceQp(cfg.qp);
+        slice.setDepQuantEnabledFlag(cfg.depQuant);
+        slice.setSignDataHidingEnabledFlag(cfg.signHiding);
+        cu.slice = &slice;
+        tu.cu    = &cu;
+    }
+
+    void decode(const TestBlock& blk, std::vector<TCoeffSig>& coeffs) {
+        const int w = 1 << blk.log2W;
+        const int h = 1 << blk.log2H;
+        static_cast<UnitArea&>(tu) = UnitArea(CHROMA_444, CompArea(COMPONENT_Y, 0, 0, w, h), CompArea(COMPONENT_Cb, 0, 0, w, h),
+                                              CompArea(COMPONENT_Cr, 0, 0, w, h));
+        coeffs.assign(w * h, 0x5555);   // residual_coding() clears the block itself
+        reader.residual_coding(tu, blk.compID, CoeffSigBuf(coeffs.data(), w, h));
+    }
+};
+
+// Every combination of slice type and cabac_init_flag, dependent quantization and sign data hiding, with
+// many blocks per CABAC stream so the contexts adapt across blocks as in slice data.
+static void testRoundTrip() {
+    TestRandom rnd(19);
+    int        numHidden = 0;
+
+    for(int iter = 0; iter < 600; iter++) {
+        SliceCfg cfg;
+        cfg.type          = (SliceType)(iter % 3 == 0 ? I_SLICE : iter % 3 == 1 ? P_SLICE : B_SLICE);
+        cfg.cabacInitFlag = rnd.next(2);
+        cfg.qp            = rnd.next(64);
+        cfg.depQuant      = (iter / 3) % 2;
+        cfg.signHiding    = !cfg.depQuant && (iter / 6) % 2;
+
+        std::vector<TestBlock> blocks;
+        const int              numBlocks = 1 + rnd.next(40);
+        for(int i = 0; i < numBlocks; i++) {
+            blocks.push_back(randomBlock(rnd, rnd.next(2)));
+        }
+        TestBitWriter writer;
+        numHidden += encodeBlocks(cfg, blocks, writer);
+
+        InputBitstream bs;
+        attach(bs, writer);
+        DecodeContext dec(cfg);
+        dec.reader.initCtxModels(dec.slice);
+        dec.reader.initBitstream(&bs);
+
+        std::vector<TCoeffSig> coeffs;
+        for(const TestBlock& blk: blocks) {
+            dec.decode(blk, coeffs);
+            const int w   = 1 << blk.log2W;
+            bool      ok  = true;
+            int       maxX = 0, maxY = 0;
+            for(size_t k = 0; k < coeffs.size(); k++) {
+                ok &= coeffs[k] == blk.expected[k];
+                if(blk.expected[k]) {
+                    maxX = std::max(maxX, (int)k % w);
+                    maxY = std::max(maxY, (int)k / w);
+                }
+            }
+            TEST_CHECK(ok);
+            TEST_CHECK_EQ(dec.tu.maxScanPosX[blk.compID], maxX);
+            TEST_CHECK_EQ(dec.tu.maxScanPosY[blk.compID], maxY);
+            if(!ok) {
+                fprintf(stderr, "  %dx%d %s, depQuant %d, signHiding %d\n", w, 1 << blk.log2H, isLuma(blk.compID) ? "luma" : "chroma",
+                        cfg.depQuant, cfg.signHiding);
+                break;   // the following blocks are decoded from a desynchronized stream
+            }
+        }
+    }
+    TEST_CHECK(numHidden > 0);
+}
+
+// Decoded coefficients per second for 8x8 to 32x32 luma blocks with the level statistics of
+// moderate QPs, with and without dependent quantization.
+static void benchmark(bool depQuant) {
+    TestRandom             rnd(23);
+    std::vector<TestBlock> blocks;
+    size_t                 numCoeffs = 0;
+    while(numCoeffs < (8 << 20)) {
+        TestBlock blk;
+        blk.compID = COMPONENT_Y;
+        blk.log2W  = 3 + rnd.next(3);
+        blk.log2H  = 3 + rnd.next(3);
+        const int w = 1 << blk.log2W, h = 1 << blk.log2H;
+        blk.absLevel.assign(w * h, 0);
+        blk.negative.assign(w * h, 0);
+        for(int y = 0; y < h; y++) {
+            for(int x = 0; x < w; x++) {
+                // levels decay away from DC
+                const uint32_t p = 256 >> std::min(7, (x + y) / 3);
+                if(rnd.next(256) < p) {
+                    blk.absLevel[y * w + x] = 1 + (rnd.next(4) == 0 ? rnd.next(16) : rnd.next(2));
+                    blk.negative[y * w + x] = rnd.next(2);
+                }
+            }
+        }
+        blk.absLevel[0] = std::max(blk.absLevel[0], 1);
+        numCoeffs += w * h;
+        blocks.push_back(blk);
+    }
+
+    SliceCfg cfg = { B_SLICE, false, 32, depQuant, !depQuant };
+    TestBitWriter writer;
+    encodeBlocks(cfg, blocks, writer);
+
+    double                 bestSec = 1e9;
+    std::vector<TCoeffSig> coeffs;
+    int64_t                sum = 0;
+    for(int run = 0; run < 5; run++) {
+        InputBitstream bs;
+        attach(bs, writer);
+        DecodeContext dec(cfg);
+        dec.reader.initCtxModels(dec.slice);
+        dec.reader.initBitstream(&bs);
+
+        BenchTimer timer;
+        for(const TestBlock& blk: blocks) {
+            dec.decode(blk, coeffs);
+            sum += coeffs[0];
+        }
+        bestSec = std::min(bestSec, timer.elapsedSec());
+    }
+    benchKeep(sum);
+    printf("residual_coding %s: %.1f Mcoeff/s, %.1f Mbit/s of coded data\n", depQuant ? "dependent quantization" : "sign hiding",
+           numCoeffs / bestSec * 1e-6, writer.getNumBits() / bestSec * 1e-6);
+}
+
+int main() {
+    initROM();
+    testRoundTrip();
+    benchmark(false);
+    benchmark(true);
+    return testResult("TestResidualCoding");
+}
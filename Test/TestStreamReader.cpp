@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "App/BitstreamReader.h"
+#include "App/StreamReader.h"
+#include "TestCommon.h"
+
+struct ReadNal {
+    std::vector<uint8_t> bytes;   // the NAL unit without start code and trailing zeros
+    int                  startCodeLen;
+    int                  decodeResult;
+};
+
+// Reads every NAL unit of input and decodes it with its own decoder instance.
+static std::vector<ReadNal> readAll(BitstreamInput& input) {
+    std::vector<ReadNal> nals;
+    Decoder*             dec        = decoderOpen();
+    AccessUnit&          accessUnit = *accessUnitAlloc();
+    Frame*               frame      = nullptr;
+    while(input.read(accessUnit) > 0) {
+        TEST_CHECK(accessUnit.nals != nullptr && accessUnit.numNals == 1);
+        if(accessUnit.nals == nullptr) {
+            break;
+        }
+        const NalBoundary& b = accessUnit.nals[0];
+        ReadNal            nal;
+        nal.bytes.assign(accessUnit.payload + b.offset, accessUnit.payload + b.offset + b.size);
+        nal.startCodeLen = b.startCodeLen;
+        nal.decodeResult = decode(dec, &accessUnit, &frame);
+        nals.push_back(nal);
+    }
+    return nals;
+}
+
+static bool isVclNal(const uint8_t* payload, const AccessUnit& accessUnit) {
+    return accessUnit.nals && getNalUnitHeaderType(payload + accessUnit.nals[0].offset) < NAL_UNIT_DCI;
+}
+
+// Writes data into fd in random chunks of 1 to maxChunk bytes, optionally pausing after each chunk like
+// a network source, and closes fd at the end.
+static void writeChunks(int fd, const std::vector<uint8_t>& data, uint64_t seed, uint32_t maxChunk, int pauseUs) {
+    TestRandom rnd(seed);
+    size_t     pos = 0;
+    while(pos < data.size()) {
+        const size_t len = std::min<size_t>(data.size() - pos, 1 + rnd.next(maxChunk));
+        const ssize_t ret = ::write(fd, data.data() + pos, len);
+        if(ret <= 0) {
+            break;
+        }
+        pos += ret;
+        if(pauseUs) {
+            usleep(pauseUs);
+        }
+    }
+    ::close(fd);
+}
+
+// A pipe whose read end StreamReader opens through /dev/fd, fed by a writer thread.
+class ChunkedPipe {
+public:
+    ChunkedPipe(const std::vector<uint8_t>& data, uint64_t seed, uint32_t maxChunk, int pauseUs) {
+        TEST_CHECK_EQ(pipe(m_fds), 0);
+        m_writer = std::thread(writeChunks, m_fds[1], std::cref(data), seed, maxChunk, pauseUs);
+    }
+    ~ChunkedPipe() {
+        m_writer.join();
+        ::close(m_fds[0]);
+    }
+    std::string getPath() const { return "/dev/fd/" + std::to_string(m_fds[0]); }
+
+private:
+    int         m_fds[2] = { -1, -1 };
+    std::thread m_writer;
+};
+
+static void writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "wb");
+    TEST_CHECK(file != nullptr);
+    if(file) {
+        fwrite(data.data(), 1, data.size(), file);
+        fclose(file);
+    }
+}
+
+// Streams fed in random chunk sizes through a ring that wraps several times must give the NAL units and
+// decode results of the memory-mapped file.
+static void testSameAsFile(const std::string& file, const std::vector<uint8_t>& data, size_t ringSize) {
+    BitstreamReader fileReader;
+    TEST_CHECK_EQ(fileReader.open(file), 0);
+    const std::vector<ReadNal> expected = readAll(fileReader);
+    TEST_CHECK(expected.size() > 1);
+
+    for(uint64_t seed = 1; seed <= 20; seed++) {
+        const uint32_t maxChunk = seed <= 10 ? 16 : 3000;
+        ChunkedPipe    pipe(data, seed, maxChunk, 0);
+        StreamReader   streamReader;
+        TEST_CHECK_EQ(streamReader.open(pipe.getPath(), ringSize), 0);
+        const std::vector<ReadNal> nals = readAll(streamReader);
+        streamReader.close();
+
+        TEST_CHECK_EQ(nals.size(), expected.size());
+        for(size_t i = 0; i < std::min(nals.size(), expected.size()); i++) {
+            TEST_CHECK(nals[i].bytes == expected[i].bytes);
+            TEST_CHECK_EQ(nals[i].startCodeLen, expected[i].startCodeLen);
+            TEST_CHECK_EQ(nals[i].decodeResult, expected[i].decodeResult);
+        }
+    }
+}
+
+// Time from the first byte leaving a paced producer until the first coded slice reaches the decoder. The
+// file path has to wait for the whole stream to be written to a temporary file before it can open it.
+static void benchTimeToFirstPicture(const std::string& file, const std::vector<uint8_t>& data) {
+    const uint32_t maxChunk = 2048;
+    const int      pauseUs  = 100;
+    AccessUnit&    accessUnit = *accessUnitAlloc();
+
+    double fileSec = 0;
+    {
+        BenchTimer timer;
+        int        fds[2];
+        TEST_CHECK_EQ(pipe(fds), 0);
+        std::thread writer(writeChunks, fds[1], std::cref(data), 1, maxChunk, pauseUs);
+        std::vector<uint8_t> received;
+        uint8_t              buf[4096];
+        for(ssize_t ret; (ret = ::read(fds[0], buf, sizeof(buf))) > 0;) {
+            received.insert(received.end(), buf, buf + ret);
+        }
+        writer.join();
+        ::close(fds[0]);
+        writeFile(file, received);
+
+        BitstreamReader reader;
+        TEST_CHECK_EQ(reader.open(file), 0);
+        while(reader.read(accessUnit) > 0 && !isVclNal(accessUnit.payload, accessUnit)) {
+        }
+        fileSec = timer.elapsedSec();
+    }
+
+    double streamSec = 0;
+    {
+        BenchTimer   timer;
+        ChunkedPipe  pipe(data, 1, maxChunk, pauseUs);
+        StreamReader reader;
+        TEST_CHECK_EQ(reader.open(pipe.getPath(), StreamReader::DEFAULT_RING_SIZE), 0);
+        while(reader.read(accessUnit) > 0 && !isVclNal(accessUnit.payload, accessUnit)) {
+        }
+        streamSec = timer.elapsedSec();
+        while(reader.read(accessUnit) > 0) {   // drain, so the writer can finish
+        }
+    }
+
+    printf("time to first picture, %.1f KiB in chunks of up to %u bytes every %d us: temp file %.2f ms, stream %.2f ms\n",
+           data.size() / 1024.0, maxChunk, pauseUs, fileSec * 1e3, streamSec * 1e3);
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: TestStreamReader <bitstream>\n");
+        return 1;
+    }
+
+    char tmpDir[] = "/tmp/w266-stream-XXXXXX";
+    TEST_CHECK(mkdtemp(tmpDir) != nullptr);
+    const std::string file = std::string(tmpDir) + "/bs.266";
+
+    // several copies of the sample stream, so that a small ring wraps around repeatedly
+    const std::vector<uint8_t> sample = readFile(argv[1]);
+    TEST_CHECK(!sample.empty());
+    std::vector<uint8_t> data;
+    for(int i = 0; i < 8; i++) {
+        data.insert(data.end(), sample.begin(), sample.end());
+    }
+    writeFile(file, data);
+
+    // the smallest ring that holds the largest NAL unit of the sample
+    size_t ringSize = 4096;
+    while(ringSize < sample.size()) {
+        ringSize <<= 1;
+    }
+    TEST_CHECK(data.size() > 2 * ringSize);
+    testSameAsFile(file, data, ringSize);
+
+    std::vector<uint8_t> paced;
+    for(int i = 0; i < 8; i++) {
+        paced.insert(paced.end(), data.begin(), data.end());
+    }
+    benchTimeToFirstPicture(file, paced);
+
+    unlink(file.c_str());
+    rmdir(tmpDir);
+    return testResult("TestStreamReader");
+}